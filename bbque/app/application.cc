@@ -123,10 +123,9 @@ void Application::InitWorkingModes(AppPtr_t & papp) {
 
 	// Init AWM lists
 	for (int i = 0; i <= awms.max_id; ++i) {
-		// Copy the working mode and set the owner (current Application)
-		AwmPtr_t app_awm(new WorkingMode(*rcp_awms[i]));
-		assert(!app_awm->Owner());
-		app_awm->SetOwner(papp);
+		// Instance the working mode, owned by the current Application, which
+		// shares the recipe information (i.e., the resource usages)
+		AwmPtr_t app_awm(new WorkingMode(*rcp_awms[i], papp));
 
 		// Insert the working mode into the vector
 		awms.recipe_vect[app_awm->Id()] = app_awm;
@@ -629,6 +628,7 @@ Application::ExitCode_t Application::ScheduleRequest(AwmPtr_t const & awm,
 	ResourceAccounter &ra(ResourceAccounter::GetInstance());
 	ResourceAccounter::ExitCode_t booking;
 	AppSPtr_t papp(awm->Owner());
+	br::UsagesMapPtr_t pum;
 	ExitCode_t result;
 
 	// App is SYNC/BLOCKED for a previously failed scheduling.
@@ -653,8 +653,13 @@ Application::ExitCode_t Application::ScheduleRequest(AwmPtr_t const & awm,
 		return APP_DISABLED;
 	}
 
+	// The resource bindings of the AWMs evaluated are released at the
+	// beginning of the next scheduling run, while the one booked is kept up
+	// to the release of the resources: move it on the heap
+	pum = awm->CopySchedResourceBinding(bid);
+
 	// Checking for resources availability
-	booking = ra.BookResources(papp, awm->GetSchedResourceBinding(bid), vtok);
+	booking = ra.BookResources(papp, pum, vtok);
 
 	// If resources are not available, unschedule
 	if (booking != ResourceAccounter::RA_SUCCESS) {
@@ -664,7 +669,7 @@ Application::ExitCode_t Application::ScheduleRequest(AwmPtr_t const & awm,
 	}
 
 	// Bind the resource set to the working mode
-	awm->SetResourceBinding(bid);
+	awm->SetResourceBinding(pum);
 
 	// Reschedule accordingly to "awm"
 	logger->Debug("Rescheduling [%s] into AWM [%d:%s]...",
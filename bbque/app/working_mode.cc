@@ -24,6 +24,7 @@
 
 #include "bbque/app/application.h"
 #include "bbque/resource_accounter.h"
+#include "bbque/scheduler_manager.h"
 #include "bbque/res/resource_utils.h"
 #include "bbque/utils/utility.h"
 
@@ -31,28 +32,31 @@ namespace br = bbque::res;
 namespace bp = bbque::plugins;
 
 using br::ResourcePathUtils;
+using br::UsagesMapAlloc_t;
 
 namespace bbque { namespace app {
 
 
 WorkingMode::WorkingMode():
-	hidden(false) {
-	resources.on_sched.resize(MAX_NUM_BINDINGS);
+	info(new WorkingModeInfo) {
+	info->hidden = false;
+	resources.on_sched = nullptr;
 }
 
 
 WorkingMode::WorkingMode(uint8_t _id,
 		std::string const & _name,
 		float _value):
-	id(_id),
-	name(_name),
-	hidden(false) {
+	info(new WorkingModeInfo) {
+
+	info->id = _id;
+	info->name = _name;
+	info->hidden = false;
 
 	// Value must be positive
-	_value > 0 ? value.recpv = _value : value.recpv = 0;
+	_value > 0 ? info->value.recpv = _value : info->value.recpv = 0;
 
-	// Init the size of the scheduling bindings vector
-	resources.on_sched.resize(MAX_NUM_BINDINGS);
+	resources.on_sched = nullptr;
 
 	// Get a logger
 	bp::LoggerIF::Configuration conf(AWM_NAMESPACE);
@@ -60,8 +64,18 @@ WorkingMode::WorkingMode(uint8_t _id,
 }
 
 
+WorkingMode::WorkingMode(WorkingMode const & rcp_awm,
+		AppSPtr_t const & papp):
+	logger(rcp_awm.logger),
+	owner(papp),
+	info(rcp_awm.info) {
+
+	resources.on_sched = nullptr;
+	clusters.changed = false;
+}
+
+
 WorkingMode::~WorkingMode() {
-	resources.from_recp.clear();
 	if (resources.to_sync)
 		resources.to_sync->clear();
 }
@@ -80,7 +94,7 @@ WorkingMode::ExitCode_t WorkingMode::AddResourceUsage(
 
 	// Insert a new resource usage object in the map
 	UsagePtr_t pusage(UsagePtr_t(new Usage(required_amount)));
-	resources.from_recp.insert(
+	info->from_recp.insert(
 			std::pair<std::string, UsagePtr_t>(rsrc_path, pusage));
 
 	logger->Debug("AddResourceUsage: added {%s}\t[usage: %" PRIu64 "]",
@@ -95,9 +109,9 @@ WorkingMode::ExitCode_t WorkingMode::Validate() {
 	uint64_t total_amount;
 
 	// Initialization
-	usage_it = resources.from_recp.begin();
-	it_end   = resources.from_recp.end();
-	hidden   = false;
+	usage_it = info->from_recp.begin();
+	it_end   = info->from_recp.end();
+	info->hidden = false;
 
 	// Map of resource usages required
 	for (; usage_it != it_end; ++usage_it) {
@@ -117,8 +131,8 @@ WorkingMode::ExitCode_t WorkingMode::Validate() {
 					"exceeds total (%" PRIu64 ")",
 					rcp_path_tpl.c_str(), rcp_pusage->GetAmount(),
 					total_amount);
-			hidden = true;
-			logger->Warn("validation: AWM %d set to 'hidden'", id);
+			info->hidden = true;
+			logger->Warn("validation: AWM %d set to 'hidden'", info->id);
 			return WM_RSRC_USAGE_EXCEEDS;
 		}
 	}
@@ -145,8 +159,8 @@ uint64_t WorkingMode::ResourceUsageAmount(
 
 UsagePtr_t
 WorkingMode::ResourceUsageTempRef(std::string const & temp_path) const {
-	UsagesMap_t::const_iterator rsrc_it(resources.from_recp.begin());
-	UsagesMap_t::const_iterator it_end(resources.from_recp.end());
+	UsagesMap_t::const_iterator rsrc_it(info->from_recp.begin());
+	UsagesMap_t::const_iterator it_end(info->from_recp.end());
 
 	// Iterate over the map of resource usages retrieved from the recipe
 	for (; rsrc_it != it_end; ++rsrc_it) {
@@ -171,12 +185,12 @@ WorkingMode::ResourceUsageRef(std::string const & rsrc_path) const {
 	// If the resource binding is missing, perform the search in the map of
 	// resource usages parsed from the recipe
 	if (!resources.to_sync)
-		rsrc_it = resources.from_recp.find(rsrc_path);
+		rsrc_it = info->from_recp.find(rsrc_path);
 	else
 		rsrc_it = resources.to_sync->find(rsrc_path);
 
 	// Search failed
-	if (rsrc_it != resources.from_recp.end())
+	if (rsrc_it != info->from_recp.end())
 		return UsagePtr_t();
 
 	// Return the Usage object
@@ -190,28 +204,39 @@ WorkingMode::ExitCode_t WorkingMode::BindResource(
 		ResID_t dst_ID,
 		uint8_t bid) {
 	ResourceAccounter &ra(ResourceAccounter::GetInstance());
+	Arena & arena(SchedulerManager::SchedArena());
 	UsagesMap_t::iterator usage_it, it_end;
+	SchedBinding_t * sched_bind;
 
 	// Null name check
 	if (rsrc_name.empty()) {
-		logger->Error("Binding [AWM%d]: Missing resource name", id);
+		logger->Error("Binding [AWM%d]: Missing resource name", info->id);
 		return WM_RSRC_ERR_NAME;
 	}
 
-	// Allocate a new temporary resource usages map
-	UsagesMapPtr_t temp_binds(UsagesMapPtr_t(new UsagesMap_t()));
+	// Allocate a new temporary resource usages map on the scheduling arena
+	UsagesMap_t * temp_binds(arena.New<UsagesMap_t>(
+				std::less<std::string>(), UsagesMapAlloc_t(&arena)));
+
+	// The bindings of the current scheduling run
+	if (!SchedBindings()) {
+		resources.on_sched = arena.New<SchedBindings_t>(
+				ArenaAllocator<SchedBinding_t>(&arena));
+		resources.on_sched_gen = arena.Generation();
+	}
+	sched_bind = SchedBindingRef(bid);
 
 	// If this is the first binding action, the resource paths to consider
 	// must be taken from the recipe resource map. Converserly, if a previous
 	// call to this method has been performed, a map of resource usages to
 	// schedule has been created. Thus we must continue the binding...
-	if (!resources.on_sched[bid]) {
-		usage_it = resources.from_recp.begin();
-		it_end = resources.from_recp.end();
+	if (!sched_bind) {
+		usage_it = info->from_recp.begin();
+		it_end = info->from_recp.end();
 	}
 	else {
-		usage_it = resources.on_sched[bid]->begin();
-		it_end = resources.on_sched[bid]->end();
+		usage_it = sched_bind->usages->begin();
+		it_end = sched_bind->usages->end();
 	}
 
 	// Proceed with the resource binding...
@@ -224,12 +249,18 @@ WorkingMode::ExitCode_t WorkingMode::BindResource(
 		std::string bind_path(
 				ResourcePathUtils::ReplaceID(rcp_path, rsrc_name, src_ID,
 					dst_ID));
-		logger->Debug("Binding [AWM%d]: 'recipe' [%s] \t=> 'platform' [%s]", id,
+		logger->Debug("Binding [AWM%d]: 'recipe' [%s] \t=> 'platform' [%s]", info->id,
 				rcp_path.c_str(), bind_path.c_str());
 
-		// Create a new Usage object and set the binding list
-		UsagePtr_t bind_pusage(new Usage(rcp_pusage->GetAmount()));
-		bind_pusage->SetBindingList(ra.GetResources(bind_path));
+		// Create a new Usage object and set the binding list, both of them
+		// on the scheduling arena
+		ResourcePtrListAlloc_t list_alloc(&arena);
+		ResourcePtrList_t bind_list(list_alloc);
+		ra.GetResources(bind_path, bind_list);
+		UsagePtr_t bind_pusage(std::allocate_shared<Usage>(
+					ArenaAllocator<Usage>(&arena),
+					rcp_pusage->GetAmount(), list_alloc));
+		bind_pusage->SetBindingList(bind_list);
 		assert(!bind_pusage->EmptyBindingList());
 
 		// Insert the bound resource into the temporary resource usages map
@@ -238,46 +269,50 @@ WorkingMode::ExitCode_t WorkingMode::BindResource(
 	}
 
 	// Update the resource usages map to schedule
-	resources.on_sched[bid] = temp_binds;
+	if (!sched_bind) {
+		SchedBinding_t new_bind = { bid, temp_binds };
+		resources.on_sched->push_back(new_bind);
+	} else
+		sched_bind->usages = temp_binds;
 
 	// Debug messages
 	DB(
-		usage_it = resources.on_sched[bid]->begin();
-		it_end = resources.on_sched[bid]->end();
+		usage_it = temp_binds->begin();
+		it_end = temp_binds->end();
 		for (; usage_it != it_end; ++usage_it) {
 			UsagePtr_t & pusage(usage_it->second);
 			std::string const & rcp_path(usage_it->first);
 
 			logger->Debug("Binding [AWM%d]: {%s}\t[amount: %" PRIu64 " bindings: %d]",
-					id, rcp_path.c_str(), pusage->GetAmount(),
+					info->id, rcp_path.c_str(), pusage->GetAmount(),
 					pusage->GetBindingList().size());
 		}
-		logger->Debug("Binding [AWM%d]: %d resources bound", id,
-			resources.on_sched[bid]->size());
+		logger->Debug("Binding [AWM%d]: %d resources bound", info->id,
+			temp_binds->size());
 	);
 
 	// Are all the resource usages bound ?
-	if (resources.from_recp.size() < resources.on_sched[bid]->size())
+	if (info->from_recp.size() < temp_binds->size())
 		return WM_RSRC_MISS_BIND;
 
 	return WM_SUCCESS;
 }
 
 
-WorkingMode::ExitCode_t WorkingMode::SetResourceBinding(uint8_t bid) {
+WorkingMode::ExitCode_t WorkingMode::SetResourceBinding(
+		UsagesMapPtr_t const & binding) {
 	ClustersBitSet clust_tmp;
 
 	// The binding map must have the same size of resource usages map built
 	// from the recipe
-	if (!resources.on_sched[bid] ||
-			(resources.on_sched[bid]->size() != resources.from_recp.size()))
+	if (!binding || (binding->size() != info->from_recp.size()))
 		return WM_RSRC_MISS_BIND;
 
 	// Init the iterators for the maps
-	UsagesMap_t::iterator bind_it(resources.on_sched[bid]->begin());
-	UsagesMap_t::iterator end_bind(resources.on_sched[bid]->end());
-	UsagesMap_t::iterator recp_it(resources.from_recp.begin());
-	UsagesMap_t::iterator end_recp(resources.from_recp.end());
+	UsagesMap_t::iterator bind_it(binding->begin());
+	UsagesMap_t::iterator end_bind(binding->end());
+	UsagesMap_t::iterator recp_it(info->from_recp.begin());
+	UsagesMap_t::iterator end_recp(info->from_recp.end());
 
 	// Check the correctness of the binding
 	for(; bind_it != end_bind, recp_it != end_recp; ++recp_it, ++bind_it) {
@@ -289,7 +324,7 @@ WorkingMode::ExitCode_t WorkingMode::SetResourceBinding(uint8_t bid) {
 		// A mismatch of path template means an error
 		if (bind_tmpl.compare(recp_tmpl) != 0) {
 			logger->Error("SetBinding [AWM%d]: %s resource path mismatch %s",
-					id, bind_tmpl.c_str(), recp_tmpl.c_str());
+					info->id, bind_tmpl.c_str(), recp_tmpl.c_str());
 			return WM_RSRC_MISS_BIND;
 		}
 
@@ -299,28 +334,99 @@ WorkingMode::ExitCode_t WorkingMode::SetResourceBinding(uint8_t bid) {
 			continue;
 
 		// Set the bit in the clusters bitset
-		logger->Debug("SetBinding [AWM%d]: Bound into cluster %d", id, cl_id);
+		logger->Debug("SetBinding [AWM%d]: Bound into cluster %d", info->id, cl_id);
 		clust_tmp.set(cl_id);
 	}
 
 	// Update the clusters bitset
 	clusters.prev = clusters.curr;
 	clusters.curr = clust_tmp;
-	logger->Debug("SetBinding [AWM%d]: previous cluster set: %s", id,
+	logger->Debug("SetBinding [AWM%d]: previous cluster set: %s", info->id,
 			clusters.prev.to_string().c_str());
-	logger->Debug("SetBinding [AWM%d]:  current cluster set: %s", id,
+	logger->Debug("SetBinding [AWM%d]:  current cluster set: %s", info->id,
 			clusters.curr.to_string().c_str());
 
 	// Cluster set changed?
 	clusters.changed = clusters.prev != clusters.curr;
 
 	// Set the new binding / resource usages map
-	resources.to_sync = resources.on_sched[bid];
-	resources.on_sched[bid].reset();
+	resources.to_sync = binding;
 
 	return WM_SUCCESS;
 }
 
+
+/**
+ * @brief Deleter of the maps allocated on the scheduling arena
+ */
+static void ArenaUsagesMapRelease(UsagesMap_t *) {
+	// Released by the arena reset
+}
+
+UsagesMapPtr_t WorkingMode::GetSchedResourceBinding(uint8_t bid) const {
+	Arena & arena(SchedulerManager::SchedArena());
+	SchedBinding_t * sched_bind;
+
+	sched_bind = SchedBindingRef(bid);
+	if (!sched_bind)
+		return UsagesMapPtr_t();
+
+	// The reference count is allocated on the arena as well
+	return UsagesMapPtr_t(sched_bind->usages, ArenaUsagesMapRelease,
+			ArenaAllocator<UsagesMap_t>(&arena));
+}
+
+UsagesMapPtr_t WorkingMode::CopySchedResourceBinding(uint8_t bid) const {
+	SchedBinding_t * sched_bind;
+	UsagesMap_t::const_iterator usage_it;
+	UsagesMapPtr_t pum;
+
+	sched_bind = SchedBindingRef(bid);
+	if (!sched_bind)
+		return pum;
+
+	// Both the Usage objects and their binding lists must be moved on the
+	// heap, since they are released by the arena reset as well
+	pum = UsagesMapPtr_t(new UsagesMap_t);
+	for (usage_it = sched_bind->usages->begin();
+			usage_it != sched_bind->usages->end(); ++usage_it) {
+		UsagePtr_t const & sched_pusage(usage_it->second);
+		UsagePtr_t pusage(new Usage(sched_pusage->GetAmount()));
+		ResourcePtrList_t const & bind_list(sched_pusage->GetBindingList());
+
+		pusage->SetBindingList(
+				ResourcePtrList_t(bind_list.begin(), bind_list.end()));
+		pum->insert(std::pair<std::string, UsagePtr_t>(
+					usage_it->first, pusage));
+	}
+
+	return pum;
+}
+
+WorkingMode::SchedBindings_t * WorkingMode::SchedBindings() const {
+	Arena & arena(SchedulerManager::SchedArena());
+
+	if (!resources.on_sched ||
+			(resources.on_sched_gen != arena.Generation()))
+		return nullptr;
+
+	return resources.on_sched;
+}
+
+WorkingMode::SchedBinding_t * WorkingMode::SchedBindingRef(uint8_t bid) const {
+	SchedBindings_t * sched_binds(SchedBindings());
+
+	if (!sched_binds)
+		return nullptr;
+
+	for (size_t i = 0; i < sched_binds->size(); ++i) {
+		if ((*sched_binds)[i].bid == bid)
+			return &(*sched_binds)[i];
+	}
+
+	return nullptr;
+}
+
 } // namespace app
 
 } // namespace bbque
@@ -25,12 +25,24 @@
 #include "bbque/app/working_mode.h"
 #include "bbque/app/recipe.h"
 #include "bbque/plugins/recipe_loader.h"
+#include "bbque/plugins/recipe_compiled.h"
 #include "bbque/resource_accounter.h"
 #include "bbque/cpp11/chrono.h"
+#include "bbque/utils/utility.h"
 
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
 
+#include <cstring>
+#include <set>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+
 #define RP_DIV1 "============================================================="
 #define RP_DIV2 "|------------------+------------+-------------+-------------|"
 #define RP_DIV3 "|..................+............+.............+.............|"
@@ -38,10 +50,10 @@
 
 #define PRINT_NOTICE_IF_VERBOSE(verbose, text)\
 	if (verbose)\
-		logger->Notice(text);\
+		logger->Notice("%s", text);\
 	else\
 		DB(\
-		logger->Debug(text);\
+		logger->Debug("%s", text);\
 		);
 
 
@@ -62,6 +74,7 @@ ApplicationManager & ApplicationManager::GetInstance() {
 
 ApplicationManager::ApplicationManager() :
 	pp(PlatformProxy::GetInstance()),
+	recipes_done(false),
 	cleanup_dfr("am.cln", std::bind(&ApplicationManager::Cleanup, this)) {
 
 	// Get a logger
@@ -76,6 +89,8 @@ ApplicationManager::ApplicationManager() :
 		assert(rloader);
 	}
 
+	recipes_wakeup_fd[0] = recipes_wakeup_fd[1] = -1;
+
 	// Debug logging
 	logger->Debug("Priority levels: %d, (O = highest)",
 			BBQUE_APP_PRIO_LEVELS);
@@ -84,6 +99,20 @@ ApplicationManager::ApplicationManager() :
 
 
 ApplicationManager::~ApplicationManager() {
+	char wakeup = 0;
+
+	// Stop the recipes prefetch and watcher
+	__atomic_store_n(&recipes_done, true, __ATOMIC_RELEASE);
+	if ((recipes_wakeup_fd[1] >= 0) &&
+			(::write(recipes_wakeup_fd[1], &wakeup, 1) < 0))
+		logger->Warn("Recipes watcher wake-up FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+	if (recipes_thd.joinable())
+		recipes_thd.join();
+	if (recipes_wakeup_fd[0] >= 0) {
+		::close(recipes_wakeup_fd[0]);
+		::close(recipes_wakeup_fd[1]);
+	}
 
 	// Clear the sync vector
 	logger->Debug("Clearing SYNC vector...");
@@ -149,6 +178,20 @@ bp::RecipeLoaderIF::ExitCode_t ApplicationManager::LoadRecipe(
 		recipe = (*it).second;
 		return bp::RecipeLoaderIF::RL_SUCCESS;
 	}
+	recipes_ul.unlock();
+
+	// Serialize the parsing, and check again for the recipe, which could
+	// have been loaded meanwhile (e.g. by the prefetch)
+	std::unique_lock<std::mutex> rloader_ul(rloader_mtx);
+	recipes_ul.lock();
+	it = recipes.find(recipe_name);
+	if (it != recipes.end()) {
+		logger->Debug("recipe [%s] already loaded",
+				recipe_name.c_str());
+		recipe = (*it).second;
+		return bp::RecipeLoaderIF::RL_SUCCESS;
+	}
+	recipes_ul.unlock();
 
 	//---  Loading a new recipe
 	logger->Info("Loading NEW recipe [%s]...", recipe_name.c_str());
@@ -179,6 +222,7 @@ bp::RecipeLoaderIF::ExitCode_t ApplicationManager::LoadRecipe(
 	recipe->Validate();
 
 	// Place the new recipe object in the map, and return it
+	recipes_ul.lock();
 	recipes[recipe_name] = recipe;
 
 	return bp::RecipeLoaderIF::RL_SUCCESS;
@@ -186,6 +230,263 @@ bp::RecipeLoaderIF::ExitCode_t ApplicationManager::LoadRecipe(
 }
 
 
+/*******************************************************************************
+  *     Recipes Prefetch and Watcher
+  *****************************************************************************/
+
+void ApplicationManager::StartRecipesPrefetch() {
+
+	if (recipes_thd.joinable())
+		return;
+
+	// Setup the pipe used to wake-up the recipes watcher
+	if (::pipe2(recipes_wakeup_fd, O_CLOEXEC|O_NONBLOCK)) {
+		logger->Error("Recipes watcher wake-up pipe setup FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		recipes_wakeup_fd[0] = recipes_wakeup_fd[1] = -1;
+		return;
+	}
+
+	recipes_thd = std::thread(&ApplicationManager::RecipesTask, this);
+}
+
+static bool HasSuffix(std::string const & str, std::string const & suffix) {
+	return (str.size() > suffix.size()) &&
+		(str.compare(str.size() - suffix.size(), suffix.size(),
+			suffix) == 0);
+}
+
+/**
+ * @brief Get the name of the recipe stored into the specified file
+ *
+ * @return An empty string if the file is not a (compiled) recipe
+ */
+static std::string RecipeName(std::string const & file) {
+	static const std::string xml_ext(RECIPE_FILE_EXT);
+	static const std::string brc_ext(BBQUE_RECIPE_COMPILED_EXT);
+
+	if (HasSuffix(file, xml_ext))
+		return file.substr(0, file.size() - xml_ext.size());
+	if (HasSuffix(file, brc_ext))
+		return file.substr(0, file.size() - brc_ext.size());
+	return std::string();
+}
+
+void ApplicationManager::ListRecipes(std::string const & dir,
+		std::vector<std::string> & names) {
+	std::set<std::string> found;
+	struct dirent * entry;
+	std::string name;
+	DIR * pdir;
+
+	pdir = ::opendir(dir.c_str());
+	if (!pdir) {
+		logger->Warn("Recipes directory [%s] scanning FAILED "
+				"(Error %d: %s)", dir.c_str(), errno, strerror(errno));
+		return;
+	}
+
+	// A recipe could be there both in XML and compiled format
+	while ((entry = ::readdir(pdir)) != NULL) {
+		name = RecipeName(entry->d_name);
+		if (!name.empty())
+			found.insert(name);
+	}
+	::closedir(pdir);
+
+	names.assign(found.begin(), found.end());
+}
+
+void ApplicationManager::PrefetchRecipes(RecipeLoaderIF * loader,
+		std::vector<std::string> const & names, uint32_t * next) {
+	bp::RecipeLoaderIF::ExitCode_t result;
+	RecipePtr_t recipe;
+	uint32_t idx;
+
+	while (!__atomic_load_n(&recipes_done, __ATOMIC_ACQUIRE)) {
+		idx = __atomic_fetch_add(next, 1, __ATOMIC_RELAXED);
+		if (idx >= names.size())
+			break;
+
+		recipe = RecipePtr_t(new ba::Recipe(names[idx]));
+		result = loader->LoadRecipe(names[idx], recipe);
+
+		// Leave the recipe to be loaded at registration time, which
+		// accepts a weak load, or reports the errors
+		if (result == bp::RecipeLoaderIF::RL_WEAK_LOAD) {
+			logger->Debug("Prefetch recipe [%s] SKIPPED (weak load)",
+					names[idx].c_str());
+			continue;
+		}
+		if (result != bp::RecipeLoaderIF::RL_SUCCESS) {
+			logger->Warn("Prefetch recipe [%s] FAILED (Error: %d)",
+					names[idx].c_str(), result);
+			continue;
+		}
+		recipe->Validate();
+
+		// Keep a recipe loaded meanwhile by a registration
+		std::unique_lock<std::mutex> recipes_ul(recipes_mtx);
+		recipes.insert(
+				std::pair<std::string, RecipePtr_t>(names[idx], recipe));
+	}
+}
+
+void ApplicationManager::ReloadRecipe(std::string const & name) {
+	std::unique_lock<std::mutex> rloader_ul(rloader_mtx);
+	bp::RecipeLoaderIF::ExitCode_t result;
+	RecipePtr_t recipe;
+
+	// Forget the recipe, if it is not there anymore (in any format)
+	if ((::access((rloader->RecipesDir() + "/" + name +
+						RECIPE_FILE_EXT).c_str(), F_OK) != 0) &&
+			(::access((rloader->RecipesDir() + "/" + name +
+					   BBQUE_RECIPE_COMPILED_EXT).c_str(), F_OK) != 0)) {
+		logger->Info("Recipe [%s] removed", name.c_str());
+		std::unique_lock<std::mutex> recipes_ul(recipes_mtx);
+		recipes.erase(name);
+		return;
+	}
+
+	logger->Info("Reloading CHANGED recipe [%s]...", name.c_str());
+	recipe = RecipePtr_t(new ba::Recipe(name));
+	result = rloader->LoadRecipe(name, recipe);
+	if (result == bp::RecipeLoaderIF::RL_SUCCESS)
+		recipe->Validate();
+
+	// A recipe not fully loaded is forgotten, thus the next registration
+	// will try to load it again, and report the errors
+	std::unique_lock<std::mutex> recipes_ul(recipes_mtx);
+	if (result != bp::RecipeLoaderIF::RL_SUCCESS) {
+		logger->Warn("Reload recipe [%s] FAILED (Error: %d)",
+				name.c_str(), result);
+		recipes.erase(name);
+		return;
+	}
+	recipes[name] = recipe;
+}
+
+void ApplicationManager::RecipesTask() {
+	std::unique_lock<std::mutex> recipes_ul(recipes_mtx, std::defer_lock);
+	std::vector<std::string> names;
+	std::vector<std::thread> workers;
+	std::set<std::string> changed;
+	std::set<std::string>::iterator it;
+	struct inotify_event * event;
+	struct pollfd fds[2];
+	uint32_t next = 0;
+	uint16_t nr_workers;
+	std::string dir;
+	std::string name;
+	char buff[4096]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	char drain[8];
+	ssize_t len;
+	int watch_fd;
+
+	// Set the module name
+	if (prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("am.rcp"),
+				0, 0, 0) != 0) {
+		logger->Error("Set name FAILED! (Error: %s)\n", strerror(errno));
+	}
+
+	dir = rloader->RecipesDir();
+
+	// Start watching before the prefetch, to not miss any change
+	watch_fd = ::inotify_init1(IN_CLOEXEC|IN_NONBLOCK);
+	if ((watch_fd >= 0) && (::inotify_add_watch(watch_fd, dir.c_str(),
+				IN_CLOSE_WRITE|IN_MOVED_TO|IN_DELETE|IN_MOVED_FROM) < 0)) {
+		::close(watch_fd);
+		watch_fd = -1;
+	}
+	if (watch_fd < 0)
+		logger->Warn("Recipes directory [%s] watch FAILED "
+				"(Error %d: %s)", dir.c_str(), errno, strerror(errno));
+
+	//---  Recipes prefetch
+	ListRecipes(dir, names);
+	nr_workers = std::thread::hardware_concurrency();
+	if (nr_workers == 0)
+		nr_workers = ::sysconf(_SC_NPROCESSORS_ONLN);
+	if (nr_workers > names.size())
+		nr_workers = names.size();
+
+	logger->Info("Prefetching %d recipes from [%s] (%d workers)...",
+			names.size(), dir.c_str(), nr_workers);
+
+	// Each worker needs its own recipe loader module
+	for (uint16_t i = prefetch_rloaders.size(); i < nr_workers; ++i) {
+		RecipeLoaderIF * loader = ModulesFactory::GetRecipeLoaderModule();
+		if (!loader)
+			break;
+		prefetch_rloaders.push_back(loader);
+	}
+	for (uint16_t i = 0; i < prefetch_rloaders.size() &&
+			i < nr_workers; ++i)
+		workers.push_back(std::thread(&ApplicationManager::PrefetchRecipes,
+					this, prefetch_rloaders[i], std::cref(names), &next));
+	for (uint16_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+
+	// Release the prefetch loaders: changed recipes are then reloaded by
+	// the main recipe loader
+	for (uint16_t i = 0; i < prefetch_rloaders.size(); ++i)
+		delete prefetch_rloaders[i];
+	prefetch_rloaders.clear();
+
+	recipes_ul.lock();
+	logger->Info("Prefetch recipes DONE (%d loaded)", recipes.size());
+	recipes_ul.unlock();
+
+	if (watch_fd < 0)
+		return;
+
+	//---  Recipes watcher
+	fds[0].fd = recipes_wakeup_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = watch_fd;
+	fds[1].events = POLLIN;
+
+	while (!__atomic_load_n(&recipes_done, __ATOMIC_ACQUIRE)) {
+
+		fds[0].revents = fds[1].revents = 0;
+		if ((::poll(fds, 2, -1) < 0) && (errno != EINTR)) {
+			logger->Error("Recipes watcher poll FAILED "
+					"(Error %d: %s)", errno, strerror(errno));
+			break;
+		}
+
+		if (fds[0].revents & POLLIN) {
+			while (::read(recipes_wakeup_fd[0], drain, sizeof(drain)) > 0) {}
+			continue;
+		}
+
+		if (!(fds[1].revents & POLLIN))
+			continue;
+
+		// Collect the changed recipes, which could be notified more times
+		// (e.g. both in XML and compiled format)
+		while ((len = ::read(watch_fd, buff, sizeof(buff))) > 0) {
+			for (char * ptr = buff; ptr < buff + len;
+					ptr += sizeof(struct inotify_event) + event->len) {
+				event = (struct inotify_event *) ptr;
+				if (event->len == 0)
+					continue;
+				name = RecipeName(event->name);
+				if (!name.empty())
+					changed.insert(name);
+			}
+		}
+
+		for (it = changed.begin(); it != changed.end(); ++it)
+			ReloadRecipe(*it);
+		changed.clear();
+	}
+
+	::close(watch_fd);
+}
+
+
 /*******************************************************************************
   *     Queued Access Functions
   *****************************************************************************/
@@ -530,7 +831,7 @@ void ApplicationManager::ReportStatusQ(bool verbose) const {
 			report[17+i*10] = ',';
 		}
 		report[17+10*(Application::STATE_COUNT-1)] = ']';
-		logger->Info(report);
+		logger->Info("%s", report);
 	} else {
 		DB(
 		for (uint8_t i = 0; i < Application::STATE_COUNT; ++i) {
@@ -539,7 +840,7 @@ void ApplicationManager::ReportStatusQ(bool verbose) const {
 			report[17+i*10] = ',';
 		}
 		report[17+10*(Application::STATE_COUNT-1)] = ']';
-		logger->Debug(report);
+		logger->Debug("%s", report);
 		);
 	}
 
@@ -557,7 +858,7 @@ void ApplicationManager::ReportSyncQ(bool verbose) const {
 			report[17+i*10] = ',';
 		}
 		report[17+10*(Application::SYNC_STATE_COUNT-1)] = ']';
-		logger->Info(report);
+		logger->Info("%s", report);
 	} else {
 		DB(
 		for (uint8_t i = 0; i < Application::SYNC_STATE_COUNT; ++i) {
@@ -566,7 +867,7 @@ void ApplicationManager::ReportSyncQ(bool verbose) const {
 			report[17+i*10] = ',';
 		}
 		report[17+10*(Application::SYNC_STATE_COUNT-1)] = ']';
-		logger->Debug(report);
+		logger->Debug("%s", report);
 		);
 	}
 
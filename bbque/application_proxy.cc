@@ -25,6 +25,11 @@
 
 #include "bbque/cpp11/chrono.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace ba = bbque::app;
 
 namespace bbque {
@@ -97,6 +102,7 @@ inline ApplicationProxy::pcmdSn_t ApplicationProxy::SetupCmdSession(
 	// Resetting command session response message
 	// This is the condition verified by the reception thread
 	pcs->pmsg = NULL;
+	pcs->expired = false;
 
 	logger->Debug("APPs PRX: setup command session for [%s]",
 			pcs->papp->StrId());
@@ -255,8 +261,12 @@ ApplicationProxy::SyncP_PreChangeSend(pcmdSn_t pcs) {
 		return RTLIB_BBQUE_CHANNEL_UNAVAILABLE;
 	}
 
-	// Sending message on the application connection context
+	// Invalidate the AWM published to the EXC before notifying it
 	pcon = (*it).second;
+	MailboxPublish(pcon, papp, papp->Blocking() ?
+			AWM_MBOX_SYNC | AWM_MBOX_BLOCKED : AWM_MBOX_SYNC);
+
+	// Sending message on the application connection context
 	result = rpc->SendMessage(pcon->pd, &syncp_prechange_msg.hdr,
 			(size_t)RPC_PKT_SIZE(BBQ_SYNCP_PRECHANGE));
 	if (result == -1) {
@@ -275,19 +285,19 @@ ApplicationProxy::SyncP_PreChangeRecv(pcmdSn_t pcs,
 	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
 	rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t *pmsg_pyl;
 	rpc_msg_header_t *pmsg_hdr;
-	std::cv_status ready;
 	pchMsg_t pchMsg;
 
 	// Wait for a response (if not yet available)
 	if (!pcs->pmsg) {
 		logger->Debug("APPs PRX: waiting for PreChange response, "
 				"Timeout: %d[ms]", BBQUE_DEFAULT_SYNCP_TIMEOUT);
-		ready = (pcs->resp_cv).wait_for(resp_ul,
+		(pcs->resp_cv).wait_for(resp_ul,
 				std::chrono::milliseconds(
 					BBQUE_DEFAULT_SYNCP_TIMEOUT));
-		if (ready == std::cv_status::timeout) {
+		if (!pcs->pmsg) {
 			logger->Warn("APPs PRX: PreChange response TIMEOUT");
-			pcs->pmsg = NULL;
+			// A late response is freed once received
+			pcs->expired = true;
 			return RTLIB_BBQUE_CHANNEL_TIMEOUT;
 		}
 	}
@@ -310,6 +320,10 @@ ApplicationProxy::SyncP_PreChangeRecv(pcmdSn_t pcs,
 	// Processing response
 	presp->syncLatency = pmsg_pyl->syncLatency;
 
+	// Give back the response message to the RPC channel
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -462,19 +476,19 @@ ApplicationProxy::SyncP_SyncChangeRecv(pcmdSn_t pcs,
 	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
 	//rpc_msg_BBQ_SYNCP_SYNCCHANGE_RESP_t *pmsg_pyl;
 	rpc_msg_header_t *pmsg_hdr;
-	std::cv_status ready;
 	pchMsg_t pchMsg;
 
 	// Wait for a response (if not yet available)
 	if (!pcs->pmsg) {
 		logger->Debug("APPs PRX: waiting for SyncChange response, "
 				"Timeout: %d[ms]", BBQUE_DEFAULT_SYNCP_TIMEOUT);
-		ready = (pcs->resp_cv).wait_for(resp_ul,
+		(pcs->resp_cv).wait_for(resp_ul,
 				std::chrono::milliseconds(
 					BBQUE_DEFAULT_SYNCP_TIMEOUT));
-		if (ready == std::cv_status::timeout) {
+		if (!pcs->pmsg) {
 			logger->Warn("APPs PRX: SyncChange response TIMEOUT");
-			pcs->pmsg = NULL;
+			// A late response is freed once received
+			pcs->expired = true;
 			return RTLIB_BBQUE_CHANNEL_TIMEOUT;
 		}
 	}
@@ -496,6 +510,10 @@ ApplicationProxy::SyncP_SyncChangeRecv(pcmdSn_t pcs,
 	// Processing response (nothing to process right now)
 	(void)presp;
 
+	// Give back the response message to the RPC channel
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -707,8 +725,12 @@ ApplicationProxy::SyncP_PostChangeSend(pcmdSn_t pcs) {
 		return RTLIB_BBQUE_CHANNEL_UNAVAILABLE;
 	}
 
-	// Sending message on the application connection context
+	// The synchronization is completed, publish the new AWM
 	pcon = (*it).second;
+	MailboxPublish(pcon, papp, papp->Blocking() ?
+			AWM_MBOX_BLOCKED : AWM_MBOX_VALID);
+
+	// Sending message on the application connection context
 	result = rpc->SendMessage(pcon->pd, &syncp_syncchange_msg.hdr,
 			(size_t)RPC_PKT_SIZE(BBQ_SYNCP_POSTCHANGE));
 	if (result == -1) {
@@ -727,19 +749,19 @@ ApplicationProxy::SyncP_PostChangeRecv(pcmdSn_t pcs,
 	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
 	//rpc_msg_BBQ_SYNCP_POSTCHANGE_RESP_t *pmsg_pyl;
 	rpc_msg_header_t *pmsg_hdr;
-	std::cv_status ready;
 	pchMsg_t pchMsg;
 
 	// Wait for a response (if not yet available)
 	if (!pcs->pmsg) {
 		logger->Debug("APPs PRX: waiting for PostChange response, "
 				"Timeout: %d[ms]", BBQUE_DEFAULT_SYNCP_TIMEOUT);
-		ready = (pcs->resp_cv).wait_for(resp_ul,
+		(pcs->resp_cv).wait_for(resp_ul,
 				std::chrono::milliseconds(
 					BBQUE_DEFAULT_SYNCP_TIMEOUT));
-		if (ready == std::cv_status::timeout) {
+		if (!pcs->pmsg) {
 			logger->Warn("APPs PRX: PostChange response TIMEOUT");
-			pcs->pmsg = NULL;
+			// A late response is freed once received
+			pcs->expired = true;
 			return RTLIB_BBQUE_CHANNEL_TIMEOUT;
 		}
 	}
@@ -761,6 +783,10 @@ ApplicationProxy::SyncP_PostChangeRecv(pcmdSn_t pcs,
 	// Processing response (nothing to process right now)
 	(void)presp;
 
+	// Give back the response message to the RPC channel
+	rpc->FreeMessage(pcs->pmsg);
+	pcs->pmsg = NULL;
+
 	return RTLIB_OK;
 }
 
@@ -805,6 +831,94 @@ ApplicationProxy::SyncP_PostChange(AppPtr_t papp, pPostChangeRsp_t presp) {
 }
 
 
+/*******************************************************************************
+ * AWM Mailbox
+ ******************************************************************************/
+
+void ApplicationProxy::MailboxSetup(pconCtx_t pcon) {
+	std::unique_lock<std::mutex> mbox_ul(pcon->mbox_mtx);
+	char mbox_name[BBQUE_AWM_MAILBOX_NAME_LENGTH];
+	rtlib::awm_mailbox_t *mbox;
+	void *addr;
+	int fd;
+
+	snprintf(mbox_name, BBQUE_AWM_MAILBOX_NAME_LENGTH,
+			BBQUE_AWM_MAILBOX_FMT, pcon->app_pid);
+
+	// Drop a stale segment, e.g. of a crashed application
+	::shm_unlink(mbox_name);
+	fd = ::shm_open(mbox_name, O_CREAT|O_EXCL|O_RDWR, 0644);
+	if (fd < 0) {
+		logger->Error("APPs PRX: Creating AWM mailbox [%s] FAILED "
+				"(Error %d: %s)", mbox_name,
+				errno, strerror(errno));
+		return;
+	}
+
+	// Ensuring the segment is read-only to applications (despite the
+	// umask), thus only Barbeque could update it
+	if (fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH) ||
+			ftruncate(fd, sizeof(rtlib::awm_mailbox_t))) {
+		logger->Error("APPs PRX: Setup AWM mailbox [%s] FAILED "
+				"(Error %d: %s)", mbox_name,
+				errno, strerror(errno));
+		::close(fd);
+		::shm_unlink(mbox_name);
+		return;
+	}
+
+	addr = ::mmap(NULL, sizeof(rtlib::awm_mailbox_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		logger->Error("APPs PRX: Mapping AWM mailbox [%s] FAILED "
+				"(Error %d: %s)", mbox_name,
+				errno, strerror(errno));
+		::shm_unlink(mbox_name);
+		return;
+	}
+
+	// The segment is zero filled, i.e. no valid AWM published yet
+	mbox = (rtlib::awm_mailbox_t *)addr;
+	mbox->version = BBQUE_AWM_MAILBOX_VERSION;
+	mbox->app_pid = pcon->app_pid;
+	__atomic_store_n(&mbox->magic, BBQUE_AWM_MAILBOX_MAGIC,
+			__ATOMIC_RELEASE);
+
+	logger->Debug("APPs PRX: AWM mailbox [%s] created", mbox_name);
+	pcon->mbox = mbox;
+}
+
+void ApplicationProxy::MailboxPublish(pconCtx_t pcon, AppPtr_t papp,
+		uint8_t flags) {
+	std::unique_lock<std::mutex> mbox_ul(pcon->mbox_mtx);
+	uint8_t awm_id = 0;
+
+	if (!pcon->mbox)
+		return;
+
+	if (!papp->Blocking() && papp->NextAWM())
+		awm_id = papp->NextAWM()->Id();
+
+	rtlib::awm_mailbox_publish(&pcon->mbox->slots[papp->ExcId()],
+			awm_id, flags, (uint8_t)papp->SyncState());
+}
+
+void ApplicationProxy::MailboxRelease(pconCtx_t pcon) {
+	std::unique_lock<std::mutex> mbox_ul(pcon->mbox_mtx);
+	char mbox_name[BBQUE_AWM_MAILBOX_NAME_LENGTH];
+
+	if (!pcon->mbox)
+		return;
+
+	::munmap(pcon->mbox, sizeof(rtlib::awm_mailbox_t));
+	pcon->mbox = NULL;
+
+	snprintf(mbox_name, BBQUE_AWM_MAILBOX_NAME_LENGTH,
+			BBQUE_AWM_MAILBOX_FMT, pcon->app_pid);
+	::shm_unlink(mbox_name);
+}
+
 
 /*******************************************************************************
  * Command Sessions Helpers
@@ -817,12 +931,13 @@ ApplicationProxy::GetCommandSession(rpc_msg_header_t *pmsg_hdr)  {
 	pcmdSn_t pcs;
 
 	// Looking for a valid command session
+	// NOTE: this could happen for responses received once the command
+	// session has been already released, e.g. after a timeout
 	it = cmdSnMap.find(pmsg_hdr->token);
 	if (it == cmdSnMap.end()) {
 		cmdSnMap_ul.unlock();
-		logger->Warn("APPs PRX [%5d]: Command session get FAILED",
+		logger->Warn("APPs PRX [%5d]: Command session get FAILED "
 			"(Error: command session not found)", pmsg_hdr->token);
-		assert(it != cmdSnMap.end());
 		return pcmdSn_t();
 	}
 
@@ -856,6 +971,13 @@ ApplicationProxy::ReleaseCommandSession(pcmdSn_t pcs)  {
 
 	logger->Debug("APPs PRX: dq command session [%05d] for [%s], "
 			"[qcount: %d]", pcs->pid, pcs->papp->StrId(), cmdSnMap.size());
+	cmdSnMap_ul.unlock();
+
+	// Give back a response not consumed, and have the late ones freed
+	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
+	pcs->expired = true;
+	if (pcs->pmsg)
+		rpc->FreeMessage(pcs->pmsg);
 
 }
 
@@ -874,10 +996,21 @@ void ApplicationProxy::CompleteTransaction(pchMsg_t & pmsg) {
 	// Looking for a valid command session
 	pcs = GetCommandSession(pmsg_hdr);
 	if (!pcs) {
-		logger->Crit("APPs PRX: dispatching command response FAILED "
+		logger->Warn("APPs PRX: dispatching command response FAILED "
 				"(Error: cmd session not found for token [%d])",
 				pmsg_hdr->token);
-		assert(pcs);
+		rpc->FreeMessage(pmsg);
+		return;
+	}
+
+	// Drop late, or duplicated, responses nobody is waiting for
+	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
+	if (pcs->expired || pcs->pmsg) {
+		logger->Warn("APPs PRX: dropping orphaned command response "
+				"[typ: %d, pid: %d] for [%5d]",
+				pmsg_hdr->typ, pmsg_hdr->app_pid,
+				pmsg_hdr->token);
+		rpc->FreeMessage(pmsg);
 		return;
 	}
 
@@ -885,7 +1018,6 @@ void ApplicationProxy::CompleteTransaction(pchMsg_t & pmsg) {
 	pcs->pmsg = pmsg;
 
 	// Notify command session
-	std::unique_lock<std::mutex> resp_ul(pcs->resp_mtx);
 	(pcs->resp_cv).notify_one();
 
 }
@@ -923,6 +1055,13 @@ void ApplicationProxy::RpcACK(pconCtx_t pcon, rpc_msg_header_t *pmsg_hdr,
 		rpc_msg_type_t type) {
 	rpc_msg_resp_t resp;
 
+	// Pipelined requests are acknowledged only on failures
+	if (pmsg_hdr->token & RPC_MSG_TOKEN_PIPELINED) {
+		logger->Debug("APPs PRX: Skip RPC channel ACK " APP_STRID
+				" (pipelined request)", AppStrId(pcon));
+		return;
+	}
+
 	// Sending response to application
 	logger->Debug("APPs PRX: Send RPC channel ACK " APP_STRID, AppStrId(pcon));
 	::memcpy(&resp.hdr, pmsg_hdr, RPC_PKT_SIZE(header));
@@ -1285,6 +1424,9 @@ void ApplicationProxy::RpcAppPair(prqsSn_t prqs) {
 		return;
 	}
 
+	// The AWM mailbox must be available once the pairing is acknowledged
+	MailboxSetup(pcon);
+
 	// Backup communication context for further messages
 	conCtxMap_ul.lock();
 	conCtxMap.insert(std::pair<pid_t, pconCtx_t>(
@@ -1313,6 +1455,7 @@ void ApplicationProxy::RpcAppExit(prqsSn_t prqs) {
 	// Cleanup communication channel resources
 	pconCtx = (*conCtxIt).second;
 	rpc->ReleasePluginData(pconCtx->pd);
+	MailboxRelease(pconCtx);
 
 	// Removing the connection context
 	conCtxMap.erase(conCtxIt);
@@ -1323,9 +1466,31 @@ void ApplicationProxy::RpcAppExit(prqsSn_t prqs) {
 
 }
 
+bool ApplicationProxy::NextRequest(prqsSn_t prqs, AppUid_t rqs_uid) {
+	std::unique_lock<std::mutex> rqsQueueMap_ul(rqsQueueMap_mtx);
+	rqsQueueMap_t::iterator it;
+
+	// The request just served is the head of the EXC queue
+	it = rqsQueueMap.find(rqs_uid);
+	assert(it != rqsQueueMap.end());
+	it->second.pop_front();
+	if (it->second.empty()) {
+		rqsQueueMap.erase(it);
+		return false;
+	}
+
+	prqs->pmsg = it->second.front();
+	logger->Debug("APPs PRX [%d:%d]: serving queued request, "
+			"[qcount: %d]", prqs->pid, prqs->pmsg->typ,
+			it->second.size());
+	return true;
+}
+
 void ApplicationProxy::RequestExecutor(prqsSn_t prqs) {
 	std::unique_lock<std::mutex> snCtxMap_ul(snCtxMap_mtx);
 	snCtxMap_t::iterator it;
+	AppUid_t rqs_uid;
+	uint8_t rqs_typ;
 	psnCtx_t psc;
 
 	// Set the thread PID
@@ -1337,72 +1502,86 @@ void ApplicationProxy::RequestExecutor(prqsSn_t prqs) {
 	// tracking data structures.
 	snCtxMap_ul.unlock();
 
-	logger->Debug("APPs PRX [%d:%d]: RequestExecutor START",
-			prqs->pid, prqs->pmsg->typ);
-
-	assert(prqs->pmsg->typ<RPC_EXC_MSGS_COUNT);
-
-	// TODO put here command execution code
-	switch(prqs->pmsg->typ) {
-	case RPC_EXC_REGISTER:
-		logger->Debug("EXC_REGISTER");
-		RpcExcRegister(prqs);
-		break;
-
-	case RPC_EXC_UNREGISTER:
-		logger->Debug("EXC_UNREGISTER");
-		RpcExcUnregister(prqs);
-		break;
-
-	case RPC_EXC_SET:
-		logger->Debug("EXC_SET");
-		RpcExcSet(prqs);
-		break;
-
-	case RPC_EXC_CLEAR:
-		logger->Debug("EXC_CLEAR");
-		RpcExcClear(prqs);
-		break;
-
-	case RPC_EXC_GGAP:
-		logger->Debug("EXC_GGAP");
-		RpcExcGoalGap(prqs);
-		break;
-
-	case RPC_EXC_START:
-		logger->Debug("EXC_START");
-		RpcExcStart(prqs);
-		break;
-
-	case RPC_EXC_STOP:
-		logger->Debug("EXC_STOP");
-		RpcExcStop(prqs);
-		break;
-
-	case RPC_EXC_SCHEDULE:
-		logger->Debug("EXC_SCHEDULE");
-		RpcExcSchedule(prqs);
-		break;
-
-	case RPC_APP_PAIR:
-		logger->Debug("APP_PAIR");
-		RpcAppPair(prqs);
-		break;
-
-	case RPC_APP_EXIT:
-		logger->Debug("APP_EXIT");
-		RpcAppExit(prqs);
-		break;
-
-	default:
-		// Unknowen command
-		assert(false);
-		break;
-	}
+	// The messages are freed once served, thus keep track of the EXC
+	// queue and of the thread tracking data
+	rqs_uid = Application::Uid(prqs->pmsg->app_pid, prqs->pmsg->exc_id);
+	rqs_typ = prqs->pmsg->typ;
+
+	// Serve all the requests queued for the EXC meanwhile
+	do {
+		logger->Debug("APPs PRX [%d:%d]: RequestExecutor START",
+				prqs->pid, prqs->pmsg->typ);
+
+		assert(prqs->pmsg->typ<RPC_EXC_MSGS_COUNT);
+
+		// TODO put here command execution code
+		switch(prqs->pmsg->typ) {
+		case RPC_EXC_REGISTER:
+			logger->Debug("EXC_REGISTER");
+			RpcExcRegister(prqs);
+			break;
+
+		case RPC_EXC_UNREGISTER:
+			logger->Debug("EXC_UNREGISTER");
+			RpcExcUnregister(prqs);
+			break;
+
+		case RPC_EXC_SET:
+			logger->Debug("EXC_SET");
+			RpcExcSet(prqs);
+			break;
+
+		case RPC_EXC_CLEAR:
+			logger->Debug("EXC_CLEAR");
+			RpcExcClear(prqs);
+			break;
+
+		case RPC_EXC_GGAP:
+			logger->Debug("EXC_GGAP");
+			RpcExcGoalGap(prqs);
+			break;
+
+		case RPC_EXC_START:
+			logger->Debug("EXC_START");
+			RpcExcStart(prqs);
+			break;
+
+		case RPC_EXC_STOP:
+			logger->Debug("EXC_STOP");
+			RpcExcStop(prqs);
+			break;
+
+		case RPC_EXC_SCHEDULE:
+			logger->Debug("EXC_SCHEDULE");
+			RpcExcSchedule(prqs);
+			break;
+
+		case RPC_APP_PAIR:
+			logger->Debug("APP_PAIR");
+			RpcAppPair(prqs);
+			break;
+
+		case RPC_APP_EXIT:
+			logger->Debug("APP_EXIT");
+			RpcAppExit(prqs);
+			break;
+
+		default:
+			// Unknowen command
+			assert(false);
+			break;
+		}
+
+		logger->Debug("APPs PRX [%d:%d]: RequestExecutor END",
+				prqs->pid, prqs->pmsg->typ);
+
+		// Give back the request message to the RPC channel
+		rpc->FreeMessage(prqs->pmsg);
+	} while (NextRequest(prqs, rqs_uid));
 
 	// Releasing the thread tracking data before exiting
 	snCtxMap_ul.lock();
-	it = snCtxMap.lower_bound(prqs->pmsg->typ);
+	it = snCtxMap.lower_bound(rqs_typ);
 	for ( ; it != snCtxMap.end() ; it++) {
 		psc = it->second;
 		if (psc->pid == prqs->pid) {
@@ -1412,14 +1591,27 @@ void ApplicationProxy::RequestExecutor(prqsSn_t prqs) {
 	}
 	snCtxMap_ul.unlock();
 
-	logger->Debug("APPs PRX [%d:%d]: RequestExecutor END",
-			prqs->pid, prqs->pmsg->typ);
-
 }
 
 void ApplicationProxy::ProcessRequest(pchMsg_t & pmsg) {
-	std::unique_lock<std::mutex> snCtxMap_ul(snCtxMap_mtx);
-	prqsSn_t prqsSn = prqsSn_t(new rqsSn_t);
+	std::unique_lock<std::mutex> rqsQueueMap_ul(rqsQueueMap_mtx);
+	std::unique_lock<std::mutex> snCtxMap_ul(snCtxMap_mtx, std::defer_lock);
+	std::deque<pchMsg_t> & rqs_queue(rqsQueueMap[
+			Application::Uid(pmsg->app_pid, pmsg->exc_id)]);
+	prqsSn_t prqsSn;
+
+	// An executor is already serving the EXC: it will serve this request
+	// too, once the previous ones have been completed
+	rqs_queue.push_back(pmsg);
+	if (rqs_queue.size() > 1) {
+		logger->Debug("APPs PRX: Queuing NEW REQUEST [typ: %d], "
+				"[qcount: %d]", pmsg->typ, rqs_queue.size());
+		return;
+	}
+	rqsQueueMap_ul.unlock();
+
+	snCtxMap_ul.lock();
+	prqsSn = prqsSn_t(new rqsSn_t);
 	assert(prqsSn);
 
 	prqsSn->pmsg = pmsg;
@@ -0,0 +1,483 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/metrics_exporter.h"
+
+#include "bbque/configuration_manager.h"
+#include "bbque/modules_factory.h"
+#include "bbque/cpp11/chrono.h"
+#include "bbque/utils/timer.h"
+#include "bbque/utils/utility.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MODULE_CONFIG "MetricsExporter"
+
+/** The maximum time [ms] a client could take to send a request or to
+ * receive a snapshot */
+#define BBQUE_METRICS_EXPORT_TIMEOUT_MS 1000
+
+namespace po = boost::program_options;
+
+using bbque::utils::Timer;
+
+namespace bbque {
+
+MetricsExporter & MetricsExporter::GetInstance() {
+	static MetricsExporter me;
+	return me;
+}
+
+MetricsExporter::MetricsExporter() :
+	mc(MetricsCollector::GetInstance()),
+	listen_fd(-1),
+	trdRunning(false),
+	done(false) {
+
+	// Get a logger module
+	plugins::LoggerIF::Configuration conf(METRICS_EXPORTER_NAMESPACE);
+	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
+
+	//---------- Loading module configuration
+	ConfigurationManager & cm = ConfigurationManager::GetInstance();
+	po::options_description opts_desc("Metrics Exporter Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG".socket",
+		 po::value<std::string>
+		 (&sock_path)->default_value(
+			 BBQUE_PATH_VAR "/" BBQUE_METRICS_EXPORT_SOCK),
+		 "The UNIX socket serving metrics snapshots (empty to disable)")
+		(MODULE_CONFIG".file",
+		 po::value<std::string>
+		 (&file_path)->default_value(""),
+		 "The file metrics snapshots are appended to (empty to disable)")
+		(MODULE_CONFIG".period",
+		 po::value<uint32_t>
+		 (&period_ms)->default_value(BBQUE_METRICS_EXPORT_PERIOD_DEFAULT),
+		 "The period [ms] of metrics export to file")
+		(MODULE_CONFIG".file_size",
+		 po::value<uint32_t>
+		 (&file_size)->default_value(BBQUE_METRICS_EXPORT_FILE_SIZE_DEFAULT),
+		 "The maximum size [kB] of the metrics file before rotating it")
+		(MODULE_CONFIG".file_count",
+		 po::value<uint16_t>
+		 (&file_count)->default_value(BBQUE_METRICS_EXPORT_FILE_COUNT_DEFAULT),
+		 "The number of rotated metrics files to keep")
+		;
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+	if (period_ms == 0)
+		period_ms = BBQUE_METRICS_EXPORT_PERIOD_DEFAULT;
+
+	// Setup the pipe used to wake-up the export thread
+	if (::pipe2(wakeup_fd, O_CLOEXEC|O_NONBLOCK)) {
+		logger->Error("MET EXP: wake-up pipe setup FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		wakeup_fd[0] = wakeup_fd[1] = -1;
+		return;
+	}
+
+	// Spawn the metrics export thread
+	export_thd = std::thread(&MetricsExporter::Task, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+	Stop();
+	if (export_thd.joinable())
+		export_thd.join();
+	if (wakeup_fd[0] >= 0) {
+		::close(wakeup_fd[0]);
+		::close(wakeup_fd[1]);
+	}
+}
+
+void MetricsExporter::Start() {
+	std::unique_lock<std::mutex> ul(trdStatus_mtx);
+
+	logger->Debug("MET EXP: starting the metrics export service...");
+	trdRunning = true;
+	trdStatus_cv.notify_one();
+}
+
+void MetricsExporter::Stop() {
+	std::unique_lock<std::mutex> ul(trdStatus_mtx);
+	char wakeup = 0;
+
+	if (__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+		return;
+
+	logger->Debug("MET EXP: stopping the metrics export service...");
+	__atomic_store_n(&done, true, __ATOMIC_RELEASE);
+	trdStatus_cv.notify_one();
+
+	// Wake-up the export thread, if waiting for clients
+	if ((wakeup_fd[1] >= 0) && (::write(wakeup_fd[1], &wakeup, 1) < 0))
+		logger->Warn("MET EXP: wake-up FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+}
+
+
+/*******************************************************************************
+ * Snapshots Formatting
+ ******************************************************************************/
+
+/**
+ * @brief Get the OpenMetrics name of a metric
+ *
+ * Metrics names are prefixed by "bbque_", while dots (or any other
+ * character not allowed) are replaced by underscores.
+ */
+static void OpenMetricsName(const char *name, char *buff, size_t size) {
+	size_t len = snprintf(buff, size, "bbque_%s", name);
+
+	if (len >= size)
+		len = size - 1;
+	for (size_t i = 0; i < len; ++i) {
+		if (!isalnum(buff[i]))
+			buff[i] = '_';
+	}
+}
+
+void MetricsExporter::FormatText(
+		MetricsCollector::MetricsSnapshot_t const & snap,
+		std::string & text) {
+	MetricsCollector::MetricsSnapshot_t::const_iterator it;
+	char name[2 * BBQUE_METRICS_EXPORT_NAME_LENGTH];
+	char labels[16];
+	char sep[2];
+	char line[256];
+
+	text.clear();
+	for (it = snap.begin(); it != snap.end(); ++it) {
+		MetricsCollector::MetricSnapshot_t const & ms(*it);
+
+		OpenMetricsName(ms.name, name, sizeof(name));
+
+		// Each family starts with its main metric
+		if (ms.sm_idx < 0) {
+			static const char *types[MetricsCollector::CLASSES_COUNT] = {
+				"counter", "gauge", "summary", "summary", "summary"
+			};
+			snprintf(line, sizeof(line), "# TYPE %s %s\n# HELP %s %s\n",
+					name, types[ms.mc], name, ms.desc);
+			text += line;
+			labels[0] = 0;
+			sep[0] = 0;
+		} else {
+			snprintf(labels, sizeof(labels), "sub=\"%02d\"", ms.sm_idx);
+			sep[0] = ',';
+		}
+		sep[1] = 0;
+
+		switch (ms.mc) {
+		case MetricsCollector::COUNTER:
+			snprintf(line, sizeof(line), "%s_total%s%s%s %" PRIu64 "\n",
+					name, labels[0] ? "{" : "", labels,
+					labels[0] ? "}" : "", ms.count);
+			break;
+		case MetricsCollector::VALUE:
+			snprintf(line, sizeof(line), "%s%s%s%s %.3f\n",
+					name, labels[0] ? "{" : "", labels,
+					labels[0] ? "}" : "", ms.value);
+			break;
+		case MetricsCollector::HISTOGRAM:
+			snprintf(line, sizeof(line),
+					"%s{%s%squantile=\"0.5\"} %.3f\n"
+					"%s{%s%squantile=\"0.9\"} %.3f\n"
+					"%s{%s%squantile=\"0.99\"} %.3f\n"
+					"%s{%s%squantile=\"0.999\"} %.3f\n",
+					name, labels, sep, ms.p50,
+					name, labels, sep, ms.p90,
+					name, labels, sep, ms.p99,
+					name, labels, sep, ms.p999);
+			text += line;
+			// fall-through to count and sum
+		case MetricsCollector::SAMPLE:
+		case MetricsCollector::PERIOD:
+			snprintf(line, sizeof(line),
+					"%s_count%s%s%s %" PRIu64 "\n"
+					"%s_sum%s%s%s %.3f\n",
+					name, labels[0] ? "{" : "", labels,
+					labels[0] ? "}" : "", ms.count,
+					name, labels[0] ? "{" : "", labels,
+					labels[0] ? "}" : "", ms.mean * ms.count);
+			break;
+		default:
+			continue;
+		}
+		text += line;
+	}
+
+	text += "# EOF\n";
+}
+
+void MetricsExporter::FormatBinary(
+		MetricsCollector::MetricsSnapshot_t const & snap,
+		std::string & bin) {
+	using namespace std::chrono;
+	MetricsCollector::MetricsSnapshot_t::const_iterator it;
+	metrics_export_header_t hdr;
+	metrics_export_record_t rec;
+	uint16_t count = 0;
+
+	bin.clear();
+	bin.reserve(sizeof(hdr) + snap.size() * sizeof(rec));
+	bin.append(sizeof(hdr), 0);
+
+	for (it = snap.begin(); it != snap.end(); ++it) {
+		MetricsCollector::MetricSnapshot_t const & ms(*it);
+
+		if (count == UINT16_MAX)
+			break;
+
+		::memset(&rec, 0, sizeof(rec));
+		::strncpy(rec.name, ms.name, BBQUE_METRICS_EXPORT_NAME_LENGTH - 1);
+		rec.mc = ms.mc;
+		rec.sm_idx = (ms.sm_idx < 0) ? 0xFF : ms.sm_idx;
+		rec.count = ms.count;
+		rec.value = ms.value;
+		rec.min = ms.min;
+		rec.max = ms.max;
+		rec.mean = ms.mean;
+		rec.stddev = ms.stddev;
+		rec.p50 = ms.p50;
+		rec.p90 = ms.p90;
+		rec.p99 = ms.p99;
+		rec.p999 = ms.p999;
+		bin.append((const char *)&rec, sizeof(rec));
+		++count;
+	}
+
+	hdr.magic = BBQUE_METRICS_EXPORT_MAGIC;
+	hdr.version = BBQUE_METRICS_EXPORT_VERSION;
+	hdr.count = count;
+	hdr.tstamp_ms = duration_cast<milliseconds>(
+			system_clock::now().time_since_epoch()).count();
+	bin.replace(0, sizeof(hdr), (const char *)&hdr, sizeof(hdr));
+}
+
+
+/*******************************************************************************
+ * Snapshots Export
+ ******************************************************************************/
+
+int MetricsExporter::SetupSocket() {
+	struct sockaddr_un addr;
+
+	if (sock_path.length() >= sizeof(addr.sun_path)) {
+		logger->Error("MET EXP: socket path [%s] too long",
+				sock_path.c_str());
+		return -1;
+	}
+
+	// If the socket already exists: destroy it and rebuild a new one
+	::unlink(sock_path.c_str());
+
+	listen_fd = ::socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+	if (listen_fd < 0) {
+		logger->Error("MET EXP: socket creation FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		return -2;
+	}
+
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::strncpy(addr.sun_path, sock_path.c_str(), sizeof(addr.sun_path) - 1);
+	if (::bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+			::listen(listen_fd, SOMAXCONN)) {
+		logger->Error("MET EXP: socket [%s] setup FAILED "
+				"(Error %d: %s)", sock_path.c_str(),
+				errno, strerror(errno));
+		::close(listen_fd);
+		listen_fd = -1;
+		return -3;
+	}
+
+	logger->Info("MET EXP: serving metrics on [%s]", sock_path.c_str());
+	return 0;
+}
+
+void MetricsExporter::ServeClient() {
+	MetricsCollector::MetricsSnapshot_t snap;
+	struct timeval tv = {
+		BBQUE_METRICS_EXPORT_TIMEOUT_MS / 1000,
+		(BBQUE_METRICS_EXPORT_TIMEOUT_MS % 1000) * 1000
+	};
+	char req[16];
+	std::string out;
+	size_t sent = 0;
+	ssize_t bytes;
+	int fd;
+
+	fd = ::accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+	if (fd < 0) {
+		logger->Warn("MET EXP: client accept FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		return;
+	}
+
+	// A slow client must not stall the export of metrics
+	::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	bytes = ::recv(fd, req, sizeof(req) - 1, 0);
+	req[(bytes > 0) ? bytes : 0] = 0;
+
+	// Copy the metrics, and then format them without any lock
+	mc.GetSnapshot(snap);
+	if (::strncmp(req, BBQUE_METRICS_EXPORT_REQ_BINARY,
+				strlen(BBQUE_METRICS_EXPORT_REQ_BINARY)) == 0)
+		FormatBinary(snap, out);
+	else
+		FormatText(snap, out);
+
+	while (sent < out.size()) {
+		bytes = ::send(fd, out.data() + sent, out.size() - sent,
+				MSG_NOSIGNAL);
+		if (bytes <= 0) {
+			logger->Warn("MET EXP: snapshot send FAILED "
+					"(Error %d: %s)", errno, strerror(errno));
+			break;
+		}
+		sent += bytes;
+	}
+
+	logger->Debug("MET EXP: served [%d] metrics, [%d] bytes",
+			snap.size(), sent);
+	::close(fd);
+}
+
+void MetricsExporter::ExportFile() {
+	MetricsCollector::MetricsSnapshot_t snap;
+	char from[PATH_MAX], to[PATH_MAX];
+	struct stat st;
+	std::string text;
+	int fd;
+
+	mc.GetSnapshot(snap);
+	FormatText(snap, text);
+
+	// Rotate the metrics file, once too big
+	if ((::stat(file_path.c_str(), &st) == 0) &&
+			(st.st_size + text.size() > (off_t)file_size * 1024)) {
+		for (uint16_t i = file_count; i > 1; --i) {
+			snprintf(from, PATH_MAX, "%s.%d", file_path.c_str(), i - 1);
+			snprintf(to, PATH_MAX, "%s.%d", file_path.c_str(), i);
+			::rename(from, to);
+		}
+		snprintf(to, PATH_MAX, "%s.1", file_path.c_str());
+		if (file_count)
+			::rename(file_path.c_str(), to);
+		else
+			::unlink(file_path.c_str());
+	}
+
+	fd = ::open(file_path.c_str(), O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,
+			S_IRUSR|S_IWUSR|S_IRGRP|S_IROTH);
+	if (fd < 0) {
+		logger->Error("MET EXP: opening [%s] FAILED "
+				"(Error %d: %s)", file_path.c_str(),
+				errno, strerror(errno));
+		return;
+	}
+	if (::write(fd, text.data(), text.size()) != (ssize_t)text.size())
+		logger->Error("MET EXP: writing [%s] FAILED "
+				"(Error %d: %s)", file_path.c_str(),
+				errno, strerror(errno));
+	::close(fd);
+}
+
+void MetricsExporter::Task() {
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+	struct pollfd fds[2];
+	Timer export_tmr;
+	double elapsed;
+	int timeout;
+	char drain[8];
+
+	// Set the module name
+	if (prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("me"), 0, 0, 0) != 0) {
+		logger->Error("Set name FAILED! (Error: %s)\n", strerror(errno));
+	}
+
+	// Waiting for thread authorization to start
+	while (!trdRunning && !__atomic_load_n(&done, __ATOMIC_ACQUIRE))
+		trdStatus_cv.wait(trdStatus_ul);
+
+	trdStatus_ul.unlock();
+
+	if (!sock_path.empty())
+		SetupSocket();
+
+	logger->Info("MET EXP: Export thread STARTED");
+
+	fds[0].fd = wakeup_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = listen_fd;
+	fds[1].events = POLLIN;
+
+	export_tmr.start();
+	while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+
+		// Wait for clients, or for the next export to file
+		timeout = -1;
+		if (!file_path.empty()) {
+			elapsed = export_tmr.getElapsedTimeMs();
+			timeout = (elapsed < period_ms) ? period_ms - elapsed : 0;
+		}
+		fds[0].revents = fds[1].revents = 0;
+		if ((::poll(fds, (listen_fd < 0) ? 1 : 2, timeout) < 0) &&
+				(errno != EINTR)) {
+			logger->Error("MET EXP: poll FAILED "
+					"(Error %d: %s)", errno, strerror(errno));
+			break;
+		}
+
+		if (fds[0].revents & POLLIN) {
+			while (::read(wakeup_fd[0], drain, sizeof(drain)) > 0) {}
+			continue;
+		}
+
+		if (fds[1].revents & POLLIN)
+			ServeClient();
+
+		if (!file_path.empty() &&
+				(export_tmr.getElapsedTimeMs() >= period_ms)) {
+			ExportFile();
+			export_tmr.start();
+		}
+	}
+
+	if (listen_fd >= 0) {
+		::close(listen_fd);
+		::unlink(sock_path.c_str());
+	}
+
+	logger->Info("MET EXP: Export thread ENDED");
+}
+
+} // namespace bbque
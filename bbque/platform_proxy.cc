@@ -17,16 +17,41 @@
 
 #include "bbque/platform_proxy.h"
 
-#include "bbque/utils/utility.h"
+#include "bbque/configuration_manager.h"
 #include "bbque/modules_factory.h"
+#include "bbque/utils/trace.h"
+#include "bbque/utils/utility.h"
+
+#include <algorithm>
+#include <functional>
+
+#define MODULE_CONFIG "PlatformProxy"
+
+/** Metrics (class COUNTER) declaration */
+#define PP_COUNTER_METRIC(NAME, DESC)\
+ {PLATFORM_PROXY_NAMESPACE "." NAME, DESC, \
+	 MetricsCollector::COUNTER, 0, NULL, 0}
+
+/** Metrics (class SAMPLE) declaration */
+#define PP_SAMPLE_METRIC(NAME, DESC)\
+ {PLATFORM_PROXY_NAMESPACE "." NAME, DESC, \
+	 MetricsCollector::SAMPLE, 0, NULL, 0}
+/** Acquire a new completion time sample */
+#define PP_GET_TIMING(METRICS, INDEX, TIMER) \
+	mc.AddSample(METRICS[INDEX].mh, TIMER.getElapsedTimeMs());
 
 #ifdef CONFIG_BBQUE_TEST_PLATFORM_DATA
 # warning Using Test Platform Data (TPD)
 # define PLATFORM_PROXY PlatformProxy // Use the base class when TPD in use
 #else // CONFIG_BBQUE_TEST_PLATFORM_DATA
 # ifdef CONFIG_TARGET_LINUX
-#  include "bbque/pp/linux.h"
-#  define  PLATFORM_PROXY LinuxPP
+#  ifdef CONFIG_BBQUE_LINUXPP_CGFS
+#   include "bbque/pp/linux_cgfs.h"
+#   define  PLATFORM_PROXY LinuxCGFSPP
+#  else
+#   include "bbque/pp/linux.h"
+#   define  PLATFORM_PROXY LinuxPP
+#  endif
 # endif
 # ifdef CONFIG_TARGET_P2012
 #  include "bbque/pp/p2012.h"
@@ -35,13 +60,31 @@
 #endif // CONFIG_BBQUE_TEST_PLATFORM_DATA
 
 namespace br = bbque::res;
+namespace po = boost::program_options;
 
 namespace bbque {
 
+/* Definition of metrics used by this module */
+MetricsCollector::MetricsCollection_t
+PlatformProxy::metrics[PP_METRICS_COUNT] = {
+	//----- Event counting metrics
+	PP_COUNTER_METRIC("setup.hit",  "Setup from pre-built pool HIT count"),
+	PP_COUNTER_METRIC("setup.miss", "Setup from pre-built pool MISS count"),
+	//----- Timing metrics
+	PP_SAMPLE_METRIC("setup.time", "Avg platform data setup t[ms]"),
+	PP_SAMPLE_METRIC("awm.first",  "Avg time to first AWM mapped t[ms]"),
+};
+
 PlatformProxy::PlatformProxy() :
 	trdRunning(false),
 	done(false),
 	pilInitialized(false),
+	map_workers(BBQUE_PP_MAP_WORKERS_DEFAULT),
+	map_batch(nullptr),
+	map_next(0),
+	map_pending(0),
+	map_done(false),
+	mc(MetricsCollector::GetInstance()),
 	platformIdentifier(NULL) {
 
 	// Get a logger module
@@ -49,6 +92,23 @@ PlatformProxy::PlatformProxy() :
 	plugins::LoggerIF::Configuration conf(logger_name.c_str());
 	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
 
+	//---------- Loading module configuration
+	ConfigurationManager & cm = ConfigurationManager::GetInstance();
+	po::options_description opts_desc("Platform Proxy Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG".map_workers",
+		 po::value<uint16_t>
+		 (&map_workers)->default_value(BBQUE_PP_MAP_WORKERS_DEFAULT),
+		 "The maximum number of concurrent resources mapping workers")
+		;
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+	if (map_workers == 0)
+		map_workers = 1;
+
+	// Register all the metrics collected by this module
+	mc.Register(metrics, PP_METRICS_COUNT);
+
 #ifndef CONFIG_BBQUE_TEST_PLATFORM_DATA
 	// Spawn the platform monitoring thread
 	monitor_thd = std::thread(&PlatformProxy::Monitor, this);
@@ -62,6 +122,7 @@ PlatformProxy::PlatformProxy() :
 PlatformProxy::~PlatformProxy() {
 	// Stopping the monitor thread
 	Stop();
+	StopMapWorkers();
 }
 
 PlatformProxy & PlatformProxy::GetInstance() {
@@ -73,7 +134,7 @@ PlatformProxy & PlatformProxy::GetInstance() {
 void PlatformProxy::Start() {
 	std::unique_lock<std::mutex> ul(trdStatus_mtx);
 
-	logger->Debug("PLAT PRX: starting the monitoring service...");
+	BBQUE_LOG_DEBUG("PLAT PRX: starting the monitoring service...");
 	trdRunning = true;
 	trdStatus_cv.notify_one();
 }
@@ -84,7 +145,7 @@ void PlatformProxy::Stop() {
 	if (done == true)
 		return;
 
-	logger->Debug("PLAT PRX: stopping the monitoring service...");
+	BBQUE_LOG_DEBUG("PLAT PRX: stopping the monitoring service...");
 	done = true;
 	trdStatus_cv.notify_one();
 }
@@ -94,7 +155,7 @@ void PlatformProxy::Monitor() {
 
 	// Set the module name
 	if (prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("pp"), 0, 0, 0) != 0) {
-		logger->Error("Set name FAILED! (Error: %s)\n", strerror(errno));
+		BBQUE_LOG_ERROR("Set name FAILED! (Error: %s)\n", strerror(errno));
 	}
 
 	// Waiting for thread authorization to start
@@ -103,7 +164,7 @@ void PlatformProxy::Monitor() {
 
 	trdStatus_ul.unlock();
 
-	logger->Info("PLAT PRX: Monitoring thread STARTED");
+	BBQUE_LOG_INFO("PLAT PRX: Monitoring thread STARTED");
 
 	while (!done) {
 		// TODO place here the code to monitor for resources availability and
@@ -112,7 +173,7 @@ void PlatformProxy::Monitor() {
 		trdStatus_cv.wait(trdStatus_ul);
 	}
 
-	logger->Info("PLAT PRX: Monitoring thread ENDED");
+	BBQUE_LOG_INFO("PLAT PRX: Monitoring thread ENDED");
 }
 
 
@@ -123,15 +184,15 @@ PlatformProxy::LoadPlatformData() {
 
 	// Return if the PIL has not been properly initialized
 	if (!pilInitialized) {
-		logger->Fatal("PLAT PRX: Platform Integration Layer initialization FAILED");
+		BBQUE_LOG_FATAL("PLAT PRX: Platform Integration Layer initialization FAILED");
 		return PLATFORM_INIT_FAILED;
 	}
 
 	// Platform specific resources enumeration
-	logger->Debug("PLAT PRX: loading platform data");
+	BBQUE_LOG_DEBUG("PLAT PRX: loading platform data");
 	result = _LoadPlatformData();
 	if (unlikely(result != OK)) {
-		logger->Fatal("PLAT PRX: Platform [%s] initialization FAILED",
+		BBQUE_LOG_FATAL("PLAT PRX: Platform [%s] initialization FAILED",
 				GetPlatformID());
 		return result;
 	}
@@ -139,7 +200,7 @@ PlatformProxy::LoadPlatformData() {
 	// Setup the Platform Specific ID
 	platformIdentifier = _GetPlatformID();
 
-	logger->Notice("PLAT PRX: Platform [%s] initialization COMPLETED",
+	BBQUE_LOG_NOTICE("PLAT PRX: Platform [%s] initialization COMPLETED",
 			GetPlatformID());
 
 	// Dump status of registered resource
@@ -152,7 +213,7 @@ PlatformProxy::ExitCode_t
 PlatformProxy::Setup(AppPtr_t papp) {
 	ExitCode_t result = OK;
 
-	logger->Debug("PLAT PRX: platform setup for run-time control "
+	BBQUE_LOG_DEBUG("PLAT PRX: platform setup for run-time control "
 			"of app [%s]", papp->StrId());
 	result = _Setup(papp);
 	return result;
@@ -162,7 +223,7 @@ PlatformProxy::ExitCode_t
 PlatformProxy::Release(AppPtr_t papp) {
 	ExitCode_t result = OK;
 
-	logger->Debug("PLAT PRX: releasing platform-specific run-time control "
+	BBQUE_LOG_DEBUG("PLAT PRX: releasing platform-specific run-time control "
 			"for app [%s]", papp->StrId());
 	result = _Release(papp);
 	return result;
@@ -172,40 +233,159 @@ PlatformProxy::ExitCode_t
 PlatformProxy::ReclaimResources(AppPtr_t papp) {
 	ExitCode_t result = OK;
 
-	logger->Debug("PLAT PRX: Reclaiming resources of app [%s]", papp->StrId());
+	BBQUE_LOG_DEBUG("PLAT PRX: Reclaiming resources of app [%s]", papp->StrId());
 	result = _ReclaimResources(papp);
 	return result;
 }
 
+uint64_t
+PlatformProxy::GetMemoryFootprint(AppPtr_t papp) {
+	// Platform data not yet initialized, the application has never been
+	// scheduled thus there is nothing to migrate
+	if (!papp || !papp->HasPlatformData())
+		return 0;
+	return _GetMemoryFootprint(papp);
+}
+
 PlatformProxy::ExitCode_t
 PlatformProxy::MapResources(AppPtr_t papp, UsagesMapPtr_t pres, bool excl) {
 	ResourceAccounter &ra = ResourceAccounter::GetInstance();
 	RViewToken_t rvt = ra.GetScheduledView();
 	ExitCode_t result = OK;
+	bool first_awm = false;
+	Timer pp_tmr;
 
-	logger->Debug("PLAT PRX: Mapping resources for app [%s], using view [%d]",
+	BBQUE_LOG_DEBUG("PLAT PRX: Mapping resources for app [%s], using view [%d]",
 			papp->StrId(), rvt);
 
 	// Platform Specific Data (PSD) should be initialized the first time
 	// an application is scheduled for execution
 	if (unlikely(!papp->HasPlatformData())) {
+		pp_tmr.start();
+		first_awm = true;
 
 		// Setup PSD
+		BBQUE_TRACE_BEGIN(PP, "pp.setup", papp->Uid());
 		result = Setup(papp);
+		BBQUE_TRACE_END(PP, "pp.setup", papp->Uid());
 		if (result != OK) {
-			logger->Error("Setup PSD for EXC [%s] FAILED",
+			BBQUE_LOG_ERROR("Setup PSD for EXC [%s] FAILED",
 					papp->StrId());
 			return result;
 		}
+		PP_GET_TIMING(metrics, PP_SETUP_TIME, pp_tmr);
 
 		// Mark PSD as correctly initialized
 		papp->SetPlatformData();
 	}
 
 	// Map resources
+	BBQUE_TRACE_BEGIN(PP, "pp.map", papp->Uid());
 	result = _MapResources(papp, pres, rvt, excl);
+	BBQUE_TRACE_END(PP, "pp.map", papp->Uid());
+
+	// Account for the time required to get the first AWM mapped
+	if (unlikely(first_awm) && (result == OK))
+		PP_GET_TIMING(metrics, PP_FIRST_AWM_TIME, pp_tmr);
+
+	return result;
+}
+
+void PlatformProxy::MapNext(std::unique_lock<std::mutex> & batch_ul) {
+	MappingRequest_t & req((*map_batch)[map_next++]);
+
+	batch_ul.unlock();
+	req.result = MapResources(req.papp, req.pres, req.excl);
+	batch_ul.lock();
+
+	if (--map_pending == 0)
+		batch_done_cv.notify_all();
+}
+
+void PlatformProxy::MapWorker() {
+	std::unique_lock<std::mutex> batch_ul(batch_mtx);
+
+	// Set the module name
+	if (prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("pp.map"),
+				0, 0, 0) != 0) {
+		BBQUE_LOG_ERROR("Set name FAILED! (Error: %s)\n", strerror(errno));
+	}
+
+	while (!map_done) {
+
+		// Wait for a request to serve
+		if (!map_batch || (map_next >= map_batch->size())) {
+			batch_cv.wait(batch_ul);
+			continue;
+		}
+
+		MapNext(batch_ul);
+	}
+}
+
+void PlatformProxy::StopMapWorkers() {
+	std::unique_lock<std::mutex> batch_ul(batch_mtx);
+
+	map_done = true;
+	batch_cv.notify_all();
+	batch_ul.unlock();
+
+	for_each(map_thds.begin(), map_thds.end(), mem_fn(&std::thread::join));
+	map_thds.clear();
+}
+
+PlatformProxy::ExitCode_t
+PlatformProxy::MapResources(MappingBatch_t & batch) {
+	std::unique_lock<std::mutex> batch_ul(batch_mtx);
+	MappingBatch_t::iterator req_it;
+	ExitCode_t result = OK;
+	size_t workers;
+
+	if (batch.empty())
+		return OK;
+
+	// Start the missing workers, but no more than the requests to serve,
+	// while the current thread serves requests as well
+	workers = std::min<size_t>(map_workers, batch.size());
+	while (map_thds.size() + 1 < workers)
+		map_thds.push_back(std::thread(&PlatformProxy::MapWorker, this));
+	BBQUE_LOG_DEBUG("PLAT PRX: Mapping resources for [%zu] apps, "
+			"using [%zu] workers", batch.size(), workers);
+
+	// Hand over the batch to the workers
+	map_batch = &batch;
+	map_next = 0;
+	map_pending = batch.size();
+	batch_cv.notify_all();
+
+	while (map_next < batch.size())
+		MapNext(batch_ul);
+	while (map_pending)
+		batch_done_cv.wait(batch_ul);
+	map_batch = nullptr;
+	batch_ul.unlock();
+
+	// Report the failed mappings
+	for (req_it = batch.begin(); req_it != batch.end(); ++req_it) {
+		if ((*req_it).result == OK)
+			continue;
+		BBQUE_LOG_ERROR("PLAT PRX: Mapping resources for app [%s] FAILED "
+				"(Error: %d)", (*req_it).papp->StrId(),
+				(*req_it).result);
+		result = MAPPING_FAILED;
+	}
 
 	return result;
 }
 
+PlatformProxy::ExitCode_t
+PlatformProxy::MapClusterResources() {
+	ResourceAccounter &ra = ResourceAccounter::GetInstance();
+	RViewToken_t rvt = ra.GetScheduledView();
+
+	BBQUE_LOG_DEBUG("PLAT PRX: Mapping cluster resources, using view [%d]",
+			rvt);
+	return _MapClusterResources(rvt);
+}
+
 } /* bbque */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/pp/cpufreq_manager.h"
+
+#include "bbque/resource_accounter.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPUFREQ_GOVERNOR 	"scaling_governor"
+#define CPUFREQ_GOVERNORS 	"scaling_available_governors"
+#define CPUFREQ_FREQS 		"scaling_available_frequencies"
+#define CPUFREQ_MIN 		"cpuinfo_min_freq"
+#define CPUFREQ_MAX 		"cpuinfo_max_freq"
+#define CPUFREQ_SETSPEED 	"scaling_setspeed"
+#define CPUFREQ_SCALING_MAX 	"scaling_max_freq"
+
+namespace bbque {
+
+CPUFreqManager::CPUFreqManager(std::string const & _mode,
+		std::string const & _root, plugins::LoggerIF *_logger) :
+	logger(_logger),
+	mode(CPUFREQ_NONE),
+	root(_root) {
+
+	if (_mode.compare("userspace") == 0)
+		mode = CPUFREQ_USERSPACE;
+	else if (_mode.compare("maxfreq") == 0)
+		mode = CPUFREQ_MAXFREQ;
+	else if (_mode.compare("none") != 0)
+		logger->Warn("PLAT FRQ: unknown actuation mode [%s], "
+				"disabling frequency management", _mode.c_str());
+
+	logger->Info("PLAT FRQ: CPU frequency management [%s] on [%s]",
+			(mode == CPUFREQ_USERSPACE) ? "userspace" :
+			(mode == CPUFREQ_MAXFREQ) ? "maxfreq" : "none",
+			root.c_str());
+}
+
+CPUFreqManager::~CPUFreqManager() {
+	std::map<uint16_t, ClusterFreqPtr_t>::iterator it;
+	ClusterFreqPtr_t pcf;
+
+	// Give back the CPUs to the original governors, at full speed
+	for (it = clusters.begin(); it != clusters.end(); ++it) {
+		pcf = (*it).second;
+		SetFrequency(pcf, pcf->max_khz);
+		if (pcf->mode != CPUFREQ_USERSPACE)
+			continue;
+		for (size_t i = 0; i < pcf->cpus.size(); ++i)
+			WriteAttribute(pcf->cpus[i], CPUFREQ_GOVERNOR,
+					pcf->governors[i]);
+	}
+}
+
+std::string
+CPUFreqManager::AttributePath(uint16_t cpu, const char *attr) const {
+	char cpu_dir[] = "/cpu65535/cpufreq/";
+	snprintf(cpu_dir, sizeof(cpu_dir), "/cpu%hu/cpufreq/", cpu);
+	return root + cpu_dir + attr;
+}
+
+bool
+CPUFreqManager::ReadAttribute(uint16_t cpu, const char *attr,
+		std::string & value) const {
+	std::string path(AttributePath(cpu, attr));
+	char buff[256];
+	FILE *fp;
+
+	fp = fopen(path.c_str(), "r");
+	if (!fp)
+		return false;
+
+	if (!fgets(buff, sizeof(buff), fp)) {
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+
+	// Drop the trailing new line
+	value = buff;
+	value.erase(value.find_last_not_of(" \n") + 1);
+	return true;
+}
+
+bool
+CPUFreqManager::WriteAttribute(uint16_t cpu, const char *attr,
+		std::string const & value) const {
+	std::string path(AttributePath(cpu, attr));
+	FILE *fp;
+	int result;
+
+	fp = fopen(path.c_str(), "w");
+	if (!fp) {
+		logger->Error("PLAT FRQ: Opening [%s] FAILED "
+				"(Error: %d - %s)", path.c_str(),
+				errno, strerror(errno));
+		return false;
+	}
+
+	result = fputs(value.c_str(), fp);
+	if ((fclose(fp) != 0) || (result < 0)) {
+		logger->Error("PLAT FRQ: Writing [%s] into [%s] FAILED "
+				"(Error: %d - %s)", value.c_str(), path.c_str(),
+				errno, strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+void
+CPUFreqManager::ParseCPUs(std::string const & list,
+		std::vector<uint16_t> & cpus) {
+	const char *p = list.c_str();
+	unsigned long first, last;
+	char *end;
+
+	while (*p) {
+
+		// Get a CPU id, or the first CPU of a range
+		first = strtoul(p, &end, 10);
+		if (end == p)
+			return;
+		last = first;
+		p = end;
+
+		// Get the last CPU of a range
+		if (*p == '-') {
+			last = strtoul(++p, &end, 10);
+			if (end == p)
+				return;
+			p = end;
+		}
+
+		for ( ; first <= last; ++first)
+			cpus.push_back(first);
+
+		if (*p != ',')
+			return;
+		++p;
+	}
+}
+
+bool
+CPUFreqManager::RegisterCluster(uint16_t cluster_id,
+		std::string const & cpus) {
+	ResourceAccounter &ra(ResourceAccounter::GetInstance());
+	ClusterFreqPtr_t pcf(new ClusterFreq_t);
+	char rsrc_path[] = "tile0.cluster65535.freq0";
+	std::string value;
+	const char *p;
+	char *end;
+
+	if (mode == CPUFREQ_NONE)
+		return false;
+
+	ParseCPUs(cpus, pcf->cpus);
+	if (pcf->cpus.empty())
+		return false;
+
+	// NOTE: the CPUs of a cluster are expected to share the same
+	// frequency domain, thus the first one is used to get the frequencies
+	// supported by the whole cluster
+	if (!ReadAttribute(pcf->cpus[0], CPUFREQ_MIN, value)) {
+		logger->Warn("PLAT FRQ: cpufreq not available for cluster [%d]",
+				cluster_id);
+		return false;
+	}
+	pcf->min_khz = strtoul(value.c_str(), NULL, 10);
+	if (!ReadAttribute(pcf->cpus[0], CPUFREQ_MAX, value)) {
+		logger->Warn("PLAT FRQ: cpufreq not available for cluster [%d]",
+				cluster_id);
+		return false;
+	}
+	pcf->max_khz = strtoul(value.c_str(), NULL, 10);
+	pcf->cur_khz = 0;
+
+	// The available frequencies are not exported by all the drivers, in
+	// that case any frequency within [min, max] could be requested
+	if (ReadAttribute(pcf->cpus[0], CPUFREQ_FREQS, value)) {
+		for (p = value.c_str(); *p; p = end) {
+			uint32_t khz = strtoul(p, &end, 10);
+			if (end == p)
+				break;
+			pcf->freqs.push_back(khz);
+		}
+		std::sort(pcf->freqs.begin(), pcf->freqs.end());
+	}
+
+	// Switch to the userspace governor, if supported, otherwise fall
+	// back to capping the maximum frequency
+	pcf->mode = mode;
+	if ((pcf->mode == CPUFREQ_USERSPACE) &&
+			(!ReadAttribute(pcf->cpus[0], CPUFREQ_GOVERNORS, value) ||
+			 (value.find("userspace") == std::string::npos))) {
+		logger->Warn("PLAT FRQ: userspace governor not available for "
+				"cluster [%d], using maxfreq", cluster_id);
+		pcf->mode = CPUFREQ_MAXFREQ;
+	}
+	for (size_t i = 0; i < pcf->cpus.size(); ++i) {
+		if (!ReadAttribute(pcf->cpus[i], CPUFREQ_GOVERNOR, value))
+			value.clear();
+		pcf->governors.push_back(value);
+		if (pcf->mode == CPUFREQ_USERSPACE)
+			WriteAttribute(pcf->cpus[i], CPUFREQ_GOVERNOR, "userspace");
+	}
+
+	// Register the frequency resource [MHz], which is shared by all the
+	// applications running on the cluster
+	snprintf(rsrc_path, sizeof(rsrc_path), "tile0.cluster%hu.freq0",
+			cluster_id);
+	pcf->path = rsrc_path;
+	logger->Debug("PLAT FRQ: Registering [%s: %u MHz]...",
+			rsrc_path, pcf->max_khz / 1000);
+	ra.RegisterResource(rsrc_path, "MHz", pcf->max_khz / 1000, true);
+
+	logger->Info("PLAT FRQ: cluster [%d] CPUs [%s] frequency range "
+			"[%u - %u] kHz, %d steps", cluster_id, cpus.c_str(),
+			pcf->min_khz, pcf->max_khz, pcf->freqs.size());
+	clusters[cluster_id] = pcf;
+
+	return true;
+}
+
+uint64_t
+CPUFreqManager::MaxRequest(ClusterFreqPtr_t pcf, RViewToken_t vtok) const {
+	ResourceAccounter &ra(ResourceAccounter::GetInstance());
+	res::ResourcePtr_t prsrc;
+
+	// The frequency is a shared resource, thus it is used as much as the
+	// highest amount booked
+	prsrc = ra.GetResource(pcf->path);
+	if (!prsrc)
+		return 0;
+
+	return prsrc->Used(vtok);
+}
+
+uint32_t
+CPUFreqManager::GetFrequency(ClusterFreqPtr_t pcf, uint64_t mhz) const {
+	std::vector<uint32_t>::const_iterator it;
+	uint64_t khz = mhz * 1000;
+
+	// Without any request the cluster runs at full speed
+	if ((khz == 0) || (khz >= pcf->max_khz))
+		return pcf->max_khz;
+	if (khz <= pcf->min_khz)
+		return pcf->min_khz;
+
+	// Round up to the nearest available frequency
+	it = std::lower_bound(pcf->freqs.begin(), pcf->freqs.end(), khz);
+	if (it != pcf->freqs.end())
+		return *it;
+
+	return khz;
+}
+
+bool
+CPUFreqManager::SetFrequency(ClusterFreqPtr_t pcf, uint32_t khz) {
+	const char *attr;
+	char value[] = "4294967295";
+	bool result = true;
+
+	attr = (pcf->mode == CPUFREQ_USERSPACE) ?
+		CPUFREQ_SETSPEED : CPUFREQ_SCALING_MAX;
+	snprintf(value, sizeof(value), "%u", khz);
+
+	for (size_t i = 0; i < pcf->cpus.size(); ++i)
+		result &= WriteAttribute(pcf->cpus[i], attr, value);
+
+	return result;
+}
+
+void
+CPUFreqManager::Actuate(RViewToken_t vtok) {
+	std::map<uint16_t, ClusterFreqPtr_t>::iterator it;
+	ClusterFreqPtr_t pcf;
+	uint32_t khz;
+	uint64_t mhz;
+
+	for (it = clusters.begin(); it != clusters.end(); ++it) {
+		pcf = (*it).second;
+
+		// The highest frequency granted to the cluster applications
+		mhz = MaxRequest(pcf, vtok);
+		khz = GetFrequency(pcf, mhz);
+		if (khz == pcf->cur_khz)
+			continue;
+
+		logger->Notice("PLAT FRQ: cluster [%d] => {req [%" PRIu64 " MHz], "
+				"freq [%u kHz]}", (*it).first, mhz, khz);
+		if (!SetFrequency(pcf, khz)) {
+			logger->Error("PLAT FRQ: cluster [%d] frequency setting "
+					"FAILED", (*it).first);
+			pcf->cur_khz = 0;
+			continue;
+		}
+		pcf->cur_khz = khz;
+	}
+}
+
+} // namespace bbque
@@ -17,12 +17,16 @@
 
 #include "bbque/pp/linux.h"
 
+#include "bbque/configuration_manager.h"
 #include "bbque/resource_accounter.h"
 #include "bbque/res/resource_utils.h"
 
 #include <string.h>
 #include <linux/version.h>
 
+// The prefix for configuration file attributes
+#define MODULE_CONFIG "LinuxPP"
+
 #define BBQUE_LINUXPP_PLATFORM_ID		"org.linux.cgroup"
 
 #define BBQUE_LINUXPP_SILOS 			BBQUE_LINUXPP_CGROUP"/silos"
@@ -34,6 +38,8 @@
 #define BBQUE_LINUXPP_MEMB_PARAM 		"memory.limit_in_bytes"
 #define BBQUE_LINUXPP_CPU_EXCLUSIVE_PARAM 	"cpuset.cpu_exclusive"
 #define BBQUE_LINUXPP_MEM_EXCLUSIVE_PARAM 	"cpuset.mem_exclusive"
+#define BBQUE_LINUXPP_MEMM_PARAM 		"cpuset.memory_migrate"
+#define BBQUE_LINUXPP_MSTAT_PARAM 		"memory.stat"
 #define BBQUE_LINUXPP_PROCS_PARAM		"cgroup.procs"
 
 // The default CFS bandwidth period [us]
@@ -50,6 +56,7 @@
 
 
 namespace bb = bbque;
+namespace po = boost::program_options;
 namespace br = bbque::res;
 
 namespace bbque {
@@ -59,27 +66,81 @@ LinuxPP::LinuxPP() :
 	controller("cpuset"),
 	cfsQuotaSupported(true),
 	MaxCpusCount(DEFAULT_MAX_CPUS),
-	MaxMemsCount(DEFAULT_MAX_MEMS) {
+	MaxMemsCount(DEFAULT_MAX_MEMS),
+	cg_pool_size(BBQUE_LINUXPP_POOL_DEFAULT),
+	cg_pool_next(0),
+	cg_pool_dfr("pp.cgpool", std::bind(&LinuxPP::RefillPool, this)) {
 	ExitCode_t pp_result = OK;
 	char *mount_path = NULL;
+	std::string mig_mode;
+	uint32_t mig_period;
+	std::string cpufreq_mode;
+	std::string cpufreq_root;
+	CGroupDataPtr_t pcgd;
 	int cg_result;
 
+	//---------- Loading module configuration
+	ConfigurationManager & cm = ConfigurationManager::GetInstance();
+	po::options_description opts_desc("Linux Platform Proxy Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG".cgpool_size",
+		 po::value<uint16_t>
+		 (&cg_pool_size)->default_value(BBQUE_LINUXPP_POOL_DEFAULT),
+		 "The number of pre-built applications control groups")
+		(MODULE_CONFIG".memory_migrate",
+		 po::value<std::string>
+		 (&mig_mode)->default_value("none"),
+		 "The memory pages migration mode (none, cgroup, async)")
+		(MODULE_CONFIG".memory_migrate_period",
+		 po::value<uint32_t>
+		 (&mig_period)->default_value(BBQUE_MEMMIG_PERIOD_DEFAULT),
+		 "The minimum time between asynchronous migrations [ms]")
+		(MODULE_CONFIG".cpufreq",
+		 po::value<std::string>
+		 (&cpufreq_mode)->default_value("none"),
+		 "The CPU frequency actuation mode (none, userspace, maxfreq)")
+		(MODULE_CONFIG".cpufreq_root",
+		 po::value<std::string>
+		 (&cpufreq_root)->default_value(BBQUE_CPUFREQ_ROOT_DEFAULT),
+		 "The sysfs folder exporting the CPUs frequency controls")
+		;
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+
+	// Setup the memory pages migration support
+	pmm = MemoryMigratorPtr_t(new MemoryMigrator(mig_mode, mig_period,
+				logger));
+
+	// Setup the CPU frequency management support
+	pcf = CPUFreqManagerPtr_t(new CPUFreqManager(cpufreq_mode,
+				cpufreq_root, logger));
+
 	// Init the Control Group Library
 	cg_result = cgroup_init();
 	if (cg_result) {
-		logger->Error("PLAT LNX: CGroup Library initializaton FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup Library initializaton FAILED! "
 				"(Error: %d - %s)", cg_result, cgroup_strerror(cg_result));
 		return;
 	}
 
 	cg_result = cgroup_get_subsys_mount_point(controller, &mount_path);
 	if (cg_result) {
-		logger->Error("PLAT LNX: CGroup Library mountpoint lookup FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup Library mountpoint lookup FAILED! "
 				"(Error: %d - %s)", cg_result, cgroup_strerror(cg_result));
 		return;
 	}
-	logger->Info("PLAT LNX: controller [%s] mounted at [%s]",
+	BBQUE_LOG_INFO("PLAT LNX: controller [%s] mounted at [%s]",
 			controller, mount_path);
+	free(mount_path);
+
+	// The "memory" controller is accessed to read applications footprint
+	cg_result = cgroup_get_subsys_mount_point("memory", &mount_path);
+	if (cg_result) {
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup Library mountpoint lookup FAILED! "
+				"(Error: %d - %s)", cg_result, cgroup_strerror(cg_result));
+		return;
+	}
+	memory_mount = mount_path;
 
 
 	// TODO: check that the "bbq" cgroup already existis
@@ -91,12 +152,25 @@ LinuxPP::LinuxPP() :
 	// Build "silos" CGroup to host blocked applications
 	pp_result = BuildSilosCG(psilos);
 	if (pp_result) {
-		logger->Error("PLAT LNX: Silos CGroup setup FAILED!");
+		BBQUE_LOG_ERROR("PLAT LNX: Silos CGroup setup FAILED!");
 		return;
 	}
 
 	free(mount_path);
 
+	// Pre-build the pool of applications control groups
+	BBQUE_LOG_INFO("PLAT LNX: Pre-building [%d] applications CGroups",
+			cg_pool_size);
+	for (uint16_t i = 0; i < cg_pool_size; ++i) {
+		pp_result = BuildPoolCG(pcgd);
+		if (pp_result) {
+			BBQUE_LOG_WARN("PLAT LNX: CGroups pool setup FAILED "
+					"(Error: [%d] CGroups built)", i);
+			break;
+		}
+		cg_pool.push_back(pcgd);
+	}
+
 	// Mark the Platform Integration Layer (PIL) as initialized
 	SetPilInitialized();
 }
@@ -128,7 +202,7 @@ LinuxPP::RegisterClusterCPUs(RLinuxBindingsPtr_t prlb) {
 	//   QUOTA = CPU_QUOTA * 100 / CPU_PERIOD
 	if (prlb->amount_cpup) {
 		cpu_quota = (prlb->amount_cpuq * 100) / prlb->amount_cpup;
-		logger->Debug("Registering CPUs of node [%d] with CPU quota of [%lu]%",
+		BBQUE_LOG_DEBUG("Registering CPUs of node [%d] with CPU quota of [%lu]%",
 				prlb->socket_id, cpu_quota);
 	}
 
@@ -140,7 +214,7 @@ LinuxPP::RegisterClusterCPUs(RLinuxBindingsPtr_t prlb) {
 		sscanf(p, "%hu", &first_cpu_id);
 		snprintf(resourcePath+13, 10, "%hu.pe%d",
 				prlb->socket_id, first_cpu_id);
-		logger->Debug("PLAT LNX: Registering [%s]...", resourcePath);
+		BBQUE_LOG_DEBUG("PLAT LNX: Registering [%s]...", resourcePath);
 		ra.RegisterResource(resourcePath, "", cpu_quota);
 
 		// Look-up for next CPU id
@@ -163,7 +237,7 @@ LinuxPP::RegisterClusterCPUs(RLinuxBindingsPtr_t prlb) {
 		while (++first_cpu_id <= last_cpu_id) {
 			snprintf(resourcePath+13, 8, "%hu.pe%d",
 					prlb->socket_id, first_cpu_id);
-			logger->Debug("PLAT LNX: Registering [%s]...", resourcePath);
+			BBQUE_LOG_DEBUG("PLAT LNX: Registering [%s]...", resourcePath);
 			ra.RegisterResource(resourcePath, "", cpu_quota);
 		}
 
@@ -188,18 +262,30 @@ LinuxPP::RegisterClusterMEMs(RLinuxBindingsPtr_t prlb) {
 	// Setup resource path
 	snprintf(resourcePath+13, 11, "%hu.mem0", prlb->socket_id);
 
-	logger->Debug("PLAT LNX: Registering [%s: %" PRIu64 " Bytes]...",
+	BBQUE_LOG_DEBUG("PLAT LNX: Registering [%s: %" PRIu64 " Bytes]...",
 			resourcePath, limit_in_bytes);
 	ra.RegisterResource(resourcePath, "Bytes", limit_in_bytes);
 
 	return OK;
 }
 
+LinuxPP::ExitCode_t
+LinuxPP::RegisterClusterFreq(RLinuxBindingsPtr_t prlb) {
+
+	// The frequency is an optional resource, thus a missing cpufreq
+	// support does not prevent the cluster registration
+	if (!pcf->RegisterCluster(prlb->socket_id, prlb->cpus))
+		BBQUE_LOG_DEBUG("PLAT LNX: Frequency of node [%d] not managed",
+				prlb->socket_id);
+
+	return OK;
+}
+
 LinuxPP::ExitCode_t
 LinuxPP::RegisterCluster(RLinuxBindingsPtr_t prlb) {
 	ExitCode_t pp_result = OK;
 
-	logger->Debug("PLAT LNX: Setup resources for Node [%d], "
+	BBQUE_LOG_DEBUG("PLAT LNX: Setup resources for Node [%d], "
 			"CPUs [%s], MEMs [%s]",
 			prlb->socket_id, prlb->cpus, prlb->mems);
 
@@ -214,6 +300,11 @@ LinuxPP::RegisterCluster(RLinuxBindingsPtr_t prlb) {
 	if (pp_result != OK)
 		return pp_result;
 
+	// The CPU frequency is represented in MHz
+	pp_result = RegisterClusterFreq(prlb);
+	if (pp_result != OK)
+		return pp_result;
+
 	return pp_result;
 }
 
@@ -230,7 +321,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	int cg_result;
 
 	// Read "cpuset" attributes from kernel
-	logger->Debug("PLAT LNX: Loading kernel info for [%s]...", entry.path);
+	BBQUE_LOG_DEBUG("PLAT LNX: Loading kernel info for [%s]...", entry.path);
 
 
 	// Initialize the CGroup variable
@@ -243,7 +334,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 			prlb->socket_id);
 	bbq_node = cgroup_new_cgroup(group_name);
 	if (bbq_node == NULL) {
-		logger->Error("PLAT LNX: Parsing resources FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Parsing resources FAILED! "
 				"(Error: cannot create [%s] group)", entry.path);
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
 		goto parsing_failed;
@@ -252,7 +343,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	// Update the CGroup variable with kernel info
 	cg_result = cgroup_get_cgroup(bbq_node);
 	if (cg_result != 0) {
-		logger->Error("PLAT LNX: Reading kernel info FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Reading kernel info FAILED! "
 				"(Error: %d, %s)", cg_result, cgroup_strerror(cg_result));
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
 		goto parsing_failed;
@@ -265,7 +356,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	// Get "cpuset" controller info
 	cg_controller = cgroup_get_controller(bbq_node, "cpuset");
 	if (cg_controller == NULL) {
-		logger->Error("PLAT LNX: Getting controller FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting controller FAILED! "
 				"(Error: Cannot find controller \"cpuset\" "
 				"in group [%s])", entry.path);
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
@@ -276,12 +367,23 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	cg_result = cgroup_get_value_string(cg_controller, BBQUE_LINUXPP_CPUS_PARAM,
 			&(prlb->cpus));
 	if (cg_result) {
-		logger->Error("PLAT LNX: Getting CPUs attribute FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting CPUs attribute FAILED! "
 				"(Error: 'cpuset.cpus' not configured or not readable)");
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
 		goto parsing_failed;
 	}
 
+	// Getting the value for the "cpuset.mems" attribute
+	// NOTE: the returned buffer is released by the RLinuxBindings
+	cg_result = cgroup_get_value_string(cg_controller, BBQUE_LINUXPP_MEMN_PARAM,
+			&(prlb->mems));
+	if (cg_result) {
+		BBQUE_LOG_WARN("PLAT LNX: Getting MEMs attribute FAILED! "
+				"(Error: 'cpuset.mems' not readable, using node 0)");
+		prlb->mems = NULL;
+	}
+	cluster_mems[prlb->socket_id] = prlb->mems ? prlb->mems : "0";
+
 	/**********************************************************************
 	 *    MEMORY Controller
 	 **********************************************************************/
@@ -289,7 +391,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	// Get "memory" controller info
 	cg_controller = cgroup_get_controller(bbq_node, "memory");
 	if (cg_controller == NULL) {
-		logger->Error("PLAT LNX: Getting controller FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting controller FAILED! "
 				"(Error: Cannot find controller \"memory\" "
 				"in group [%s])", entry.path);
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
@@ -300,7 +402,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	cg_result = cgroup_get_value_string(cg_controller, BBQUE_LINUXPP_MEMB_PARAM,
 			&(prlb->memb));
 	if (cg_result) {
-		logger->Error("PLAT LNX: Getting MEMORY attribute FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting MEMORY attribute FAILED! "
 				"(Error: 'memory.limit_in_bytes' not configured "
 				"or not readable)");
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
@@ -319,7 +421,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	// Get "cpu" controller info
 	cg_controller = cgroup_get_controller(bbq_node, "cpu");
 	if (cg_controller == NULL) {
-		logger->Error("PLAT LNX: Getting controller FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting controller FAILED! "
 				"(Error: Cannot find controller \"cpu\" "
 				"in group [%s])", entry.path);
 		pp_result = PLATFORM_NODE_PARSING_FAILED;
@@ -330,10 +432,10 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 	cg_result = cgroup_get_value_string(cg_controller,
 			BBQUE_LINUXPP_CPUQ_PARAM, &buff);
 	if (cg_result) {
-		logger->Error("PLAT LNX: Getting CPU attributes FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: Getting CPU attributes FAILED! "
 				"(Error: 'cpu.cfs_quota_us' not configured "
 				"or not readable)");
-		logger->Warn("PLAT LNX: Disabling CPU Quota management");
+		BBQUE_LOG_WARN("PLAT LNX: Disabling CPU Quota management");
 
 		// Disable CFS quota management
 		cfsQuotaSupported = false;
@@ -348,18 +450,20 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 		errno = 0;
 		prlb->amount_cpuq = strtoul(buff, NULL, 10);
 		if (errno != 0) {
-			logger->Error("PLAT LNX: Getting CPU attributes FAILED! "
+			BBQUE_LOG_ERROR("PLAT LNX: Getting CPU attributes FAILED! "
 					"(Error: 'cpu.cfs_quota_us' convertion)");
 			pp_result = PLATFORM_NODE_PARSING_FAILED;
 			goto parsing_failed;
 		}
 
 		// Getting the value for the "cpu.cfs_period_us" attribute
+		free(buff);
+		buff = NULL;
 		cg_result = cgroup_get_value_string(cg_controller,
 				BBQUE_LINUXPP_CPUP_PARAM,
 				&buff);
 		if (cg_result) {
-			logger->Error("PLAT LNX: Getting CPU attributes FAILED! "
+			BBQUE_LOG_ERROR("PLAT LNX: Getting CPU attributes FAILED! "
 					"(Error: 'cpu.cfs_period_us' not configured "
 					"or not readable)");
 			pp_result = PLATFORM_NODE_PARSING_FAILED;
@@ -370,7 +474,7 @@ LinuxPP::ParseNodeAttributes(struct cgroup_file_info &entry,
 		errno = 0;
 		prlb->amount_cpup = strtoul(buff, NULL, 10);
 		if (errno != 0) {
-			logger->Error("PLAT LNX: Getting CPU attributes FAILED! "
+			BBQUE_LOG_ERROR("PLAT LNX: Getting CPU attributes FAILED! "
 					"(Error: 'cpu.cfs_period_us' convertion)");
 			pp_result = PLATFORM_NODE_PARSING_FAILED;
 			goto parsing_failed;
@@ -384,6 +488,9 @@ jump_quota_parsing:
 #endif
 
 parsing_failed:
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(3,2,0)
+	free(buff);
+#endif
 	cgroup_free (&bbq_node);
 	return pp_result;
 }
@@ -401,13 +508,13 @@ LinuxPP::ParseNode(struct cgroup_file_info &entry) {
 	if (entry.type != CGROUP_FILE_TYPE_DIR)
 		return OK;
 
-	logger->Info("PLAT LNX: scanning [%d:%s]...",
+	BBQUE_LOG_INFO("PLAT LNX: scanning [%d:%s]...",
 			entry.depth, entry.full_path);
 
 	// Consistency check for required folder names
 	if (strncmp(BBQUE_LINUXPP_CLUSTER, entry.path,
 				STRLEN(BBQUE_LINUXPP_CLUSTER))) {
-		logger->Warn("PLAT LNX: Resources enumeration, "
+		BBQUE_LOG_WARN("PLAT LNX: Resources enumeration, "
 				"ignoring unexpected CGroup [%s]",
 				entry.full_path);
 		return OK;
@@ -418,7 +525,7 @@ LinuxPP::ParseNode(struct cgroup_file_info &entry) {
 		return pp_result;
 
 	// Scan "cpus" and "mems" attributes for each cluster
-	logger->Debug("PLAT LNX: Setup resources from [%s]...",
+	BBQUE_LOG_DEBUG("PLAT LNX: Setup resources from [%s]...",
 			entry.full_path);
 
 	// Register CPUs for this Node
@@ -442,13 +549,13 @@ LinuxPP::_LoadPlatformData() {
 	int cg_result;
 	int level;
 
-	logger->Info("PLAT LNX: CGROUP based resources enumeration...");
+	BBQUE_LOG_INFO("PLAT LNX: CGROUP based resources enumeration...");
 
 	// Lookup for a "bbque/res" cgroup
 	bbq_resources = cgroup_new_cgroup(BBQUE_LINUXPP_RESOURCES);
 	cg_result = cgroup_get_cgroup(bbq_resources);
 	if (cg_result) {
-		logger->Error("PLAT LNX: [" BBQUE_LINUXPP_RESOURCES "] lookup FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: [" BBQUE_LINUXPP_RESOURCES "] lookup FAILED! "
 				"(Error: No resources assignment)");
 		return PLATFORM_ENUMERATION_FAILED;
 	}
@@ -457,7 +564,7 @@ LinuxPP::_LoadPlatformData() {
 	cg_result = cgroup_walk_tree_begin("cpuset", BBQUE_LINUXPP_RESOURCES,
 			1, &node_it, &entry, &level);
 	if ((cg_result != 0) || (node_it == NULL)) {
-		logger->Error("PLAT LNX: [" BBQUE_LINUXPP_RESOURCES "] lookup FAILED! "
+		BBQUE_LOG_ERROR("PLAT LNX: [" BBQUE_LINUXPP_RESOURCES "] lookup FAILED! "
 				"(Error: No resources assignment)");
 		return PLATFORM_ENUMERATION_FAILED;
 	}
@@ -486,6 +593,8 @@ LinuxPP::GetRLinuxType(br::ResourcePtr_t pres) {
 		return RLINUX_TYPE_SMEM;
 	case 'p':
 		return RLINUX_TYPE_CPU;
+	case 'f':
+		return RLINUX_TYPE_FREQ;
 	}
 
 	return RLINUX_TYPE_UNKNOWN;
@@ -502,7 +611,7 @@ LinuxPP::GetRLinuxId(br::ResourcePtr_t pres) {
 	}
 	// Parse the resource ID
 	sscanf(pid, "%u", &rid);
-	logger->Debug("Parsing from [%s] => id [%u]",
+	BBQUE_LOG_DEBUG("Parsing from [%s] => id [%u]",
 			pres->Name().c_str(), rid);
 	return rid;
 }
@@ -530,17 +639,21 @@ LinuxPP::ParseBindings(AppPtr_t papp, RViewToken_t rvt,
 		switch (GetRLinuxType(pres)) {
 		case RLINUX_TYPE_SMEM:
 			prlb->amount_memb += usage;
-			logger->Debug("PLAT LNX: Adding MEMORY %d, "
+			BBQUE_LOG_DEBUG("PLAT LNX: Adding MEMORY %d, "
 					"+%" PRIu64 ", total %" PRIu64 " Bytes",
 					rid, usage, prlb->amount_memb);
 			break;
 		case RLINUX_TYPE_CPU:
 			prlb->amount_cpus += usage;
 			strcat(prlb->cpus, buff);
-			logger->Debug("PLAT LNX: Adding CPU %d, "
+			BBQUE_LOG_DEBUG("PLAT LNX: Adding CPU %d, "
 					"+%" PRIu64 " %, total %" PRIu64 " %",
 					rid, usage, prlb->amount_cpus);
 			break;
+		case RLINUX_TYPE_FREQ:
+			// Frequency is a cluster-wide resource
+			// @see _MapClusterResources
+			break;
 		default:
 			// Just to mute compiler warnings..
 			break;
@@ -576,7 +689,7 @@ LinuxPP::GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
 		// Parse "tile" and "cluster"
 		prlb->node_id = br::ResourcePathUtils::GetID(pname, "tile");
 		prlb->socket_id = br::ResourcePathUtils::GetID(pname, "cluster");
-		logger->Debug("PLAT LNX: Map resources [%s] @ "
+		BBQUE_LOG_DEBUG("PLAT LNX: Map resources [%s] @ "
 				"Node [%d], Socket [%d]",
 				pname,
 				prlb->node_id, prlb->socket_id);
@@ -589,7 +702,7 @@ LinuxPP::GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
 	prlb->cpus[strlen(prlb->cpus)-1] = 0;
 	prlb->mems[strlen(prlb->mems)-1] = 0;
 
-	logger->Debug("PLAT LNX: [%s] => {cpus [%s: %" PRIu64 " %], "
+	BBQUE_LOG_DEBUG("PLAT LNX: [%s] => {cpus [%s: %" PRIu64 " %], "
 			"mnode[%d: %" PRIu64 " Bytes]}",
 			papp->StrId(), prlb->cpus, prlb->amount_cpus,
 			prlb->socket_id, prlb->amount_memb);
@@ -600,15 +713,12 @@ LinuxPP::GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
 
 
 LinuxPP::ExitCode_t
-LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
-	int result;
-
-	logger->Debug("PLAT LNX: Building CGroup [%s]...", pcgd->cgpath);
+LinuxPP::InitCGroup(CGroupDataPtr_t &pcgd) {
 
 	// Setup CGroup path for this application
 	pcgd->pcg = cgroup_new_cgroup(pcgd->cgpath);
 	if (!pcgd->pcg) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, \"cgroup\" creation)");
 		return MAPPING_FAILED;
 	}
@@ -616,7 +726,7 @@ LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
 	// Add "cpuset" controller
 	pcgd->pc_cpuset = cgroup_add_controller(pcgd->pcg, "cpuset");
 	if (!pcgd->pc_cpuset) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, [cpuset] \"controller\" "
 				"creation failed)");
 		return MAPPING_FAILED;
@@ -625,7 +735,7 @@ LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
 	// Add "memory" controller
 	pcgd->pc_memory = cgroup_add_controller(pcgd->pcg, "memory");
 	if (!pcgd->pc_memory) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, [memory] \"controller\" "
 				"creation failed)");
 		return MAPPING_FAILED;
@@ -636,7 +746,7 @@ LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
 	// Add "cpu" controller
 	pcgd->pc_cpu = cgroup_add_controller(pcgd->pcg, "cpu");
 	if (!pcgd->pc_cpu) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, [cpu] \"controller\" "
 				"creation failed)");
 		return MAPPING_FAILED;
@@ -644,13 +754,28 @@ LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
 
 #endif
 
+	return OK;
+}
+
+LinuxPP::ExitCode_t
+LinuxPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
+	ExitCode_t pp_result;
+	int result;
+
+	BBQUE_LOG_DEBUG("PLAT LNX: Building CGroup [%s]...", pcgd->cgpath);
+
+	// Setup the user-space CGroup descriptor
+	pp_result = InitCGroup(pcgd);
+	if (pp_result != OK)
+		return pp_result;
+
 	// Create the kernel-space CGroup
 	// NOTE: the current libcg API is quite confuse and unclear
 	// regarding the "ignore_ownership" second parameter
-	logger->Notice("PLAT LNX: Create kernel CGroup [%s]", pcgd->cgpath);
+	BBQUE_LOG_NOTICE("PLAT LNX: Create kernel CGroup [%s]", pcgd->cgpath);
 	result = cgroup_create_cgroup(pcgd->pcg, 0);
 	if (result && errno) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, kernel cgroup creation "
 				"[%d: %s]", errno, strerror(errno));
 		return MAPPING_FAILED;
@@ -666,7 +791,7 @@ LinuxPP::BuildSilosCG(CGroupDataPtr_t &pcgd) {
 	ExitCode_t result;
 	int error;
 
-	logger->Debug("PLAT LNX: Building SILOS CGroup...");
+	BBQUE_LOG_DEBUG("PLAT LNX: Building SILOS CGroup...");
 
 	// Build new CGroup data
 	pcgd = CGroupDataPtr_t(new CGroupData_t(BBQUE_LINUXPP_SILOS));
@@ -685,10 +810,10 @@ LinuxPP::BuildSilosCG(CGroupDataPtr_t &pcgd) {
 			BBQUE_LINUXPP_MEMN_PARAM, prlb->mems);
 
 	// Updating silos constraints
-	logger->Notice("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
+	BBQUE_LOG_NOTICE("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
 	error = cgroup_modify_cgroup(pcgd->pcg);
 	if (error) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, kernel cgroup update "
 				"[%d: %s]", errno, strerror(errno));
 		return MAPPING_FAILED;
@@ -704,6 +829,131 @@ LinuxPP::BuildAppCG(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
 	return BuildCGroup(pcgd);
 }
 
+LinuxPP::ExitCode_t
+LinuxPP::BuildPoolCG(CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	char cgpath[BBQUE_LINUXPP_CGROUP_PATH_MAX];
+
+	snprintf(cgpath, BBQUE_LINUXPP_CGROUP_PATH_MAX,
+			BBQUE_LINUXPP_POOL"%u", cg_pool_next++);
+	pool_ul.unlock();
+
+	// Build new CGroup data, not yet assigned to any application
+	pcgd = CGroupDataPtr_t(new CGroupData_t(cgpath));
+	return BuildCGroup(pcgd);
+}
+
+LinuxPP::ExitCode_t
+LinuxPP::GetPoolCG(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	ExitCode_t result;
+
+	// Get a pre-built CGroup, if available
+	if (likely(!cg_pool.empty())) {
+		pcgd = cg_pool.front();
+		cg_pool.pop_front();
+		pool_ul.unlock();
+
+		mc.Count(metrics[PP_SETUP_POOL_HIT].mh);
+		pcgd->papp = papp;
+		BBQUE_LOG_DEBUG("PLAT LNX: [%s] => pooled CGroup [%s]",
+				papp->StrId(), pcgd->cgpath);
+		cg_pool_dfr.Schedule(milliseconds(BBQUE_LINUXPP_POOL_REFILL_DELAY));
+		return OK;
+	}
+	pool_ul.unlock();
+	cg_pool_dfr.Schedule(milliseconds(BBQUE_LINUXPP_POOL_REFILL_DELAY));
+
+	// Otherwise, a new one must be built on demand
+	mc.Count(metrics[PP_SETUP_POOL_MISS].mh);
+	BBQUE_LOG_DEBUG("PLAT LNX: [%s] CGroups pool empty, building a new one",
+			papp->StrId());
+	result = BuildPoolCG(pcgd);
+	if (result != OK)
+		return result;
+	pcgd->papp = papp;
+
+	return OK;
+}
+
+void
+LinuxPP::RefillPool() {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	CGroupDataPtr_t pcgd;
+	ExitCode_t result;
+
+	while (cg_pool.size() < cg_pool_size) {
+		pool_ul.unlock();
+		result = BuildPoolCG(pcgd);
+		if (result != OK) {
+			BBQUE_LOG_WARN("PLAT LNX: CGroups pool refill FAILED");
+			return;
+		}
+		pool_ul.lock();
+
+		// The pool could have been filled by parked control groups
+		// meanwhile, thus the exceeding one is just released
+		if (cg_pool.size() >= cg_pool_size)
+			break;
+		cg_pool.push_back(pcgd);
+	}
+}
+
+bool
+LinuxPP::TaskInCGroup(app::AppPid_t pid, CGroupDataPtr_t const &pcgd) {
+	char *cgpath = NULL;
+	bool found;
+
+	if (cgroup_get_current_controller_path(pid, controller, &cgpath))
+		return false;
+
+	// The path is reported with respect to the controller mount point
+	found = (strcmp(cgpath + (cgpath[0] == '/'), pcgd->cgpath) == 0);
+	free(cgpath);
+
+	return found;
+}
+
+void
+LinuxPP::ParkCGroup(CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	ExitCode_t result;
+
+	// Exceeding control groups are just released
+	if (cg_pool.size() >= cg_pool_size)
+		return;
+	pool_ul.unlock();
+
+	// Move the application task, if still into this control group, into
+	// the silos, since a parked control group must not host any task. The
+	// PID could have been reused by another process in the meanwhile.
+	if (pcgd->papp && TaskInCGroup(pcgd->papp->Pid(), pcgd)) {
+		result = _ReclaimResources(pcgd->papp);
+		if (result != OK) {
+			BBQUE_LOG_WARN("PLAT LNX: [%s] CGroup parking FAILED",
+					pcgd->papp->StrId());
+			return;
+		}
+	}
+
+	// Reset the CGroup descriptor, to drop the attributes values
+	// (e.g. the task PID) set for the released application
+	cgroup_free(&pcgd->pcg);
+	result = InitCGroup(pcgd);
+	if (result != OK)
+		return;
+
+	BBQUE_LOG_DEBUG("PLAT LNX: Parking CGroup [%s]", pcgd->cgpath);
+	pcgd->papp.reset();
+	pcgd->mems.clear();
+	pcgd->rss_tmr.stop();
+
+	pool_ul.lock();
+	if (cg_pool.size() >= cg_pool_size)
+		return;
+	cg_pool.push_back(pcgd);
+}
+
 LinuxPP::ExitCode_t
 LinuxPP::GetCGroupData(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
 	ExitCode_t result;
@@ -715,8 +965,12 @@ LinuxPP::GetCGroupData(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
 	if (pcgd)
 		return OK;
 
-	// A new CGroupData must be setup for this app
-	result = BuildAppCG(papp, pcgd);
+	// A new CGroupData must be setup for this app, getting it from the
+	// pool of pre-built ones (if enabled)
+	if (cg_pool_size)
+		result = GetPoolCG(papp, pcgd);
+	else
+		result = BuildAppCG(papp, pcgd);
 	if (result != OK)
 		return result;
 
@@ -733,7 +987,9 @@ LinuxPP::ExitCode_t
 LinuxPP::SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 		bool excl, bool move) {
 	char quota[] = "9223372036854775807";
-	char mnode[] = "\09"; // Empty memory node (by default)
+	char mnode[] = "65535";
+	std::map<unsigned short, std::string>::const_iterator mems_it;
+	std::string mems;
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(3,2,0)
 	int64_t cpus_quota = -1; // NOTE: use "-1" for no quota assignement
 #endif
@@ -759,19 +1015,32 @@ LinuxPP::SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 			prlb->cpus ? prlb->cpus : "");
 	// Set the assigned memory NODE (only if we have at least one CPUS)
 	if (prlb->cpus[0]) {
-		snprintf(mnode, 3, "%d", prlb->node_id);
+		// Memory nodes of the assigned cluster, as defined by the
+		// corresponding resources CGroup
+		mems_it = cluster_mems.find(prlb->socket_id);
+		if (mems_it != cluster_mems.end()) {
+			mems = (*mems_it).second;
+		} else {
+			snprintf(mnode, sizeof(mnode), "%d", prlb->node_id);
+			mems = mnode;
+		}
 		cgroup_set_value_string(pcgd->pc_cpuset,
-				BBQUE_LINUXPP_MEMN_PARAM, mnode);
+				BBQUE_LINUXPP_MEMN_PARAM, mems.c_str());
 
-		logger->Debug("PLAT LNX: Setup CPUSET for [%s]: "
+		// Let the kernel migrate pages on memory nodes update
+		if (pmm->Mode() == MemoryMigrator::MIGRATE_CGROUP)
+			cgroup_set_value_string(pcgd->pc_cpuset,
+					BBQUE_LINUXPP_MEMM_PARAM, "1");
+
+		BBQUE_LOG_DEBUG("PLAT LNX: Setup CPUSET for [%s]: "
 			"{cpus [%c: %s], mems[%s]}",
 			pcgd->papp->StrId(),
 			excl ? 'E' : 'S',
 			prlb->cpus ? prlb->cpus : "-",
-			mnode);
+			mems.c_str());
 	} else {
 
-		logger->Debug("PLAT LNX: Setup CPUSET for [%s]: "
+		BBQUE_LOG_DEBUG("PLAT LNX: Setup CPUSET for [%s]: "
 			"{cpus [NONE], mems[NONE]}",
 			pcgd->papp->StrId());
 	}
@@ -786,7 +1055,7 @@ LinuxPP::SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 	cgroup_set_value_string(pcgd->pc_memory,
 			BBQUE_LINUXPP_MEMB_PARAM, quota);
 
-	logger->Debug("PLAT LNX: Setup MEMORY for [%s]: "
+	BBQUE_LOG_DEBUG("PLAT LNX: Setup MEMORY for [%s]: "
 			"{bytes_limit [%lu]}",
 			pcgd->papp->StrId(), prlb->amount_memb);
 
@@ -816,14 +1085,14 @@ LinuxPP::SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 		cgroup_set_value_int64(pcgd->pc_cpu,
 				BBQUE_LINUXPP_CPUQ_PARAM, cpus_quota);
 
-		logger->Debug("PLAT LNX: Setup CPU for [%s]: "
+		BBQUE_LOG_DEBUG("PLAT LNX: Setup CPU for [%s]: "
 				"{period [%s], quota [%lu]",
 				pcgd->papp->StrId(),
 				STR(BBQUE_LINUXPP_CPUP_DEFAULT),
 				cpus_quota);
 	} else {
 
-		logger->Debug("PLAT LNX: Setup CPU for [%s]: "
+		BBQUE_LOG_DEBUG("PLAT LNX: Setup CPU for [%s]: "
 				"{period [%s], quota [-]}",
 				pcgd->papp->StrId(),
 				STR(BBQUE_LINUXPP_CPUP_DEFAULT));
@@ -838,10 +1107,10 @@ jump_quota_management:
 	 *    CGroup Configuraiton
 	 **********************************************************************/
 
-	logger->Debug("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
+	BBQUE_LOG_DEBUG("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
 	result = cgroup_modify_cgroup(pcgd->pcg);
 	if (result) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, kernel cgroup update "
 				"[%d: %s])", errno, strerror(errno));
 		return MAPPING_FAILED;
@@ -859,7 +1128,7 @@ jump_quota_management:
 	// task. Otherwise a task could be killed if being assigned to a
 	// CGroup not yet configure.
 
-	logger->Notice("PLAT LNX: [%s] => "
+	BBQUE_LOG_NOTICE("PLAT LNX: [%s] => "
 			"{cpu [%s: %" PRIu64 " %], mem[%d: %" PRIu64 " B]}",
 			pcgd->papp->StrId(),
 			prlb->cpus, prlb->amount_cpus,
@@ -868,15 +1137,26 @@ jump_quota_management:
 			BBQUE_LINUXPP_PROCS_PARAM,
 			pcgd->papp->Pid());
 
-	logger->Debug("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
+	BBQUE_LOG_DEBUG("PLAT LNX: Updating kernel CGroup [%s]", pcgd->cgpath);
 	result = cgroup_modify_cgroup(pcgd->pcg);
 	if (result) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, kernel cgroup update "
 				"[%d: %s])", errno, strerror(errno));
 		return MAPPING_FAILED;
 	}
 
+	/**********************************************************************
+	 *    Memory Pages Migration
+	 **********************************************************************/
+
+	// Pages left on the memory nodes of the previous cluster are migrated
+	// in background (if required)
+	if (mems.empty())
+		return OK;
+	pmm->Migrate(pcgd->papp->Pid(), pcgd->mems, mems);
+	pcgd->mems = mems;
+
 	return OK;
 }
 
@@ -891,7 +1171,7 @@ LinuxPP::_Setup(AppPtr_t papp) {
 	// Setup a new CGroup data for this application
 	result = GetCGroupData(papp, pcgd);
 	if (result != OK) {
-		logger->Error("PLAT LNX: [%s] CGroup initialization FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: [%s] CGroup initialization FAILED "
 				"(Error: CGroupData setup)");
 		return result;
 	}
@@ -902,7 +1182,7 @@ LinuxPP::_Setup(AppPtr_t papp) {
 	// Reclaim application resource, thus moving this app into the silos
 	result = _ReclaimResources(papp);
 	if (result != OK) {
-		logger->Error("PLAT LNX: [%s] CGroup initialization FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: [%s] CGroup initialization FAILED "
 				"(Error: failed moving app into silos)");
 		return result;
 	}
@@ -912,8 +1192,17 @@ LinuxPP::_Setup(AppPtr_t papp) {
 
 LinuxPP::ExitCode_t
 LinuxPP::_Release(AppPtr_t papp) {
+	CGroupDataPtr_t pcgd;
+
+	// Recycle the application control group into the pool
+	pcgd = std::static_pointer_cast<CGroupData_t>(
+			papp->GetAttribute(PLAT_LNX_ATTRIBUTE, "cgroup")
+		);
+	if (pcgd && cg_pool_size)
+		ParkCGroup(pcgd);
+
 	// Release CGroup plugin data
-	// ... thus releasing the corresponding control group
+	// ... thus releasing the corresponding control group (if not parked)
 	papp->ClearAttribute(PLAT_LNX_ATTRIBUTE);
 	return OK;
 }
@@ -926,29 +1215,57 @@ LinuxPP::_ReclaimResources(AppPtr_t papp) {
 	CGroupDataPtr_t pcgd;
 	int error;
 
-	logger->Debug("PLAT LNX: CGroup resource claiming START");
+	BBQUE_LOG_DEBUG("PLAT LNX: CGroup resource claiming START");
 
 	// Move this app into "silos" CGroup
+	std::unique_lock<std::mutex> silos_ul(silos_mtx);
 	cgroup_set_value_uint64(psilos->pc_cpuset,
 			BBQUE_LINUXPP_PROCS_PARAM,
 			papp->Pid());
 
 	// Configure the CGroup based on resource bindings
-	logger->Notice("PLAT LNX: [%s] => SILOS[%s]",
+	BBQUE_LOG_NOTICE("PLAT LNX: [%s] => SILOS[%s]",
 			papp->StrId(), psilos->cgpath);
 	error = cgroup_modify_cgroup(psilos->pcg);
 	if (error) {
-		logger->Error("PLAT LNX: CGroup resource mapping FAILED "
+		BBQUE_LOG_ERROR("PLAT LNX: CGroup resource mapping FAILED "
 				"(Error: libcgroup, kernel cgroup update "
 				"[%d: %s]", errno, strerror(errno));
 		return MAPPING_FAILED;
 	}
 
-	logger->Debug("PLAT LNX: CGroup resource claiming DONE!");
+	BBQUE_LOG_DEBUG("PLAT LNX: CGroup resource claiming DONE!");
 
 	return OK;
 }
 
+uint64_t
+LinuxPP::_GetMemoryFootprint(AppPtr_t papp) {
+	CGroupDataPtr_t pcgd;
+	std::string path;
+
+	pcgd = std::static_pointer_cast<CGroupData_t>(
+			papp->GetAttribute(PLAT_LNX_ATTRIBUTE, "cgroup")
+		);
+	if (!pcgd)
+		return 0;
+
+	// The footprint is sampled at most once per refresh period, since this
+	// could be queried for each scheduling alternative of an application
+	std::unique_lock<std::mutex> rss_ul(pcgd->rss_mtx);
+	if (pcgd->rss_tmr.Running() &&
+			(pcgd->rss_tmr.getElapsedTimeMs() < BBQUE_LINUXPP_RSS_PERIOD))
+		return pcgd->rss;
+
+	path = memory_mount + "/" + pcgd->cgpath + "/" BBQUE_LINUXPP_MSTAT_PARAM;
+	pcgd->rss = MemoryMigrator::ReadRSS(path);
+	pcgd->rss_tmr.start();
+
+	BBQUE_LOG_DEBUG("PLAT LNX: [%s] memory footprint [%" PRIu64 " Bytes]",
+			papp->StrId(), pcgd->rss);
+	return pcgd->rss;
+}
+
 LinuxPP::ExitCode_t
 LinuxPP::_MapResources(AppPtr_t papp, UsagesMapPtr_t pum, RViewToken_t rvt,
 		bool excl) {
@@ -957,7 +1274,7 @@ LinuxPP::_MapResources(AppPtr_t papp, UsagesMapPtr_t pum, RViewToken_t rvt,
 	CGroupDataPtr_t pcgd;
 	ExitCode_t result;
 
-	logger->Debug("PLAT LNX: CGroup resource mapping START");
+	BBQUE_LOG_DEBUG("PLAT LNX: CGroup resource mapping START");
 
 	// Get a reference to the CGroup data
 	result = GetCGroupData(papp, pcgd);
@@ -966,16 +1283,27 @@ LinuxPP::_MapResources(AppPtr_t papp, UsagesMapPtr_t pum, RViewToken_t rvt,
 
 	result = GetResouceMapping(papp, pum, rvt, prlb);
 	if (result != OK) {
-		logger->Error("PLAT LNX: binding parsing FAILED");
+		BBQUE_LOG_ERROR("PLAT LNX: binding parsing FAILED");
 		return MAPPING_FAILED;
 	}
 	//prlb->cpus << "7";
 	//prlb->mems << "0";
 
 	// Configure the CGroup based on resource bindings
-	SetupCGroup(pcgd, prlb, excl, true);
+	result = SetupCGroup(pcgd, prlb, excl, true);
+	if (result != OK) {
+		BBQUE_LOG_ERROR("PLAT LNX: [%s] CGroup setup FAILED",
+				papp->StrId());
+		return result;
+	}
 
-	logger->Debug("PLAT LNX: CGroup resource mapping DONE!");
+	BBQUE_LOG_DEBUG("PLAT LNX: CGroup resource mapping DONE!");
+	return OK;
+}
+
+LinuxPP::ExitCode_t
+LinuxPP::_MapClusterResources(RViewToken_t rvt) {
+	pcf->Actuate(rvt);
 	return OK;
 }
 
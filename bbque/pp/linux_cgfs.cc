@@ -0,0 +1,1093 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/pp/linux_cgfs.h"
+
+#include "bbque/configuration_manager.h"
+#include "bbque/resource_accounter.h"
+#include "bbque/res/resource_utils.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
+#include <sys/uio.h>
+
+#include <linux/magic.h>
+
+#ifndef CGROUP_SUPER_MAGIC
+# define CGROUP_SUPER_MAGIC  0x27e0eb
+#endif
+#ifndef CGROUP2_SUPER_MAGIC
+# define CGROUP2_SUPER_MAGIC 0x63677270
+#endif
+
+// The prefix for configuration file attributes
+#define MODULE_CONFIG "LinuxPP"
+
+#define BBQUE_LINUXCGFS_PLATFORM_ID		"org.linux.cgroup"
+
+#define BBQUE_LINUXCGFS_SILOS 			BBQUE_LINUXCGFS_CGROUP"/silos"
+
+// The default CFS bandwidth period [us]
+#define BBQUE_LINUXCGFS_CPUP_DEFAULT		100000
+
+// The max length of an attribute value read from the cgroupfs
+#define BBQUE_LINUXCGFS_VALUE_MAX		4096
+
+namespace br = bbque::res;
+namespace po = boost::program_options;
+
+namespace bbque {
+
+LinuxCGFSPP::CGAttributeDesc_t const
+LinuxCGFSPP::cgAttributes[CGFS_ATTRS_COUNT] = {
+	{CGFS_CTRL_CPUSET, "cpuset.cpus",           "cpuset.cpus",  false},
+	{CGFS_CTRL_CPUSET, "cpuset.mems",           "cpuset.mems",  false},
+	{CGFS_CTRL_MEMORY, "memory.limit_in_bytes", "memory.max",   false},
+	{CGFS_CTRL_CPU,    "cpu.cfs_period_us",     NULL,           false},
+	{CGFS_CTRL_CPU,    "cpu.cfs_quota_us",      "cpu.max",      false},
+	{CGFS_CTRL_CPUSET, "cpuset.memory_migrate", NULL,           false},
+	{CGFS_CTRL_CPUSET, "cgroup.procs",          "cgroup.procs", true},
+	{CGFS_CTRL_MEMORY, "cgroup.procs",          NULL,           true},
+	{CGFS_CTRL_CPU,    "cgroup.procs",          NULL,           true},
+};
+
+const char *
+LinuxCGFSPP::cgControllers[CGFS_CTRL_COUNT] = {
+	"cpuset",
+	"memory",
+	"cpu",
+};
+
+LinuxCGFSPP::CGroupData::CGroupData(AppPtr_t pa) :
+	Attribute(PLAT_CGFS_ATTRIBUTE, "cgroup"),
+	papp(pa),
+	cgpath(BBQUE_LINUXCGFS_CGROUP"/"),
+	emulated(false),
+	rss(0) {
+	cgpath.append(papp->StrId());
+	for (uint8_t i = 0; i < CGFS_ATTRS_COUNT; ++i)
+		fd[i] = -1;
+}
+
+LinuxCGFSPP::CGroupData::CGroupData(const char *cgp) :
+	Attribute(PLAT_CGFS_ATTRIBUTE, "cgroup"),
+	cgpath(cgp),
+	emulated(false),
+	rss(0) {
+	for (uint8_t i = 0; i < CGFS_ATTRS_COUNT; ++i)
+		fd[i] = -1;
+}
+
+LinuxCGFSPP::CGroupData::~CGroupData() {
+	struct dirent *entry;
+	std::string path;
+	DIR *dir;
+
+	// Releasing attributes file descriptors
+	for (uint8_t i = 0; i < CGFS_ATTRS_COUNT; ++i) {
+		if (fd[i] >= 0)
+			close(fd[i]);
+	}
+
+	// Removing Kernel Control Group (from each controller hierarchy)
+	for (uint8_t i = 0; i < CGFS_CTRL_COUNT; ++i) {
+		if (cgdir[i].empty())
+			continue;
+
+		// On an emulated cgroupfs the attribute files must be removed
+		// before the folder could be released
+		if (emulated && (dir = opendir(cgdir[i].c_str()))) {
+			while ((entry = readdir(dir)) != NULL) {
+				if (entry->d_name[0] == '.')
+					continue;
+				path = cgdir[i] + "/" + entry->d_name;
+				unlink(path.c_str());
+			}
+			closedir(dir);
+		}
+
+		// NOTE: on a unified hierarchy all the controllers share the same
+		// folder, thus only the first removal is expected to succeed
+		rmdir(cgdir[i].c_str());
+	}
+}
+
+LinuxCGFSPP::LinuxCGFSPP() :
+	PlatformProxy(),
+	cgfs_v2(false),
+	cgfs_emulated(false),
+	cfsQuotaSupported(true),
+	cg_pool_size(BBQUE_LINUXCGFS_POOL_DEFAULT),
+	cg_pool_next(0),
+	cg_pool_dfr("pp.cgpool", std::bind(&LinuxCGFSPP::RefillPool, this)) {
+	struct statfs fs_info;
+	std::string bbque_dir;
+	std::string mig_mode;
+	uint32_t mig_period;
+	std::string cpufreq_mode;
+	std::string cpufreq_root;
+	ExitCode_t pp_result;
+	CGroupDataPtr_t pcgd;
+	int fd;
+
+	//---------- Loading module configuration
+	ConfigurationManager & cm = ConfigurationManager::GetInstance();
+	po::options_description opts_desc("Linux Platform Proxy Options");
+	opts_desc.add_options()
+		(MODULE_CONFIG".cgfs_root",
+		 po::value<std::string>
+		 (&cgfs_root)->default_value(BBQUE_LINUXCGFS_ROOT_DEFAULT),
+		 "The mount point of the control groups filesystem")
+		(MODULE_CONFIG".cgpool_size",
+		 po::value<uint16_t>
+		 (&cg_pool_size)->default_value(BBQUE_LINUXCGFS_POOL_DEFAULT),
+		 "The number of pre-built applications control groups")
+		(MODULE_CONFIG".memory_migrate",
+		 po::value<std::string>
+		 (&mig_mode)->default_value("none"),
+		 "The memory pages migration mode (none, cgroup, async)")
+		(MODULE_CONFIG".memory_migrate_period",
+		 po::value<uint32_t>
+		 (&mig_period)->default_value(BBQUE_MEMMIG_PERIOD_DEFAULT),
+		 "The minimum time between asynchronous migrations [ms]")
+		(MODULE_CONFIG".cpufreq",
+		 po::value<std::string>
+		 (&cpufreq_mode)->default_value("none"),
+		 "The CPU frequency actuation mode (none, userspace, maxfreq)")
+		(MODULE_CONFIG".cpufreq_root",
+		 po::value<std::string>
+		 (&cpufreq_root)->default_value(BBQUE_CPUFREQ_ROOT_DEFAULT),
+		 "The sysfs folder exporting the CPUs frequency controls")
+		;
+	po::variables_map opts_vm;
+	cm.ParseConfigurationFile(opts_desc, opts_vm);
+
+	// Setup the memory pages migration support
+	pmm = MemoryMigratorPtr_t(new MemoryMigrator(mig_mode, mig_period,
+				logger));
+
+	// Setup the CPU frequency management support
+	pcf = CPUFreqManagerPtr_t(new CPUFreqManager(cpufreq_mode,
+				cpufreq_root, logger));
+
+	// Look-up for the unified (v2) hierarchy
+	cgfs_v2 = (access((cgfs_root + "/cgroup.controllers").c_str(),
+				F_OK) == 0);
+	logger->Info("PLAT CGFS: using CGroup v%d hierarchy mounted at [%s]",
+			cgfs_v2 ? 2 : 1, cgfs_root.c_str());
+
+	// Check the "bbque" cgroup has been properly configured
+	bbque_dir = CGroupDir(CGFS_CTRL_CPUSET, BBQUE_LINUXCGFS_CGROUP);
+	if (statfs(bbque_dir.c_str(), &fs_info)) {
+		logger->Error("PLAT CGFS: CGroup [%s] lookup FAILED! "
+				"(Error: %d - %s)", bbque_dir.c_str(),
+				errno, strerror(errno));
+		return;
+	}
+
+	// Check if we are running on top of an emulated cgroupfs
+	if ((fs_info.f_type != CGROUP_SUPER_MAGIC) &&
+			(fs_info.f_type != CGROUP2_SUPER_MAGIC)) {
+		logger->Warn("PLAT CGFS: [%s] is not a cgroup filesystem, "
+				"using an EMULATED hierarchy", bbque_dir.c_str());
+		cgfs_emulated = true;
+	}
+
+	// Enable the required controllers for the "bbque" sub-groups
+	if (cgfs_v2 && !cgfs_emulated) {
+		fd = open((bbque_dir + "/cgroup.subtree_control").c_str(),
+				O_WRONLY | O_CLOEXEC);
+		if ((fd < 0) ||
+			(write(fd, "+cpuset +memory +cpu", 20) < 0)) {
+			logger->Warn("PLAT CGFS: enabling controllers on [%s] FAILED "
+					"(Error: %d - %s)", bbque_dir.c_str(),
+					errno, strerror(errno));
+		}
+		if (fd >= 0)
+			close(fd);
+	}
+
+	// Build "silos" CGroup to host blocked applications
+	pp_result = BuildSilosCG(psilos);
+	if (pp_result) {
+		logger->Error("PLAT CGFS: Silos CGroup setup FAILED!");
+		return;
+	}
+
+	// Pre-build the pool of applications control groups
+	logger->Info("PLAT CGFS: Pre-building [%d] applications CGroups",
+			cg_pool_size);
+	for (uint16_t i = 0; i < cg_pool_size; ++i) {
+		pp_result = BuildPoolCG(pcgd);
+		if (pp_result) {
+			logger->Warn("PLAT CGFS: CGroups pool setup FAILED "
+					"(Error: [%d] CGroups built)", i);
+			break;
+		}
+		cg_pool.push_back(pcgd);
+	}
+
+	// Mark the Platform Integration Layer (PIL) as initialized
+	SetPilInitialized();
+}
+
+LinuxCGFSPP::~LinuxCGFSPP() {
+
+}
+
+/*******************************************************************************
+ *    CGroupFS Attributes Access
+ ******************************************************************************/
+
+std::string
+LinuxCGFSPP::CGroupDir(CGController_t ctrl, std::string const & cgpath) {
+	if (cgfs_v2)
+		return cgfs_root + "/" + cgpath;
+	return cgfs_root + "/" + cgControllers[ctrl] + "/" + cgpath;
+}
+
+bool
+LinuxCGFSPP::ReadAttribute(std::string const & cgpath, CGAttribute_t attr,
+		std::string & value) {
+	const char *name = cgfs_v2 ? cgAttributes[attr].v2 : cgAttributes[attr].v1;
+	char buff[BBQUE_LINUXCGFS_VALUE_MAX];
+	std::string path;
+	ssize_t len;
+	int fd;
+
+	// Attribute not available on this hierarchy
+	if (!name)
+		return false;
+
+	path = CGroupDir(cgAttributes[attr].ctrl, cgpath) + "/" + name;
+	fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		logger->Debug("PLAT CGFS: opening [%s] FAILED (Error: %d - %s)",
+				path.c_str(), errno, strerror(errno));
+		return false;
+	}
+
+	len = read(fd, buff, BBQUE_LINUXCGFS_VALUE_MAX - 1);
+	close(fd);
+	if (len < 0) {
+		logger->Debug("PLAT CGFS: reading [%s] FAILED (Error: %d - %s)",
+				path.c_str(), errno, strerror(errno));
+		return false;
+	}
+
+	// Clean-up trailing new-lines
+	while (len && (buff[len-1] == '\n'))
+		--len;
+	value.assign(buff, len);
+
+	return true;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::WriteAttribute(CGroupDataPtr_t &pcgd, CGAttribute_t attr,
+		std::string const & value, bool force) {
+	CGAttributeDesc_t const & desc(cgAttributes[attr]);
+	const char *name = cgfs_v2 ? desc.v2 : desc.v1;
+	struct iovec iov[2];
+	std::string path;
+	ssize_t len;
+	int flags;
+
+	// Attribute not available on this hierarchy
+	if (!name)
+		return OK;
+
+	// Skip writing values which are already configured
+	if (!force && !desc.volatile_value && (pcgd->fd[attr] >= 0) &&
+			(pcgd->value[attr] == value)) {
+		logger->Debug("PLAT CGFS: [%s] %s = [%s] (unchanged)",
+				pcgd->cgpath.c_str(), name, value.c_str());
+		return OK;
+	}
+
+	// Open the attribute file the first time it is written
+	if (pcgd->fd[attr] < 0) {
+		path = pcgd->cgdir[desc.ctrl] + "/" + name;
+		flags = O_WRONLY | O_CLOEXEC;
+		if (pcgd->emulated)
+			flags |= O_CREAT;
+		pcgd->fd[attr] = open(path.c_str(), flags, 0644);
+		if (pcgd->fd[attr] < 0) {
+			logger->Error("PLAT CGFS: opening [%s] FAILED "
+					"(Error: %d - %s)", path.c_str(),
+					errno, strerror(errno));
+			return MAPPING_FAILED;
+		}
+	}
+
+	// Write the new value, followed by a new-line, with a single syscall
+	iov[0].iov_base = (void*)value.c_str();
+	iov[0].iov_len  = value.length();
+	iov[1].iov_base = (void*)"\n";
+	iov[1].iov_len  = 1;
+	len = pwritev(pcgd->fd[attr], iov, 2, 0);
+	if (len < 0) {
+		logger->Error("PLAT CGFS: [%s] %s = [%s] FAILED "
+				"(Error: %d - %s)", pcgd->cgpath.c_str(), name,
+				value.c_str(), errno, strerror(errno));
+		// Force a write at the next update
+		pcgd->value[attr].clear();
+		return MAPPING_FAILED;
+	}
+
+	// Emulated attributes must not retain previous (longer) values
+	if (pcgd->emulated && ftruncate(pcgd->fd[attr], len)) {
+		logger->Warn("PLAT CGFS: [%s] %s truncation FAILED "
+				"(Error: %d - %s)", pcgd->cgpath.c_str(), name,
+				errno, strerror(errno));
+	}
+
+	logger->Debug("PLAT CGFS: [%s] %s = [%s]",
+			pcgd->cgpath.c_str(), name, value.c_str());
+
+	if (!desc.volatile_value)
+		pcgd->value[attr] = value;
+
+	return OK;
+}
+
+/*******************************************************************************
+ *    Platform Resources Parsing and Loading
+ ******************************************************************************/
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::RegisterClusterCPUs(RLinuxBindingsPtr_t prlb) {
+	ResourceAccounter &ra(ResourceAccounter::GetInstance());
+	const char *p = prlb->cpus.c_str();
+	char resourcePath[] = "tile0.cluster65535.pe65535";
+	unsigned long first_cpu_id;
+	unsigned long last_cpu_id;
+	uint32_t cpu_quota = 100;
+	char *end;
+
+	// NOTE: The CPU bandwidth is used to assign the SAME quota to each
+	// processor within the same node/cluster.
+	// @see LinuxPP::RegisterClusterCPUs
+	if (prlb->amount_cpup) {
+		cpu_quota = (prlb->amount_cpuq * 100) / prlb->amount_cpup;
+		logger->Debug("Registering CPUs of node [%d] with CPU quota of [%u]%",
+				prlb->socket_id, cpu_quota);
+	}
+
+	// The CPUs are generally represented with a syntax like this:
+	// 1-3,4,5-7
+	while (*p) {
+		first_cpu_id = strtoul(p, &end, 10);
+		if (end == p)
+			break;
+		last_cpu_id = first_cpu_id;
+		if (*end == '-')
+			last_cpu_id = strtoul(end + 1, &end, 10);
+
+		for ( ; first_cpu_id <= last_cpu_id; ++first_cpu_id) {
+			snprintf(resourcePath, sizeof(resourcePath),
+					"tile0.cluster%hu.pe%lu",
+					prlb->socket_id, first_cpu_id);
+			logger->Debug("PLAT CGFS: Registering [%s]...", resourcePath);
+			ra.RegisterResource(resourcePath, "", cpu_quota);
+		}
+
+		p = end;
+		if (*p == ',')
+			++p;
+	}
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::RegisterClusterMEMs(RLinuxBindingsPtr_t prlb) {
+	ResourceAccounter &ra(ResourceAccounter::GetInstance());
+	char resourcePath[] = "tile0.cluster65535.mem0";
+
+	snprintf(resourcePath, sizeof(resourcePath),
+			"tile0.cluster%hu.mem0", prlb->socket_id);
+
+	logger->Debug("PLAT CGFS: Registering [%s: %" PRIu64 " Bytes]...",
+			resourcePath, prlb->amount_memb);
+	ra.RegisterResource(resourcePath, "Bytes", prlb->amount_memb);
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::RegisterClusterFreq(RLinuxBindingsPtr_t prlb) {
+
+	// @see LinuxPP::RegisterClusterFreq
+	if (!pcf->RegisterCluster(prlb->socket_id, prlb->cpus))
+		logger->Debug("PLAT CGFS: Frequency of node [%d] not managed",
+				prlb->socket_id);
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::ParseNode(const char *node) {
+	RLinuxBindingsPtr_t prlb(new RLinuxBindings_t());
+	std::string cgpath(BBQUE_LINUXCGFS_RESOURCES"/");
+	ExitCode_t pp_result;
+	std::string value;
+
+	cgpath.append(node);
+	logger->Info("PLAT CGFS: scanning [%s]...", cgpath.c_str());
+	sscanf(node + STRLEN(BBQUE_LINUXCGFS_CLUSTER), "%hu", &prlb->socket_id);
+
+	/**********************************************************************
+	 *    CPUSET Controller
+	 **********************************************************************/
+
+	if (!ReadAttribute(cgpath, CGFS_CPUS, prlb->cpus)) {
+		logger->Error("PLAT CGFS: Getting CPUs attribute FAILED! "
+				"(Error: 'cpuset.cpus' not configured or not readable)");
+		return PLATFORM_NODE_PARSING_FAILED;
+	}
+
+	// The memory nodes to assign to applications running on this cluster
+	if (!ReadAttribute(cgpath, CGFS_MEMS, prlb->mems) || prlb->mems.empty())
+		prlb->mems = "0";
+	cluster_mems[prlb->socket_id] = prlb->mems;
+
+	/**********************************************************************
+	 *    MEMORY Controller
+	 **********************************************************************/
+
+	if (!ReadAttribute(cgpath, CGFS_MEMB, value)) {
+		logger->Error("PLAT CGFS: Getting MEMORY attribute FAILED! "
+				"(Error: memory limit not configured or not readable)");
+		return PLATFORM_NODE_PARSING_FAILED;
+	}
+
+	// A not limited node (i.e. "max") is granted all the host memory
+	if (value.compare(0, 3, "max") == 0) {
+		prlb->amount_memb = sysconf(_SC_PHYS_PAGES);
+		prlb->amount_memb *= sysconf(_SC_PAGESIZE);
+	} else {
+		prlb->amount_memb = strtoull(value.c_str(), NULL, 10);
+	}
+
+	/**********************************************************************
+	 *    CPU Quota Controller
+	 **********************************************************************/
+
+	if (unlikely(!cfsQuotaSupported))
+		goto jump_quota_parsing;
+
+	if (!ReadAttribute(cgpath, CGFS_CPUQ, value)) {
+		logger->Warn("PLAT CGFS: Disabling CPU Quota management");
+		cfsQuotaSupported = false;
+		goto jump_quota_parsing;
+	}
+
+	// Check if a quota has been assigned (otherwise a "-1", or a "max" on
+	// the unified hierarchy, is expected)
+	if ((value[0] == '-') || (value[0] == 'm'))
+		goto jump_quota_parsing;
+
+	// On the unified hierarchy "cpu.max" reports both quota and period
+	if (cgfs_v2) {
+		sscanf(value.c_str(), "%" SCNu64 " %" SCNu64,
+				&prlb->amount_cpuq, &prlb->amount_cpup);
+		goto jump_quota_parsing;
+	}
+
+	prlb->amount_cpuq = strtoull(value.c_str(), NULL, 10);
+	if (!ReadAttribute(cgpath, CGFS_CPUP, value)) {
+		logger->Error("PLAT CGFS: Getting CPU attributes FAILED! "
+				"(Error: 'cpu.cfs_period_us' not configured "
+				"or not readable)");
+		return PLATFORM_NODE_PARSING_FAILED;
+	}
+	prlb->amount_cpup = strtoull(value.c_str(), NULL, 10);
+
+jump_quota_parsing:
+	// Here we jump, if CFS Quota management is not enabled on the target
+
+	logger->Debug("PLAT CGFS: Setup resources for Node [%d], "
+			"CPUs [%s], MEMs [%" PRIu64 " Bytes]",
+			prlb->socket_id, prlb->cpus.c_str(), prlb->amount_memb);
+
+	pp_result = RegisterClusterCPUs(prlb);
+	if (pp_result != OK)
+		return pp_result;
+
+	pp_result = RegisterClusterMEMs(prlb);
+	if (pp_result != OK)
+		return pp_result;
+
+	return RegisterClusterFreq(prlb);
+}
+
+const char*
+LinuxCGFSPP::_GetPlatformID() {
+	static const char linuxPlatformID[] = BBQUE_LINUXCGFS_PLATFORM_ID;
+	return linuxPlatformID;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_LoadPlatformData() {
+	std::string res_dir(CGroupDir(CGFS_CTRL_CPUSET, BBQUE_LINUXCGFS_RESOURCES));
+	ExitCode_t pp_result = OK;
+	struct dirent *entry;
+	DIR *dir;
+
+	logger->Info("PLAT CGFS: CGROUP based resources enumeration...");
+
+	// Lookup for a "bbque/res" cgroup
+	dir = opendir(res_dir.c_str());
+	if (!dir) {
+		logger->Error("PLAT CGFS: [%s] lookup FAILED! "
+				"(Error: No resources assignment)", res_dir.c_str());
+		return PLATFORM_ENUMERATION_FAILED;
+	}
+
+	// Scan all "nodeN" assignment
+	while ((pp_result == OK) && (entry = readdir(dir))) {
+		if (strncmp(BBQUE_LINUXCGFS_CLUSTER, entry->d_name,
+					STRLEN(BBQUE_LINUXCGFS_CLUSTER)))
+			continue;
+		pp_result = ParseNode(entry->d_name);
+	}
+
+	closedir(dir);
+	return pp_result;
+}
+
+/*******************************************************************************
+ *    Resources Mappign and Assigment to Applications
+ ******************************************************************************/
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
+		RViewToken_t rvt, RLinuxBindingsPtr_t prlb) {
+	std::map<unsigned short, std::string>::const_iterator mems_it;
+	br::ResourcePtrListIterator_t pres_it;
+	br::UsagesMap_t::iterator uit;
+	br::ResourcePtr_t pres;
+	br::UsagePtr_t pusage;
+	char buff[] = "65535,";
+	const char *pname;
+	uint64_t usage;
+
+	for (uit = pum->begin(); uit != pum->end(); ++uit) {
+		pname = ((*uit).first).c_str();
+		pusage = (*uit).second;
+
+		// Parse "cluster"
+		prlb->socket_id = br::ResourcePathUtils::GetID(pname, "cluster");
+
+		pres = pusage->GetFirstResource(pres_it);
+		for ( ; pres; pres = pusage->GetNextResource(pres_it)) {
+			usage = pres->ApplicationUsage(papp, rvt);
+
+			switch (pres->Name()[0]) {
+			case 'm':
+				prlb->amount_memb += usage;
+				break;
+			case 'p':
+				prlb->amount_cpus += usage;
+				snprintf(buff, sizeof(buff), "%d,",
+						br::ResourcePathUtils::GetID(pres->Name(), "pe"));
+				prlb->cpus.append(buff);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	// Clean-up trailing comma
+	if (!prlb->cpus.empty())
+		prlb->cpus.resize(prlb->cpus.length() - 1);
+
+	// Memory nodes of the assigned cluster
+	mems_it = cluster_mems.find(prlb->socket_id);
+	prlb->mems = (mems_it != cluster_mems.end()) ? mems_it->second : "0";
+
+	logger->Debug("PLAT CGFS: [%s] => {cpus [%s: %" PRIu64 " %], "
+			"mnode[%s: %" PRIu64 " Bytes]}",
+			papp->StrId(), prlb->cpus.c_str(), prlb->amount_cpus,
+			prlb->mems.c_str(), prlb->amount_memb);
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::BuildCGroup(CGroupDataPtr_t &pcgd) {
+	uint8_t ctrl;
+
+	logger->Notice("PLAT CGFS: Create kernel CGroup [%s]",
+			pcgd->cgpath.c_str());
+
+	pcgd->emulated = cgfs_emulated;
+	for (ctrl = 0; ctrl < CGFS_CTRL_COUNT; ++ctrl) {
+		pcgd->cgdir[ctrl] = CGroupDir((CGController_t)ctrl, pcgd->cgpath);
+		if (mkdir(pcgd->cgdir[ctrl].c_str(), 0755) && (errno != EEXIST)) {
+			logger->Error("PLAT CGFS: CGroup resource mapping FAILED "
+					"(Error: kernel cgroup [%s] creation [%d: %s])",
+					pcgd->cgdir[ctrl].c_str(), errno, strerror(errno));
+			return MAPPING_FAILED;
+		}
+	}
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::BuildSilosCG(CGroupDataPtr_t &pcgd) {
+	ExitCode_t result;
+
+	logger->Debug("PLAT CGFS: Building SILOS CGroup...");
+
+	// Build new CGroup data
+	pcgd = CGroupDataPtr_t(new CGroupData_t(BBQUE_LINUXCGFS_SILOS));
+	result = BuildCGroup(pcgd);
+	if (result != OK)
+		return result;
+
+	// Setting up silos (limited) resources, just to run the RTLib
+	result = WriteAttribute(pcgd, CGFS_CPUS, "0");
+	if (result != OK)
+		return result;
+	return WriteAttribute(pcgd, CGFS_MEMS, "0");
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::BuildPoolCG(CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	char cgpath[] = BBQUE_LINUXCGFS_POOL"4294967295";
+
+	snprintf(cgpath, sizeof(cgpath), BBQUE_LINUXCGFS_POOL"%u",
+			cg_pool_next++);
+	pool_ul.unlock();
+
+	// Build new CGroup data, not yet assigned to any application
+	pcgd = CGroupDataPtr_t(new CGroupData_t(cgpath));
+	return BuildCGroup(pcgd);
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::GetPoolCG(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	ExitCode_t result;
+
+	// Get a pre-built CGroup, if available
+	if (likely(!cg_pool.empty())) {
+		pcgd = cg_pool.front();
+		cg_pool.pop_front();
+		pool_ul.unlock();
+
+		mc.Count(metrics[PP_SETUP_POOL_HIT].mh);
+		pcgd->papp = papp;
+		logger->Debug("PLAT CGFS: [%s] => pooled CGroup [%s]",
+				papp->StrId(), pcgd->cgpath.c_str());
+		cg_pool_dfr.Schedule(
+				milliseconds(BBQUE_LINUXCGFS_POOL_REFILL_DELAY));
+		return OK;
+	}
+	pool_ul.unlock();
+	cg_pool_dfr.Schedule(milliseconds(BBQUE_LINUXCGFS_POOL_REFILL_DELAY));
+
+	// Otherwise, a new one must be built on demand
+	mc.Count(metrics[PP_SETUP_POOL_MISS].mh);
+	logger->Debug("PLAT CGFS: [%s] CGroups pool empty, building a new one",
+			papp->StrId());
+	result = BuildPoolCG(pcgd);
+	if (result != OK)
+		return result;
+	pcgd->papp = papp;
+
+	return OK;
+}
+
+void
+LinuxCGFSPP::RefillPool() {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	CGroupDataPtr_t pcgd;
+	ExitCode_t result;
+
+	while (cg_pool.size() < cg_pool_size) {
+		pool_ul.unlock();
+		result = BuildPoolCG(pcgd);
+		if (result != OK) {
+			logger->Warn("PLAT CGFS: CGroups pool refill FAILED");
+			return;
+		}
+		pool_ul.lock();
+
+		// The pool could have been filled by parked control groups
+		// meanwhile, thus the exceeding one is just released
+		if (cg_pool.size() >= cg_pool_size)
+			break;
+		cg_pool.push_back(pcgd);
+	}
+}
+
+bool
+LinuxCGFSPP::TaskInCGroup(app::AppPid_t pid, CGroupDataPtr_t const &pcgd) {
+	std::string procs;
+	const char *pos;
+	char *end;
+
+	if (!ReadAttribute(pcgd->cgpath, CGFS_PROCS_CPUSET, procs))
+		return false;
+
+	// One PID per line
+	for (pos = procs.c_str(); *pos; pos = end) {
+		if ((app::AppPid_t)strtoul(pos, &end, 10) == pid)
+			return true;
+		if (end == pos)
+			break;
+		while (*end == '\n')
+			++end;
+	}
+
+	return false;
+}
+
+void
+LinuxCGFSPP::ParkCGroup(CGroupDataPtr_t &pcgd) {
+	std::unique_lock<std::mutex> pool_ul(cg_pool_mtx);
+	ExitCode_t result;
+
+	// Exceeding control groups are just released
+	if (cg_pool.size() >= cg_pool_size)
+		return;
+	pool_ul.unlock();
+
+	// Move the application task, if still into this control group, into
+	// the silos, since a parked control group must not host any task. The
+	// PID could have been reused by another process in the meanwhile.
+	if (pcgd->papp && TaskInCGroup(pcgd->papp->Pid(), pcgd)) {
+		result = _ReclaimResources(pcgd->papp);
+		if (result != OK) {
+			logger->Warn("PLAT CGFS: [%s] CGroup parking FAILED",
+					pcgd->papp->StrId());
+			return;
+		}
+	}
+
+	// NOTE: the attributes values cache is kept, since it still matches
+	// the kernel CGroup configuration
+	logger->Debug("PLAT CGFS: Parking CGroup [%s]", pcgd->cgpath.c_str());
+	pcgd->papp.reset();
+	pcgd->mems.clear();
+	pcgd->rss_tmr.stop();
+
+	pool_ul.lock();
+	if (cg_pool.size() >= cg_pool_size)
+		return;
+	cg_pool.push_back(pcgd);
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::GetCGroupData(AppPtr_t papp, CGroupDataPtr_t &pcgd) {
+	ExitCode_t result;
+
+	// Loop-up for application control group data
+	pcgd = std::static_pointer_cast<CGroupData_t>(
+			papp->GetAttribute(PLAT_CGFS_ATTRIBUTE, "cgroup")
+		);
+	if (pcgd)
+		return OK;
+
+	// A new CGroupData must be setup for this app, getting it from the
+	// pool of pre-built ones (if enabled)
+	if (cg_pool_size) {
+		result = GetPoolCG(papp, pcgd);
+	} else {
+		pcgd = CGroupDataPtr_t(new CGroupData_t(papp));
+		result = BuildCGroup(pcgd);
+	}
+	if (result != OK)
+		return result;
+
+	// Keep track of this control group
+	papp->SetAttribute(pcgd);
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::MoveTask(CGroupDataPtr_t &pcgd, app::AppPid_t pid) {
+	char buff[] = "4294967295";
+	ExitCode_t result;
+
+	snprintf(buff, sizeof(buff), "%u", pid);
+
+	// NOTE: on a v1 hierarchy the task must be moved into each one of the
+	// controllers hierarchies, while the unified hierarchy exports just
+	// the cpuset one.
+	result = WriteAttribute(pcgd, CGFS_PROCS_CPUSET, buff);
+	if (result != OK)
+		return result;
+	result = WriteAttribute(pcgd, CGFS_PROCS_MEMORY, buff);
+	if (result != OK)
+		return result;
+	return WriteAttribute(pcgd, CGFS_PROCS_CPU, buff);
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
+		bool excl, bool move) {
+	char buff[] = "-9223372036854775807 9223372036854775807";
+	ExitCode_t result = OK;
+	int64_t cpus_quota = -1; // NOTE: use "-1" for no quota assignement
+	(void)excl;
+
+	/**********************************************************************
+	 *    CPUSET Controller
+	 **********************************************************************/
+
+	// Set the assigned CPUs
+	result = WriteAttribute(pcgd, CGFS_CPUS, prlb->cpus);
+	if (result != OK)
+		return result;
+
+	// Set the assigned memory NODE (only if we have at least one CPUS)
+	if (!prlb->cpus.empty()) {
+		// Let the kernel migrate pages on memory nodes update
+		if (pmm->Mode() == MemoryMigrator::MIGRATE_CGROUP) {
+			result = WriteAttribute(pcgd, CGFS_MMIG, "1");
+			if (result != OK)
+				return result;
+		}
+		result = WriteAttribute(pcgd, CGFS_MEMS, prlb->mems);
+		if (result != OK)
+			return result;
+	}
+
+	/**********************************************************************
+	 *    MEMORY Controller
+	 **********************************************************************/
+
+	// Set the assigned MEMORY amount (if any)
+	if (prlb->amount_memb)
+		snprintf(buff, sizeof(buff), "%" PRIu64, prlb->amount_memb);
+	else
+		snprintf(buff, sizeof(buff), "%s", cgfs_v2 ? "max" : "-1");
+	result = WriteAttribute(pcgd, CGFS_MEMB, buff);
+	if (result != OK)
+		return result;
+
+	/**********************************************************************
+	 *    CPU Quota Controller
+	 **********************************************************************/
+
+	if (unlikely(!cfsQuotaSupported))
+		goto jump_quota_management;
+
+	// NOTE: if a quota is NOT assigned we have amount_cpus="0", but this
+	// is not acceptable by the CFS controller, which requires a negative
+	// number (or "max") to remove any constraint.
+	if (prlb->amount_cpus)
+		cpus_quota = (BBQUE_LINUXCGFS_CPUP_DEFAULT / 100) *
+			prlb->amount_cpus;
+
+	if (cgfs_v2) {
+		if (cpus_quota < 0)
+			snprintf(buff, sizeof(buff), "max %d",
+					BBQUE_LINUXCGFS_CPUP_DEFAULT);
+		else
+			snprintf(buff, sizeof(buff), "%" PRId64 " %d",
+					cpus_quota, BBQUE_LINUXCGFS_CPUP_DEFAULT);
+	} else {
+		// Set the default CPU bandwidth period
+		result = WriteAttribute(pcgd, CGFS_CPUP,
+				STR(BBQUE_LINUXCGFS_CPUP_DEFAULT));
+		if (result != OK)
+			return result;
+		snprintf(buff, sizeof(buff), "%" PRId64, cpus_quota);
+	}
+	result = WriteAttribute(pcgd, CGFS_CPUQ, buff);
+	if (result != OK)
+		return result;
+
+jump_quota_management:
+	// Here we jump, if CFS Quota management is not enabled on the target
+
+	/* If a task has not beed assigned, we are done */
+	if (!move)
+		return OK;
+
+	/**********************************************************************
+	 *    CGroup Task Assignement
+	 **********************************************************************/
+	// NOTE: task assignement must be done AFTER CGroup configuration, to
+	// ensure all the controller have been properly setup to manage the
+	// task.
+
+	logger->Notice("PLAT CGFS: [%s] => "
+			"{cpu [%s: %" PRIu64 " %], mem[%d: %" PRIu64 " B]}",
+			pcgd->papp->StrId(),
+			prlb->cpus.c_str(), prlb->amount_cpus,
+			prlb->socket_id, prlb->amount_memb);
+
+	result = MoveTask(pcgd, pcgd->papp->Pid());
+	if (result != OK)
+		return result;
+
+	/**********************************************************************
+	 *    Memory Pages Migration
+	 **********************************************************************/
+
+	// Pages left on the memory nodes of the previous cluster are migrated
+	// in background (if required)
+	if (prlb->cpus.empty())
+		return OK;
+	pmm->Migrate(pcgd->papp->Pid(), pcgd->mems, prlb->mems);
+	pcgd->mems = prlb->mems;
+
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_Setup(AppPtr_t papp) {
+	RLinuxBindingsPtr_t prlb(new RLinuxBindings_t());
+	ExitCode_t result = OK;
+	CGroupDataPtr_t pcgd;
+
+	// Setup a new CGroup data for this application
+	result = GetCGroupData(papp, pcgd);
+	if (result != OK) {
+		logger->Error("PLAT CGFS: [%s] CGroup initialization FAILED "
+				"(Error: CGroupData setup)", papp->StrId());
+		return result;
+	}
+
+	// Setup the kernel CGroup with an empty resources assignement
+	SetupCGroup(pcgd, prlb, false, false);
+
+	// Reclaim application resource, thus moving this app into the silos
+	result = _ReclaimResources(papp);
+	if (result != OK) {
+		logger->Error("PLAT CGFS: [%s] CGroup initialization FAILED "
+				"(Error: failed moving app into silos)", papp->StrId());
+		return result;
+	}
+
+	return result;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_Release(AppPtr_t papp) {
+	CGroupDataPtr_t pcgd;
+
+	// Recycle the application control group into the pool
+	pcgd = std::static_pointer_cast<CGroupData_t>(
+			papp->GetAttribute(PLAT_CGFS_ATTRIBUTE, "cgroup")
+		);
+	if (pcgd && cg_pool_size)
+		ParkCGroup(pcgd);
+
+	// Release CGroup plugin data
+	// ... thus releasing the corresponding control group (if not parked)
+	papp->ClearAttribute(PLAT_CGFS_ATTRIBUTE);
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_ReclaimResources(AppPtr_t papp) {
+	std::unique_lock<std::mutex> silos_ul(silos_mtx);
+	ExitCode_t result;
+
+	logger->Notice("PLAT CGFS: [%s] => SILOS[%s]",
+			papp->StrId(), psilos->cgpath.c_str());
+
+	// Move this app into "silos" CGroup
+	result = MoveTask(psilos, papp->Pid());
+	if (result != OK) {
+		logger->Error("PLAT CGFS: CGroup resource claiming FAILED");
+		return result;
+	}
+
+	return OK;
+}
+
+uint64_t
+LinuxCGFSPP::_GetMemoryFootprint(AppPtr_t papp) {
+	CGroupDataPtr_t pcgd;
+	std::string path;
+
+	pcgd = std::static_pointer_cast<CGroupData_t>(
+			papp->GetAttribute(PLAT_CGFS_ATTRIBUTE, "cgroup")
+		);
+	if (!pcgd)
+		return 0;
+
+	// The footprint is sampled at most once per refresh period, since this
+	// could be queried for each scheduling alternative of an application
+	std::unique_lock<std::mutex> rss_ul(pcgd->rss_mtx);
+	if (pcgd->rss_tmr.Running() &&
+			(pcgd->rss_tmr.getElapsedTimeMs() < BBQUE_LINUXCGFS_RSS_PERIOD))
+		return pcgd->rss;
+
+	path = pcgd->cgdir[CGFS_CTRL_MEMORY] + "/memory.stat";
+	pcgd->rss = MemoryMigrator::ReadRSS(path);
+	pcgd->rss_tmr.start();
+
+	logger->Debug("PLAT CGFS: [%s] memory footprint [%" PRIu64 " Bytes]",
+			papp->StrId(), pcgd->rss);
+	return pcgd->rss;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_MapResources(AppPtr_t papp, UsagesMapPtr_t pum,
+		RViewToken_t rvt, bool excl) {
+	RLinuxBindingsPtr_t prlb(new RLinuxBindings_t());
+	CGroupDataPtr_t pcgd;
+	ExitCode_t result;
+
+	logger->Debug("PLAT CGFS: CGroup resource mapping START");
+
+	// Get a reference to the CGroup data
+	result = GetCGroupData(papp, pcgd);
+	if (result != OK)
+		return result;
+
+	result = GetResouceMapping(papp, pum, rvt, prlb);
+	if (result != OK) {
+		logger->Error("PLAT CGFS: binding parsing FAILED");
+		return MAPPING_FAILED;
+	}
+
+	// Configure the CGroup based on resource bindings
+	result = SetupCGroup(pcgd, prlb, excl, true);
+	if (result != OK) {
+		logger->Error("PLAT CGFS: [%s] CGroup setup FAILED",
+				papp->StrId());
+		return result;
+	}
+
+	logger->Debug("PLAT CGFS: CGroup resource mapping DONE!");
+	return OK;
+}
+
+LinuxCGFSPP::ExitCode_t
+LinuxCGFSPP::_MapClusterResources(RViewToken_t rvt) {
+	pcf->Actuate(rvt);
+	return OK;
+}
+
+} /* bbque */
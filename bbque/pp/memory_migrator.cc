@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/pp/memory_migrator.h"
+
+#include "bbque/utils/utility.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// The number of bits of each bitmask word
+#define BITS_PER_ULONG (8 * sizeof(unsigned long))
+
+namespace bbque {
+
+MemoryMigrator::MemoryMigrator(std::string const & _mode, uint32_t _period,
+		plugins::LoggerIF *_logger) :
+	logger(_logger),
+	mode(MIGRATE_NONE),
+	period(_period),
+	done(false) {
+
+	if (_mode.compare("cgroup") == 0)
+		mode = MIGRATE_CGROUP;
+	else if (_mode.compare("async") == 0)
+		mode = MIGRATE_ASYNC;
+	else if (_mode.compare("none") != 0)
+		logger->Warn("PLAT MIG: unknown migration mode [%s], "
+				"disabling pages migration", _mode.c_str());
+
+	logger->Info("PLAT MIG: memory pages migration mode [%s]",
+			(mode == MIGRATE_ASYNC) ? "async" :
+			(mode == MIGRATE_CGROUP) ? "cgroup" : "none");
+
+	// Spawn the background migration thread (only if required)
+	if (mode == MIGRATE_ASYNC)
+		migrator_thd = std::thread(&MemoryMigrator::Migrator, this);
+}
+
+MemoryMigrator::~MemoryMigrator() {
+	std::unique_lock<std::mutex> pending_ul(pending_mtx);
+
+	if (mode != MIGRATE_ASYNC)
+		return;
+
+	done = true;
+	pending_cv.notify_one();
+	pending_ul.unlock();
+
+	migrator_thd.join();
+}
+
+void MemoryMigrator::Migrate(pid_t pid, std::string const & from,
+		std::string const & to) {
+	std::unique_lock<std::mutex> pending_ul(pending_mtx);
+
+	if (mode != MIGRATE_ASYNC)
+		return;
+
+	// Nothing to migrate if the memory nodes are not changed
+	if (from.empty() || (from == to))
+		return;
+
+	// Coalesce requests for the same task, by keeping the original
+	// source nodes and updating the destination ones
+	std::map<pid_t, MigrationRequest_t>::iterator it(pending.find(pid));
+	if (it != pending.end()) {
+		logger->Debug("PLAT MIG: [%d] pending migration updated "
+				"{%s => %s}", pid, (*it).second.from.c_str(),
+				to.c_str());
+		(*it).second.to = to;
+		return;
+	}
+
+	logger->Debug("PLAT MIG: [%d] queuing migration {%s => %s}",
+			pid, from.c_str(), to.c_str());
+	MigrationRequest_t & req(pending[pid]);
+	req.from = from;
+	req.to   = to;
+	pending_cv.notify_one();
+}
+
+void MemoryMigrator::Migrator() {
+	std::unique_lock<std::mutex> pending_ul(pending_mtx);
+	MigrationRequest_t req;
+	pid_t pid;
+
+	// Set the module name
+	if (prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("mm"), 0, 0, 0) != 0) {
+		logger->Error("Set name FAILED! (Error: %s)\n", strerror(errno));
+	}
+
+	logger->Info("PLAT MIG: Migration thread STARTED");
+
+	while (!done) {
+
+		if (pending.empty()) {
+			pending_cv.wait(pending_ul);
+			continue;
+		}
+
+		// Get the next migration to serve
+		pid = (*pending.begin()).first;
+		req = (*pending.begin()).second;
+		pending.erase(pending.begin());
+		pending_ul.unlock();
+
+		DoMigrate(pid, req);
+
+		// Rate limiting, to bound the memory bandwidth used by
+		// back-to-back migrations
+		std::this_thread::sleep_for(std::chrono::milliseconds(period));
+		pending_ul.lock();
+	}
+
+	logger->Info("PLAT MIG: Migration thread ENDED");
+}
+
+void MemoryMigrator::DoMigrate(pid_t pid, MigrationRequest_t const & req) {
+	unsigned long from_mask[BBQUE_MEMMIG_NODES_MAX / BITS_PER_ULONG];
+	unsigned long to_mask[BBQUE_MEMMIG_NODES_MAX / BITS_PER_ULONG];
+	long result;
+
+	if (!ParseNodes(req.from.c_str(), from_mask) ||
+			!ParseNodes(req.to.c_str(), to_mask)) {
+		logger->Error("PLAT MIG: [%d] migration {%s => %s} FAILED "
+				"(Error: nodes parsing)", pid,
+				req.from.c_str(), req.to.c_str());
+		return;
+	}
+
+	// NOTE: the kernel expects the number of bits of the masks plus one
+	result = syscall(__NR_migrate_pages, pid, BBQUE_MEMMIG_NODES_MAX + 1,
+			from_mask, to_mask);
+	if (result < 0) {
+		// The task could be exited in the meanwhile
+		logger->Warn("PLAT MIG: [%d] migration {%s => %s} FAILED "
+				"(Error: %d - %s)", pid,
+				req.from.c_str(), req.to.c_str(),
+				errno, strerror(errno));
+		return;
+	}
+
+	logger->Info("PLAT MIG: [%d] migration {%s => %s} DONE "
+			"(%ld pages not moved)", pid,
+			req.from.c_str(), req.to.c_str(), result);
+}
+
+bool MemoryMigrator::ParseNodes(const char *list, unsigned long *mask) {
+	unsigned int first, last;
+	const char *p = list;
+	bool parsed = false;
+	char *end;
+
+	memset(mask, 0, BBQUE_MEMMIG_NODES_MAX / 8);
+
+	while (*p) {
+
+		// Get a node id, or the first node of a range
+		first = strtoul(p, &end, 10);
+		if (end == p)
+			return false;
+		last = first;
+		p = end;
+
+		// Get the last node of a range
+		if (*p == '-') {
+			++p;
+			last = strtoul(p, &end, 10);
+			if (end == p)
+				return false;
+			p = end;
+		}
+
+		for ( ; first <= last && first < BBQUE_MEMMIG_NODES_MAX; ++first) {
+			mask[first / BITS_PER_ULONG] |=
+				(1UL << (first % BITS_PER_ULONG));
+			parsed = true;
+		}
+
+		if (*p == ',')
+			++p;
+		else if (*p && *p != '\n')
+			return false;
+		else
+			break;
+	}
+
+	return parsed;
+}
+
+uint64_t MemoryMigrator::ReadRSS(std::string const & path) {
+	unsigned long long value;
+	uint64_t rss = 0;
+	char line[128];
+	FILE *fp;
+
+	fp = fopen(path.c_str(), "r");
+	if (!fp)
+		return 0;
+
+	// NOTE: v1 hierarchies report the "rss" (and the hierarchical
+	// "total_rss") while the unified hierarchy reports the "anon" memory
+	while (fgets(line, sizeof(line), fp)) {
+		if ((sscanf(line, "total_rss %llu", &value) == 1) ||
+				(sscanf(line, "anon %llu", &value) == 1)) {
+			rss = value;
+			break;
+		}
+		if (sscanf(line, "rss %llu", &value) == 1)
+			rss = value;
+	}
+
+	fclose(fp);
+	return rss;
+}
+
+} // namespace bbque
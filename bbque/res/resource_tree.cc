@@ -89,7 +89,7 @@ ResourcePtr_t & ResourceTree::insert(std::string const & _rsrc_path) {
 bool ResourceTree::find_node(ResourceNode_t * curr_node,
 		std::string const & rsrc_path,
 		SearchOption_t opt,
-		std::list<ResourcePtr_t> & matches) const {
+		ResourcePtrList_t & matches) const {
 
 	// Null node / empty children lsit check
 	if ((!curr_node) || (curr_node->children.empty()))
@@ -18,6 +18,8 @@
 #include "bbque/res/resources.h"
 #include "bbque/resource_accounter.h"
 
+#include <algorithm>
+
 #define MODULE_NAMESPACE "bq.re"
 
 namespace bbque { namespace res {
@@ -28,11 +30,13 @@ namespace bbque { namespace res {
 
 Resource::Resource(std::string const & nm):
 	name(nm),
-	total(1) {
+	total(1),
+	shared(false) {
 }
 
 Resource::Resource(std::string const & res_path, uint64_t tot):
-	total(tot) {
+	total(tot),
+	shared(false) {
 
 	// Extract the name from the path
 	size_t pos = res_path.find_last_of(".");
@@ -62,6 +66,10 @@ uint64_t Resource::Available(AppSPtr_t papp, RViewToken_t vtok) {
 		return total;
 	}
 
+	// A shared resource is never exhausted by the other applications
+	if (shared)
+		return total;
+
 	// Return the amount of available resource plus the amount currently
 	// used by the given application
 	if (papp)
@@ -125,6 +133,15 @@ uint64_t Resource::Acquire(AppSPtr_t const & papp, uint64_t amount,
 		state_views[vtok] = view;
 	}
 
+	// A shared resource is used as much as the highest amount required
+	if (shared) {
+		if (amount > total)
+			return 0;
+		view->used = std::max(view->used, amount);
+		view->apps[papp->Uid()] = amount;
+		return amount;
+	}
+
 	// Try to set the new "used" value
 	uint64_t fut_used = view->used + amount;
 	if (fut_used > total)
@@ -155,8 +172,18 @@ uint64_t Resource::Release(AppSPtr_t const & papp, RViewToken_t vtok) {
 
 	// Decrease the used value and remove the application
 	uint64_t used_by_app = lkp->second;
-	view->used -= used_by_app;
 	view->apps.erase(papp->Uid());
+	if (!shared) {
+		view->used -= used_by_app;
+		return used_by_app;
+	}
+
+	// A shared resource is used as much as the highest amount still
+	// required
+	view->used = 0;
+	for (AppUseQtyMap_t::iterator apps_it = view->apps.begin();
+			apps_it != view->apps.end(); ++apps_it)
+		view->used = std::max(view->used, apps_it->second);
 
 	// Return the amount of resource released
 	return used_by_app;
@@ -21,8 +21,9 @@
 namespace bbque { namespace res {
 
 
-Usage::Usage(uint64_t usage_value):
-	value(usage_value) {
+Usage::Usage(uint64_t usage_value, ResourcePtrListAlloc_t const & alloc):
+	value(usage_value),
+	bindings(alloc) {
 }
 
 Usage::~Usage() {
@@ -37,10 +38,10 @@ ResourcePtrList_t & Usage::GetBindingList() {
 	return bindings;
 }
 
-void Usage::SetBindingList(ResourcePtrList_t bind_list) {
+void Usage::SetBindingList(ResourcePtrList_t const & bind_list) {
 	bindings = bind_list;
-	first_bind = bind_list.begin();
-	last_bind = bind_list.end();
+	first_bind = bindings.begin();
+	last_bind = bindings.end();
 }
 
 bool Usage::EmptyBindingList() {
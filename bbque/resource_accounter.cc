@@ -42,10 +42,10 @@
 
 #define PRINT_NOTICE_IF_VERBOSE(verbose, text)\
 	if (verbose)\
-		logger->Notice(text);\
+		BBQUE_LOG_NOTICE("%s", text);\
 	else\
 		DB(\
-		logger->Debug(text);\
+		BBQUE_LOG_DEBUG("%s", text);\
 		);
 
 
@@ -92,19 +92,23 @@ void ResourceAccounter::PrintStatusReport(RViewToken_t vtok, bool verbose) const
 	char rsrc_text_row[66];
 	uint64_t rsrc_used;
 
+	// Non verbose reports are logged only at DEBUG level
+	if (!verbose && !BBQUE_LOG_ENABLED(DEBUG))
+		return;
+
 	// Print the head of the report table
 	if (verbose) {
-		logger->Info("Report on state view: %d", vtok);
-		logger->Notice(RP_DIV1);
-		logger->Notice(RP_HEAD);
-		logger->Notice(RP_DIV2);
+		BBQUE_LOG_INFO("Report on state view: %d", vtok);
+		BBQUE_LOG_NOTICE(RP_DIV1);
+		BBQUE_LOG_NOTICE(RP_HEAD);
+		BBQUE_LOG_NOTICE(RP_DIV2);
 	}
 	else {
 		DB(
-		logger->Debug("Report on state view: %d", vtok);
-		logger->Debug(RP_DIV1);
-		logger->Debug(RP_HEAD);
-		logger->Debug(RP_DIV2);
+		BBQUE_LOG_DEBUG("Report on state view: %d", vtok);
+		BBQUE_LOG_DEBUG(RP_DIV1);
+		BBQUE_LOG_DEBUG(RP_HEAD);
+		BBQUE_LOG_DEBUG(RP_DIV2);
 		);
 	}
 
@@ -231,7 +235,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::CheckAvailability(
 
 		// If the availability is less than the amount required...
 		if (avail < pusage->GetAmount()) {
-			logger->Debug("Check availability: Exceeding request for {%s}"
+			BBQUE_LOG_DEBUG("Check availability: Exceeding request for {%s}"
 					"[USG:%" PRIu64 " | AV:%" PRIu64 " | TOT:%" PRIu64 "] ",
 					rsrc_path.c_str(), pusage->GetAmount(), avail,
 					QueryStatus(pusage->GetBindingList(), RA_TOTAL));
@@ -257,7 +261,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::GetAppUsagesByView(
 	// "Alternate" state view
 	view_it = usages_per_views.find(vtok);
 	if (view_it == usages_per_views.end()) {
-		logger->Error("Application usages:"
+		BBQUE_LOG_ERROR("Application usages:"
 				"Cannot find the resource state view referenced by %d",	vtok);
 		return RA_ERR_MISS_VIEW;
 	}
@@ -274,25 +278,27 @@ ResourceAccounter::ExitCode_t ResourceAccounter::GetAppUsagesByView(
 ResourceAccounter::ExitCode_t ResourceAccounter::RegisterResource(
 		std::string const & _path,
 		std::string const & _units,
-		uint64_t _amount) {
+		uint64_t _amount,
+		bool _shared) {
 	std::string rsrc_type;
 
 	// Check arguments
 	if(_path.empty()) {
-		logger->Fatal("Registering: Invalid resource path");
+		BBQUE_LOG_FATAL("Registering: Invalid resource path");
 		return RA_ERR_MISS_PATH;
 	}
 
 	// Insert a new resource in the tree
 	ResourcePtr_t rsrc(resources.insert(_path));
 	if (!rsrc) {
-		logger->Crit("Registering: Unable to allocate a new resource"
+		BBQUE_LOG_CRIT("Registering: Unable to allocate a new resource"
 				"descriptor");
 		return RA_ERR_MEM;
 	}
 
 	// Set the amount of resource considering the units
 	rsrc->SetTotal(ConvertValue(_amount, _units));
+	rsrc->SetShared(_shared);
 
 	// Insert the path in the paths set
 	paths.insert(_path);
@@ -317,13 +323,13 @@ ResourceAccounter::ExitCode_t ResourceAccounter::BookResources(
 
 	// Check to avoid null pointer segmentation fault
 	if (!papp) {
-		logger->Fatal("Booking: Null pointer to the application descriptor");
+		BBQUE_LOG_FATAL("Booking: Null pointer to the application descriptor");
 		return RA_ERR_MISS_APP;
 	}
 
 	// Check that the set of resource usages is not null
 	if ((!rsrc_usages) || (rsrc_usages->empty())) {
-		logger->Fatal("Booking: Empty resource usages set");
+		BBQUE_LOG_FATAL("Booking: Empty resource usages set");
 		return RA_ERR_MISS_USAGES;
 	}
 
@@ -332,14 +338,14 @@ ResourceAccounter::ExitCode_t ResourceAccounter::BookResources(
 	// valid.
 	AppUsagesMapPtr_t apps_usages;
 	if (GetAppUsagesByView(vtok, apps_usages) == RA_ERR_MISS_VIEW) {
-		logger->Fatal("Booking: Invalid resource state view token");
+		BBQUE_LOG_FATAL("Booking: Invalid resource state view token");
 		return RA_ERR_MISS_VIEW;
 	}
 
 	// Each application can hold just one resource usages set
 	AppUsagesMap_t::iterator usemap_it(apps_usages->find(papp->Uid()));
 	if (usemap_it != apps_usages->end()) {
-		logger->Warn("Booking: [%s] currently using a resource set yet",
+		BBQUE_LOG_WARN("Booking: [%s] currently using a resource set yet",
 				papp->StrId());
 		return RA_ERR_APP_USAGES;
 	}
@@ -347,7 +353,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::BookResources(
 	// Check resource availability (if this is not a sync session)
 	if ((do_check) && !(Synching())) {
 		if (CheckAvailability(rsrc_usages, vtok) == RA_ERR_USAGE_EXC) {
-			logger->Debug("Booking: Cannot allocate the resource set");
+			BBQUE_LOG_DEBUG("Booking: Cannot allocate the resource set");
 			return RA_ERR_USAGE_EXC;
 		}
 	}
@@ -357,7 +363,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::BookResources(
 	IncBookingCounts(rsrc_usages, papp, vtok);
 	apps_usages->insert(std::pair<AppUid_t, UsagesMapPtr_t>(papp->Uid(),
 				rsrc_usages));
-	logger->Debug("Booking: [%s] now holds %d resources", papp->StrId(),
+	BBQUE_LOG_DEBUG("Booking: [%s] now holds %d resources", papp->StrId(),
 			rsrc_usages->size());
 
 	return RA_SUCCESS;
@@ -368,7 +374,7 @@ void ResourceAccounter::ReleaseResources(AppSPtr_t papp, RViewToken_t vtok) {
 
 	// Sanity check
 	if (!papp) {
-		logger->Fatal("Release: Null pointer to the application descriptor");
+		BBQUE_LOG_FATAL("Release: Null pointer to the application descriptor");
 		return;
 	}
 
@@ -376,14 +382,14 @@ void ResourceAccounter::ReleaseResources(AppSPtr_t papp, RViewToken_t vtok) {
 	// referenced by 'vtok'
 	AppUsagesMapPtr_t apps_usages;
 	if (GetAppUsagesByView(vtok, apps_usages) == RA_ERR_MISS_VIEW) {
-		logger->Fatal("Release: Resource view unavailable");
+		BBQUE_LOG_FATAL("Release: Resource view unavailable");
 		return;
 	}
 
 	// Get the map of resource usages of the application
 	AppUsagesMap_t::iterator usemap_it(apps_usages->find(papp->Uid()));
 	if (usemap_it == apps_usages->end()) {
-		logger->Fatal("Release: Application referenced misses a resource set."
+		BBQUE_LOG_FATAL("Release: Application referenced misses a resource set."
 				" Possible data corruption occurred.");
 		return;
 	}
@@ -391,7 +397,7 @@ void ResourceAccounter::ReleaseResources(AppSPtr_t papp, RViewToken_t vtok) {
 	// Decrement resources counts and remove the usages map
 	DecBookingCounts(usemap_it->second, papp, vtok);
 	apps_usages->erase(papp->Uid());
-	logger->Debug("Release: [%s] resource release terminated", papp->StrId());
+	BBQUE_LOG_DEBUG("Release: [%s] resource release terminated", papp->StrId());
 }
 
 /************************************************************************
@@ -405,13 +411,13 @@ ResourceAccounter::ExitCode_t ResourceAccounter::GetView(
 
 	// Null-string check
 	if (req_path.empty()) {
-		logger->Error("GetView: Missing a valid string");
+		BBQUE_LOG_ERROR("GetView: Missing a valid string");
 		return RA_ERR_MISS_PATH;
 	}
 
 	// Token
 	token = std::hash<std::string>()(req_path);
-	logger->Debug("GetView: New resource state view. Token = %d", token);
+	BBQUE_LOG_DEBUG("GetView: New resource state view. Token = %d", token);
 
 	// Allocate a new view for the applications resource usages
 	usages_per_views.insert(std::pair<RViewToken_t, AppUsagesMapPtr_t>(token,
@@ -429,14 +435,14 @@ void ResourceAccounter::PutView(RViewToken_t vtok) {
 
 	// Do nothing if the token references the system state view
 	if (vtok == sys_view_token) {
-		logger->Warn("PutView: Cannot release the system resources view");
+		BBQUE_LOG_WARN("PutView: Cannot release the system resources view");
 		return;
 	}
 
 	// Get the resource set using the referenced view
 	ResourceViewsMap_t::iterator rviews_it(rsrc_per_views.find(vtok));
 	if (rviews_it == rsrc_per_views.end()) {
-		logger->Error("PutView: Cannot find resource view token %d", vtok);
+		BBQUE_LOG_ERROR("PutView: Cannot find resource view token %d", vtok);
 		return;
 	}
 
@@ -451,8 +457,8 @@ void ResourceAccounter::PutView(RViewToken_t vtok) {
 	usages_per_views.erase(vtok);
 	rsrc_per_views.erase(vtok);
 
-	logger->Debug("PutView: view %d cleared", vtok);
-	logger->Debug("PutView: %d resource set and %d usages per view currently managed",
+	BBQUE_LOG_DEBUG("PutView: view %d cleared", vtok);
+	BBQUE_LOG_DEBUG("PutView: %d resource set and %d usages per view currently managed",
 			rsrc_per_views.size(), usages_per_views.erase(vtok));
 }
 
@@ -462,7 +468,7 @@ RViewToken_t ResourceAccounter::SetView(RViewToken_t vtok) {
 
 	// Do nothing if the token references the system state view
 	if (vtok == sys_view_token) {
-		logger->Debug("SetView: View %d is already the system state!", vtok);
+		BBQUE_LOG_DEBUG("SetView: View %d is already the system state!", vtok);
 		return sys_view_token;
 	}
 
@@ -470,7 +476,7 @@ RViewToken_t ResourceAccounter::SetView(RViewToken_t vtok) {
 	// usages of this view and point to
 	AppUsagesViewsMap_t::iterator us_view_it(usages_per_views.find(vtok));
 	if (us_view_it == usages_per_views.end()) {
-		logger->Fatal("SetView: View %d unknown", vtok);
+		BBQUE_LOG_FATAL("SetView: View %d unknown", vtok);
 		return sys_view_token;
 	}
 
@@ -485,9 +491,9 @@ RViewToken_t ResourceAccounter::SetView(RViewToken_t vtok) {
 	// Put the old view
 	PutView(old_sys_vtok);
 
-	logger->Info("SetView: View %d is the new system state view.",
+	BBQUE_LOG_INFO("SetView: View %d is the new system state view.",
 			sys_view_token);
-	logger->Debug("SetView: %d resource set and %d usages per view currently managed",
+	BBQUE_LOG_DEBUG("SetView: %d resource set and %d usages per view currently managed",
 			rsrc_per_views.size(), usages_per_views.erase(vtok));
 
 	return sys_view_token;
@@ -502,17 +508,17 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncStart() {
 	ResourceAccounter::ExitCode_t result;
 	char tk_path[TOKEN_PATH_MAX_LEN];
 	std::unique_lock<std::mutex> sync_ul(sync_ssn.mtx);
-	logger->Info("SyncMode: Start");
+	BBQUE_LOG_INFO("SyncMode: Start");
 
 	// If the counter has reached the maximum, reset
 	if (sync_ssn.count == std::numeric_limits<uint32_t>::max()) {
-		logger->Debug("SyncMode: Session counter reset");
+		BBQUE_LOG_DEBUG("SyncMode: Session counter reset");
 		sync_ssn.count = 0;
 	}
 
 	// Build the path for getting the resource view token
 	snprintf(tk_path, TOKEN_PATH_MAX_LEN, SYNC_RVIEW_PATH"%d", ++sync_ssn.count);
-	logger->Debug("SyncMode [%d]: Requiring resource state view for %s",
+	BBQUE_LOG_DEBUG("SyncMode [%d]: Requiring resource state view for %s",
 			sync_ssn.count,	tk_path);
 
 	// Synchronization has started
@@ -522,12 +528,12 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncStart() {
 	// Get a resource state view for the synchronization
 	result = GetView(tk_path, sync_ssn.view);
 	if (result != RA_SUCCESS) {
-		logger->Fatal("SyncMode [%d]: Cannot get a resource state view",
+		BBQUE_LOG_FATAL("SyncMode [%d]: Cannot get a resource state view",
 				sync_ssn.count);
 		SyncFinalize();
 		return RA_ERR_SYNC_VIEW;
 	}
-	logger->Debug("SyncMode [%d]: Resource state view token = %d",
+	BBQUE_LOG_DEBUG("SyncMode [%d]: Resource state view token = %d",
 			sync_ssn.count,	sync_ssn.view);
 
 	// Init the view with the resource accounting of running applications
@@ -543,14 +549,14 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncInit() {
 	papp = am.GetFirst(ApplicationStatusIF::RUNNING, apps_it);
 	for ( ; papp; papp = am.GetNext(ApplicationStatusIF::RUNNING, apps_it)) {
 
-		logger->Info("SyncInit: [%s] current AWM: %d", papp->StrId(),
+		BBQUE_LOG_INFO("SyncInit: [%s] current AWM: %d", papp->StrId(),
 				papp->CurrentAWM()->Id());
 
 		// Re-acquire the resources (these should not have a "Next AWM"!)
 		result = BookResources(papp, papp->CurrentAWM()->GetResourceBinding(),
 				sync_ssn.view, false);
 		if (result != RA_SUCCESS) {
-			logger->Fatal("SyncInit [%d]: Resource booking failed for %s."
+			BBQUE_LOG_FATAL("SyncInit [%d]: Resource booking failed for %s."
 					" Aborting sync session...", sync_ssn.count, papp->StrId());
 
 			SyncAbort();
@@ -558,7 +564,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncInit() {
 		}
 	}
 
-	logger->Info("SyncMode [%d]: Initialization finished", sync_ssn.count);
+	BBQUE_LOG_INFO("SyncMode [%d]: Initialization finished", sync_ssn.count);
 	return RA_SUCCESS;
 }
 
@@ -566,7 +572,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncAcquireResources(
 		AppSPtr_t const & papp) {
 	// Check next AWM
 	if (!papp->NextAWM()) {
-		logger->Fatal("SyncMode [%d]: [%s] missing the next AWM",
+		BBQUE_LOG_FATAL("SyncMode [%d]: [%s] missing the next AWM",
 				sync_ssn.count, papp->StrId());
 		return RA_ERR_MISS_AWM;
 	}
@@ -576,7 +582,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncAcquireResources(
 
 	// Check that we are in a synchronized session
 	if (!Synching()) {
-		logger->Error("SyncMode [%d]: Session not open", sync_ssn.count);
+		BBQUE_LOG_ERROR("SyncMode [%d]: Session not open", sync_ssn.count);
 		return RA_ERR_SYNC_START;
 	}
 
@@ -587,7 +593,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncAcquireResources(
 void ResourceAccounter::SyncAbort() {
 	PutView(sync_ssn.view);
 	SyncFinalize();
-	logger->Error("SyncMode [%d]: Session aborted", sync_ssn.count);
+	BBQUE_LOG_ERROR("SyncMode [%d]: Session aborted", sync_ssn.count);
 }
 
 ResourceAccounter::ExitCode_t ResourceAccounter::SyncCommit() {
@@ -597,7 +603,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncCommit() {
 	// Set the synchronization view as the new system one
 	view = SetView(sync_ssn.view);
 	if (view != sync_ssn.view) {
-		logger->Fatal("SyncMode [%d]: Unable to set the new system resource"
+		BBQUE_LOG_FATAL("SyncMode [%d]: Unable to set the new system resource"
 				"state view", sync_ssn.count);
 		result = RA_ERR_SYNC_VIEW;
 	}
@@ -605,7 +611,7 @@ ResourceAccounter::ExitCode_t ResourceAccounter::SyncCommit() {
 	// Release the last scheduled view, by setting it to the system view
 	if (result == RA_SUCCESS) {
 		SetScheduledView(sys_view_token);
-		logger->Info("SyncMode [%d]: Session committed", sync_ssn.count);
+		BBQUE_LOG_INFO("SyncMode [%d]: Session committed", sync_ssn.count);
 	}
 
 	// Finalize the synchronization
@@ -633,13 +639,13 @@ void ResourceAccounter::IncBookingCounts(
 		// Current required resource (Usage object)
 		std::string const & rsrc_path(usages_it->first);
 		UsagePtr_t pusage(usages_it->second);
-		logger->Debug("Booking: [%s] requires resource {%s}",
+		BBQUE_LOG_DEBUG("Booking: [%s] requires resource {%s}",
 				papp->StrId(), rsrc_path.c_str());
 
 		// Do booking for the current resource request
 		result = DoResourceBooking(papp, pusage, vtok);
 		if (result != RA_SUCCESS)  {
-			logger->Crit("Booking: unexpected fail! %s "
+			BBQUE_LOG_CRIT("Booking: unexpected fail! %s "
 					"[USG:%" PRIu64 " | AV:%" PRIu64 " | TOT:%" PRIu64 "]",
 				rsrc_path.c_str(), pusage->GetAmount(),
 				Available(rsrc_path, vtok, papp),
@@ -650,7 +656,7 @@ void ResourceAccounter::IncBookingCounts(
 		}
 
 		assert(result == RA_SUCCESS);
-		logger->Info("Booking: SUCCESS - %s [USG:%" PRIu64 " | AV:%" PRIu64 " | TOT:%" PRIu64 "]",
+		BBQUE_LOG_INFO("Booking: SUCCESS - %s [USG:%" PRIu64 " | AV:%" PRIu64 " | TOT:%" PRIu64 "]",
 				rsrc_path.c_str(), pusage->GetAmount(),
 				Available(rsrc_path, vtok, papp),
 				Total(rsrc_path));
@@ -738,7 +744,7 @@ bool ResourceAccounter::IsReshuffling(
 		presc = puc->GetFirstResource(presc_it);
 		presa = pua->GetFirstResource(presa_it);
 		while (presc && presa) {
-			logger->Debug("Checking: curr [%s:%d] vs next [%s:%d]",
+			BBQUE_LOG_DEBUG("Checking: curr [%s:%d] vs next [%s:%d]",
 				presc->Name().c_str(),
 				presc->ApplicationUsage(
 					puc->own_app, 0),
@@ -749,7 +755,7 @@ bool ResourceAccounter::IsReshuffling(
 			if (presc->ApplicationUsage(puc->own_app, 0) !=
 				presc->ApplicationUsage(puc->own_app,
 					pua->view_tk)) {
-				logger->Debug("AWM Shuffling detected");
+				BBQUE_LOG_DEBUG("AWM Shuffling detected");
 				return true;
 			}
 			// Check next resource
@@ -777,7 +783,7 @@ inline void ResourceAccounter::SchedResourceBooking(
 	else
 		requested -= rsrc->Acquire(papp, available, vtok);
 
-	logger->Debug("DRBooking (sched): [%s] scheduled to use {%s}",
+	BBQUE_LOG_DEBUG("DRBooking (sched): [%s] scheduled to use {%s}",
 			papp->StrId(), rsrc->Name().c_str());
 }
 
@@ -788,7 +794,7 @@ inline void ResourceAccounter::SyncResourceBooking(
 	// Skip the resource binding if the not assigned by the scheduler
 	uint64_t sched_usage = rsrc->ApplicationUsage(papp, sch_view_token);
 	if (sched_usage == 0) {
-		logger->Debug("DRBooking (sync): no usage of {%s} scheduled for [%s]",
+		BBQUE_LOG_DEBUG("DRBooking (sync): no usage of {%s} scheduled for [%s]",
 				rsrc->Name().c_str(), papp->StrId());
 		return;
 	}
@@ -796,7 +802,7 @@ inline void ResourceAccounter::SyncResourceBooking(
 	// Acquire the resource according to the amount assigned by the
 	// scheduler
 	requested -= rsrc->Acquire(papp, sched_usage, sync_ssn.view);
-	logger->Debug("DRBooking (sync): %s acquires %s (%d left)",
+	BBQUE_LOG_DEBUG("DRBooking (sync): %s acquires %s (%d left)",
 			papp->StrId(), rsrc->Name().c_str(), requested);
 }
 
@@ -807,7 +813,7 @@ void ResourceAccounter::DecBookingCounts(
 	// Maps of resource usages per Application/EXC
 	UsagesMap_t::const_iterator usages_it(app_usages->begin());
 	UsagesMap_t::const_iterator usages_end(app_usages->end());
-	logger->Debug("DecCount: [%s] holds %d resources", papp->StrId(),
+	BBQUE_LOG_DEBUG("DecCount: [%s] holds %d resources", papp->StrId(),
 			app_usages->size());
 
 	// Release the all the resources hold by the Application/EXC
@@ -817,7 +823,7 @@ void ResourceAccounter::DecBookingCounts(
 
 		// Release the resources bound to the current request
 		UndoResourceBooking(papp, pusage, vtok);
-		logger->Debug("DecCount: [%s] has freed {%s} of %" PRIu64,
+		BBQUE_LOG_DEBUG("DecCount: [%s] has freed {%s} of %" PRIu64,
 				papp->StrId(), rsrc_path.c_str(), pusage->GetAmount());
 	}
 }
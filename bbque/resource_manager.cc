@@ -25,6 +25,7 @@
 #include "bbque/signals_manager.h"
 #include "bbque/application_manager.h"
 
+#include "bbque/utils/trace.h"
 #include "bbque/utils/utility.h"
 
 #define RESOURCE_MANAGER_NAMESPACE "bq.rm"
@@ -139,6 +140,7 @@ ResourceManager::ResourceManager() :
 	ra(ResourceAccounter::GetInstance()),
 	mc(MetricsCollector::GetInstance()),
 	pp(PlatformProxy::GetInstance()),
+	me(MetricsExporter::GetInstance()),
 	optimize_dfr("rm.opt", std::bind(&ResourceManager::Optimize, this)) {
 
 	//---------- Setup all the module metrics
@@ -189,8 +191,10 @@ ResourceManager::Setup() {
 	}
 
 	//---------- Start bbque services
+	am.StartRecipesPrefetch();
 	ap.Start();
 	pp.Start();
+	me.Start();
 	optimize_dfr.SetPeriodic(milliseconds(opt_interval));
 
 	return OK;
@@ -236,7 +240,9 @@ void ResourceManager::Optimize() {
 	//--- Scheduling
 	logger->Notice(LNSCHB);
 	optimization_tmr.start();
+	BBQUE_TRACE_BEGIN(RM, "rm.schedule", 0);
 	schedResult = sm.Schedule();
+	BBQUE_TRACE_END(RM, "rm.schedule", 0);
 	optimization_tmr.stop();
 	switch(schedResult) {
 	case SchedulerManager::MISSING_POLICY:
@@ -272,8 +278,19 @@ void ResourceManager::Optimize() {
 	//--- Synchroniztion
 	logger->Notice(LNSYNB);
 	optimization_tmr.start();
+	BBQUE_TRACE_BEGIN(RM, "rm.sync", 0);
 	syncResult = ym.SyncSchedule();
+	BBQUE_TRACE_END(RM, "rm.sync", 0);
 	optimization_tmr.stop();
+	if (syncResult == SynchronizationManager::PLATFORM_SYNC_FAILED) {
+		// The EXCs which resources mapping failed have been aborted,
+		// thus a new optimization is required to schedule them again
+		logger->Warn(LNSYNF);
+		RM_COUNT_EVENT(metrics, RM_SYNCH_FAILED);
+		pendingEvts_ul.unlock();
+		NotifyEvent(BBQ_OPTS);
+		return;
+	}
 	if (syncResult != SynchronizationManager::OK) {
 		logger->Warn(LNSYNF);
 		RM_COUNT_EVENT(metrics, RM_SYNCH_FAILED);
@@ -291,7 +308,9 @@ sched_profile:
 	//--- Profiling
 	logger->Notice(LNPROB);
 	optimization_tmr.start();
+	BBQUE_TRACE_BEGIN(RM, "rm.profile", 0);
 	profResult = om.ProfileSchedule();
+	BBQUE_TRACE_END(RM, "rm.profile", 0);
 	optimization_tmr.stop();
 	if (profResult != ProfileManager::OK) {
 		logger->Warn("Scheduler profiling FAILED");
@@ -426,6 +445,7 @@ void ResourceManager::EvtBbqUsr2() {
 
 	logger->Debug("Dumping metrics collection...");
 	mc.DumpMetrics();
+	BBQUE_TRACE_DUMP();
 
 	// Clear the corresponding event flag
 	pendingEvts.reset(BBQ_USR2);
@@ -476,6 +496,7 @@ void ResourceManager::ControlLoop() {
 
 		// Account for a new event
 		RM_COUNT_EVENT(metrics, RM_EVT_TOTAL);
+		BBQUE_TRACE_INSTANT(RM, "rm.event", evt-1, 0);
 		RM_GET_PERIOD(metrics, RM_EVT_PERIOD, period);
 
 		// Dispatching events to handlers
@@ -42,6 +42,10 @@
 #define SM_SAMPLE_METRIC(NAME, DESC)\
  {SCHEDULER_MANAGER_NAMESPACE "." NAME, DESC, \
 	 MetricsCollector::SAMPLE, 0, NULL, 0}
+/** Metrics (class HISTOGRAM) declaration */
+#define SM_HISTOGRAM_METRIC(NAME, DESC)\
+ {SCHEDULER_MANAGER_NAMESPACE "." NAME, DESC, \
+	 MetricsCollector::HISTOGRAM, 0, NULL, 0}
 /** Reset the timer used to evaluate metrics */
 #define SM_RESET_TIMING(TIMER) \
 	TIMER.start();
@@ -71,7 +75,7 @@ SchedulerManager::metrics[SM_METRICS_COUNT] = {
 	SM_COUNTER_METRIC("migrec",	"MIGREC count"),
 	SM_COUNTER_METRIC("block",	"BLOCK count"),
 	//----- Timing metrics
-	SM_SAMPLE_METRIC("time",	"Scheduler execution t[ms]"),
+	SM_HISTOGRAM_METRIC("time",	"Scheduler execution t[ms]"),
 	SM_SAMPLE_METRIC("period",	"Scheduler activation period t[ms]"),
 	//----- Couting statistics
 	SM_SAMPLE_METRIC("avg.start",	"Avg START per schedule"),
@@ -79,6 +83,9 @@ SchedulerManager::metrics[SM_METRICS_COUNT] = {
 	SM_SAMPLE_METRIC("avg.migrec",	"Avg MIGREC per schedule"),
 	SM_SAMPLE_METRIC("avg.migrate",	"Avg MIGRATE per schedule"),
 	SM_SAMPLE_METRIC("avg.block",	"Avg BLOCK per schedule"),
+	//----- Scheduling arena statistics
+	SM_SAMPLE_METRIC("arena.allocs","Arena allocations per schedule"),
+	SM_SAMPLE_METRIC("arena.used",	"Arena memory [kB] per schedule"),
 
 };
 
@@ -102,7 +109,7 @@ SchedulerManager::SchedulerManager() :
 		assert(logger);
 	}
 
-	logger->Debug("Starting resource scheduler...");
+	BBQUE_LOG_DEBUG("Starting resource scheduler...");
 
 	//---------- Loading module configuration
 	ConfigurationManager & cm = ConfigurationManager::GetInstance();
@@ -118,12 +125,12 @@ SchedulerManager::SchedulerManager() :
 
 	//---------- Load the required optimization plugin
 	std::string opt_namespace(SCHEDULER_POLICY_NAMESPACE".");
-	logger->Debug("Loading optimization policy [%s%s]...",
+	BBQUE_LOG_DEBUG("Loading optimization policy [%s%s]...",
 			opt_namespace.c_str(), opt_policy.c_str());
 	policy = ModulesFactory::GetSchedulerPolicyModule(
 			opt_namespace + opt_policy);
 	if (!policy) {
-		logger->Fatal("Optimization policy load FAILED "
+		BBQUE_LOG_FATAL("Optimization policy load FAILED "
 			"(Error: missing plugin for [%s%s])",
 			opt_namespace.c_str(), opt_policy.c_str());
 		assert(policy);
@@ -153,6 +160,11 @@ SchedulerManager::CollectStats() {
 	SM_COLLECT_STATS(MIGRATE);
 	SM_COLLECT_STATS(BLOCKED);
 
+	// Account for the temporaries of the scheduling policy
+	SM_ADD_SCHED(metrics, SM_SCHED_ARENA_ALLOCS,
+			(double)SchedArena().Allocations());
+	SM_ADD_SCHED(metrics, SM_SCHED_ARENA_USED,
+			(double)SchedArena().Used() / 1024);
 }
 
 SchedulerManager::ExitCode_t
@@ -163,7 +175,7 @@ SchedulerManager::Schedule() {
 	RViewToken_t svt;
 
 	if (!policy) {
-		logger->Crit("Resource scheduling FAILED (Error: missing policy)");
+		BBQUE_LOG_CRIT("Resource scheduling FAILED (Error: missing policy)");
 		assert(policy);
 		return MISSING_POLICY;
 	}
@@ -177,10 +189,10 @@ SchedulerManager::Schedule() {
 	// stability problems and scheduling overheads.
 	// In case of a scheduling is not considered safe proper at this time,
 	// a DELAYED exit code should be returned
-	DB(logger->Warn("TODO: add scheduling activation policy"));
+	DB(BBQUE_LOG_WARN("TODO: add scheduling activation policy"));
 
 	++sched_count;
-	logger->Notice("Scheduling [%d] START, policy [%s]",
+	BBQUE_LOG_NOTICE("Scheduling [%d] START, policy [%s]",
 			sched_count,
 			policy->Name());
 
@@ -194,9 +206,12 @@ SchedulerManager::Schedule() {
 	// Reset timer for schedule execution time collection
 	SM_RESET_TIMING(sm_tmr);
 
+	// Release the temporaries of the previous scheduling run
+	SchedArena().Reset();
+
 	result = policy->Schedule(sv, svt);
 	if (result != SchedulerPolicyIF::SCHED_DONE) {
-		logger->Error("Scheduling [%d] FAILED", sched_count);
+		BBQUE_LOG_ERROR("Scheduling [%d] FAILED", sched_count);
 		return FAILED;
 	}
 
@@ -218,11 +233,16 @@ SchedulerManager::Schedule() {
 	// Collect statistics on scheduling decisions
 	CollectStats();
 
-	logger->Notice("Scheduling [%d] DONE", sched_count);
+	BBQUE_LOG_NOTICE("Scheduling [%d] DONE", sched_count);
 
 	return DONE;
 }
 
+Arena & SchedulerManager::SchedArena() {
+	static Arena sched_arena;
+	return sched_arena;
+}
+
 void SchedulerManager::ClearRunningApps() {
 	AppsUidMapIt apps_it;
 	AppPtr_t papp;
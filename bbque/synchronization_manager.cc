@@ -27,6 +27,7 @@
 #include "bbque/app/application.h"
 #include "bbque/app/working_mode.h"
 
+#include "bbque/utils/trace.h"
 #include "bbque/utils/utility.h"
 
 // The prefix for configuration file attributes
@@ -57,11 +58,18 @@
 #define SM_ADD_SAMPLE(METRICS, INDEX, COUNT) \
 	mc.AddSample(METRICS[INDEX].mh, COUNT);
 
-/** SyncState Metrics (class SAMPLE) declaration */
-#define SM_SAMPLE_METRIC_SYNCSTATE(NAME, DESC)\
- {SYNCHRONIZATION_MANAGER_NAMESPACE "." NAME, DESC, MetricsCollector::SAMPLE, \
+/** Metrics (class HISTOGRAM) declaration */
+#define SM_HISTOGRAM_METRIC(NAME, DESC)\
+ {SYNCHRONIZATION_MANAGER_NAMESPACE "." NAME, DESC, \
+	 MetricsCollector::HISTOGRAM, 0, NULL, 0}
+
+/** SyncState Metrics (class HISTOGRAM) declaration */
+#define SM_HISTOGRAM_METRIC_SYNCSTATE(NAME, DESC)\
+ {SYNCHRONIZATION_MANAGER_NAMESPACE "." NAME, DESC, \
+	 MetricsCollector::HISTOGRAM, \
 	 bbque::app::ApplicationStatusIF::SYNC_STATE_COUNT, \
 	 bbque::app::ApplicationStatusIF::syncStateStr, 0}
+
 /** Acquire a new completion time sample for SyncState Metrics*/
 #define SM_GET_TIMING_SYNCSTATE(METRICS, INDEX, TIMER, STATE) \
 	mc.AddSample(METRICS[INDEX].mh, TIMER.getElapsedTimeMs(), STATE);
@@ -83,16 +91,16 @@ SynchronizationManager::metrics[SM_METRICS_COUNT] = {
 	SM_COUNTER_METRIC("sync_hit",  "Syncs HIT count"),
 	SM_COUNTER_METRIC("sync_miss", "Syncs MISS count"),
 	//----- Timing metrics
-	SM_SAMPLE_METRIC("sp.a.time",  "Avg SyncP execution t[ms]"),
-	SM_SAMPLE_METRIC("sp.a.lat",   " Pre-Sync Lat   t[ms]"),
-	SM_SAMPLE_METRIC_SYNCSTATE("sp.a.pre",   " PreChange  exe t[ms]"),
-	SM_SAMPLE_METRIC_SYNCSTATE("sp.a.sync",  " SyncChange exe t[ms]"),
-	SM_SAMPLE_METRIC_SYNCSTATE("sp.a.synp",  " SyncPlatform exe t[ms]"),
-	SM_SAMPLE_METRIC_SYNCSTATE("sp.a.do",    " DoChange   exe t[ms]"),
-	SM_SAMPLE_METRIC_SYNCSTATE("sp.a.post",  " PostChange exe t[ms]"),
+	SM_HISTOGRAM_METRIC("sp.a.time",  "SyncP execution t[ms]"),
+	SM_HISTOGRAM_METRIC("sp.a.lat",   " Pre-Sync Lat   t[ms]"),
+	SM_HISTOGRAM_METRIC_SYNCSTATE("sp.a.pre",   " PreChange  exe t[ms]"),
+	SM_HISTOGRAM_METRIC_SYNCSTATE("sp.a.sync",  " SyncChange exe t[ms]"),
+	SM_HISTOGRAM_METRIC_SYNCSTATE("sp.a.synp",  " SyncPlatform exe t[ms]"),
+	SM_HISTOGRAM_METRIC_SYNCSTATE("sp.a.do",    " DoChange   exe t[ms]"),
+	SM_HISTOGRAM_METRIC_SYNCSTATE("sp.a.post",  " PostChange exe t[ms]"),
 	//----- Couting statistics
 	SM_SAMPLE_METRIC("avge", "Average EXCs reconf"),
-	SM_SAMPLE_METRIC("app.SyncLat", "Average SyncLatency declared"),
+	SM_HISTOGRAM_METRIC("app.SyncLat", "SyncLatency declared"),
 
 };
 
@@ -119,7 +127,7 @@ SynchronizationManager::SynchronizationManager() :
 		assert(logger);
 	}
 
-	logger->Debug("Starting synchronization manager...");
+	BBQUE_LOG_DEBUG("Starting synchronization manager...");
 
 	//---------- Loading module configuration
 	ConfigurationManager & cm = ConfigurationManager::GetInstance();
@@ -136,12 +144,12 @@ SynchronizationManager::SynchronizationManager() :
 
 	//---------- Load the required optimization plugin
 	std::string sync_namespace(SYNCHRONIZATION_POLICY_NAMESPACE".");
-	logger->Debug("Loading synchronization policy [%s%s]...",
+	BBQUE_LOG_DEBUG("Loading synchronization policy [%s%s]...",
 			sync_namespace.c_str(), sync_policy.c_str());
 	policy = ModulesFactory::GetSynchronizationPolicyModule(
 			sync_namespace + sync_policy);
 	if (!policy) {
-		logger->Fatal("Synchronization policy load FAILED "
+		BBQUE_LOG_FATAL("Synchronization policy load FAILED "
 			"(Error: missing plugin for [%s%s])",
 			sync_namespace.c_str(), sync_policy.c_str());
 		assert(policy);
@@ -169,7 +177,7 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 	RspMap_t rsp_map;
 	AppPtr_t papp;
 
-	logger->Debug("STEP 1: preChange() START");
+	BBQUE_LOG_DEBUG("STEP 1: preChange() START");
 	SM_RESET_TIMING(sm_tmr);
 
 	papp = am.GetFirst(syncState, apps_it);
@@ -178,11 +186,11 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 		if (!policy->DoSync(papp))
 			continue;
 
-		logger->Info("STEP 1: preChange() ===> [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 1: preChange() ===> [%s]", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 1: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 1: ignoring disabled EXC [%s]",
 					papp->StrId());
 			continue;
 		}
@@ -191,6 +199,7 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 		presp = ApplicationProxy::pPreChangeRsp_t(
 				new ApplicationProxy::preChangeRsp_t());
 		result = ap.SyncP_PreChange(papp, presp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.pre.app", papp->Uid(), result);
 		if (result != RTLIB_OK)
 			continue;
 
@@ -213,19 +222,20 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 1: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 1: ignoring disabled EXC [%s]",
 					papp->StrId());
 			// Remove the respose future
 			rsp_map.erase(resp_it);
 			continue;
 		}
 
-		logger->Debug("STEP 1: .... (wait) .... [%s]", papp->StrId());
+		BBQUE_LOG_DEBUG("STEP 1: .... (wait) .... [%s]", papp->StrId());
 		result = ap.SyncP_PreChange_GetResult(presp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.pre.rsp", papp->Uid(), result);
 
 
 		if (result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {
-			logger->Warn("STEP 1: <---- TIMEOUT -- [%s]",
+			BBQUE_LOG_WARN("STEP 1: <---- TIMEOUT -- [%s]",
 					papp->StrId());
 			// Disabling not responding applications
 			papp->Disable();
@@ -235,7 +245,7 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 		}
 
 		if (result == RTLIB_BBQUE_CHANNEL_WRITE_FAILED) {
-			logger->Warn("STEP 1: <------ WERROR -- [%s]",
+			BBQUE_LOG_WARN("STEP 1: <------ WERROR -- [%s]",
 					papp->StrId());
 			// TODO: disappeared applications could be killed
 			papp->Disable();
@@ -245,13 +255,13 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 		}
 
 		if (result != RTLIB_OK) {
-			logger->Warn("STEP 1: <----- FAILED -- [%s]", papp->StrId());
+			BBQUE_LOG_WARN("STEP 1: <----- FAILED -- [%s]", papp->StrId());
 			// FIXME This case should be handled
 			assert(false);
 		}
 
-		logger->Info("STEP 1: <--------- OK -- [%s]", papp->StrId());
-		logger->Info("STEP 1: [%s] declared syncLatency %d[ms]",
+		BBQUE_LOG_INFO("STEP 1: <--------- OK -- [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 1: [%s] declared syncLatency %d[ms]",
 				papp->StrId(), presp->syncLatency);
 
 		// Collect stats on declared sync latency
@@ -268,7 +278,7 @@ SynchronizationManager::Sync_PreChange(ApplicationStatusIF::SyncState_t syncStat
 	// Collecing execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_PRECHANGE,
 			sm_tmr, syncState);
-	logger->Debug("STEP 1: preChange() DONE");
+	BBQUE_LOG_DEBUG("STEP 1: preChange() DONE");
 
 	return OK;
 }
@@ -287,7 +297,7 @@ SynchronizationManager::Sync_SyncChange(
 	RspMap_t rsp_map;
 	AppPtr_t papp;
 
-	logger->Debug("STEP 2: syncChange() START");
+	BBQUE_LOG_DEBUG("STEP 2: syncChange() START");
 	SM_RESET_TIMING(sm_tmr);
 
 	papp = am.GetFirst(syncState, apps_it);
@@ -296,11 +306,11 @@ SynchronizationManager::Sync_SyncChange(
 		if (!policy->DoSync(papp))
 			continue;
 
-		logger->Info("STEP 2: syncChange() ===> [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 2: syncChange() ===> [%s]", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 2: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 2: ignoring disabled EXC [%s]",
 					papp->StrId());
 			continue;
 		}
@@ -309,6 +319,7 @@ SynchronizationManager::Sync_SyncChange(
 		presp = ApplicationProxy::pSyncChangeRsp_t(
 				new ApplicationProxy::syncChangeRsp_t());
 		result = ap.SyncP_SyncChange(papp, presp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.sync.app", papp->Uid(), result);
 		if (result != RTLIB_OK)
 			continue;
 
@@ -331,18 +342,19 @@ SynchronizationManager::Sync_SyncChange(
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 2: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 2: ignoring disabled EXC [%s]",
 					papp->StrId());
 			// Remove the respose future
 			rsp_map.erase(resp_it);
 			continue;
 		}
 
-		logger->Debug("STEP 2: .... (wait) .... [%s]", papp->StrId());
+		BBQUE_LOG_DEBUG("STEP 2: .... (wait) .... [%s]", papp->StrId());
 		result = ap.SyncP_SyncChange_GetResult(presp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.sync.rsp", papp->Uid(), result);
 
 		if (result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {
-			logger->Warn("STEP 2: <---- TIMEOUT -- [%s]",
+			BBQUE_LOG_WARN("STEP 2: <---- TIMEOUT -- [%s]",
 					papp->StrId());
 			// Disabling not responding applications
 			papp->Disable();
@@ -355,7 +367,7 @@ SynchronizationManager::Sync_SyncChange(
 		}
 
 		if (result == RTLIB_BBQUE_CHANNEL_WRITE_FAILED) {
-			logger->Warn("STEP 1: <------ WERROR -- [%s]",
+			BBQUE_LOG_WARN("STEP 1: <------ WERROR -- [%s]",
 					papp->StrId());
 			// TODO: disappeared applications could be killed
 			papp->Disable();
@@ -369,12 +381,12 @@ SynchronizationManager::Sync_SyncChange(
 
 
 		if (result != RTLIB_OK) {
-			logger->Warn("STEP 2: <----- FAILED -- [%s]", papp->StrId());
+			BBQUE_LOG_WARN("STEP 2: <----- FAILED -- [%s]", papp->StrId());
 			// TODO Here the synchronization policy should be queryed to
 			// decide if the synchronization latency is compliant with the
 			// RTRM optimization goals.
 			//
-			DB(logger->Warn("TODO: Check sync policy for sync miss reaction"));
+			DB(BBQUE_LOG_WARN("TODO: Check sync policy for sync miss reaction"));
 
 			// FIXME This case should be handled
 			assert(false);
@@ -383,7 +395,7 @@ SynchronizationManager::Sync_SyncChange(
 		// Accounting for syncpoints missed
 		SM_COUNT_EVENT(metrics, SM_SYNCP_SYNC_HIT);
 
-		logger->Info("STEP 2: <--------- OK -- [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 2: <--------- OK -- [%s]", papp->StrId());
 
 		// Remove the respose future
 		rsp_map.erase(resp_it);
@@ -393,7 +405,7 @@ SynchronizationManager::Sync_SyncChange(
 	// Collecing execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_SYNCCHANGE,
 			sm_tmr, syncState);
-	logger->Debug("STEP 2: syncChange() DONE");
+	BBQUE_LOG_DEBUG("STEP 2: syncChange() DONE");
 
 	return OK;
 }
@@ -405,7 +417,7 @@ SynchronizationManager::Sync_DoChange(ApplicationStatusIF::SyncState_t syncState
 	RTLIB_ExitCode_t result;
 	AppPtr_t papp;
 
-	logger->Debug("STEP 3: doChange() START");
+	BBQUE_LOG_DEBUG("STEP 3: doChange() START");
 	SM_RESET_TIMING(sm_tmr);
 
 	papp = am.GetFirst(syncState, apps_it);
@@ -414,27 +426,28 @@ SynchronizationManager::Sync_DoChange(ApplicationStatusIF::SyncState_t syncState
 		if (!policy->DoSync(papp))
 			continue;
 
-		logger->Info("STEP 3: doChange() ===> [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 3: doChange() ===> [%s]", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 3: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 3: ignoring disabled EXC [%s]",
 					papp->StrId());
 			continue;
 		}
 
 		// Send a Do-Change
 		result = ap.SyncP_DoChange(papp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.do.app", papp->Uid(), result);
 		if (result != RTLIB_OK)
 			continue;
 
-		logger->Info("STEP 3: <--------- OK -- [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 3: <--------- OK -- [%s]", papp->StrId());
 	}
 
 	// Collecing execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_DOCHANGE,
 			sm_tmr, syncState);
-	logger->Debug("STEP 3: doChange() DONE");
+	BBQUE_LOG_DEBUG("STEP 3: doChange() DONE");
 
 	return OK;
 }
@@ -447,7 +460,7 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 	AppPtr_t papp;
 	uint8_t excs = 0;
 
-	logger->Debug("STEP 4: postChange() START");
+	BBQUE_LOG_DEBUG("STEP 4: postChange() START");
 	SM_RESET_TIMING(sm_tmr);
 
 	papp = am.GetFirst(syncState, apps_it);
@@ -458,11 +471,11 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 		if (!policy->DoSync(papp))
 			goto commit;
 
-		logger->Info("STEP 4: postChange() ===> [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 4: postChange() ===> [%s]", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP 4: ignoring disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP 4: ignoring disabled EXC [%s]",
 					papp->StrId());
 			continue;
 		}
@@ -471,9 +484,10 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 		presp = ApplicationProxy::pPostChangeRsp_t(
 				new ApplicationProxy::postChangeRsp_t());
 		result = ap.SyncP_PostChange(papp, presp);
+		BBQUE_TRACE_INSTANT(SYNC, "sync.post.app", papp->Uid(), result);
 
 		if (result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {
-			logger->Warn("STEP 4: <---- TIMEOUT -- [%s]",
+			BBQUE_LOG_WARN("STEP 4: <---- TIMEOUT -- [%s]",
 					papp->StrId());
 			// Disabling not responding applications
 			papp->Disable();
@@ -481,7 +495,7 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 		}
 
 		if (result == RTLIB_BBQUE_CHANNEL_WRITE_FAILED) {
-			logger->Warn("STEP 1: <------ WERROR -- [%s]",
+			BBQUE_LOG_WARN("STEP 1: <------ WERROR -- [%s]",
 					papp->StrId());
 			// TODO: disappeared applications could be killed
 			papp->Disable();
@@ -491,10 +505,10 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 		if (result != RTLIB_OK)
 			continue;
 
-		logger->Info("STEP 4: <--------- OK -- [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP 4: <--------- OK -- [%s]", papp->StrId());
 
 		// TODO Here we should collect reconfiguration statistics
-		DB(logger->Warn("TODO: Collect reconf statistics"));
+		DB(BBQUE_LOG_WARN("TODO: Collect reconf statistics"));
 
 	commit:
 		// Disregarding commit for EXC disabled meanwhile
@@ -509,7 +523,7 @@ SynchronizationManager::Sync_PostChange(ApplicationStatusIF::SyncState_t syncSta
 	// Collecing execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_POSTCHANGE,
 			sm_tmr, syncState);
-	logger->Debug("STEP 4: postChange() DONE");
+	BBQUE_LOG_DEBUG("STEP 4: postChange() DONE");
 
 	// Account for total reconfigured EXCs
 	SM_COUNT_EVENT2(metrics, SM_SYNCP_EXCS, excs);
@@ -528,7 +542,7 @@ void SynchronizationManager::DoAcquireResources(AppPtr_t papp) {
 	// Acquiring the resources for RUNNING Applications
 	if (!papp->Blocking()) {
 
-		logger->Debug("SyncAcquire: [%s] is in %s/%s", papp->StrId(),
+		BBQUE_LOG_DEBUG("SyncAcquire: [%s] is in %s/%s", papp->StrId(),
 				papp->StateStr(papp->State()),
 				papp->SyncStateStr(papp->SyncState()));
 
@@ -537,7 +551,7 @@ void SynchronizationManager::DoAcquireResources(AppPtr_t papp) {
 
 		// If failed abort the single App/ExC sync
 		if (raResult != ResourceAccounter::RA_SUCCESS) {
-			logger->Error("SyncAcquire: failed for [%s]. Returned %d",
+			BBQUE_LOG_ERROR("SyncAcquire: failed for [%s]. Returned %d",
 					papp->StrId(), raResult);
 			am.SyncAbort(papp);
 		}
@@ -553,20 +567,23 @@ void SynchronizationManager::DoAcquireResources(AppPtr_t papp) {
 SynchronizationManager::ExitCode_t
 SynchronizationManager::Sync_Platform(ApplicationStatusIF::SyncState_t syncState) {
 	PlatformProxy::ExitCode_t result = PlatformProxy::OK;
+	PlatformProxy::MappingBatch_t batch;
+	PlatformProxy::MappingBatch_t::iterator req_it;
+	ExitCode_t sync_result = OK;
 	AppsUidMapIt apps_it;
 	AppPtr_t papp;
 
-	logger->Debug("STEP M: SyncPlatform() START");
+	BBQUE_LOG_DEBUG("STEP M: SyncPlatform() START");
 	SM_RESET_TIMING(sm_tmr);
 
 	papp = am.GetFirst(syncState, apps_it);
 	for ( ; papp; papp = am.GetNext(syncState, apps_it)) {
 
-		logger->Info("STEP M: SyncPlatform() ===> [%s]", papp->StrId());
+		BBQUE_LOG_INFO("STEP M: SyncPlatform() ===> [%s]", papp->StrId());
 
 		// Jumping meanwhile disabled applications
 		if (papp->Disabled()) {
-			logger->Debug("STEP M: release resources of disabled EXC [%s]",
+			BBQUE_LOG_DEBUG("STEP M: release resources of disabled EXC [%s]",
 					papp->StrId());
 			pp.ReclaimResources(papp);
 		}
@@ -574,15 +591,13 @@ SynchronizationManager::Sync_Platform(ApplicationStatusIF::SyncState_t syncState
 		// TODO: reconfigure resources
 		switch (syncState) {
 		case ApplicationStatusIF::STARTING:
-			result = pp.MapResources(papp,
-					papp->NextAWM()->GetResourceBinding());
-			break;
 		case ApplicationStatusIF::RECONF:
 		case ApplicationStatusIF::MIGREC:
 		case ApplicationStatusIF::MIGRATE:
-			result = pp.MapResources(papp,
-					papp->NextAWM()->GetResourceBinding());
-			break;
+			// Resources mapping is batched for concurrent actuation
+			batch.push_back(PlatformProxy::MappingRequest_t(papp,
+					papp->NextAWM()->GetResourceBinding()));
+			continue;
 		case ApplicationStatusIF::BLOCKED:
 			result = pp.ReclaimResources(papp);
 			break;
@@ -590,58 +605,104 @@ SynchronizationManager::Sync_Platform(ApplicationStatusIF::SyncState_t syncState
 			break;
 		}
 
-		logger->Info("STEP M: <--------- OK -- [%s]", papp->StrId());
+		if (result != PlatformProxy::OK) {
+			BBQUE_LOG_ERROR("STEP M: <----- FAILED -- [%s]", papp->StrId());
+			sync_result = PLATFORM_SYNC_FAILED;
+			continue;
+		}
+
+		BBQUE_LOG_INFO("STEP M: <--------- OK -- [%s]", papp->StrId());
+	}
+
+	// Setup the cluster-wide resources (e.g. frequency), before the
+	// applications are (re)started on them
+	BBQUE_TRACE_BEGIN(PP, "pp.map.cluster", syncState);
+	pp.MapClusterResources();
+	BBQUE_TRACE_END(PP, "pp.map.cluster", syncState);
+
+	// Map resources of all the batched applications
+	BBQUE_TRACE_BEGIN(PP, "pp.map.batch", batch.size());
+	pp.MapResources(batch);
+	BBQUE_TRACE_END(PP, "pp.map.batch", batch.size());
+	for (req_it = batch.begin(); req_it != batch.end(); ++req_it) {
+		papp = (*req_it).papp;
+
+		// A failed mapping does not prevent the synchronization of the
+		// other applications. The failed one is released and its schedule
+		// aborted, which removes it from the next synchronization steps and
+		// makes it READY to be scheduled again.
+		if ((*req_it).result != PlatformProxy::OK) {
+			BBQUE_LOG_ERROR("STEP M: <----- FAILED -- [%s]", papp->StrId());
+			pp.ReclaimResources(papp);
+			am.SyncAbort(papp);
+			sync_result = PLATFORM_SYNC_FAILED;
+			continue;
+		}
+
+		BBQUE_LOG_INFO("STEP M: <--------- OK -- [%s]", papp->StrId());
 	}
 
 	// Collecting execution metrics
 	SM_GET_TIMING_SYNCSTATE(metrics, SM_SYNCP_TIME_SYNCPLAT, sm_tmr, syncState);
-	logger->Debug("STEP M: SyncPlatform() DONE");
+	BBQUE_LOG_DEBUG("STEP M: SyncPlatform() DONE");
 
-	if (result == PlatformProxy::OK)
-		return OK;
-
-	return PLATFORM_SYNC_FAILED;
+	return sync_result;
 }
 
 SynchronizationManager::ExitCode_t
 SynchronizationManager::SyncApps(ApplicationStatusIF::SyncState_t syncState) {
 	SynchronizationPolicyIF::SyncLatency_t syncLatency;
+	ExitCode_t platResult;
 	ExitCode_t result;
 
 	if (syncState == ApplicationStatusIF::SYNC_NONE) {
-		logger->Warn("Synchronization FAILED (Error: empty EXCs list)");
+		BBQUE_LOG_WARN("Synchronization FAILED (Error: empty EXCs list)");
 		assert(syncState != ApplicationStatusIF::SYNC_NONE);
 		return OK;
 	}
 
+	BBQUE_TRACE_BEGIN(SYNC, "sync.pre", syncState);
 	result = Sync_PreChange(syncState);
+	BBQUE_TRACE_END(SYNC, "sync.pre", syncState);
 	if (result != OK)
 		return result;
 
 	// Wait for the policy specified sync point
 	syncLatency = policy->EstimatedSyncTime();
-	logger->Debug("Wait sync point for %d[ms]", syncLatency);
+	BBQUE_LOG_DEBUG("Wait sync point for %d[ms]", syncLatency);
+	BBQUE_TRACE_BEGIN(SYNC, "sync.wait", syncLatency);
 	std::this_thread::sleep_for(
 			std::chrono::milliseconds(syncLatency));
+	BBQUE_TRACE_END(SYNC, "sync.wait", syncLatency);
 	SM_ADD_SAMPLE(metrics, SM_SYNCP_TIME_LATENCY, syncLatency);
 
+	BBQUE_TRACE_BEGIN(SYNC, "sync.sync", syncState);
 	result = Sync_SyncChange(syncState);
+	BBQUE_TRACE_END(SYNC, "sync.sync", syncState);
 	if (result != OK)
 		return result;
 
-	result = Sync_Platform(syncState);
-	if (result != OK)
-		return result;
+	// The applications which mapping failed have been aborted, thus the
+	// synchronization of the others can be completed
+	BBQUE_TRACE_BEGIN(SYNC, "sync.platform", syncState);
+	platResult = Sync_Platform(syncState);
+	BBQUE_TRACE_END(SYNC, "sync.platform", syncState);
+	if ((platResult != OK) && (platResult != PLATFORM_SYNC_FAILED))
+		return platResult;
 
+	BBQUE_TRACE_BEGIN(SYNC, "sync.do", syncState);
 	result = Sync_DoChange(syncState);
+	BBQUE_TRACE_END(SYNC, "sync.do", syncState);
 	if (result != OK)
 		return result;
 
+	BBQUE_TRACE_BEGIN(SYNC, "sync.post", syncState);
 	result = Sync_PostChange(syncState);
+	BBQUE_TRACE_END(SYNC, "sync.post", syncState);
 	if (result != OK)
 		return result;
 
-	return OK;
+	return platResult;
 }
 
 SynchronizationManager::ExitCode_t
@@ -649,13 +710,14 @@ SynchronizationManager::SyncSchedule() {
 	ApplicationStatusIF::SyncState_t syncState;
 	ResourceAccounter::ExitCode_t raResult;
 	bu::Timer syncp_tmr;
+	ExitCode_t syncResult = OK;
 	ExitCode_t result;
 
 	// TODO add here proper tracing/monitoring events for statistics
 	// collection
 
 	++sync_count;
-	logger->Notice("Synchronization [%d] START, policy [%s]",
+	BBQUE_LOG_NOTICE("Synchronization [%d] START, policy [%s]",
 			sync_count,
 			policy->Name());
 	am.ReportStatusQ();
@@ -679,7 +741,7 @@ SynchronizationManager::SyncSchedule() {
 	syncState = policy->GetApplicationsQueue(sv, true);
 
 	if (syncState == ApplicationStatusIF::SYNC_NONE) {
-		logger->Info("Synchronization [%d] ABORTED", sync_count);
+		BBQUE_LOG_INFO("Synchronization [%d] ABORTED", sync_count);
 		// Possibly this should never happens
 		assert(syncState != ApplicationStatusIF::SYNC_NONE);
 		return OK;
@@ -688,7 +750,7 @@ SynchronizationManager::SyncSchedule() {
 	// Start the resource accounter synchronized session
 	raResult = ra.SyncStart();
 	if (raResult != ResourceAccounter::RA_SUCCESS) {
-		logger->Fatal("SynchSchedule: Unable to start resource accounting "
+		BBQUE_LOG_FATAL("SynchSchedule: Unable to start resource accounting "
 				"sync session");
 		return ABORTED;
 	}
@@ -696,8 +758,12 @@ SynchronizationManager::SyncSchedule() {
 	while (syncState != ApplicationStatusIF::SYNC_NONE) {
 
 		// Synchronize these policy selected apps
+		// Platform failures affect only the failed applications, which
+		// have been already aborted
 		result = SyncApps(syncState);
-		if (result != OK) {
+		if (result == PLATFORM_SYNC_FAILED)
+			syncResult = result;
+		else if (result != OK) {
 			ra.SyncAbort();
 			return result;
 		}
@@ -709,7 +775,7 @@ SynchronizationManager::SyncSchedule() {
 	// Commit the resource accounter synchronized session
 	raResult = ra.SyncCommit();
 	if (raResult != ResourceAccounter::RA_SUCCESS) {
-		logger->Fatal("SynchSchedule: Resource accounting sync session commit"
+		BBQUE_LOG_FATAL("SynchSchedule: Resource accounting sync session commit"
 				"failed");
 		return ABORTED;
 	}
@@ -720,11 +786,11 @@ SynchronizationManager::SyncSchedule() {
 	// Account for SyncP completed
 	SM_COUNT_EVENT(metrics, SM_SYNCP_COMP);
 
-	logger->Notice("Synchronization [%d] DONE", sync_count);
+	BBQUE_LOG_NOTICE("Synchronization [%d] DONE", sync_count);
 	am.ReportStatusQ();
 	am.ReportSyncQ();
 
-	return OK;
+	return syncResult;
 }
 
 } // namespace bbque
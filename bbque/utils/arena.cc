@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/utils/arena.h"
+
+#include <cstdlib>
+
+#define ARENA_ROUND(size) \
+	(((size) + BBQUE_ARENA_ALIGN - 1) & ~((size_t)BBQUE_ARENA_ALIGN - 1))
+
+namespace bbque { namespace utils {
+
+Arena::Arena(size_t chunk_size) :
+	chunk_size(ARENA_ROUND(chunk_size)),
+	first(nullptr),
+	current(nullptr),
+	size(0),
+	allocations(0),
+	generation(0),
+	finalizers(nullptr) {
+}
+
+Arena::~Arena() {
+	Chunk_t * next;
+
+	Reset();
+	for (; first; first = next) {
+		next = first->next;
+		::free(first);
+	}
+}
+
+void * Arena::Allocate(size_t _size) {
+	Chunk_t * chunk;
+	size_t offset;
+
+	_size = ARENA_ROUND(_size);
+	__atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+
+	for (;;) {
+		chunk = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+		if (chunk) {
+			// A failed bump leaves the chunk full, which is harmless
+			// since the allocation is served by the next one
+			offset = __atomic_fetch_add(&chunk->used, _size,
+					__ATOMIC_RELAXED);
+			if (offset + _size <= chunk->size)
+				return Data(chunk) + offset;
+		}
+		Grow(chunk, _size);
+	}
+}
+
+void Arena::Grow(Chunk_t * full, size_t _size) {
+	std::unique_lock<std::mutex> grow_ul(grow_mtx);
+	Chunk_t * chunk;
+	Chunk_t * last;
+
+	// Another thread switched to a new chunk meanwhile
+	if (current != full)
+		return;
+
+	// Look for a chunk kept by a previous reset
+	for (chunk = full ? full->next : first; chunk; chunk = chunk->next) {
+		if (chunk->size >= _size)
+			break;
+	}
+
+	if (!chunk) {
+		if (_size < chunk_size)
+			_size = chunk_size;
+		chunk = static_cast<Chunk_t *>(::malloc(sizeof(Chunk_t) + _size));
+		if (!chunk)
+			throw std::bad_alloc();
+		chunk->next = nullptr;
+		chunk->size = _size;
+		chunk->used = 0;
+		size += _size;
+
+		// Append the new chunk to the list
+		for (last = first; last && last->next; last = last->next);
+		if (last)
+			last->next = chunk;
+		else
+			first = chunk;
+	}
+
+	__atomic_store_n(&current, chunk, __ATOMIC_RELEASE);
+}
+
+void Arena::AddFinalizer(void (*destroy)(void *), void * obj) {
+	Finalizer_t * fin;
+
+	fin = static_cast<Finalizer_t *>(Allocate(sizeof(Finalizer_t)));
+	fin->destroy = destroy;
+	fin->obj = obj;
+	fin->next = __atomic_load_n(&finalizers, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&finalizers, &fin->next, fin,
+				true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+void Arena::Reset() {
+	Finalizer_t * fin;
+	Chunk_t * chunk;
+
+	// Destroy the objects, which could still access the arena memory
+	for (fin = finalizers; fin; fin = fin->next)
+		fin->destroy(fin->obj);
+	finalizers = nullptr;
+
+	for (chunk = first; chunk; chunk = chunk->next)
+		chunk->used = 0;
+	current = first;
+	allocations = 0;
+
+	__atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+}
+
+size_t Arena::Used() const {
+	Chunk_t * chunk;
+	size_t used = 0;
+
+	for (chunk = first; chunk; chunk = chunk->next) {
+		used += (chunk->used < chunk->size) ? chunk->used : chunk->size;
+		if (chunk == current)
+			break;
+	}
+
+	return used;
+}
+
+} // namespace utils
+
+} // namespace bbque
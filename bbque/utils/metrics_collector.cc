@@ -19,6 +19,8 @@
 
 #include "bbque/modules_factory.h"
 
+#include <deque>
+
 #define METRICS_COLLECTOR_NAMESPACE "bq.mc"
 
 namespace bp = bbque::plugins;
@@ -64,18 +66,14 @@ MetricsCollector::SamplesMetric::SamplesMetric(
 		const char *name, const char *desc,
 		uint8_t sm_count, const char **sm_desc) :
 	Metric(name, desc, SAMPLE, sm_count, sm_desc),
-	sm_pstat(sm_count) {
-	pstat = pStatMetric_t(new statMetric_t);
-	for (uint8_t i = 0; i < sm_pstat.size(); ++i) {
-		sm_pstat[i] = pStatMetric_t(new statMetric_t);
-	}
+	sm_stats(sm_count) {
+
 }
 
 void MetricsCollector::SamplesMetric::Reset() {
-	pstat = pStatMetric_t(new statMetric_t);
-	for (uint8_t i = 0; i < sm_pstat.size(); ++i) {
-		sm_pstat[i] = pStatMetric_t(new statMetric_t);
-	}
+	stats.Reset();
+	for (uint8_t i = 0; i < sm_stats.size(); ++i)
+		sm_stats[i].Reset();
 }
 
 MetricsCollector::PeriodMetric::PeriodMetric(
@@ -96,12 +94,32 @@ void MetricsCollector::PeriodMetric::Reset() {
 	}
 }
 
+MetricsCollector::HistogramMetric::HistogramMetric(
+		const char *name, const char *desc,
+		uint8_t sm_count, const char **sm_desc) :
+	Metric(name, desc, HISTOGRAM, sm_count, sm_desc),
+	sm_hist(sm_count) {
+
+}
+
+void MetricsCollector::HistogramMetric::Reset() {
+	hist.Reset();
+	for (uint8_t i = 0; i < sm_hist.size(); ++i)
+		sm_hist[i].Reset();
+}
+
 MetricsCollector & MetricsCollector::GetInstance() {
 	static MetricsCollector mc;
 	return mc;
 }
 
-MetricsCollector::MetricsCollector() {
+__thread MetricsCollector::Shard *MetricsCollector::tlsShard = NULL;
+
+MetricsCollector::MetricsCollector() :
+	metricsCount(0),
+	retired(new Shard()),
+	shard_key_valid(false),
+	resetGen(0) {
 
 	//---------- Get a logger module
 	bp::LoggerIF::Configuration conf(METRICS_COLLECTOR_NAMESPACE);
@@ -112,31 +130,144 @@ MetricsCollector::MetricsCollector() {
 	}
 
 	logger->Debug("Starting metrics collector...");
+
+	// The metrics of terminated threads are accounted by the retired shard
+	shards.push_back(retired);
+	shard_key_valid = (pthread_key_create(&shard_key, ReleaseShard) == 0);
+	if (!shard_key_valid)
+		logger->Warn("Shards of terminated threads will not be reused");
 }
 
 MetricsCollector::~MetricsCollector() {
+	if (shard_key_valid)
+		pthread_key_delete(shard_key);
+	for (uint16_t i = 0; i < shards.size(); ++i)
+		delete shards[i];
 }
 
 
-MetricsCollector::MetricHandler_t
-MetricsCollector::GetHandler(const char *name) {
-	return std::hash<const char *>()(name);
-}
-
 MetricsCollector::pMetric_t
-MetricsCollector::GetMetric(MetricHandler_t hdlr) {
-	MetricsMap_t::iterator it = metricsMap.find(hdlr);
+MetricsCollector::GetMetric(const char *name) {
+	MetricsMap_t::iterator it;
+
 	// Lookup for metrics
+	it = metricsMap.find(std::hash<const char *>()(name));
 	if (it != metricsMap.end())
 		return (*it).second;
 	// Return NULL pointer
 	return pMetric_t();
 }
 
-MetricsCollector::pMetric_t
-MetricsCollector::GetMetric(const char *name) {
-	MetricHandler_t hdlr = GetHandler(name);
-	return GetMetric(hdlr);
+MetricsCollector::Shard *
+MetricsCollector::NewShard() {
+	std::unique_lock<std::mutex> metrics_ul(metrics_mtx);
+
+	// Reuse the shard of a terminated thread, if any: it has been already
+	// folded into the retired one
+	if (!freeShards.empty()) {
+		tlsShard = freeShards.back();
+		freeShards.pop_back();
+		logger->Debug("Reused metrics shard for thread [%d]", gettid());
+	} else {
+		tlsShard = new Shard();
+		shards.push_back(tlsShard);
+		logger->Debug("New metrics shard [%d] for thread [%d]",
+				shards.size(), gettid());
+	}
+
+	if (shard_key_valid)
+		pthread_setspecific(shard_key, tlsShard);
+
+	return tlsShard;
+}
+
+void
+MetricsCollector::ReleaseShard(void *ps) {
+	MetricsCollector & mc(GetInstance());
+	std::unique_lock<std::mutex> metrics_ul(mc.metrics_mtx);
+	mc.RetireShard((Shard *)ps);
+}
+
+void
+MetricsCollector::RetireShard(Shard *ps) {
+	SampleShard_t *pss, *prss;
+	Histogram *phst, *prhst;
+	uint64_t *pcnt, *prcnt;
+	uint16_t j, k, b;
+	uint8_t sm_count;
+
+	// NOTE: the owner thread is terminated, thus the shard could be updated
+	// just by a concurrent reset, which requires the metrics lock too
+	for (j = 0; j < metricsCount; ++j) {
+		sm_count = metricsArr[j]->sm_count;
+
+		// Sum-up the counters
+		pcnt = ps->cnt[j];
+		if (pcnt) {
+			prcnt = retired->cnt[j];
+			if (!prcnt) {
+				prcnt = new uint64_t[1 + sm_count]();
+				__atomic_store_n(&retired->cnt[j], prcnt,
+						__ATOMIC_RELEASE);
+			}
+			for (k = 0; k <= sm_count; ++k) {
+				__atomic_fetch_add(&prcnt[k], pcnt[k],
+						__ATOMIC_RELAXED);
+				__atomic_store_n(&pcnt[k], 0, __ATOMIC_RELAXED);
+			}
+		}
+
+		// Merge the samples of the current generation
+		pss = ps->smp[j];
+		if (pss && pss[0].gen == resetGen) {
+			prss = retired->smp[j];
+			if (!prss) {
+				prss = new SampleShard_t[1 + sm_count];
+				for (k = 0; k <= sm_count; ++k) {
+					prss[k].seq = 0;
+					prss[k].gen = resetGen;
+				}
+				__atomic_store_n(&retired->smp[j], prss,
+						__ATOMIC_RELEASE);
+			}
+			if (prss[0].gen != resetGen) {
+				for (k = 0; k <= sm_count; ++k) {
+					prss[k].stats.Reset();
+					prss[k].gen = resetGen;
+				}
+			}
+			for (k = 0; k <= sm_count; ++k) {
+				prss[k].stats.Merge(pss[k].stats);
+				pss[k].stats.Reset();
+			}
+		}
+
+		// Merge the histograms
+		phst = ps->hst[j];
+		if (phst) {
+			prhst = retired->hst[j];
+			if (!prhst) {
+				prhst = new Histogram[1 + sm_count];
+				__atomic_store_n(&retired->hst[j], prhst,
+						__ATOMIC_RELEASE);
+			}
+			for (k = 0; k <= sm_count; ++k) {
+				__atomic_fetch_add(&prhst[k].count, phst[k].count,
+						__ATOMIC_RELAXED);
+				__atomic_fetch_add(&prhst[k].sum, phst[k].sum,
+						__ATOMIC_RELAXED);
+				for (b = 0; b < BBQUE_METRICS_HIST_BUCKETS; ++b)
+					__atomic_fetch_add(&prhst[k].buckets[b],
+							phst[k].buckets[b],
+							__ATOMIC_RELAXED);
+				phst[k].Reset();
+			}
+		}
+	}
+
+	freeShards.push_back(ps);
+	logger->Debug("Retired metrics shard, [%d] ready to be reused",
+			freeShards.size());
 }
 
 MetricsCollector::ExitCode_t
@@ -154,6 +285,13 @@ MetricsCollector::Register(const char *name, const char *desc,
 		return DUPLICATE;
 	}
 
+	// Check there is room for a new metric
+	if (metricsCount == BBQUE_METRICS_MAX) {
+		logger->Error("Metric [%s] registration FAILED "
+				"(Error: too many metrics)", name);
+		return UNSUPPORTED;
+	}
+
 	// Build a new metric container
 	assert(!pm);
 	switch(mc) {
@@ -169,20 +307,28 @@ MetricsCollector::Register(const char *name, const char *desc,
 	case PERIOD:
 		pm = pMetric_t(new PeriodMetric(name, desc, count, pdescs));
 		break;
+	case HISTOGRAM:
+		pm = pMetric_t(new HistogramMetric(name, desc, count, pdescs));
+		break;
 	default:
 		logger->Error("Metric [%s] registration FAILED "
 				"(Error: metric class not supported)", name);
 		return UNSUPPORTED;
 	}
 
-	// Compute the metric handler
-	mh = GetHandler(name);
+	// The metric handler is the index of the metric
+	mh = metricsCount;
 
 	// Save the metric containter into proper map
 	assert(mc < CLASSES_COUNT);
-	metricsMap.insert(MetricsMapEntry_t(mh, pm));
+	metricsMap.insert(MetricsMapEntry_t(
+				std::hash<const char *>()(name), pm));
 	metricsVec[mc].insert(MetricsMapEntry_t(mh, pm));
 
+	// Publish the metric for lock-less accesses
+	metricsArr[mh] = pm;
+	__atomic_store_n(&metricsCount, mh + 1, __ATOMIC_RELEASE);
+
 	logger->Debug("New metric [%s:%s => %s] registered, "
 			"with [%d] sub-metrics",
 			metricClassName[pm->mc], pm->name,
@@ -211,8 +357,9 @@ MetricsCollector::Register(MetricsCollection_t *mc, uint8_t count) {
 
 MetricsCollector::ExitCode_t
 MetricsCollector::Count(MetricHandler_t mh, uint64_t amount, uint8_t idx) {
-	pMetric_t pm = GetMetric(mh);
-	CounterMetric *m;
+	Metric *pm = GetMetric(mh);
+	Shard *ps;
+	uint64_t *pcnt;
 
 	// Check if the metric has not yet been registered
 	if (!pm) {
@@ -229,16 +376,20 @@ MetricsCollector::Count(MetricHandler_t mh, uint64_t amount, uint8_t idx) {
 		return UNSUPPORTED;
 	}
 
-	// Lock this metric
-	std::unique_lock<std::mutex> ul(pm->mtx);
-
-	// Get the SAMPLE metrics
-	m = (CounterMetric*)pm.get();
+	// Get the counters of this thread, the first time allocating them
+	ps = GetShard();
+	pcnt = ps->cnt[mh];
+	if (unlikely(!pcnt)) {
+		pcnt = new uint64_t[1 + pm->sm_count]();
+		__atomic_store_n(&ps->cnt[mh], pcnt, __ATOMIC_RELEASE);
+	}
 
 	// Increase the counter for the specified value
-	m->cnt += amount;
-	if (m->HasSubmetrics())
-		m->sm_cnt[idx] += amount;
+	// NOTE: counters are written only by this thread, but they could be
+	// reset concurrently
+	__atomic_fetch_add(&pcnt[0], amount, __ATOMIC_RELAXED);
+	if (pm->HasSubmetrics())
+		__atomic_fetch_add(&pcnt[1 + idx], amount, __ATOMIC_RELAXED);
 
 	return OK;
 }
@@ -246,7 +397,7 @@ MetricsCollector::Count(MetricHandler_t mh, uint64_t amount, uint8_t idx) {
 MetricsCollector::ExitCode_t
 MetricsCollector::UpdateValue(MetricHandler_t mh, double amount,
 		uint8_t idx) {
-	pMetric_t pm = GetMetric(mh);
+	Metric *pm = GetMetric(mh);
 	ValueMetric *m;
 
 	// Check if the metric has not yet been registered
@@ -268,7 +419,7 @@ MetricsCollector::UpdateValue(MetricHandler_t mh, double amount,
 	std::unique_lock<std::mutex> ul(pm->mtx);
 
 	// Get the VALUE metric
-	m = (ValueMetric*)pm.get();
+	m = (ValueMetric*)pm;
 
 	// Update the value if not zero, otherwise reset it
 	if (amount) {
@@ -314,8 +465,11 @@ MetricsCollector::Reset(MetricHandler_t mh, uint8_t idx) {
 MetricsCollector::ExitCode_t
 MetricsCollector::AddSample(MetricHandler_t mh,
 		double sample, uint8_t idx) {
-	pMetric_t pm = GetMetric(mh);
-	SamplesMetric *m;
+	Metric *pm = GetMetric(mh);
+	uint32_t gen = __atomic_load_n(&resetGen, __ATOMIC_ACQUIRE);
+	SampleShard_t *pss;
+	uint32_t seq;
+	Shard *ps;
 
 	// Check if the metric has not yet been registered
 	if (!pm) {
@@ -324,6 +478,10 @@ MetricsCollector::AddSample(MetricHandler_t mh,
 		return UNKNOWEN;
 	}
 
+	// Histograms have their own shards
+	if (pm->mc == HISTOGRAM)
+		return RecordSample(pm, mh, sample, idx);
+
 	// Check the metrics is of compatible type
 	if (pm->mc != SAMPLE) {
 		logger->Error("Add sample FAILED "
@@ -332,24 +490,137 @@ MetricsCollector::AddSample(MetricHandler_t mh,
 		return UNSUPPORTED;
 	}
 
-	// Lock this metric
-	std::unique_lock<std::mutex> ul(pm->mtx);
+	// Get the samples of this thread, the first time allocating them
+	ps = GetShard();
+	pss = ps->smp[mh];
+	if (unlikely(!pss)) {
+		pss = new SampleShard_t[1 + pm->sm_count];
+		for (uint16_t i = 0; i <= pm->sm_count; ++i) {
+			pss[i].seq = 0;
+			pss[i].gen = gen;
+		}
+		__atomic_store_n(&ps->smp[mh], pss, __ATOMIC_RELEASE);
+	}
 
-	// Get the SAMPLE metrics
-	m = (SamplesMetric*)pm.get();
+	// Mark the update in progress before touching the statistics
+	seq = pss[0].seq;
+	__atomic_store_n(&pss[0].seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
 
-	// Push-in the new sample into the accumulator
-	(*m->pstat)(sample);
-	if (m->HasSubmetrics())
-		(*m->sm_pstat[idx])(sample);
+	// Discard the samples collected before the last reset
+	if (unlikely(pss[0].gen != gen)) {
+		for (uint16_t i = 0; i <= pm->sm_count; ++i) {
+			pss[i].stats.Reset();
+			pss[i].gen = gen;
+		}
+	}
+
+	// Push-in the new sample into the statistics
+	pss[0].stats.Add(sample);
+	if (pm->HasSubmetrics())
+		pss[1 + idx].stats.Add(sample);
+
+	__atomic_store_n(&pss[0].seq, seq + 2, __ATOMIC_RELEASE);
+
+	return OK;
+}
+
+MetricsCollector::ExitCode_t
+MetricsCollector::RecordSample(Metric *pm, MetricHandler_t mh,
+		double sample, uint8_t idx) {
+	uint64_t value = Histogram::Scale(sample);
+	uint16_t bucket = Histogram::Index(value);
+	Histogram *phst;
+	Shard *ps;
+
+	// Get the histograms of this thread, the first time allocating them
+	ps = GetShard();
+	phst = ps->hst[mh];
+	if (unlikely(!phst)) {
+		phst = new Histogram[1 + pm->sm_count];
+		__atomic_store_n(&ps->hst[mh], phst, __ATOMIC_RELEASE);
+	}
+
+	// Account the new sample
+	// NOTE: histograms are written only by this thread, but they could be
+	// reset concurrently
+	__atomic_fetch_add(&phst[0].count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&phst[0].sum, value, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&phst[0].buckets[bucket], 1, __ATOMIC_RELAXED);
+	if (!pm->HasSubmetrics())
+		return OK;
+
+	__atomic_fetch_add(&phst[1 + idx].count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&phst[1 + idx].sum, value, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&phst[1 + idx].buckets[bucket], 1, __ATOMIC_RELAXED);
 
 	return OK;
 }
 
+void
+MetricsCollector::MergeHistogram(MetricHandler_t mh, Histogram & hist,
+		int16_t idx) {
+	Histogram *phst;
+
+	for (uint16_t i = 0; i < shards.size(); ++i) {
+		phst = __atomic_load_n(&shards[i]->hst[mh], __ATOMIC_ACQUIRE);
+		if (!phst)
+			continue;
+		hist.Merge(phst[1 + idx]);
+	}
+}
+
+MetricsCollector::ExitCode_t
+MetricsCollector::GetHistogram(MetricHandler_t mh,
+		Histogram & hist, int16_t idx) {
+	std::unique_lock<std::mutex> metrics_ul(metrics_mtx);
+	Metric *pm = GetMetric(mh);
+
+	// Check if the metric has not yet been registered
+	if (!pm) {
+		logger->Error("Get histogram FAILED "
+				"(Error: metric not registered)");
+		return UNKNOWEN;
+	}
+
+	// Check the metrics is of compatible type
+	if (pm->mc != HISTOGRAM) {
+		logger->Error("Get histogram FAILED "
+				"(Error: wrong metric class)");
+		return UNSUPPORTED;
+	}
+
+	// Check the sub-metric index
+	if (idx >= pm->sm_count) {
+		logger->Error("Get histogram FAILED "
+				"(Error: sub-metric [%d] out of range)", idx);
+		return UNSUPPORTED;
+	}
+
+	hist.Reset();
+	MergeHistogram(mh, hist, idx);
+
+	return OK;
+}
+
+MetricsCollector::ExitCode_t
+MetricsCollector::GetPercentile(MetricHandler_t mh, double pct,
+		double & value, int16_t idx) {
+	Histogram hist;
+	ExitCode_t result;
+
+	result = GetHistogram(mh, hist, idx);
+	if (result != OK)
+		return result;
+
+	value = hist.Percentile(pct);
+	return OK;
+}
+
 MetricsCollector::ExitCode_t
 MetricsCollector::PeriodSample(MetricHandler_t mh,
 		double & last_period, uint8_t idx) {
-	pMetric_t pm = GetMetric(mh);
+	Metric *pm = GetMetric(mh);
 	PeriodMetric *m;
 
 	// Check if the metric has not yet been registered
@@ -368,10 +639,12 @@ MetricsCollector::PeriodSample(MetricHandler_t mh,
 	}
 
 	// Lock this metric
+	// NOTE: periods are measured across all the threads, thus PERIOD
+	// metrics could not be sharded
 	std::unique_lock<std::mutex> ul(pm->mtx);
 
-	// Get the SAMPLE metrics
-	m = (PeriodMetric*)pm.get();
+	// Get the PERIOD metrics
+	m = (PeriodMetric*)pm;
 
 	// Start the submetrics sampling timer (if not already)
 	if (m->HasSubmetrics() &&
@@ -403,6 +676,203 @@ MetricsCollector::PeriodSample(MetricHandler_t mh,
 	return OK;
 }
 
+void
+MetricsCollector::MergeCounters(MetricHandler_t mh, uint8_t sm_count,
+		uint64_t *cnt) {
+	uint64_t *pcnt;
+
+	for (uint16_t i = 0; i < shards.size(); ++i) {
+		pcnt = __atomic_load_n(&shards[i]->cnt[mh], __ATOMIC_ACQUIRE);
+		if (!pcnt)
+			continue;
+		for (uint16_t j = 0; j <= sm_count; ++j)
+			cnt[j] += __atomic_load_n(&pcnt[j], __ATOMIC_RELAXED);
+	}
+}
+
+void
+MetricsCollector::MergeSamples(MetricHandler_t mh, uint8_t sm_count,
+		SampleStats *stats) {
+	SampleShard_t snap[1 + UINT8_MAX];
+	SampleShard_t *pss;
+	uint32_t seq;
+
+	for (uint16_t i = 0; i < shards.size(); ++i) {
+		pss = __atomic_load_n(&shards[i]->smp[mh], __ATOMIC_ACQUIRE);
+		if (!pss)
+			continue;
+
+		// Get a consistent snapshot, retrying while the owner
+		// thread is updating it
+		do {
+			seq = __atomic_load_n(&pss[0].seq, __ATOMIC_ACQUIRE);
+			::memcpy(snap, pss, (1 + sm_count) * sizeof(SampleShard_t));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		} while ((seq & 0x1) ||
+			(seq != __atomic_load_n(&pss[0].seq, __ATOMIC_RELAXED)));
+
+		// Samples of a previous generation have been reset
+		if (snap[0].gen != resetGen)
+			continue;
+
+		for (uint16_t j = 0; j <= sm_count; ++j)
+			stats[j].Merge(snap[j].stats);
+	}
+}
+
+void
+MetricsCollector::MergeShards() {
+	SampleStats stats[1 + UINT8_MAX];
+	uint64_t cnt[1 + UINT8_MAX];
+	MetricsMap_t::iterator it;
+	HistogramMetric *hm;
+	SamplesMetric *sm;
+	CounterMetric *cm;
+	uint16_t j;
+
+	// Sum-up the counters of all the shards
+	it = metricsVec[COUNTER].begin();
+	for ( ; it != metricsVec[COUNTER].end(); ++it) {
+		cm = (CounterMetric*)(((*it).second).get());
+		memset(cnt, 0, (1 + cm->sm_count) * sizeof(uint64_t));
+		MergeCounters((*it).first, cm->sm_count, cnt);
+
+		std::unique_lock<std::mutex> ul(cm->mtx);
+		cm->cnt = cnt[0];
+		for (j = 0; j < cm->sm_count; ++j)
+			cm->sm_cnt[j] = cnt[1 + j];
+	}
+
+	// Merge the samples statistics of all the shards
+	it = metricsVec[SAMPLE].begin();
+	for ( ; it != metricsVec[SAMPLE].end(); ++it) {
+		sm = (SamplesMetric*)(((*it).second).get());
+		for (j = 0; j <= sm->sm_count; ++j)
+			stats[j].Reset();
+		MergeSamples((*it).first, sm->sm_count, stats);
+
+		std::unique_lock<std::mutex> ul(sm->mtx);
+		sm->stats = stats[0];
+		for (j = 0; j < sm->sm_count; ++j)
+			sm->sm_stats[j] = stats[1 + j];
+	}
+
+	// Merge the histograms of all the shards
+	it = metricsVec[HISTOGRAM].begin();
+	for ( ; it != metricsVec[HISTOGRAM].end(); ++it) {
+		hm = (HistogramMetric*)(((*it).second).get());
+		std::unique_lock<std::mutex> ul(hm->mtx);
+		hm->Reset();
+		MergeHistogram((*it).first, hm->hist, -1);
+		for (j = 0; j < hm->sm_count; ++j)
+			MergeHistogram((*it).first, hm->sm_hist[j], j);
+	}
+
+}
+
+void
+MetricsCollector::GetSnapshot(MetricsSnapshot_t & snap) {
+	std::unique_lock<std::mutex> metrics_ul(metrics_mtx);
+	SampleStats stats[1 + UINT8_MAX];
+	uint64_t cnt[1 + UINT8_MAX];
+	std::deque<Histogram> hists;
+	MetricSnapshot_t ms;
+	ValueMetric *vm;
+	PeriodMetric *pm;
+	Metric *m;
+	int16_t idx;
+	size_t i, j;
+
+	snap.clear();
+	for (MetricHandler_t mh = 0; mh < metricsCount; ++mh) {
+		m = metricsArr[mh].get();
+
+		if (m->mc == COUNTER) {
+			memset(cnt, 0, (1 + m->sm_count) * sizeof(uint64_t));
+			MergeCounters(mh, m->sm_count, cnt);
+		} else if (m->mc == SAMPLE) {
+			for (idx = 0; idx <= m->sm_count; ++idx)
+				stats[idx].Reset();
+			MergeSamples(mh, m->sm_count, stats);
+		}
+
+		// The main metric is followed by its sub-metrics
+		for (idx = -1; idx < m->sm_count; ++idx) {
+			memset(&ms, 0, sizeof(ms));
+			ms.name = m->name;
+			ms.desc = (idx < 0) ? m->desc : SubmetricDesc(m, idx);
+			ms.mc = m->mc;
+			ms.sm_idx = idx;
+
+			switch (m->mc) {
+			case COUNTER:
+				ms.count = cnt[1 + idx];
+				break;
+			case VALUE: {
+				vm = (ValueMetric*)m;
+				std::unique_lock<std::mutex> ul(vm->mtx);
+				ValueMetric::statMetric_t & vs((idx < 0) ?
+						*vm->pstat : *vm->sm_pstat[idx]);
+				ms.value = (idx < 0) ? vm->value : vm->sm_value[idx];
+				ms.count = count(vs);
+				if (ms.count) {
+					ms.min = min(vs);
+					ms.max = max(vs);
+				}
+				break;
+			}
+			case SAMPLE:
+				ms.count = stats[1 + idx].count;
+				ms.min = stats[1 + idx].min;
+				ms.max = stats[1 + idx].max;
+				ms.mean = stats[1 + idx].mean;
+				ms.stddev = ::sqrt(stats[1 + idx].Variance());
+				break;
+			case PERIOD: {
+				pm = (PeriodMetric*)m;
+				std::unique_lock<std::mutex> ul(pm->mtx);
+				PeriodMetric::statMetric_t & ps((idx < 0) ?
+						*pm->pstat : *pm->sm_pstat[idx]);
+				ms.count = count(ps);
+				if (ms.count) {
+					ms.min = min(ps);
+					ms.max = max(ps);
+					ms.mean = mean(ps);
+					ms.stddev = ::sqrt(variance(ps));
+				}
+				break;
+			}
+			case HISTOGRAM:
+				// Percentiles are computed once released the lock
+				hists.push_back(Histogram());
+				MergeHistogram(mh, hists.back(), idx);
+				break;
+			default:
+				break;
+			}
+
+			snap.push_back(ms);
+		}
+	}
+
+	metrics_ul.unlock();
+
+	// Fill-in the HISTOGRAM statistics from the copied histograms
+	for (i = 0, j = 0; i < snap.size(); ++i) {
+		if (snap[i].mc != HISTOGRAM)
+			continue;
+		Histogram & hist(hists[j++]);
+		snap[i].count = hist.count;
+		snap[i].mean = hist.Mean();
+		snap[i].min = hist.Percentile(0);
+		snap[i].max = hist.Percentile(100);
+		snap[i].p50 = hist.Percentile(50);
+		snap[i].p90 = hist.Percentile(90);
+		snap[i].p99 = hist.Percentile(99);
+		snap[i].p999 = hist.Percentile(99.9);
+	}
+}
+
 void
 MetricsCollector::_ResetAll(uint8_t mc) {
 	MetricsMap_t::iterator it;
@@ -420,8 +890,41 @@ MetricsCollector::_ResetAll(uint8_t mc) {
 void
 MetricsCollector::ResetAll() {
 	std::unique_lock<std::mutex> metrics_ul(metrics_mtx);
+	Histogram *phst;
+	uint64_t *pcnt;
+	uint16_t i, j, k, b;
 	uint8_t mc;
 
+	// Discard the samples collected so far by all the shards
+	__atomic_add_fetch(&resetGen, 1, __ATOMIC_RELEASE);
+
+	// Reset the counters of all the shards
+	for (i = 0; i < shards.size(); ++i) {
+		for (j = 0; j < metricsCount; ++j) {
+			pcnt = __atomic_load_n(&shards[i]->cnt[j], __ATOMIC_ACQUIRE);
+			if (!pcnt)
+				continue;
+			for (k = 0; k <= metricsArr[j]->sm_count; ++k)
+				__atomic_store_n(&pcnt[k], 0, __ATOMIC_RELAXED);
+		}
+	}
+
+	// Reset the histograms of all the shards
+	for (i = 0; i < shards.size(); ++i) {
+		for (j = 0; j < metricsCount; ++j) {
+			phst = __atomic_load_n(&shards[i]->hst[j], __ATOMIC_ACQUIRE);
+			if (!phst)
+				continue;
+			for (k = 0; k <= metricsArr[j]->sm_count; ++k) {
+				__atomic_store_n(&phst[k].count, 0, __ATOMIC_RELAXED);
+				__atomic_store_n(&phst[k].sum, 0, __ATOMIC_RELAXED);
+				for (b = 0; b < BBQUE_METRICS_HIST_BUCKETS; ++b)
+					__atomic_store_n(&phst[k].buckets[b], 0,
+							__ATOMIC_RELAXED);
+			}
+		}
+	}
+
 	for (mc = 0; mc < CLASSES_COUNT; ++mc) {
 		logger->Info("Resetting metrics of class [%d]", mc);
 		_ResetAll(mc);
@@ -429,6 +932,23 @@ MetricsCollector::ResetAll() {
 
 }
 
+const char *
+MetricsCollector::SubmetricDesc(Metric *m, uint8_t idx) {
+	uint8_t i;
+
+	// By default use main metrics description
+	if ((m->sm_desc == NULL) || (m->sm_desc[0] == NULL))
+		return m->desc;
+
+	// Use the last valid provided description
+	for (i = 0; m->sm_desc[i] && (i < idx); ++i) {}
+	// This is needed to handle the special case of just one
+	// submetric description provided
+	if (i < idx || !m->sm_desc[i]) --i;
+
+	return m->sm_desc[i];
+}
+
 void
 MetricsCollector::DumpCountSM(CounterMetric *m, uint8_t idx) {
 	char _name[21], _desc[64];
@@ -455,7 +975,7 @@ MetricsCollector::DumpCountSM(CounterMetric *m, uint8_t idx) {
 dump_count_sm:
 	// Dump sub-metric
 	logger->Notice(
-		" %-20s | %9 " PRIu64 " : %s",
+		" %-20s | %9" PRIu64 " : %s",
 		_name, m->sm_cnt[idx], _desc);
 }
 
@@ -536,14 +1056,10 @@ MetricsCollector::DumpSampleSM(SamplesMetric *m, uint8_t idx,
 	snprintf(ms.name, 21, "%s[%02hu]", m->name, idx);
 
 	// Get sub-metrics statistics
-	if (count(*m->sm_pstat[idx])) {
-		ms.min = min(*m->sm_pstat[idx]);
-		ms.max = max(*m->sm_pstat[idx]);
-		ms.avg = mean(*m->sm_pstat[idx]);
-		ms.var = variance(*m->sm_pstat[idx]);
-	} else {
-		ms.min = 0; ms.max = 0; ms.avg = 0; ms.var = 0;
-	}
+	ms.min = m->sm_stats[idx].min;
+	ms.max = m->sm_stats[idx].max;
+	ms.avg = m->sm_stats[idx].mean;
+	ms.var = m->sm_stats[idx].Variance();
 
 	// By default use main metrics description
 	if ((m->sm_desc == NULL) || (m->sm_desc[0] == NULL)) {
@@ -572,12 +1088,10 @@ void
 MetricsCollector::DumpSample(SamplesMetric *m) {
 	MetricStats<double> ms;
 
-	if (count(*m->pstat)) {
-		ms.min = min(*m->pstat);
-		ms.max = max(*m->pstat);
-		ms.avg = mean(*m->pstat);
-		ms.var = variance(*m->pstat);
-	}
+	ms.min = m->stats.min;
+	ms.max = m->stats.max;
+	ms.avg = m->stats.mean;
+	ms.var = m->stats.Variance();
 	logger->Notice(
 		" %-20s | %9.3f | %9.3f | %9.3f | %9.3f : %s",
 		m->name, ms.min, ms.max, ms.avg, ::sqrt(ms.var), m->desc);
@@ -662,6 +1176,57 @@ MetricsCollector::DumpPeriod(PeriodMetric *m) {
 
 }
 
+void
+MetricsCollector::DumpHistogramSM(HistogramMetric *m, uint8_t idx) {
+	Histogram &h(m->sm_hist[idx]);
+	char _name[21], _desc[64];
+	uint8_t i;
+
+	// Setup sub-metric name
+	snprintf(_name, 21, "%s[%02hu]", m->name, idx);
+
+	// By default use main metrics description
+	if ((m->sm_desc == NULL) || (m->sm_desc[0] == NULL)) {
+		snprintf(_desc, 64, "%s [%02d]", m->desc, idx);
+		goto dump_histogram_sm;
+	}
+
+	// Use the last valid provided description
+	for (i = 0; m->sm_desc[i] && (i < idx); ++i) {}
+	// This is needed to handle the special case of just one
+	// submetric description provided
+	if (i < idx || !m->sm_desc[i]) --i;
+
+	// Setup the sub-metric description
+	snprintf(_desc, 64, "%s [%02d]", m->sm_desc[i], idx);
+
+dump_histogram_sm:
+	// Dump sub-metric
+	logger->Notice(
+		" %-20s | %9" PRIu64 " | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f :   %s",
+		_name, h.count, h.Mean(),
+		h.Percentile(50), h.Percentile(90), h.Percentile(99),
+		h.Percentile(99.9), h.Percentile(100), _desc);
+}
+
+void
+MetricsCollector::DumpHistogram(HistogramMetric *m) {
+	Histogram &h(m->hist);
+
+	logger->Notice(
+		" %-20s | %9" PRIu64 " | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f | %9.3f : %s",
+		m->name, h.count, h.Mean(),
+		h.Percentile(50), h.Percentile(90), h.Percentile(99),
+		h.Percentile(99.9), h.Percentile(100), m->desc);
+
+	if (!m->HasSubmetrics())
+		return;
+
+	for (uint8_t idx = 0; idx < m->sm_count; ++idx)
+		DumpHistogramSM(m, idx);
+
+}
+
 #define METRICS_COUNTER_HEADER \
 "  Metric              |  Count    |  Description"
 #define METRICS_COUNTER_SEPARATOR \
@@ -682,10 +1247,19 @@ MetricsCollector::DumpPeriod(PeriodMetric *m) {
 #define METRICS_PERIOD_SEPARATOR \
 "----------------------+-----------------------+-----------------------+-----------------------+--------------------------+----------------------"
 
+#define METRICS_HISTOGRAM_HEADER \
+"  Metric              |  Count    |  Avg      |  p50      |  p90      |  p99      |  p99.9    |  Max      |  Description"
+#define METRICS_HISTOGRAM_SEPARATOR \
+"----------------------+-----------+-----------+-----------+-----------+-----------+-----------+-----------+----------------------"
+
 void
 MetricsCollector::DumpMetrics() {
+	std::unique_lock<std::mutex> metrics_ul(metrics_mtx);
 	MetricsMap_t::iterator it;
 
+	// Collect the metrics updated by all the threads
+	MergeShards();
+
 	logger->Notice("");
 	logger->Notice("==========[ Counter Metrics ]=========="
 			"========================================");
@@ -746,6 +1320,21 @@ MetricsCollector::DumpMetrics() {
 	logger->Notice(METRICS_PERIOD_SEPARATOR);
 
 
+	logger->Notice("");
+	logger->Notice("==========[ Histogram Metrics ]========"
+			"========================================");
+	logger->Notice("");
+
+	// Dumping HISTOGRAM metrics
+	logger->Notice(METRICS_HISTOGRAM_HEADER);
+	logger->Notice(METRICS_HISTOGRAM_SEPARATOR);
+	it = metricsVec[HISTOGRAM].begin();
+	for ( ; it != metricsVec[HISTOGRAM].end(); ++it) {
+		DumpHistogram((HistogramMetric*)(((*it).second).get()));
+	}
+	logger->Notice(METRICS_HISTOGRAM_SEPARATOR);
+
+
 }
 
 
@@ -754,7 +1343,8 @@ MetricsCollector::metricClassName[MetricsCollector::CLASSES_COUNT] = {
 	"Counter",
 	"Value",
 	"Samples",
-	"Period"
+	"Period",
+	"Histogram"
 };
 
 
@@ -20,7 +20,6 @@
 #include <cstdlib>
 
 #include <sys/ioctl.h>
-#include <sys/prctl.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -32,7 +31,8 @@
 namespace bbque { namespace utils {
 
 Perf::Perf() :
-	opened(false) {
+	opened(false),
+	grouped(false) {
 
 }
 
@@ -49,6 +49,8 @@ Perf::~Perf() {
 
 	// Release the group leader
 	pGroupLeader.reset();
+	group.clear();
+	standalone.clear();
 
 	// clean-up the registered counters list
 	counters.clear();
@@ -67,13 +69,12 @@ int Perf::EventOpen(struct perf_event_attr *attr,
 	result = syscall(__NR_perf_event_open, attr, pid, cpu,
 			group_fd, flags);
 	if (result == -1) {
-		fprintf(stderr, FE("Opening PERF counters FAILED "
-					"(Error: %s)\n"), strerror(errno));
+		DB(fprintf(stderr, FD("Opening PERF counter FAILED "
+					"(Error: %s)\n"), strerror(errno)));
 	} else {
 		opened = true;
 	}
 
-	assert(result >= 0);
 	return result;
 }
 
@@ -92,23 +93,58 @@ int Perf::AddCounter(perf_type_id type,
 		prc->attr.exclude_hv = 1;
 	}
 
-	// Define read format
-	prc->attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | \
-							PERF_FORMAT_TOTAL_TIME_RUNNING;
-
 	// Define the event to read
 	prc->attr.type = type;
 	prc->attr.config = config;
 
-	// Add a new event counter
-	prc->fd = EventOpen(&(prc->attr), gettid(), -1, -1, 0);
-	//prc->fd = EventOpen(&(prc->attr), gettid(), -1, GroupLeader(), 0);
+	// Try to add the new event counter to the group: the group leader
+	// controls the whole group, thus other counters are enabled by default
+	prc->attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | \
+							PERF_FORMAT_TOTAL_TIME_RUNNING | \
+							PERF_FORMAT_GROUP | \
+							PERF_FORMAT_ID;
+	if (!IsGroupLeaderDefined()) {
+		prc->fd = EventOpen(&(prc->attr), gettid(), -1, -1, 0);
+		grouped = (prc->fd != -1);
+	} else if (grouped) {
+		prc->attr.disabled = 0;
+		prc->fd = EventOpen(&(prc->attr), gettid(), -1, GroupLeader(), 0);
+	}
+
+	// Fall back to a standalone counter, e.g. if the group could not
+	// be scheduled with this counter
+	if (prc->fd == -1) {
+		prc->attr.disabled = 1;
+		prc->attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | \
+								PERF_FORMAT_TOTAL_TIME_RUNNING;
+		prc->fd = EventOpen(&(prc->attr), gettid(), -1, -1, 0);
+	}
+	if (prc->fd == -1) {
+		fprintf(stderr, FE("Opening PERF counters FAILED "
+					"(Error: %s)\n"), strerror(errno));
+		assert(prc->fd >= 0);
+		return -1;
+	}
 
 	// Keep track of GroupLeader
 	if (!IsGroupLeaderDefined()) {
 		pGroupLeader = prc;
 	}
 
+	// Keep track of group counters, and of their kernel IDs
+	if (prc->attr.read_format & PERF_FORMAT_GROUP) {
+#ifdef PERF_EVENT_IOC_ID
+		if (::ioctl(prc->fd, PERF_EVENT_IOC_ID, &prc->id) == -1)
+			prc->id = 0;
+#endif
+		prc->group_idx = group.size();
+		group.push_back(prc);
+		group_buff.resize(sizeof(ReadFormatGroup_t) / sizeof(uint64_t) +
+				2 * group.size());
+	} else {
+		standalone.push_back(prc);
+	}
+
 	counters[prc->fd] = prc;
 
 	fprintf(stderr, FI("Added new PERF counter [%02d:%d:%02lu]\n"),
@@ -124,8 +160,11 @@ int Perf::Enable() {
 		return -1;
 	}
 
-	prctl(PR_TASK_PERF_EVENTS_ENABLE);
-	//::ioctl(GroupLeader(), PERF_EVENT_IOC_ENABLE);
+	// Enable the whole group at once
+	if (grouped)
+		::ioctl(GroupLeader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	for (size_t i = 0; i < standalone.size(); ++i)
+		::ioctl(standalone[i]->fd, PERF_EVENT_IOC_ENABLE, 0);
 	DB(fprintf(stderr, FD("PERF counters (GL:%d) ENABLED\n"),
 			GroupLeader()));
 
@@ -139,8 +178,11 @@ int Perf::Disable() {
 		return 0;
 	}
 
-	prctl(PR_TASK_PERF_EVENTS_DISABLE);
-	//::ioctl(GroupLeader(), PERF_EVENT_IOC_DISABLE);
+	// Disable the whole group at once
+	if (grouped)
+		::ioctl(GroupLeader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	for (size_t i = 0; i < standalone.size(); ++i)
+		::ioctl(standalone[i]->fd, PERF_EVENT_IOC_DISABLE, 0);
 	DB(fprintf(stderr, FD("PERF counters (GL:%d) DISABLED\n"),
 				GroupLeader()));
 
@@ -161,29 +203,16 @@ int Perf::ReadCounter(int fd, void *buf, size_t n) {
 }
 
 #define UPDATE_DELTA(COUNTER)\
-	prc->delta.COUNTER = prc->count.COUNTER - old_count.COUNTER
+	prc->delta.COUNTER = count.COUNTER - prc->count.COUNTER
 
-uint64_t Perf::Update(int id, bool delta) {
-	pRegisteredCounter_t prc = counters[id];
-	ReadFormat_t old_count = prc->count;
-	ssize_t bytes;
-
-	if (!opened || !prc) {
-		fprintf(stderr, FE("Reading PERF counter FAILED "
-					"(Error: Counters not opened or invalid counter [%d])\n"),
-				id);
-		return 0;
-	}
-
-	// Reading counters
-	bytes = ReadCounter(id, &(prc->count), sizeof(prc->count));
-	assert(bytes == sizeof(prc->count));
-	(void)bytes; // quite compilation warning on RELEASE build
+void Perf::UpdateCounter(pRegisteredCounter_t prc,
+		ReadFormat_t const & count) {
 
 	// Update deltas since last update
 	UPDATE_DELTA(value);
 	UPDATE_DELTA(time_enabled);
 	UPDATE_DELTA(time_running);
+	prc->count = count;
 
 	DB(fprintf(stderr, FD("Counter [%d:%" PRIu32 ":%llu]: "
 					"cV [%" PRIu64 "], cE [%" PRIu64 "], cR [%" PRIu64 "] "
@@ -195,6 +224,84 @@ uint64_t Perf::Update(int id, bool delta) {
 				prc->delta.value,
 				prc->delta.time_enabled,
 				prc->delta.time_running));
+}
+
+int Perf::UpdateGroup() {
+	ReadFormatGroup_t *pgrp = (ReadFormatGroup_t *)&group_buff[0];
+	size_t size = group_buff.size() * sizeof(uint64_t);
+	pRegisteredCounter_t prc;
+	ReadFormat_t count;
+	ssize_t bytes;
+
+	// Reading all the group counters at once
+	bytes = ReadCounter(GroupLeader(), pgrp, size);
+	if ((bytes < (ssize_t)sizeof(ReadFormatGroup_t)) ||
+			(pgrp->nr != group.size())) {
+		fprintf(stderr, FE("Reading PERF counters group FAILED\n"));
+		return -1;
+	}
+
+	count.time_enabled = pgrp->time_enabled;
+	count.time_running = pgrp->time_running;
+	for (uint64_t i = 0; i < pgrp->nr; ++i) {
+		prc = group[i];
+		// NOTE: the kernel returns the group counters in the order they
+		// have been added to the group
+		assert(!prc->id || (prc->id == pgrp->values[i].id));
+		count.value = pgrp->values[i].value;
+		UpdateCounter(prc, count);
+	}
+
+	return 0;
+}
+
+int Perf::Update() {
+	ReadFormat_t count;
+	ssize_t bytes;
+	int result = 0;
+
+	if (!opened) {
+		fprintf(stderr, FE("Reading PERF counters FAILED "
+					"(Error: Counters not opened)\n"));
+		return -1;
+	}
+
+	if (grouped && (UpdateGroup() != 0))
+		result = -1;
+
+	for (size_t i = 0; i < standalone.size(); ++i) {
+		bytes = ReadCounter(standalone[i]->fd, &count, sizeof(count));
+		if (bytes != sizeof(count)) {
+			result = -1;
+			continue;
+		}
+		UpdateCounter(standalone[i], count);
+	}
+
+	return result;
+}
+
+uint64_t Perf::Update(int id, bool delta) {
+	pRegisteredCounter_t prc = counters[id];
+	ReadFormat_t count;
+	ssize_t bytes;
+
+	if (!opened || !prc) {
+		fprintf(stderr, FE("Reading PERF counter FAILED "
+					"(Error: Counters not opened or invalid counter [%d])\n"),
+				id);
+		return 0;
+	}
+
+	// Reading counters
+	if (prc->group_idx != -1) {
+		UpdateGroup();
+	} else {
+		bytes = ReadCounter(id, &count, sizeof(count));
+		assert(bytes == sizeof(count));
+		(void)bytes; // quite compilation warning on RELEASE build
+		UpdateCounter(prc, count);
+	}
 
 	if (delta)
 		return (prc->delta).value;
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/utils/trace.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define RING_MASK (BBQUE_TRACE_RING_RECORDS - 1)
+
+namespace bbque { namespace utils {
+
+/**
+ * @brief The ring of records of a thread
+ *
+ * The ring is written only by its owner thread, which publishes each new
+ * record by advancing the head. A reader copying the ring concurrently
+ * checks the head again afterwards, to discard the records which could have
+ * been overwritten meanwhile.
+ */
+typedef struct TraceRing {
+	/** The index of the next record to write */
+	uint64_t head;
+	/** The ID of the owner thread */
+	uint32_t tid;
+	/** The records */
+	trace_record_t records[BBQUE_TRACE_RING_RECORDS];
+} TraceRing_t;
+
+/** The ring of the current thread */
+static __thread TraceRing_t *tlsRing = NULL;
+
+/** Serialize rings setup, names interning and dumps */
+static pthread_mutex_t trace_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+/** All the rings ever allocated */
+static std::vector<TraceRing_t *> rings;
+
+/** The rings released by terminated threads, ready to be recycled */
+static std::vector<TraceRing_t *> freeRings;
+
+/** The key used to release a ring on thread termination */
+static pthread_key_t ring_key;
+static bool ring_key_valid = false;
+
+/** The tracepoint names, indexed by name ID (0 is reserved for overflows) */
+static char names[BBQUE_TRACE_NAMES_MAX][BBQUE_TRACE_NAME_LENGTH] = {
+	"overflow"
+};
+static uint16_t nr_names = 1;
+
+
+static void ReleaseRing(void *ring) {
+	pthread_mutex_lock(&trace_mtx);
+	freeRings.push_back((TraceRing_t *)ring);
+	pthread_mutex_unlock(&trace_mtx);
+}
+
+static TraceRing_t *GetRing() {
+	TraceRing_t *ring;
+
+	pthread_mutex_lock(&trace_mtx);
+
+	if (!ring_key_valid)
+		ring_key_valid = (pthread_key_create(&ring_key, ReleaseRing) == 0);
+
+	// Recycle the ring of a terminated thread, if any: its records are
+	// still valid, since each of them keeps track of its thread
+	if (!freeRings.empty()) {
+		ring = freeRings.back();
+		freeRings.pop_back();
+	} else {
+		ring = new TraceRing_t;
+		ring->head = 0;
+		rings.push_back(ring);
+	}
+	ring->tid = syscall(SYS_gettid);
+
+	if (ring_key_valid)
+		pthread_setspecific(ring_key, ring);
+
+	pthread_mutex_unlock(&trace_mtx);
+
+	tlsRing = ring;
+	return ring;
+}
+
+static inline trace_record_t *Append(TraceRing_t * & ring, uint64_t & idx) {
+	struct timespec ts;
+	trace_record_t *rec;
+
+	if (!tlsRing)
+		GetRing();
+	ring = tlsRing;
+
+	idx = ring->head;
+	rec = &ring->records[idx & RING_MASK];
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	rec->tstamp_ns = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	rec->tid = ring->tid;
+	return rec;
+}
+
+uint16_t Tracer::Intern(const char *name) {
+	uint16_t id;
+
+	pthread_mutex_lock(&trace_mtx);
+
+	// Tracepoints sharing the same name (e.g. the begin and the end of a
+	// phase) share also the same ID
+	for (id = 1; id < nr_names; ++id) {
+		if (!strncmp(names[id], name, BBQUE_TRACE_NAME_LENGTH - 1))
+			break;
+	}
+	if (id == nr_names) {
+		if (nr_names < BBQUE_TRACE_NAMES_MAX) {
+			strncpy(names[id], name, BBQUE_TRACE_NAME_LENGTH - 1);
+			++nr_names;
+		} else {
+			id = 0;
+		}
+	}
+
+	pthread_mutex_unlock(&trace_mtx);
+	return id;
+}
+
+void Tracer::Record(uint8_t type, uint8_t cat, uint16_t name,
+		uint64_t arg, uint64_t arg2) {
+	TraceRing_t *ring;
+	trace_record_t *rec;
+	uint64_t idx;
+
+	rec = Append(ring, idx);
+	rec->name = name;
+	rec->type = type;
+	rec->cat = cat;
+	rec->arg.u64 = arg;
+	rec->arg2 = arg2;
+
+	__atomic_store_n(&ring->head, idx + 1, __ATOMIC_RELEASE);
+}
+
+void Tracer::Counter(uint8_t cat, uint16_t name, double value,
+		uint64_t arg2) {
+	TraceRing_t *ring;
+	trace_record_t *rec;
+	uint64_t idx;
+
+	rec = Append(ring, idx);
+	rec->name = name;
+	rec->type = COUNTER;
+	rec->cat = cat;
+	rec->arg.dbl = value;
+	rec->arg2 = arg2;
+
+	__atomic_store_n(&ring->head, idx + 1, __ATOMIC_RELEASE);
+}
+
+int Tracer::Dump(const char *path) {
+	std::vector<trace_record_t> recs(BBQUE_TRACE_RING_RECORDS);
+	trace_header_t hdr;
+	uint64_t base, first, head, idx;
+	int result = 0;
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	if (!fp)
+		return -errno;
+
+	pthread_mutex_lock(&trace_mtx);
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = BBQUE_TRACE_MAGIC;
+	hdr.version = BBQUE_TRACE_VERSION;
+	hdr.nr_names = nr_names;
+
+	// The header is re-written at the end, once records have been counted
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	fwrite(names, BBQUE_TRACE_NAME_LENGTH, nr_names, fp);
+
+	for (size_t i = 0; i < rings.size(); ++i) {
+		TraceRing_t *ring = rings[i];
+
+		head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		base = (head > BBQUE_TRACE_RING_RECORDS) ?
+			head - BBQUE_TRACE_RING_RECORDS : 0;
+		for (idx = base; idx < head; ++idx)
+			recs[idx - base] = ring->records[idx & RING_MASK];
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		// The record at the current head could be under update,
+		// thus only the records following its slot are still valid
+		first = base;
+		idx = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+		if (idx >= first + BBQUE_TRACE_RING_RECORDS)
+			first = idx - BBQUE_TRACE_RING_RECORDS + 1;
+		if (first >= head) {
+			hdr.nr_lost += head;
+			continue;
+		}
+		hdr.nr_lost += first;
+
+		fwrite(&recs[first - base], sizeof(trace_record_t),
+				head - first, fp);
+		hdr.nr_records += head - first;
+	}
+
+	pthread_mutex_unlock(&trace_mtx);
+
+	if (fseek(fp, 0, SEEK_SET) == 0)
+		fwrite(&hdr, sizeof(hdr), 1, fp);
+	if (ferror(fp))
+		result = -EIO;
+	fclose(fp);
+
+	return result;
+}
+
+} // namespace utils
+
+} // namespace bbque
@@ -18,11 +18,16 @@
 #ifndef BBQUE_WORKING_MODE_H_
 #define BBQUE_WORKING_MODE_H_
 
+#include <memory>
+
 #include "bbque/app/working_mode_conf.h"
 #include "bbque/plugins/logger.h"
+#include "bbque/utils/arena.h"
 
 #define AWM_NAMESPACE "ap.awm"
 
+using bbque::utils::ArenaAllocator;
+
 namespace bbque { namespace app {
 
 
@@ -32,6 +37,11 @@ namespace bbque { namespace app {
  * Each Application object should be filled with a list of WorkingMode.
  * A "working mode" is characterized by a set of resource usage request and a
  * "value" which expresses a level of Quality of Service
+ *
+ * The information from the recipe (ID, name, value and resource usages) is
+ * immutable once the recipe has been loaded, thus it is shared by the AWMs of
+ * all the EXCs using the same recipe. Each AWM instance keeps just the state
+ * of its scheduling: the owner, the resource bindings and the clusters.
  */
 class WorkingMode: public WorkingModeConfIF {
 
@@ -51,6 +61,18 @@ public:
 	explicit WorkingMode(uint8_t id, std::string const & name,
 			float value);
 
+	/**
+	 * @brief Build an instance of a recipe working mode
+	 *
+	 * The instance shares the recipe information of the specified working
+	 * mode, and gets an empty scheduling state.
+	 *
+	 * @param rcp_awm The working mode from the recipe
+	 * @param papp The application owning the instance
+	 */
+	explicit WorkingMode(WorkingMode const & rcp_awm,
+			AppSPtr_t const & papp);
+
 	/**
 	 * @brief Default destructor
 	 */
@@ -60,14 +82,14 @@ public:
 	 * @see WorkingModeStatusIF
 	 */
 	inline std::string const & Name() const {
-		return name;
+		return info->name;
 	}
 
 	/**
 	 * @see WorkingModeStatusIF
 	 */
 	inline uint8_t Id() const {
-		return id;
+		return info->id;
 	}
 
 	/**
@@ -75,7 +97,7 @@ public:
 	 * @param wm_name The name
 	 */
 	inline void SetName(std::string const & wm_name) {
-		name = wm_name;
+		info->name = wm_name;
 	}
 
 	/**
@@ -107,21 +129,21 @@ public:
 	 * @return true if the AWM is hidden, false otherwise.
 	 */
 	inline bool Hidden() const {
-		return hidden;
+		return info->hidden;
 	}
 
 	/**
 	 * @brief Return the value specified in the recipe
 	 */
 	inline float RecipeValue() const {
-		return value.recpv;
+		return info->value.recpv;
 	}
 
 	/**
 	 * @see WorkingModeStatusIF
 	 */
 	inline float Value() const {
-		return value.normal;
+		return info->value.normal;
 	}
 
 	/**
@@ -135,10 +157,10 @@ public:
 	inline void SetRecipeValue(float r_value) {
 		// Value must be positive
 		if (r_value < 0) {
-			value.recpv = 0.0;
+			info->value.recpv = 0.0;
 			return;
 		}
-		value.recpv = r_value;
+		info->value.recpv = r_value;
 	}
 
 	/**
@@ -155,10 +177,10 @@ public:
 		if ((n_value < 0.0) || (n_value > 1.0)) {
 			logger->Error("SetNormalValue: value not normalized (v = %2.2f)",
 					n_value);
-			value.normal = 0.0;
+			info->value.normal = 0.0;
 			return;
 		}
-		value.normal = n_value;
+		info->value.normal = n_value;
 	}
 
 	/**
@@ -200,14 +222,14 @@ public:
 	 * @see WorkingModeStatusIF
 	 */
 	inline UsagesMap_t const & RecipeResourceUsages() const {
-		return resources.from_recp;
+		return info->from_recp;
 	}
 
 	/**
 	 * @see WorkingModeStatusIF
 	 */
 	inline size_t NumberOfResourceUsages() const {
-		return resources.from_recp.size();
+		return info->from_recp.size();
 	}
 
 	/**
@@ -218,35 +240,48 @@ public:
 
 	/**
 	 * @see WorkingModeStatusIF
+	 *
+	 * @note The map is allocated on the scheduling arena, thus it is valid
+	 * up to the next scheduling run.
 	 */
-	inline UsagesMapPtr_t GetSchedResourceBinding(uint8_t bid = 0) const {
-		return resources.on_sched[bid];
-	}
+	UsagesMapPtr_t GetSchedResourceBinding(uint8_t bid = 0) const;
+
+	/**
+	 * @brief Get a copy on the heap of a resource binding to schedule
+	 *
+	 * The copy includes the Usage objects and their binding lists, thus it
+	 * outlives the scheduling run, e.g. to be booked.
+	 *
+	 * @param bid The resource binding ID
+	 * @return A new map of resource usages, or an empty pointer if there
+	 * is no such binding
+	 */
+	UsagesMapPtr_t CopySchedResourceBinding(uint8_t bid = 0) const;
 
 	/**
 	 * @brief Set the resource binding to schedule
 	 *
-	 * This binds the map of resource usages pointed by "resources.on_sched"
-	 * to the WorkingMode. The map will contain Usage objects
-	 * specifying the the amount of resource requested (value) and a list of
-	 * system resource descriptors to which bind the request.
+	 * This binds the map of resource usages specified to the WorkingMode.
+	 * The map will contain Usage objects specifying the the amount of
+	 * resource requested (value) and a list of system resource descriptors
+	 * to which bind the request.
 	 *
 	 * This method is invoked during the scheduling step to track the set of
 	 * resources to acquire at the end of the synchronization step.
 	 *
-	 * @param bid The scheduling binding id to set ready for synchronization
-	 * (optional)
+	 * @param binding The map of resource usages to set ready for
+	 * synchronization, i.e. a copy (on the heap) of a binding built by
+	 * BindResource
 	 *
 	 * @return WM_SUCCESS, or WM_RSRC_MISS_BIND if some bindings are missing
 	 */
-	ExitCode_t SetResourceBinding(uint8_t bid = 0);
+	ExitCode_t SetResourceBinding(UsagesMapPtr_t const & binding);
 
 	/**
 	 * @see WorkingModeConfIF
 	 */
 	inline void ClearSchedResourceBinding() {
-		resources.on_sched.clear();
-		resources.on_sched.resize(MAX_NUM_BINDINGS);
+		resources.on_sched = nullptr;
 	}
 
 	/**
@@ -306,21 +341,6 @@ private:
 	 */
 	AppSPtr_t owner;
 
-	/** A numerical ID  */
-	uint8_t id;
-
-	/** A descriptive name */
-	std::string name;
-
-	/**
-	 * Whether the AWM includes resource requirements that cannot be
-	 * satisfied by the current hardware platform/configuration it can be
-	 * flagged as hidden. The idea is to support a dynamic reconfiguration
-	 * of the underlying hardware such that some AWMs could be dynamically
-	 * taken into account or not at runtime.
-	 */
-	bool hidden;
-
 	/**
 	 * @struct WorkingModeValue
 	 *
@@ -332,20 +352,66 @@ private:
 		float recpv;
 		/** The normalized QoS value associated to the working mode */
 		float normal;
-	} value;
+	};
+
+	/**
+	 * @struct WorkingModeInfo
+	 *
+	 * Store the information about the AWM specified in the recipe. This is
+	 * set while loading the recipe, and then shared (read-only) by all the
+	 * instances of the AWM.
+	 */
+	struct WorkingModeInfo {
+		/** A numerical ID  */
+		uint8_t id;
+		/** A descriptive name */
+		std::string name;
+		/**
+		 * Whether the AWM includes resource requirements that cannot be
+		 * satisfied by the current hardware platform/configuration it can
+		 * be flagged as hidden. The idea is to support a dynamic
+		 * reconfiguration of the underlying hardware such that some AWMs
+		 * could be dynamically taken into account or not at runtime.
+		 */
+		bool hidden;
+		/** The value of the AWM */
+		WorkingModeValue value;
+		/** The map of resources usages from the recipe  */
+		UsagesMap_t from_recp;
+	};
+
+	/** The recipe information, shared among the AWM instances */
+	std::shared_ptr<WorkingModeInfo> info;
+
+	/**
+	 * @struct SchedBinding
+	 *
+	 * A resource binding built by the scheduling policy
+	 */
+	typedef struct SchedBinding {
+		/** The binding ID */
+		uint8_t bid;
+		/** The map of resource usages, on the scheduling arena */
+		UsagesMap_t * usages;
+	} SchedBinding_t;
+
+	/** The resource bindings built in a scheduling run */
+	typedef std::vector<SchedBinding_t, ArenaAllocator<SchedBinding_t>>
+		SchedBindings_t;
 
 	/**
 	 * @struct ResourceUsagesInfo
 	 *
-	 * Store information about the resource requests specified in the recipe
-	 * and the bindings built by the scheduling policy
+	 * Store information about the bindings built by the scheduling policy
 	 */
 	struct ResourceUsagesInfo {
-		/** The map of resources usages from the recipe  */
-		UsagesMap_t from_recp;
-		/** The temporary map of resource bindings. This is built by the
-		 * BindResource calls */
-		std::vector<UsagesMapPtr_t> on_sched;
+		/** The temporary maps of resource bindings. These are built by the
+		 * BindResource calls, just for the binding IDs used, and they are
+		 * released all together at the beginning of the next scheduling
+		 * run */
+		SchedBindings_t * on_sched;
+		/** The scheduling arena generation of the temporary bindings */
+		uint32_t on_sched_gen;
 		/** The map of the resource bindings allocated for the working mode.
 		 * This is set by SetResourceBinding() as a commit of the
 		 * bindings performed, reasonably by the scheduling policy.	 */
@@ -384,6 +450,23 @@ private:
 	 * missing, the recipe map is considered.
 	 */
 	UsagePtr_t ResourceUsageRef(std::string const & rsrc_path) const;
+
+	/**
+	 * @brief Get the temporary bindings of the current scheduling run
+	 *
+	 * The bindings built in a previous run are ignored, since their
+	 * memory has been released by the scheduling arena reset.
+	 *
+	 * @return The bindings vector, or null if missing
+	 */
+	SchedBindings_t * SchedBindings() const;
+
+	/**
+	 * @brief Get the temporary binding with the specified ID
+	 *
+	 * @return The binding, or null if missing
+	 */
+	SchedBinding_t * SchedBindingRef(uint8_t bid) const;
 };
 
 } // namespace app
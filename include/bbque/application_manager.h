@@ -26,6 +26,7 @@
 #include "bbque/utils/deferrable.h"
 #include "bbque/plugins/logger.h"
 #include "bbque/cpp11/mutex.h"
+#include "bbque/cpp11/thread.h"
 
 #define APPLICATION_MANAGER_NAMESPACE "bq.am"
 
@@ -318,6 +319,19 @@ public:
 	 */
 	void PrintStatusReport(bool verbose = false);
 
+	/**
+	 * @brief Start the recipes prefetch and watcher
+	 *
+	 * All the recipes found into the recipes directory are loaded in
+	 * parallel, thus the registration of the applications using them does
+	 * not have to parse them. Then, the recipes directory is watched, and
+	 * the recipes which change are loaded again in background.
+	 *
+	 * @note This must be called once the platform resources have been
+	 * registered, since the recipes are checked against them.
+	 */
+	void StartRecipesPrefetch();
+
 private:
 
 	/** The logger used by the application manager */
@@ -381,6 +395,30 @@ private:
 	 */
 	std::mutex recipes_mtx;
 
+	/**
+	 * A mutex for serializing the parsing of recipes by the recipe loader
+	 * module, which keeps the state of the recipe being parsed. This is not
+	 * acquired by the registration of applications using an already loaded
+	 * recipe.
+	 */
+	std::mutex rloader_mtx;
+
+	/**
+	 * The recipe loader modules used by the prefetch workers, one for each
+	 * worker, since a module parses a single recipe at a time. These are
+	 * released once the prefetch has been completed.
+	 */
+	std::vector<RecipeLoaderIF *> prefetch_rloaders;
+
+	/** The recipes prefetch and watcher thread */
+	std::thread recipes_thd;
+
+	/** The pipe used to wake-up the recipes watcher thread */
+	int recipes_wakeup_fd[2];
+
+	/** Set true to terminate the recipes prefetch and watcher */
+	bool recipes_done;
+
 
 	/**
 	 * Priority vector of currently scheduled applications (actives).
@@ -458,6 +496,34 @@ private:
 	RecipeLoaderIF::ExitCode_t LoadRecipe(std::string const & _recipe_name,
 			RecipePtr_t & _recipe, bool weak_load = false);
 
+	/**
+	 * @brief Get the names of the recipes into the recipes directory
+	 */
+	void ListRecipes(std::string const & dir,
+			std::vector<std::string> & names);
+
+	/**
+	 * @brief A recipes prefetch worker
+	 *
+	 * Load the recipes of the specified list, starting from the one
+	 * pointed by the (shared) index, which is atomically incremented.
+	 * Only the recipes fully loaded are cached.
+	 */
+	void PrefetchRecipes(RecipeLoaderIF * loader,
+			std::vector<std::string> const & names, uint32_t * next);
+
+	/**
+	 * @brief Load again a changed recipe, or forget a removed one
+	 *
+	 * The applications already using the recipe keep the previous one.
+	 */
+	void ReloadRecipe(std::string const & name);
+
+	/**
+	 * @brief The recipes prefetch and watcher thread
+	 */
+	void RecipesTask();
+
 	/**
 	 * Remove the specified application from the priority maps
 	 */
@@ -21,10 +21,12 @@
 #include "bbque/app/application.h"
 #include "bbque/plugins/logger.h"
 #include "bbque/plugins/rpc_channel.h"
+#include "bbque/rtlib/awm_mailbox.h"
 #include "bbque/rtlib/rpc_messages.h"
 #include "bbque/cpp11/thread.h"
 #include "bbque/cpp11/future.h"
 
+#include <deque>
 #include <map>
 #include <memory>
 
@@ -75,6 +77,8 @@ private:
 		std::mutex resp_mtx;
 		std::condition_variable resp_cv;
 		pchMsg_t pmsg;
+		/** Set once nobody is waiting for the response anymore */
+		bool expired;
 	} cmdSn_t;
 
 	typedef std::shared_ptr<cmdSn_t> pcmdSn_t;
@@ -196,6 +200,12 @@ private:
 		char app_name[RTLIB_APP_NAME_LENGTH];
 		/** The communication channel data to connect the applicaton */
 		RPCChannelIF::plugin_data_t pd;
+		/** The application AWM mailbox, NULL if not available */
+		rtlib::awm_mailbox_t *mbox;
+		/** The mutex protecting the AWM mailbox mapping */
+		std::mutex mbox_mtx;
+
+		conCtx() : mbox(NULL) {};
 	} conCtx_t;
 
 	typedef std::shared_ptr<conCtx_t> pconCtx_t;
@@ -212,6 +222,19 @@ private:
 
 	typedef std::shared_ptr<rqsSn_t> prqsSn_t;
 
+	/**
+	 * @brief The requests pending for each EXC
+	 *
+	 * Requests of the same EXC are served in order by a single executor,
+	 * since pipelined requests are sent without waiting for their
+	 * responses. Requests of different EXCs are still served concurrently.
+	 */
+	typedef std::map<AppUid_t, std::deque<pchMsg_t> > rqsQueueMap_t;
+
+	rqsQueueMap_t rqsQueueMap;
+
+	std::mutex rqsQueueMap_mtx;
+
 
 	/**
 	 * @brief	A multimap to track active Command Sessions.
@@ -312,6 +335,36 @@ private:
 	RTLIB_ExitCode SyncP_PostChange(pcmdSn_t pcs, pPostChangeRsp_t presp);
 
 
+/*******************************************************************************
+ * AWM Mailbox
+ ******************************************************************************/
+
+	/**
+	 * @brief Create the AWM mailbox of a newly paired application
+	 *
+	 * The segment is owned by Barbeque, and it is read-only for the
+	 * application. A failure is not fatal, since the application then
+	 * relies just on the synchronization protocol.
+	 */
+	void MailboxSetup(pconCtx_t pcon);
+
+	/**
+	 * @brief Publish the scheduling status of an EXC into its mailbox
+	 *
+	 * This is a no-op if the application mailbox is not available.
+	 *
+	 * @param pcon the connection context of the application
+	 * @param papp the EXC which status is published
+	 * @param flags the AWM_MBOX_* status flags
+	 */
+	void MailboxPublish(pconCtx_t pcon, AppPtr_t papp, uint8_t flags);
+
+	/**
+	 * @brief Unmap and remove the mailbox of an application
+	 */
+	void MailboxRelease(pconCtx_t pcon);
+
+
 /*******************************************************************************
  * Request Sessions
  ******************************************************************************/
@@ -352,6 +405,14 @@ private:
 
 	void RequestExecutor(prqsSn_t prqs);
 
+	/**
+	 * @brief Get the next request queued for the same EXC
+	 *
+	 * @return true if the request session has been set to serve the next
+	 * request, false if there are no more requests for the EXC
+	 */
+	bool NextRequest(prqsSn_t prqs, AppUid_t rqs_uid);
+
 	void ProcessRequest(pchMsg_t & pmsg);
 
 
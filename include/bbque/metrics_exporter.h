@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_METRICS_EXPORTER_H_
+#define BBQUE_METRICS_EXPORTER_H_
+
+#include "bbque/config.h"
+#include "bbque/plugins/logger.h"
+#include "bbque/cpp11/condition_variable.h"
+#include "bbque/cpp11/mutex.h"
+#include "bbque/cpp11/thread.h"
+#include "bbque/utils/metrics_collector.h"
+
+#include <cstdint>
+#include <string>
+
+#define METRICS_EXPORTER_NAMESPACE "bq.me"
+
+/** The default name of the metrics socket, into the run-time folder */
+#define BBQUE_METRICS_EXPORT_SOCK "bbque_metrics"
+
+/** The default period [ms] of metrics export to file */
+#define BBQUE_METRICS_EXPORT_PERIOD_DEFAULT 5000
+/** The default maximum size [kB] of a metrics file before rotating it */
+#define BBQUE_METRICS_EXPORT_FILE_SIZE_DEFAULT 1024
+/** The default number of rotated metrics files kept */
+#define BBQUE_METRICS_EXPORT_FILE_COUNT_DEFAULT 3
+
+/** The request of a client for a metrics snapshot in binary form */
+#define BBQUE_METRICS_EXPORT_REQ_BINARY "binary"
+
+#define BBQUE_METRICS_EXPORT_VERSION 1
+
+/** The magic number of a binary metrics snapshot */
+#define BBQUE_METRICS_EXPORT_MAGIC 0xBB0E3E7C
+
+#define BBQUE_METRICS_EXPORT_NAME_LENGTH 32
+
+using bbque::plugins::LoggerIF;
+using bbque::utils::MetricsCollector;
+
+namespace bbque {
+
+/**
+ * @brief The header of a binary metrics snapshot
+ */
+typedef struct metrics_export_header {
+	/** Set to BBQUE_METRICS_EXPORT_MAGIC */
+	uint32_t magic;
+	/** The snapshot layout version */
+	uint16_t version;
+	/** The number of records following this header */
+	uint16_t count;
+	/** The time [ms] the snapshot has been taken (since the Epoch) */
+	uint64_t tstamp_ms;
+} metrics_export_header_t;
+
+/**
+ * @brief A (sub-)metric of a binary metrics snapshot
+ *
+ * This mirrors a MetricsCollector::MetricSnapshot_t, thus only the fields
+ * relevant for the metric class are valid.
+ */
+typedef struct metrics_export_record {
+	/** The name of the metric (possibly truncated) */
+	char name[BBQUE_METRICS_EXPORT_NAME_LENGTH];
+	/** The class of the metric, i.e. a MetricsCollector::MetricClass_t */
+	uint8_t mc;
+	/** The index of the sub-metric, 0xFF for the main metric */
+	uint8_t sm_idx;
+	uint16_t reserved[3];
+	uint64_t count;
+	double value;
+	double min, max, mean, stddev;
+	double p50, p90, p99, p999;
+} metrics_export_record_t;
+
+
+/**
+ * @brief The Metrics Exporter module
+ *
+ * This module periodically exports the Barbeque metrics in a machine
+ * readable form, without affecting the control loop: metrics are copied
+ * into a snapshot, and then formatted by a dedicated thread.
+ * Snapshots are served on demand on a UNIX socket: a client connects, sends
+ * a request ("binary" for the binary form, anything else for the
+ * OpenMetrics text form) and reads the snapshot till the end of file.
+ * Optionally, text snapshots are also appended to a size rotated file.
+ */
+class MetricsExporter {
+
+public:
+
+	/**
+	 * @brief Get a reference to the metrics exporter
+	 */
+	static MetricsExporter & GetInstance();
+
+	/**
+	 * @brief Stop the exporter and release all its resources
+	 */
+	~MetricsExporter();
+
+	/**
+	 * @brief Start the metrics export service
+	 */
+	void Start();
+
+	/**
+	 * @brief Stop the metrics export service
+	 */
+	void Stop();
+
+	/**
+	 * @brief Format a snapshot in the OpenMetrics text form
+	 */
+	static void FormatText(MetricsCollector::MetricsSnapshot_t const & snap,
+			std::string & text);
+
+	/**
+	 * @brief Format a snapshot in the compact binary form
+	 */
+	static void FormatBinary(MetricsCollector::MetricsSnapshot_t const & snap,
+			std::string & bin);
+
+private:
+
+	/**
+	 * @brief The logger to use
+	 */
+	LoggerIF *logger;
+
+	/**
+	 * @brief The collector of the metrics to export
+	 */
+	MetricsCollector & mc;
+
+	/**
+	 * @brief The path of the UNIX socket, empty to disable it
+	 */
+	std::string sock_path;
+
+	/**
+	 * @brief The path of the metrics file, empty to disable it
+	 */
+	std::string file_path;
+
+	/**
+	 * @brief The period [ms] of metrics export to file
+	 */
+	uint32_t period_ms;
+
+	/**
+	 * @brief The maximum size [kB] of the metrics file
+	 */
+	uint32_t file_size;
+
+	/**
+	 * @brief The number of rotated metrics files
+	 */
+	uint16_t file_count;
+
+	/**
+	 * @brief The socket accepting clients connections
+	 */
+	int listen_fd;
+
+	/**
+	 * @brief The pipe used to wake-up the exporter thread
+	 */
+	int wakeup_fd[2];
+
+	/**
+	 * @brief The metrics export thread
+	 */
+	std::thread export_thd;
+
+	/**
+	 * @brief Set true once the export thread has been authorized to run
+	 */
+	bool trdRunning;
+
+	/**
+	 * @brief Set true to terminate the export thread
+	 *
+	 * This is polled by the export thread without locking, thus it is
+	 * always accessed atomically.
+	 */
+	bool done;
+
+	/**
+	 * @brief Mutex controlling the thread execution
+	 */
+	std::mutex trdStatus_mtx;
+
+	/**
+	 * @brief Conditional variable used to signal the export thread
+	 */
+	std::condition_variable trdStatus_cv;
+
+	/**
+	 * @brief Build a new metrics exporter
+	 */
+	MetricsExporter();
+
+	/**
+	 * @brief Setup the UNIX socket serving metrics snapshots
+	 */
+	int SetupSocket();
+
+	/**
+	 * @brief Serve a metrics snapshot to a new client
+	 */
+	void ServeClient();
+
+	/**
+	 * @brief Append a text metrics snapshot to the metrics file
+	 *
+	 * The file is rotated once it exceeds the configured size.
+	 */
+	void ExportFile();
+
+	/**
+	 * @brief The metrics export thread
+	 */
+	void Task();
+
+};
+
+} // namespace bbque
+
+#endif // BBQUE_METRICS_EXPORTER_H_
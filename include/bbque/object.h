@@ -35,7 +35,7 @@
  * Debugging support
  */
 # define DEBUG(fmt, ...) \
-	logger->Debug("%s@%s:%d - " fmt, \
+	BBQUE_LOG_DEBUG("%s@%s:%d - " fmt, \
 			__func__, __FILE__, __LINE__, ## __VA_ARGS__)
 #else
 # define DEBUG(fmt, ...) do {} while (0)
@@ -23,18 +23,28 @@
 #include "bbque/app/application.h"
 #include "bbque/resource_accounter.h"
 #include "bbque/cpp11/thread.h"
+#include "bbque/utils/metrics_collector.h"
+#include "bbque/utils/timer.h"
 
 #ifdef CONFIG_BBQUE_TEST_PLATFORM_DATA
 # include "bbque/test_platform_data.h"
 #endif // CONFIG_BBQUE_TEST_PLATFORM_DATA
 
 #include <memory>
+#include <vector>
 
 #define PLATFORM_PROXY_NAMESPACE "bq.pp"
 
+/**
+ * @brief The default number of workers used for batched resources mapping
+ */
+#define BBQUE_PP_MAP_WORKERS_DEFAULT 8
+
 using bbque::app::AppPtr_t;
 using bbque::res::RViewToken_t;
 using bbque::res::UsagesMapPtr_t;
+using bbque::utils::MetricsCollector;
+using bbque::utils::Timer;
 
 namespace bbque {
 
@@ -60,6 +70,32 @@ public:
 		MAPPING_FAILED
 	} ExitCode_t;
 
+	/**
+	 * @brief A resources mapping request for a batched actuation
+	 *
+	 * The result of each request is reported back into the request
+	 * itself, once the batch has been processed.
+	 */
+	typedef struct MappingRequest {
+		/** The application which resources are assigned */
+		AppPtr_t papp;
+		/** The resources to be assigned */
+		UsagesMapPtr_t pres;
+		/** If true, resources are assigned for exclusive usage */
+		bool excl;
+		/** The result of the resources mapping */
+		ExitCode_t result;
+
+		MappingRequest(AppPtr_t pa, UsagesMapPtr_t pr, bool ex = true) :
+			papp(pa), pres(pr), excl(ex), result(OK) {
+		}
+	} MappingRequest_t;
+
+	/**
+	 * @brief A batch of resources mapping requests
+	 */
+	typedef std::vector<MappingRequest_t> MappingBatch_t;
+
 /**
  * @defgroup group_plt_prx Platform Proxy
  * @{
@@ -143,6 +179,20 @@ public:
  */
 
 
+	/**
+	 * @brief Get the memory footprint of the specified application
+	 *
+	 * This is the amount of resident memory which should be moved to the
+	 * memory nodes of a different cluster, in case the application is
+	 * migrated. Thus, it allows to estimate the cost of a migration.
+	 *
+	 * @param papp The application to query
+	 *
+	 * @return The resident memory of the application [Bytes], 0 if not
+	 * available on the target platform
+	 */
+	uint64_t GetMemoryFootprint(AppPtr_t papp);
+
 /**
  * @}
  * @name Resource binding
@@ -176,6 +226,33 @@ public:
 	ExitCode_t MapResources(AppPtr_t papp, UsagesMapPtr_t pres,
 			bool excl = true);
 
+	/**
+	 * @brief Bind the resources of a batch of applications
+	 *
+	 * Mapping requests of different applications are independent, thus
+	 * they are concurrently processed by a bounded set of workers, which
+	 * are reused by the following batches. Batches must not overlap.
+	 * The result of each mapping is reported into the corresponding
+	 * request, thus a failure on one application does not prevent the
+	 * mapping of the others.
+	 *
+	 * @param batch The mapping requests to process
+	 *
+	 * @return OK if all the requests have been successfully mapped,
+	 * MAPPING_FAILED otherwise.
+	 */
+	ExitCode_t MapResources(MappingBatch_t & batch);
+
+	/**
+	 * @brief Bind the cluster-wide resources
+	 *
+	 * Some resources (e.g. the CPU frequency) are shared by all the
+	 * applications running on a cluster, thus they could not be bound to
+	 * a single application. These are configured according to the overall
+	 * amount granted to all the applications by the scheduled view.
+	 */
+	ExitCode_t MapClusterResources();
+
 /**
  * @}
  * @}
@@ -228,6 +305,75 @@ private:
 	 */
 	void Monitor();
 
+	/**
+	 * @brief The maximum number of workers used for batched mappings
+	 */
+	uint16_t map_workers;
+
+	/**
+	 * @brief The workers serving the batched mappings
+	 *
+	 * Workers are started on demand, up to map_workers-1 (the caller of a
+	 * batch mapping serves requests as well), and then reused by all the
+	 * following batches.
+	 */
+	std::vector<std::thread> map_thds;
+
+	/**
+	 * @brief Mutex protecting the batch being mapped
+	 */
+	std::mutex batch_mtx;
+
+	/**
+	 * @brief Signal the workers that a new batch is available
+	 */
+	std::condition_variable batch_cv;
+
+	/**
+	 * @brief Signal the completion of all the requests of a batch
+	 */
+	std::condition_variable batch_done_cv;
+
+	/**
+	 * @brief The batch being mapped, or null if none
+	 */
+	MappingBatch_t * map_batch;
+
+	/**
+	 * @brief The index of the next request of the batch to map
+	 */
+	size_t map_next;
+
+	/**
+	 * @brief The number of requests of the batch not yet mapped
+	 */
+	size_t map_pending;
+
+	/**
+	 * @brief Set to terminate the mapping workers
+	 */
+	bool map_done;
+
+	/**
+	 * @brief A batched resources mapping worker
+	 *
+	 * Each worker waits for a batch to be available, and picks the next
+	 * request to process, until all the requests have been served.
+	 */
+	void MapWorker();
+
+	/**
+	 * @brief Map the next request of the current batch
+	 *
+	 * @param batch_ul The lock on batch_mtx, released while mapping
+	 */
+	void MapNext(std::unique_lock<std::mutex> & batch_ul);
+
+	/**
+	 * @brief Terminate the mapping workers
+	 */
+	void StopMapWorkers();
+
 	/**
 	 * @brief Setup platform data required to manage the specified application
 	 *
@@ -245,6 +391,25 @@ protected:
 	 */
 	plugins::LoggerIF *logger;
 
+	/**
+	 * @brief The metrics collector module
+	 */
+	MetricsCollector & mc;
+
+	typedef enum PlatformProxyMetrics {
+		//----- Event counting metrics
+		PP_SETUP_POOL_HIT = 0,
+		PP_SETUP_POOL_MISS,
+		//----- Timing metrics
+		PP_SETUP_TIME,
+		PP_FIRST_AWM_TIME,
+
+		PP_METRICS_COUNT
+	} PlatformProxyMetrics_t;
+
+	/** The metrics collected by this module */
+	static MetricsCollector::MetricsCollection_t metrics[PP_METRICS_COUNT];
+
 	/**
 	 * @biref Build a new platform proxy
 	 */
@@ -276,7 +441,7 @@ protected:
 	 * @brief Return the Platform specific string identifier
 	 */
 	virtual const char* _GetPlatformID() {
-		logger->Debug("PLAT PRX: default _GetPlatformID()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _GetPlatformID()");
 		return "it.polimi.bbque.tpd";
 	};
 
@@ -285,7 +450,7 @@ protected:
 	 */
 	virtual ExitCode_t _Setup(AppPtr_t papp) {
 		(void)papp;
-		logger->Debug("PLAT PRX: default _Setup()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _Setup()");
 		return OK;
 	};
 
@@ -297,10 +462,10 @@ protected:
 	 */
 	virtual ExitCode_t _LoadPlatformData() {
 #ifndef CONFIG_BBQUE_TEST_PLATFORM_DATA
-		logger->Debug("PLAT PRX: default _LoadPlatformData()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _LoadPlatformData()");
 #else // !CONFIG_BBQUE_TEST_PLATFORM_DATA
 		//---------- Loading TEST platform data
-		logger->Debug("PLAT PRX: loading Test Platform Data (TPD)");
+		BBQUE_LOG_DEBUG("PLAT PRX: loading Test Platform Data (TPD)");
 		TestPlatformData &tpd(TestPlatformData::GetInstance());
 		tpd.LoadPlatformData();
 #endif // !CONFIG_BBQUE_TEST_PLATFORM_DATA
@@ -312,7 +477,7 @@ protected:
 	 */
 	virtual ExitCode_t _Release(AppPtr_t papp) {
 		(void)papp;
-		logger->Debug("PLAT PRX: default _Release()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _Release()");
 		return OK;
 	};
 
@@ -321,10 +486,18 @@ protected:
 	 */
 	virtual ExitCode_t _ReclaimResources(AppPtr_t papp) {
 		(void)papp;
-		logger->Debug("PLAT PRX: default _ReclaimResources()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _ReclaimResources()");
 		return OK;
 	};
 
+	/**
+	 * @brief Platform specific memory footprint interface.
+	 */
+	virtual uint64_t _GetMemoryFootprint(AppPtr_t papp) {
+		(void)papp;
+		return 0;
+	};
+
 	/**
 	 * @brief Platform specifi resource binding interface.
 	 */
@@ -334,7 +507,16 @@ protected:
 		(void)pres;
 		(void)rvt;
 		(void)excl;
-		logger->Debug("PLAT PRX: default _MapResources()");
+		BBQUE_LOG_DEBUG("PLAT PRX: default _MapResources()");
+		return OK;
+	};
+
+	/**
+	 * @brief Platform specific cluster-wide resources binding interface.
+	 */
+	virtual ExitCode_t _MapClusterResources(RViewToken_t rvt) {
+		(void)rvt;
+		BBQUE_LOG_DEBUG("PLAT PRX: default _MapClusterResources()");
 		return OK;
 	};
 
@@ -32,6 +32,56 @@
  */
 #define FORMAT_DEBUG(fmt) "%25s:%05d - " fmt, __FILE__, __LINE__
 
+/**
+ * The lowest priority of the logging statements compiled in by the
+ * BBQUE_LOG_* macros, as a LoggerIF::Priority value
+ */
+#ifdef CONFIG_BBQUE_LOG_LEVEL
+# define BBQUE_LOG_LEVEL CONFIG_BBQUE_LOG_LEVEL
+#else
+# define BBQUE_LOG_LEVEL 0
+#endif
+
+// DEBUG messages are never logged by release builds
+#if defined(BBQUE_DEBUG) || (BBQUE_LOG_LEVEL > 0)
+# define BBQUE_LOG_LEVEL_MIN BBQUE_LOG_LEVEL
+#else
+# define BBQUE_LOG_LEVEL_MIN 1
+#endif
+
+/**
+ * @brief Check if messages with the specified priority are logged
+ *
+ * This is false at compile time for priorities lower than BBQUE_LOG_LEVEL,
+ * otherwise it checks the (cached) priority of the category of the "logger"
+ * in scope. Use it to guard the code preparing the arguments of a message.
+ */
+#define BBQUE_LOG_ENABLED(PRIO) \
+	((bbque::plugins::LoggerIF::PRIO >= BBQUE_LOG_LEVEL_MIN) && \
+	 logger->Enabled(bbque::plugins::LoggerIF::PRIO))
+
+/**
+ * @brief Send a log message by means of the "logger" in scope
+ *
+ * Differently from calling the logger methods directly, neither the
+ * arguments are evaluated nor the logger is called, if the message priority
+ * is not enabled.
+ */
+#define BBQUE_LOG(PRIO, METHOD, ...) \
+	do { \
+		if (BBQUE_LOG_ENABLED(PRIO)) \
+			logger->METHOD(__VA_ARGS__); \
+	} while (0)
+
+#define BBQUE_LOG_DEBUG(...)  BBQUE_LOG(DEBUG,  Debug,  __VA_ARGS__)
+#define BBQUE_LOG_INFO(...)   BBQUE_LOG(INFO,   Info,   __VA_ARGS__)
+#define BBQUE_LOG_NOTICE(...) BBQUE_LOG(NOTICE, Notice, __VA_ARGS__)
+#define BBQUE_LOG_WARN(...)   BBQUE_LOG(WARN,   Warn,   __VA_ARGS__)
+#define BBQUE_LOG_ERROR(...)  BBQUE_LOG(ERROR,  Error,  __VA_ARGS__)
+#define BBQUE_LOG_CRIT(...)   BBQUE_LOG(CRIT,   Crit,   __VA_ARGS__)
+#define BBQUE_LOG_ALERT(...)  BBQUE_LOG(ALERT,  Alert,  __VA_ARGS__)
+#define BBQUE_LOG_FATAL(...)  BBQUE_LOG(FATAL,  Fatal,  __VA_ARGS__)
+
 namespace bbque { namespace plugins {
 
 /**
@@ -70,6 +120,24 @@ public:
 
 //----- Objects interface
 
+	/**
+	 * \brief Check if messages with the specified priority are logged
+	 * \param prio the priority of the messages
+	 *
+	 * This does not call into the logger plugin, but it checks the
+	 * priority of the category, as cached at logger creation time.
+	 */
+	bool Enabled(Priority prio) const {
+		return (prio >= level);
+	}
+
+	/**
+	 * \brief Get the lowest priority of the logged messages
+	 */
+	Priority GetLevel() const {
+		return level;
+	}
+
 #ifdef BBQUE_DEBUG
 	/**
 	 * \brief Send a log message with the priority DEBUG
@@ -121,6 +189,21 @@ public:
 	 */
 	virtual void Fatal(const char *fmt, ...) = 0;
 
+protected:
+
+	/**
+	 * \brief Build a new logger
+	 * \param level the lowest priority of the logged messages
+	 */
+	LoggerIF(Priority level = DEBUG) :
+		level(level) {};
+
+	/**
+	 * The lowest priority of the logged messages, which should be set
+	 * by the logger plugins according to their category configuration
+	 */
+	Priority level;
+
 };
 
 } // namespace plugins
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RECIPE_COMPILED_H_
+#define BBQUE_RECIPE_COMPILED_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/** The suffix of the compiled recipes, which are placed beside the XML ones */
+#define BBQUE_RECIPE_COMPILED_EXT ".brc"
+
+/** The magic number of a compiled recipe */
+#define BBQUE_RECIPE_COMPILED_MAGIC 0xBB0E4EC1
+
+#define BBQUE_RECIPE_COMPILED_VERSION 1
+
+namespace bbque { namespace plugins {
+
+/**
+ * @brief The header of a compiled recipe
+ *
+ * A compiled recipe is the binary image of an XML recipe, as produced by the
+ * bbque-rcc tool, which could be memory mapped and loaded without any
+ * parsing. Resource paths are already built, and usages already converted
+ * according to their units, thus the loader just has to check them against
+ * the system resources.
+ *
+ * The header is followed by a set of tables of fixed size entries: the
+ * platform sections, the AWMs of all the platforms, the resource usages of
+ * all the AWMs, the plugins data and the constraints. Entries refer to the
+ * entries of other tables by index, and to strings by offset into the
+ * strings table, which is the last one.
+ */
+typedef struct brc_header {
+	/** Set to BBQUE_RECIPE_COMPILED_MAGIC */
+	uint32_t magic;
+	/** The compiled format version */
+	uint16_t version;
+	/** The version of the source recipe */
+	uint8_t recipe_major;
+	uint8_t recipe_minor;
+	/** The last modification time of the source recipe */
+	int64_t src_mtime;
+	/** The application priority */
+	uint16_t priority;
+	uint16_t nr_platforms;
+	/** The offset of the tables, from the beginning of the file */
+	uint32_t platforms_off;
+	uint32_t awms_off;
+	uint32_t nr_awms;
+	uint32_t usages_off;
+	uint32_t nr_usages;
+	uint32_t pdata_off;
+	uint32_t nr_pdata;
+	uint32_t constraints_off;
+	uint32_t nr_constraints;
+	uint32_t strings_off;
+	uint32_t strings_size;
+} brc_header_t;
+
+/**
+ * @brief A platform section
+ */
+typedef struct brc_platform {
+	/** The platform ID (string) */
+	uint32_t id;
+	/** The AWMs */
+	uint32_t first_awm;
+	uint32_t nr_awms;
+	/** The application plugins data */
+	uint32_t first_pdata;
+	uint32_t nr_pdata;
+	/** The static constraints */
+	uint32_t first_constraint;
+	uint32_t nr_constraints;
+} brc_platform_t;
+
+/**
+ * @brief An application working mode
+ */
+typedef struct brc_awm {
+	/** The AWM name (string) */
+	uint32_t name;
+	/** The AWM ID */
+	uint8_t id;
+	/** The AWM value */
+	uint8_t value;
+	uint16_t reserved;
+	/** The resource usages */
+	uint32_t first_usage;
+	uint32_t nr_usages;
+	/** The AWM plugins data */
+	uint32_t first_pdata;
+	uint32_t nr_pdata;
+} brc_awm_t;
+
+/**
+ * @brief A resource usage
+ */
+typedef struct brc_usage {
+	/** The resource path (string) */
+	uint32_t path;
+	uint32_t reserved;
+	/** The amount required, already converted according to the units */
+	uint64_t amount;
+} brc_usage_t;
+
+/**
+ * @brief A plugin specific data
+ */
+typedef struct brc_pdata {
+	/** The plugin name, the data key and the data value (strings) */
+	uint32_t plugin;
+	uint32_t key;
+	uint32_t value;
+} brc_pdata_t;
+
+/**
+ * @brief A static constraint
+ */
+typedef struct brc_constraint {
+	/** The resource path (string) */
+	uint32_t resource;
+	uint32_t reserved;
+	/** The lower and upper bounds (0 if not asserted) */
+	uint64_t lower;
+	uint64_t upper;
+} brc_constraint_t;
+
+
+template<typename T>
+inline const T *brc_table(const brc_header_t *hdr, uint32_t off) {
+	return (const T *)((const char *)hdr + off);
+}
+
+inline const brc_platform_t *brc_platforms(const brc_header_t *hdr) {
+	return brc_table<brc_platform_t>(hdr, hdr->platforms_off);
+}
+
+inline const brc_awm_t *brc_awms(const brc_header_t *hdr) {
+	return brc_table<brc_awm_t>(hdr, hdr->awms_off);
+}
+
+inline const brc_usage_t *brc_usages(const brc_header_t *hdr) {
+	return brc_table<brc_usage_t>(hdr, hdr->usages_off);
+}
+
+inline const brc_pdata_t *brc_pdata(const brc_header_t *hdr) {
+	return brc_table<brc_pdata_t>(hdr, hdr->pdata_off);
+}
+
+inline const brc_constraint_t *brc_constraints(const brc_header_t *hdr) {
+	return brc_table<brc_constraint_t>(hdr, hdr->constraints_off);
+}
+
+inline const char *brc_str(const brc_header_t *hdr, uint32_t off) {
+	return brc_table<char>(hdr, hdr->strings_off + off);
+}
+
+/**
+ * @brief Check the placement of a table into the file
+ */
+inline bool brc_check_table(size_t size, uint32_t off, uint64_t count,
+		size_t entry_size) {
+	return ((off % 8) == 0) && (off <= size) &&
+		(count * entry_size <= size - off);
+}
+
+/**
+ * @brief Check the consistency of a (memory mapped) compiled recipe
+ *
+ * This checks that all the tables, the references among their entries and
+ * the strings are within the file, so that a loader could then access them
+ * without any further check.
+ *
+ * @param base the beginning of the file
+ * @param size the size of the file
+ */
+inline bool brc_valid(const void *base, size_t size) {
+	const brc_header_t *hdr = (const brc_header_t *)base;
+	const brc_platform_t *pp;
+	const brc_awm_t *pawm;
+	const brc_usage_t *pusage;
+	const brc_pdata_t *ppdata;
+	const brc_constraint_t *pcons;
+	uint32_t i;
+
+	if ((size < sizeof(brc_header_t)) ||
+			(hdr->magic != BBQUE_RECIPE_COMPILED_MAGIC) ||
+			(hdr->version != BBQUE_RECIPE_COMPILED_VERSION))
+		return false;
+
+	// Tables placement, and strings termination
+	if (!brc_check_table(size, hdr->platforms_off, hdr->nr_platforms,
+				sizeof(brc_platform_t)) ||
+			!brc_check_table(size, hdr->awms_off, hdr->nr_awms,
+				sizeof(brc_awm_t)) ||
+			!brc_check_table(size, hdr->usages_off, hdr->nr_usages,
+				sizeof(brc_usage_t)) ||
+			!brc_check_table(size, hdr->pdata_off, hdr->nr_pdata,
+				sizeof(brc_pdata_t)) ||
+			!brc_check_table(size, hdr->constraints_off,
+				hdr->nr_constraints, sizeof(brc_constraint_t)) ||
+			!brc_check_table(size, hdr->strings_off, hdr->strings_size, 1) ||
+			(hdr->strings_size == 0) ||
+			(*brc_str(hdr, hdr->strings_size - 1) != '\0'))
+		return false;
+
+	// References among the entries
+#define BRC_CHECK_RANGE(first, nr, total) \
+	(((uint64_t)(first) + (nr)) <= (total))
+#define BRC_CHECK_STR(off) ((off) < hdr->strings_size)
+
+	pp = brc_platforms(hdr);
+	for (i = 0; i < hdr->nr_platforms; ++i, ++pp) {
+		if (!BRC_CHECK_STR(pp->id) ||
+				!BRC_CHECK_RANGE(pp->first_awm, pp->nr_awms,
+					hdr->nr_awms) ||
+				!BRC_CHECK_RANGE(pp->first_pdata, pp->nr_pdata,
+					hdr->nr_pdata) ||
+				!BRC_CHECK_RANGE(pp->first_constraint,
+					pp->nr_constraints, hdr->nr_constraints))
+			return false;
+	}
+	pawm = brc_awms(hdr);
+	for (i = 0; i < hdr->nr_awms; ++i, ++pawm) {
+		if (!BRC_CHECK_STR(pawm->name) ||
+				!BRC_CHECK_RANGE(pawm->first_usage, pawm->nr_usages,
+					hdr->nr_usages) ||
+				!BRC_CHECK_RANGE(pawm->first_pdata, pawm->nr_pdata,
+					hdr->nr_pdata))
+			return false;
+	}
+	pusage = brc_usages(hdr);
+	for (i = 0; i < hdr->nr_usages; ++i, ++pusage) {
+		if (!BRC_CHECK_STR(pusage->path))
+			return false;
+	}
+	ppdata = brc_pdata(hdr);
+	for (i = 0; i < hdr->nr_pdata; ++i, ++ppdata) {
+		if (!BRC_CHECK_STR(ppdata->plugin) ||
+				!BRC_CHECK_STR(ppdata->key) ||
+				!BRC_CHECK_STR(ppdata->value))
+			return false;
+	}
+	pcons = brc_constraints(hdr);
+	for (i = 0; i < hdr->nr_constraints; ++i, ++pcons) {
+		if (!BRC_CHECK_STR(pcons->resource))
+			return false;
+	}
+
+#undef BRC_CHECK_RANGE
+#undef BRC_CHECK_STR
+
+	return true;
+}
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_RECIPE_COMPILED_H_
@@ -33,6 +33,9 @@
 
 #define PLATFORM_ID_GENERIC     "generic"
 
+/** The suffix of the recipe files */
+#define RECIPE_FILE_EXT         ".recipe"
+
 using bbque::app::Recipe;
 
 namespace bbque { namespace plugins {
@@ -79,6 +82,8 @@ public:
 		RL_ABORTED
 	};
 
+	virtual ~RecipeLoaderIF() {}
+
 	/**
 	 * @brief Load the recipe of the application
 	 * @param rname The recipe name. We expect to find the recipe in the
@@ -96,6 +101,12 @@ public:
 	 */
 	virtual std::time_t LastModifiedTime(std::string const & recipe_name) = 0;
 
+	/**
+	 * @brief The directory containing the recipes
+	 * @return The path of the directory where recipes are looked for
+	 */
+	virtual std::string const & RecipesDir() = 0;
+
 };
 
 } // namespace plugins
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_CPUFREQ_MANAGER_H_
+#define BBQUE_CPUFREQ_MANAGER_H_
+
+#include "bbque/plugins/logger.h"
+#include "bbque/res/resources.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The default sysfs folder exporting the CPUs
+ */
+#define BBQUE_CPUFREQ_ROOT_DEFAULT "/sys/devices/system/cpu"
+
+namespace bbque {
+
+using res::RViewToken_t;
+
+/**
+ * @brief The CPU frequency management support
+ * @ingroup sec20_pp_linux
+ *
+ * The frequency of each cluster is managed as a shared resource, i.e.
+ * "tile0.clusterN.freq0", which total amount is the maximum frequency [MHz]
+ * supported by the CPUs of the cluster. The requests of different
+ * applications are not summed-up: each application could book any frequency
+ * up to the cluster maximum one. Since all the CPUs of a cluster run at the
+ * same frequency, the cluster is configured to run at the highest frequency
+ * booked by the applications mapped on it, rounded up to the nearest
+ * available frequency.
+ *
+ * Thus, a cluster where no application books any frequency runs at its
+ * maximum frequency, while a cluster with at least one request is slowed
+ * down to the highest one, which affects also the applications mapped on
+ * that cluster without any frequency request.
+ *
+ * The frequency is actuated, via the Linux cpufreq sysfs interface, by
+ * either:
+ * <ul>
+ * <li><i>userspace:</i> switching to the "userspace" governor and setting
+ * the "scaling_setspeed" attribute</li>
+ * <li><i>maxfreq:</i> capping the frequency selected by the current
+ * governor via the "scaling_max_freq" attribute</li>
+ * </ul>
+ */
+class CPUFreqManager {
+
+public:
+
+	/**
+	 * @brief The frequency actuation modes
+	 */
+	typedef enum ActuationMode {
+		/** Frequency is not managed */
+		CPUFREQ_NONE = 0,
+		/** The userspace governor is used to set the frequency */
+		CPUFREQ_USERSPACE,
+		/** The frequency is capped via scaling_max_freq */
+		CPUFREQ_MAXFREQ
+	} ActuationMode_t;
+
+	/**
+	 * @brief Build a new CPU frequency manager
+	 *
+	 * @param mode The configured actuation mode (e.g. "none", "userspace"
+	 * or "maxfreq")
+	 * @param root The sysfs folder exporting the CPUs, e.g.
+	 * "/sys/devices/system/cpu"
+	 * @param logger The logger to use
+	 */
+	CPUFreqManager(std::string const & mode, std::string const & root,
+			plugins::LoggerIF *logger);
+
+	/**
+	 * @brief Restore the original governors of the managed CPUs
+	 */
+	~CPUFreqManager();
+
+	/**
+	 * @brief Get the configured actuation mode
+	 */
+	inline ActuationMode_t Mode() const {
+		return mode;
+	}
+
+	/**
+	 * @brief Register the frequency resource of a cluster
+	 *
+	 * The cpufreq support of the cluster CPUs is looked-up and, if
+	 * available, the corresponding resource is registered into the
+	 * ResourceAccounter. This is a no-op if the frequency management is
+	 * not enabled.
+	 *
+	 * @param cluster_id The cluster ID
+	 * @param cpus The list of CPUs of the cluster (e.g. "0-3,6")
+	 *
+	 * @return true if the frequency of the cluster is managed
+	 */
+	bool RegisterCluster(uint16_t cluster_id, std::string const & cpus);
+
+	/**
+	 * @brief Set the frequency of the managed clusters
+	 *
+	 * The frequency of each cluster is updated according to the amount of
+	 * frequency resource used in the specified view. Only clusters which
+	 * frequency is changed are actually updated.
+	 *
+	 * @param vtok The token of the resources state view
+	 */
+	void Actuate(RViewToken_t vtok);
+
+private:
+
+	/**
+	 * @brief The frequency settings of a cluster
+	 */
+	typedef struct ClusterFreq {
+		/** The resource path of the cluster frequency */
+		std::string path;
+		/** The CPUs of the cluster */
+		std::vector<uint16_t> cpus;
+		/** The original governor of each CPU */
+		std::vector<std::string> governors;
+		/** The available frequencies [kHz], in ascending order */
+		std::vector<uint32_t> freqs;
+		/** The minimum frequency [kHz] */
+		uint32_t min_khz;
+		/** The maximum frequency [kHz] */
+		uint32_t max_khz;
+		/** The currently set frequency [kHz], 0 if not yet set */
+		uint32_t cur_khz;
+		/** The actuation mode used for this cluster */
+		ActuationMode_t mode;
+	} ClusterFreq_t;
+
+	typedef std::shared_ptr<ClusterFreq_t> ClusterFreqPtr_t;
+
+	/**
+	 * @brief The logger to use
+	 */
+	plugins::LoggerIF *logger;
+
+	/**
+	 * @brief The configured actuation mode
+	 */
+	ActuationMode_t mode;
+
+	/**
+	 * @brief The sysfs folder exporting the CPUs
+	 */
+	std::string root;
+
+	/**
+	 * @brief The managed clusters, indexed by cluster ID
+	 */
+	std::map<uint16_t, ClusterFreqPtr_t> clusters;
+
+	/**
+	 * @brief Get the path of a cpufreq attribute of a CPU
+	 */
+	std::string AttributePath(uint16_t cpu, const char *attr) const;
+
+	/**
+	 * @brief Read a cpufreq attribute of a CPU
+	 *
+	 * @return true if the attribute has been read
+	 */
+	bool ReadAttribute(uint16_t cpu, const char *attr,
+			std::string & value) const;
+
+	/**
+	 * @brief Write a cpufreq attribute of a CPU
+	 *
+	 * @return true if the attribute has been written
+	 */
+	bool WriteAttribute(uint16_t cpu, const char *attr,
+			std::string const & value) const;
+
+	/**
+	 * @brief Get the highest frequency [MHz] granted to an application
+	 * on the cluster, in the specified resource state view
+	 */
+	uint64_t MaxRequest(ClusterFreqPtr_t pcf, RViewToken_t vtok) const;
+
+	/**
+	 * @brief Get the frequency [kHz] to set to serve the specified
+	 * request [MHz]
+	 */
+	uint32_t GetFrequency(ClusterFreqPtr_t pcf, uint64_t mhz) const;
+
+	/**
+	 * @brief Set the frequency [kHz] of all the CPUs of a cluster
+	 */
+	bool SetFrequency(ClusterFreqPtr_t pcf, uint32_t khz);
+
+	/**
+	 * @brief Parse a list of CPUs
+	 *
+	 * @param list The CPUs list, e.g. "0-3,6"
+	 * @param cpus The vector to fill with the CPU IDs
+	 */
+	static void ParseCPUs(std::string const & list,
+			std::vector<uint16_t> & cpus);
+
+};
+
+typedef std::shared_ptr<CPUFreqManager> CPUFreqManagerPtr_t;
+
+} // namespace bbque
+
+#endif // BBQUE_CPUFREQ_MANAGER_H_
@@ -20,9 +20,14 @@
 
 #include "bbque/config.h"
 #include "bbque/platform_proxy.h"
+#include "bbque/pp/cpufreq_manager.h"
+#include "bbque/pp/memory_migrator.h"
 #include "bbque/utils/attributes_container.h"
+#include "bbque/utils/deferrable.h"
 
 #include <libcgroup.h>
+#include <list>
+#include <map>
 
 /**
  * @brief Default MAX number of CPUs per socket
@@ -62,6 +67,30 @@
  */
 #define BBQUE_LINUXPP_CLUSTER "node"
 
+/**
+ * @brief The CGroup prefix of pre-built control groups
+ *
+ * Control groups are pre-built under the BarbequeRTRM CGroup, and kept into a
+ * pool, to be assigned to applications at setup time.
+ */
+#define BBQUE_LINUXPP_POOL BBQUE_LINUXPP_CGROUP"/pool."
+
+/**
+ * @brief The default number of pre-built control groups
+ */
+#define BBQUE_LINUXPP_POOL_DEFAULT 8
+
+/**
+ * @brief The delay [ms] of the pool refill, since a control group has been
+ * handed out
+ */
+#define BBQUE_LINUXPP_POOL_REFILL_DELAY 100
+
+/**
+ * @brief The minimum time between two reads of an application footprint [ms]
+ */
+#define BBQUE_LINUXPP_RSS_PERIOD 1000
+
 /**
  * @brief The namespace of the Linux platform integration module
  */
@@ -70,6 +99,7 @@
 using bbque::res::UsagePtr_t;
 using bbque::res::ResourcePtr_t;
 using bbque::utils::AttributesContainer;
+using bbque::utils::Deferrable;
 
 namespace bbque {
 
@@ -102,6 +132,8 @@ private:
 		RLINUX_TYPE_CPU,		/* A CPU on an SMP Linux machine */
 		RLINUX_TYPE_SMEM,		/* A socket memory bank on an SMP Linux
 								   machine */
+		RLINUX_TYPE_FREQ,		/* The CPUs frequency of a socket on an SMP
+								   Linux machine */
 
 		RLINUX_TYPE_UNKNOWN		/* Resource which could not be mapped on an Host
 								   Linux machine */
@@ -152,11 +184,19 @@ private:
 		struct cgroup_controller *pc_cpu;
 		struct cgroup_controller *pc_cpuset;
 		struct cgroup_controller *pc_memory;
+		/** The memory nodes currently assigned */
+		std::string mems;
+		/** The last sampled memory footprint [Bytes] */
+		uint64_t rss;
+		/** The time since the last memory footprint sampling */
+		Timer rss_tmr;
+		/** Mutex protecting the memory footprint sampling */
+		std::mutex rss_mtx;
 
 		CGroupData(AppPtr_t pa) :
 			Attribute(PLAT_LNX_ATTRIBUTE, "cgroup"),
 			papp(pa), pcg(NULL), pc_cpu(NULL),
-			pc_cpuset(NULL), pc_memory(NULL) {
+			pc_cpuset(NULL), pc_memory(NULL), rss(0) {
 			snprintf(cgpath, BBQUE_LINUXPP_CGROUP_PATH_MAX,
 					BBQUE_LINUXPP_CGROUP"/%s",
 					papp->StrId());
@@ -165,7 +205,7 @@ private:
 		CGroupData(const char *cgp) :
 			Attribute(PLAT_LNX_ATTRIBUTE, "cgroup"),
 			pcg(NULL), pc_cpu(NULL),
-			pc_cpuset(NULL), pc_memory(NULL) {
+			pc_cpuset(NULL), pc_memory(NULL), rss(0) {
 			snprintf(cgpath, BBQUE_LINUXPP_CGROUP_PATH_MAX,
 					"%s", cgp);
 		}
@@ -214,6 +254,76 @@ private:
 	 */
 	CGroupDataPtr_t psilos;
 
+	/**
+	 * @brief Mutex serializing the access to the "silos" CGroup
+	 *
+	 * Resources mapping of different applications could be run
+	 * concurrently, while the silos CGroup data is shared among them.
+	 */
+	std::mutex silos_mtx;
+
+	/**
+	 * @brief The memory nodes of each registered cluster
+	 *
+	 * This maps a cluster ID on the list of memory nodes configured for
+	 * the corresponding "nodeN" resources group, which are assigned to
+	 * applications scheduled on that cluster.
+	 */
+	std::map<unsigned short, std::string> cluster_mems;
+
+	/**
+	 * @brief The mount point of the "memory" controller
+	 */
+	std::string memory_mount;
+
+	/**
+	 * @brief The memory pages migration support
+	 */
+	MemoryMigratorPtr_t pmm;
+
+	/**
+	 * @brief The CPU frequency management support
+	 */
+	CPUFreqManagerPtr_t pcf;
+
+	/**
+	 * @brief The pool of pre-built (parked) control groups
+	 *
+	 * Creating a kernel control group, with all the required controllers,
+	 * is an expensive operation which should not be on the critical path of
+	 * the first schedule of an application. A set of control groups is thus
+	 * pre-built at boot time, handed out to applications at setup time and
+	 * recycled once they are released.
+	 */
+	std::list<CGroupDataPtr_t> cg_pool;
+
+	/**
+	 * @brief The maximum number of control groups kept into the pool
+	 *
+	 * A zero value disables the pool, thus each application control
+	 * group is built at setup time and removed once released.
+	 */
+	uint16_t cg_pool_size;
+
+	/**
+	 * @brief The ID of the next control group built for the pool
+	 */
+	uint32_t cg_pool_next;
+
+	/**
+	 * @brief Mutex protecting the control groups pool
+	 *
+	 * This protects just the pool list, the control groups are built and
+	 * configured without holding it.
+	 */
+	std::mutex cg_pool_mtx;
+
+	/**
+	 * @brief Refill the pool in background, once control groups have been
+	 * handed out
+	 */
+	Deferrable cg_pool_dfr;
+
 
 /**
  * @defgroup group_plt_prx Platform Proxy
@@ -234,6 +344,7 @@ private:
 	ExitCode_t RegisterCluster(RLinuxBindingsPtr_t prlb);
 	ExitCode_t RegisterClusterCPUs(RLinuxBindingsPtr_t prlb);
 	ExitCode_t RegisterClusterMEMs(RLinuxBindingsPtr_t prlb);
+	ExitCode_t RegisterClusterFreq(RLinuxBindingsPtr_t prlb);
 	ExitCode_t ParseNode(struct cgroup_file_info &entry);
 	ExitCode_t ParseNodeAttributes(struct cgroup_file_info &entry,
 			RLinuxBindingsPtr_t prlb);
@@ -257,6 +368,19 @@ private:
 	ExitCode_t _MapResources(AppPtr_t papp, UsagesMapPtr_t pres,
 		RViewToken_t rvt, bool excl);
 
+	/**
+	 * @brief Set the frequency of the managed clusters
+	 */
+	ExitCode_t _MapClusterResources(RViewToken_t rvt);
+
+	/**
+	 * @brief Get the memory footprint of an application
+	 *
+	 * This is the resident memory reported by the "memory" controller
+	 * for the application control group.
+	 */
+	uint64_t _GetMemoryFootprint(AppPtr_t papp);
+
 /**
  * @}
  * @}
@@ -272,11 +396,46 @@ private:
 	ExitCode_t GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
 		RViewToken_t rvt, RLinuxBindingsPtr_t prlb);
 
+	ExitCode_t InitCGroup(CGroupDataPtr_t &pcgd);
 	ExitCode_t BuildCGroup(CGroupDataPtr_t &pcgd);
 
 	ExitCode_t BuildSilosCG(CGroupDataPtr_t &pcgd);
 	ExitCode_t BuildAppCG(AppPtr_t papp, CGroupDataPtr_t &pcgd);
 
+	/**
+	 * @brief Build a new control group to be kept into the pool
+	 */
+	ExitCode_t BuildPoolCG(CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Get a control group from the pool
+	 *
+	 * If the pool is empty, a new control group is built on demand.
+	 */
+	ExitCode_t GetPoolCG(AppPtr_t papp, CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Park a released control group into the pool
+	 *
+	 * The task of the released application (if still into the control
+	 * group) is moved into the silos, while the control group is kept into
+	 * the pool, unless the pool is already full.
+	 */
+	void ParkCGroup(CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Build control groups up to the configured pool size
+	 */
+	void RefillPool();
+
+	/**
+	 * @brief Check if a task belongs to the specified control group
+	 *
+	 * This allows to tell apart the task of a released application from an
+	 * unrelated one which has reused its PID.
+	 */
+	bool TaskInCGroup(app::AppPid_t pid, CGroupDataPtr_t const &pcgd);
+
 	ExitCode_t GetCGroupData(AppPtr_t papp, CGroupDataPtr_t &pcgd);
 	ExitCode_t SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
 			bool excl = false, bool move = true);
@@ -0,0 +1,443 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_LINUX_CGFS_PP_H_
+#define BBQUE_LINUX_CGFS_PP_H_
+
+#include "bbque/config.h"
+#include "bbque/platform_proxy.h"
+#include "bbque/pp/cpufreq_manager.h"
+#include "bbque/pp/memory_migrator.h"
+#include "bbque/utils/attributes_container.h"
+#include "bbque/utils/deferrable.h"
+
+#include <list>
+#include <map>
+#include <string>
+
+/**
+ * @brief The default mount point of the control groups filesystem
+ *
+ * On a CGroup v1 host this is expected to host a sub-folder for each
+ * controller (e.g. "cpuset", "memory", "cpu"), while on a CGroup v2 host
+ * this is the root of the unified hierarchy.
+ */
+#define BBQUE_LINUXCGFS_ROOT_DEFAULT "/sys/fs/cgroup"
+
+/**
+ * @brief The CGroup expected to assigne resources to BBQ
+ *
+ * Resources which are assigned to Barbeque for Run-Time Management
+ * are expected to be define under this control group, for each one of the
+ * used controllers.
+ */
+#define BBQUE_LINUXCGFS_CGROUP "bbque"
+
+/**
+ * @brief The CGroup expected to define resources clusterization
+ *
+ * @see BBQUE_LINUXPP_RESOURCES
+ */
+#define BBQUE_LINUXCGFS_RESOURCES BBQUE_LINUXCGFS_CGROUP"/res"
+
+/**
+ * @brief The CGroup expected to define Clusters
+ *
+ * @see BBQUE_LINUXPP_CLUSTER
+ */
+#define BBQUE_LINUXCGFS_CLUSTER "node"
+
+/**
+ * @brief The CGroup prefix of pre-built control groups
+ *
+ * @see BBQUE_LINUXPP_POOL
+ */
+#define BBQUE_LINUXCGFS_POOL BBQUE_LINUXCGFS_CGROUP"/pool."
+
+/**
+ * @brief The default number of pre-built control groups
+ */
+#define BBQUE_LINUXCGFS_POOL_DEFAULT 8
+
+/**
+ * @brief The delay [ms] of the pool refill
+ *
+ * @see BBQUE_LINUXPP_POOL_REFILL_DELAY
+ */
+#define BBQUE_LINUXCGFS_POOL_REFILL_DELAY 100
+
+/**
+ * @brief The minimum time between two reads of an application footprint [ms]
+ */
+#define BBQUE_LINUXCGFS_RSS_PERIOD 1000
+
+/**
+ * @brief The namespace of the Linux CGroupFS platform integration module
+ */
+#define PLAT_CGFS_ATTRIBUTE PLATFORM_PROXY_NAMESPACE".cgfs"
+
+using bbque::res::UsagePtr_t;
+using bbque::res::ResourcePtr_t;
+using bbque::utils::AttributesContainer;
+using bbque::utils::Deferrable;
+
+namespace bbque {
+
+/**
+ * @brief The Linux CGroupFS Platform Proxy module
+ * @ingroup sec20_pp_linux
+ *
+ * This is an alternative implementation of the Linux platform integration
+ * layer which does not depend on libcgroup. Control groups are accessed
+ * by directly reading and writing the attributes exported by the kernel
+ * through the cgroup filesystem.
+ *
+ * Each managed application keeps open the file descriptors of the
+ * attributes of its control group, and a copy of the last value written on
+ * each of them. This way, at each resources mapping only the attributes
+ * which values have actually changed are written, with a single system call
+ * each one.
+ *
+ * Both the CGroup v1 (one hierarchy per controller) and the CGroup v2
+ * (unified hierarchy) layouts are supported, the proper one being detected
+ * at boot time by looking at the configured mount point.
+ */
+class LinuxCGFSPP : public PlatformProxy {
+
+public:
+
+	LinuxCGFSPP();
+
+	virtual ~LinuxCGFSPP();
+
+private:
+
+	/**
+	 * @brief The control groups controllers used by this module
+	 */
+	typedef enum CGController {
+		CGFS_CTRL_CPUSET = 0,
+		CGFS_CTRL_MEMORY,
+		CGFS_CTRL_CPU,
+
+		CGFS_CTRL_COUNT // This must be the last value
+	} CGController_t;
+
+	/**
+	 * @brief The control group attributes managed by this module
+	 *
+	 * Attributes are mapped on a different file name depending on the
+	 * version of the cgroup filesystem. Some of them are defined only
+	 * for the v1 hierarchy.
+	 */
+	typedef enum CGAttribute {
+		CGFS_CPUS = 0,
+		CGFS_MEMS,
+		CGFS_MEMB,
+		CGFS_CPUP,
+		CGFS_CPUQ,
+		CGFS_MMIG,
+		CGFS_PROCS_CPUSET,
+		CGFS_PROCS_MEMORY,
+		CGFS_PROCS_CPU,
+
+		CGFS_ATTRS_COUNT // This must be the last value
+	} CGAttribute_t;
+
+	/**
+	 * @brief The description of a control group attribute
+	 */
+	typedef struct CGAttributeDesc {
+		/** The controller exporting this attribute */
+		CGController_t ctrl;
+		/** The name of the attribute on a v1 hierarchy */
+		const char *v1;
+		/** The name of the attribute on a v2 hierarchy */
+		const char *v2;
+		/** If true, the value written is not cached */
+		bool volatile_value;
+	} CGAttributeDesc_t;
+
+	/** The descriptors of all the managed attributes */
+	static CGAttributeDesc_t const cgAttributes[CGFS_ATTRS_COUNT];
+
+	/** The names of the managed controllers */
+	static const char *cgControllers[CGFS_CTRL_COUNT];
+
+	/**
+	 * @brief Resource assignement bindings on a Linux machine
+	 */
+	typedef struct RLinuxBindings {
+		/** The "cluster" (i.e. NUMA node) of the assigned resources */
+		unsigned short socket_id;
+		/** The (comma separated) list of assigned CPUs */
+		std::string cpus;
+		/** The list of memory nodes of the cluster */
+		std::string mems;
+		/** The percentage of CPUs time assigned */
+		uint64_t amount_cpus;
+		/** The bytes amount of Socket MEMORY assigned */
+		uint64_t amount_memb;
+		/** The CPU time quota assigned to a cluster */
+		uint64_t amount_cpuq;
+		/** The CPU time period considered for quota assignement */
+		uint64_t amount_cpup;
+		RLinuxBindings() :
+			socket_id(0),
+			amount_cpus(0), amount_memb(0),
+			amount_cpuq(0), amount_cpup(0) {
+		}
+	} RLinuxBindings_t;
+
+	typedef std::shared_ptr<RLinuxBindings_t> RLinuxBindingsPtr_t;
+
+	/**
+	 * @brief The cgroupfs data of a controlled application
+	 *
+	 * This keeps the file descriptors of the attributes of the application
+	 * control group, which are open the first time an attribute is written
+	 * and released only once the application exits.
+	 */
+	typedef struct CGroupData : public AttributesContainer::Attribute {
+		/** The controlled application (if any) */
+		AppPtr_t papp;
+		/** The cgroup path, relative to the controllers mount points */
+		std::string cgpath;
+		/** The absolute path of the cgroup on each controller */
+		std::string cgdir[CGFS_CTRL_COUNT];
+		/** The (lazily opened) attributes file descriptors */
+		int fd[CGFS_ATTRS_COUNT];
+		/** The last value written on each attribute */
+		std::string value[CGFS_ATTRS_COUNT];
+		/** True if the cgroup lives on an emulated cgroupfs */
+		bool emulated;
+		/** The memory nodes currently assigned to the application */
+		std::string mems;
+		/** The last sampled memory footprint [Bytes] */
+		uint64_t rss;
+		/** The time since the last memory footprint sampling */
+		Timer rss_tmr;
+		/** Mutex protecting the memory footprint sampling */
+		std::mutex rss_mtx;
+
+		CGroupData(AppPtr_t pa);
+
+		CGroupData(const char *cgp);
+
+		~CGroupData();
+
+	} CGroupData_t;
+
+	typedef std::shared_ptr<CGroupData_t> CGroupDataPtr_t;
+
+	/**
+	 * @brief The mount point of the cgroup filesystem
+	 */
+	std::string cgfs_root;
+
+	/**
+	 * @brief True if the unified (v2) hierarchy is in use
+	 */
+	bool cgfs_v2;
+
+	/**
+	 * @brief True if running on top of an emulated cgroupfs
+	 *
+	 * When the configured mount point is not a cgroup filesystem (e.g. a
+	 * tmpfs populated by a test script) the attribute files are created on
+	 * demand and truncated at each write, to mimic the kernel behavior.
+	 */
+	bool cgfs_emulated;
+
+	/**
+	 * @brief True if the target system supports CFS quota management
+	 */
+	bool cfsQuotaSupported;
+
+	/**
+	 * @brief The memory nodes of each registered cluster
+	 *
+	 * This maps a cluster ID on the list of memory nodes configured for
+	 * the corresponding "nodeN" resources group, which are assigned to
+	 * applications scheduled on that cluster.
+	 */
+	std::map<unsigned short, std::string> cluster_mems;
+
+	/**
+	 * @brief The memory pages migration support
+	 */
+	MemoryMigratorPtr_t pmm;
+
+	/**
+	 * @brief The CPU frequency management support
+	 */
+	CPUFreqManagerPtr_t pcf;
+
+	/**
+	 * @brief The "silos" CGroup
+	 *
+	 * @see LinuxPP::psilos
+	 */
+	CGroupDataPtr_t psilos;
+
+	/**
+	 * @brief Mutex serializing the access to the "silos" CGroup
+	 *
+	 * @see LinuxPP::silos_mtx
+	 */
+	std::mutex silos_mtx;
+
+	/**
+	 * @brief The pool of pre-built (parked) control groups
+	 *
+	 * Parked control groups keep open their attributes file descriptors,
+	 * as well as the cache of the last written values, thus they are
+	 * ready to be configured for a new application.
+	 *
+	 * @see LinuxPP::cg_pool
+	 */
+	std::list<CGroupDataPtr_t> cg_pool;
+
+	/**
+	 * @brief The maximum number of control groups kept into the pool
+	 *
+	 * A zero value disables the pool.
+	 */
+	uint16_t cg_pool_size;
+
+	/**
+	 * @brief The ID of the next control group built for the pool
+	 */
+	uint32_t cg_pool_next;
+
+	/**
+	 * @brief Mutex protecting the control groups pool list
+	 */
+	std::mutex cg_pool_mtx;
+
+	/**
+	 * @brief Refill the pool in background
+	 *
+	 * @see LinuxPP::cg_pool_dfr
+	 */
+	Deferrable cg_pool_dfr;
+
+/**
+ * @defgroup group_plt_prx Platform Proxy
+ * @{
+ * @name Linux CGroupFS Platform Proxy
+ * @{
+ */
+
+	const char* _GetPlatformID();
+
+	ExitCode_t _LoadPlatformData();
+
+	ExitCode_t _Setup(AppPtr_t papp);
+
+	ExitCode_t _Release(AppPtr_t papp);
+
+	ExitCode_t _ReclaimResources(AppPtr_t papp);
+
+	ExitCode_t _MapResources(AppPtr_t papp, UsagesMapPtr_t pres,
+		RViewToken_t rvt, bool excl);
+
+	ExitCode_t _MapClusterResources(RViewToken_t rvt);
+
+	uint64_t _GetMemoryFootprint(AppPtr_t papp);
+
+/**
+ * @}
+ * @}
+ */
+
+	/**
+	 * @brief Get the absolute path of a cgroup for the specified controller
+	 */
+	std::string CGroupDir(CGController_t ctrl, std::string const & cgpath);
+
+	/**
+	 * @brief Read the value of an attribute of the specified cgroup
+	 *
+	 * @return true if the attribute has been read, false otherwise
+	 */
+	bool ReadAttribute(std::string const & cgpath, CGAttribute_t attr,
+			std::string & value);
+
+	/**
+	 * @brief Write the value of an attribute of the specified cgroup
+	 *
+	 * The value is actually written only if it is different from the one
+	 * previously written, unless the attribute is volatile (e.g. the list
+	 * of tasks) or the write is forced.
+	 */
+	ExitCode_t WriteAttribute(CGroupDataPtr_t &pcgd, CGAttribute_t attr,
+			std::string const & value, bool force = false);
+
+	ExitCode_t RegisterClusterCPUs(RLinuxBindingsPtr_t prlb);
+	ExitCode_t RegisterClusterMEMs(RLinuxBindingsPtr_t prlb);
+	ExitCode_t RegisterClusterFreq(RLinuxBindingsPtr_t prlb);
+	ExitCode_t ParseNode(const char *node);
+
+	ExitCode_t GetResouceMapping(AppPtr_t papp, UsagesMapPtr_t pum,
+		RViewToken_t rvt, RLinuxBindingsPtr_t prlb);
+
+	ExitCode_t BuildCGroup(CGroupDataPtr_t &pcgd);
+	ExitCode_t BuildSilosCG(CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Build a new control group to be kept into the pool
+	 */
+	ExitCode_t BuildPoolCG(CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Get a control group from the pool
+	 *
+	 * If the pool is empty, a new control group is built on demand.
+	 */
+	ExitCode_t GetPoolCG(AppPtr_t papp, CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Park a released control group into the pool
+	 *
+	 * @see LinuxPP::ParkCGroup
+	 */
+	void ParkCGroup(CGroupDataPtr_t &pcgd);
+
+	/**
+	 * @brief Build control groups up to the configured pool size
+	 */
+	void RefillPool();
+
+	/**
+	 * @brief Check if a process is listed into the specified control group
+	 *
+	 * @see LinuxPP::TaskInCGroup
+	 */
+	bool TaskInCGroup(app::AppPid_t pid, CGroupDataPtr_t const &pcgd);
+
+	ExitCode_t GetCGroupData(AppPtr_t papp, CGroupDataPtr_t &pcgd);
+	ExitCode_t SetupCGroup(CGroupDataPtr_t &pcgd, RLinuxBindingsPtr_t prlb,
+			bool excl = false, bool move = true);
+
+	ExitCode_t MoveTask(CGroupDataPtr_t &pcgd, app::AppPid_t pid);
+
+};
+
+} // namespace bbque
+
+#endif // BBQUE_LINUX_CGFS_PP_H_
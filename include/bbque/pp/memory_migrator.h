@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_MEMORY_MIGRATOR_H_
+#define BBQUE_MEMORY_MIGRATOR_H_
+
+#include "bbque/plugins/logger.h"
+#include "bbque/cpp11/condition_variable.h"
+#include "bbque/cpp11/mutex.h"
+#include "bbque/cpp11/thread.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+
+/**
+ * @brief The default minimum time between two consecutive migrations [ms]
+ */
+#define BBQUE_MEMMIG_PERIOD_DEFAULT 100
+
+/**
+ * @brief The maximum number of memory nodes supported
+ */
+#define BBQUE_MEMMIG_NODES_MAX 1024
+
+namespace bbque {
+
+/**
+ * @brief The NUMA memory pages migration support
+ * @ingroup sec20_pp_linux
+ *
+ * When an application is moved to a different cluster (i.e. NUMA node) its
+ * memory pages are left on the memory nodes of the previous cluster, unless
+ * they are explicitely migrated. This class supports the Linux platform
+ * proxies in migrating them, by either:
+ * <ul>
+ * <li><i>cgroup:</i> enabling the "cpuset.memory_migrate" attribute, thus
+ * letting the kernel synchronously migrate pages once the memory nodes of a
+ * control group are updated</li>
+ * <li><i>async:</i> migrating the pages of each task in background, by means
+ * of the migrate_pages system call, with a configurable rate limit to bound
+ * the memory bandwidth stolen to running applications</li>
+ * </ul>
+ */
+class MemoryMigrator {
+
+public:
+
+	/**
+	 * @brief The pages migration modes
+	 */
+	typedef enum MigrationMode {
+		/** Pages are not migrated */
+		MIGRATE_NONE = 0,
+		/** Pages are migrated by the kernel via cpuset.memory_migrate */
+		MIGRATE_CGROUP,
+		/** Pages are migrated in background via migrate_pages */
+		MIGRATE_ASYNC
+	} MigrationMode_t;
+
+	/**
+	 * @brief Build a new memory migrator
+	 *
+	 * @param mode The configured migration mode (e.g. "none", "cgroup" or
+	 * "async")
+	 * @param period The minimum time between two consecutive (async)
+	 * migrations [ms]
+	 * @param logger The logger to use
+	 */
+	MemoryMigrator(std::string const & mode, uint32_t period,
+			plugins::LoggerIF *logger);
+
+	~MemoryMigrator();
+
+	/**
+	 * @brief Get the configured migration mode
+	 */
+	inline MigrationMode_t Mode() const {
+		return mode;
+	}
+
+	/**
+	 * @brief Request the migration of the pages of a task
+	 *
+	 * The migration is queued and served in background, thus this call
+	 * does not block the caller. A request for a task already queued
+	 * just updates the target memory nodes of the pending migration.
+	 * This is a no-op if the async migration mode is not in use.
+	 *
+	 * @param pid The task which pages should be migrated
+	 * @param from The list of source memory nodes (e.g. "0-1,3")
+	 * @param to The list of destination memory nodes
+	 */
+	void Migrate(pid_t pid, std::string const & from, std::string const & to);
+
+	/**
+	 * @brief Get the resident memory reported by a memory.stat file
+	 *
+	 * @param path The path of a memory controller "memory.stat" file
+	 *
+	 * @return The amount of anonymous resident memory [Bytes], 0 if
+	 * not available
+	 */
+	static uint64_t ReadRSS(std::string const & path);
+
+	/**
+	 * @brief Parse a list of nodes into a bitmask
+	 *
+	 * @param list The nodes list, e.g. "0-1,3"
+	 * @param mask The bitmask to setup, of BBQUE_MEMMIG_NODES_MAX bits
+	 *
+	 * @return true if at least one node has been parsed
+	 */
+	static bool ParseNodes(const char *list, unsigned long *mask);
+
+private:
+
+	/**
+	 * @brief A pending migration request
+	 */
+	typedef struct MigrationRequest {
+		std::string from;
+		std::string to;
+	} MigrationRequest_t;
+
+	/**
+	 * @brief The logger to use
+	 */
+	plugins::LoggerIF *logger;
+
+	/**
+	 * @brief The configured migration mode
+	 */
+	MigrationMode_t mode;
+
+	/**
+	 * @brief The minimum time between two consecutive migrations [ms]
+	 */
+	uint32_t period;
+
+	/**
+	 * @brief The pending migrations, indexed by task PID
+	 */
+	std::map<pid_t, MigrationRequest_t> pending;
+
+	/**
+	 * @brief Set true to terminate the migration thread
+	 */
+	bool done;
+
+	/**
+	 * @brief Mutex protecting the pending migrations queue
+	 */
+	std::mutex pending_mtx;
+
+	/**
+	 * @brief Conditional variable used to signal new migrations
+	 */
+	std::condition_variable pending_cv;
+
+	/**
+	 * @brief The background migration thread
+	 */
+	std::thread migrator_thd;
+
+	/**
+	 * @brief The background migration thread body
+	 */
+	void Migrator();
+
+	/**
+	 * @brief Migrate the pages of a task
+	 */
+	void DoMigrate(pid_t pid, MigrationRequest_t const & req);
+
+};
+
+typedef std::shared_ptr<MemoryMigrator> MemoryMigratorPtr_t;
+
+} // namespace bbque
+
+#endif // BBQUE_MEMORY_MIGRATOR_H_
@@ -152,6 +152,17 @@ public:
 		return matches;
 	}
 
+	/**
+	 * @brief Find all the resources matching a template path
+	 *
+	 * @param temp_path Template path to match
+	 * @param matches The list to fill with the resource descriptors
+	 */
+	inline void findAll(std::string const & temp_path,
+			ResourcePtrList_t & matches) const {
+		find_node(root, temp_path, RT_ALL_MATCHES, matches);
+	}
+
 	/**
 	 * @brief Find a set of resources matching an hybrid path
 	 * @see RT_SET_MATCHES
@@ -175,6 +186,17 @@ public:
 		return matches;
 	}
 
+	/**
+	 * @brief Find a set of resources matching an hybrid path
+	 *
+	 * @param hyb_path The resource path in hybrid form
+	 * @param matches The list to fill with the resource descriptors
+	 */
+	inline void findSet(std::string const & hyb_path,
+			ResourcePtrList_t & matches) const {
+		find_node(root, hyb_path, RT_SET_MATCHES, matches);
+	}
+
 	/**
 	 * @brief Check resource existance by its template pathname.
 	 *
@@ -27,6 +27,7 @@
 #include <unordered_map>
 
 #include "bbque/app/application_status.h"
+#include "bbque/utils/arena.h"
 #include "bbque/utils/utility.h"
 
 /** @see WorkingMode BindResource */
@@ -55,8 +56,10 @@ typedef int16_t ResID_t;
 typedef size_t RViewToken_t;
 /** Shared pointer to Resource descriptor */
 typedef std::shared_ptr<Resource> ResourcePtr_t;
+/** Allocator of the lists of Resource descriptors (on the heap by default) */
+typedef bbque::utils::ArenaAllocator<ResourcePtr_t> ResourcePtrListAlloc_t;
 /** List of shared pointers to Resource descriptors */
-typedef std::list<ResourcePtr_t> ResourcePtrList_t;
+typedef std::list<ResourcePtr_t, ResourcePtrListAlloc_t> ResourcePtrList_t;
 /** Iterator of ResourcePtr_t list */
 typedef ResourcePtrList_t::iterator ResourcePtrListIterator_t;
 /** Shared pointer to ResourceState object */
@@ -96,7 +99,10 @@ struct ResourceState {
 		apps.clear();
 	}
 
-	/** The amount of resource used in the system   */
+	/**
+	 * The amount of resource used in the system, i.e. the highest amount
+	 * used by an application for shared resources
+	 */
 	uint64_t used;
 
 	/**
@@ -122,6 +128,12 @@ struct ResourceState {
  * temporary states to use as "buffers". Thus each state is a different VIEW
  * of resource. This feature is particularly useful for components like the
  * Scheduler/Optimizer (see below.)
+ *
+ * A resource could be also "shared", i.e. the amounts used by different
+ * applications are not summed-up (e.g. the frequency of a cluster). The
+ * amount required by each application is then granted as long as it does
+ * not exceed the total, and the resource is used as much as the highest
+ * amount required.
  */
 class Resource: public AttributesContainer {
 
@@ -173,6 +185,15 @@ public:
 		return total;
 	}
 
+	/**
+	 * @brief Check if the resource is shared among the applications
+	 * @return true if the amounts used by the applications are not
+	 * summed-up
+	 */
+	inline bool Shared() {
+		return shared;
+	}
+
 	/**
 	 * @brief Amount of resource used
 	 *
@@ -252,6 +273,9 @@ private:
 	/** The total amount of resource  */
 	uint64_t total;
 
+	/** True if the amounts used by the applications are not summed-up */
+	bool shared;
+
 	/**
 	 * Hash map with all the views of the resource.
 	 * A "view" is a resource state. We can think at the hash map as a map
@@ -278,6 +302,16 @@ private:
 		total = tot;
 	}
 
+	/**
+	 * @brief Set the resource as shared among the applications
+	 *
+	 * @param shr true if the amounts used by the applications should not
+	 * be summed-up
+	 */
+	inline void SetShared(bool shr) {
+		shared = shr;
+	}
+
 	/**
 	 * @brief Acquire a given amount of resource
 	 *
@@ -26,6 +26,7 @@
 #include <string>
 
 #include "bbque/res/resources.h"
+#include "bbque/utils/arena.h"
 
 namespace bbque { namespace res {
 
@@ -34,8 +35,12 @@ class Usage;
 
 /** Shared pointer to Usage object */
 typedef std::shared_ptr<Usage> UsagePtr_t;
+/** Allocator of the maps of Usage descriptors (on the heap by default) */
+typedef bbque::utils::ArenaAllocator<std::pair<const std::string, UsagePtr_t>>
+	UsagesMapAlloc_t;
 /** Map of Usage descriptors. Key: resource path */
-typedef std::map<std::string, UsagePtr_t> UsagesMap_t;
+typedef std::map<std::string, UsagePtr_t, std::less<std::string>,
+		UsagesMapAlloc_t> UsagesMap_t;
 /** Constant pointer to the map of Usage descriptors */
 typedef std::shared_ptr<UsagesMap_t> UsagesMapPtr_t;
 
@@ -84,8 +89,10 @@ public:
 	/**
 	 * @brief Constructor
 	 * @param usage_value The amount of resource usage
+	 * @param alloc The allocator of the resource bindings list
 	 */
-	Usage(uint64_t usage_value);
+	Usage(uint64_t usage_value,
+			ResourcePtrListAlloc_t const & alloc = ResourcePtrListAlloc_t());
 
 	/**
 	 * @brief Destructor
@@ -117,9 +124,10 @@ public:
 	 * pointing to the set of resource bindings effectively granted to the
 	 * Application/EXC.
 	 *
-	 * @param bind_list The list of resource descriptor for binding
+	 * @param bind_list The list of resource descriptor for binding, which
+	 * is copied by the allocator of the Usage bindings list
 	 */
-	void SetBindingList(ResourcePtrList_t bind_list);
+	void SetBindingList(ResourcePtrList_t const & bind_list);
 
 	/**
 	 * @brief Check of the resource binding list is empty
@@ -178,6 +178,24 @@ public:
 		return resources.findSet(path);
 	}
 
+	/**
+	 * @brief Get the resources matching a path into the specified list
+	 *
+	 * This allows the caller to choose the allocator of the list, e.g. to
+	 * get the resources bound by the scheduling policy on the scheduling
+	 * arena.
+	 *
+	 * @param path The resource path (template or hybrid)
+	 * @param matches The list to fill with the resource descriptors
+	 */
+	inline void GetResources(std::string const & path,
+			ResourcePtrList_t & matches) const {
+		if (ResourcePathUtils::IsTemplate(path))
+			resources.findAll(path, matches);
+		else
+			resources.findSet(path, matches);
+	}
+
 	/**
 	 * @see ResourceAccounterStatusIF
 	 */
@@ -226,13 +244,17 @@ public:
 	 * @param path Resource path
 	 * @param units Units for the amount value (i.e. "1", "Kbps", "Mb", ...)
 	 * @param amount The total amount available
+	 * @param shared True if the amounts booked by different applications
+	 * should not be summed-up, i.e. each booking just requires an amount
+	 * not exceeding the total one (e.g. the frequency of a cluster)
 	 *
 	 * @return RA_SUCCESS if the resource has been successfully registered.
 	 * RA_ERR_MISS_PATH if the path string is empty. RA_ERR_MEM if the
 	 * resource descriptor cannot be allocated.
 	 */
 	ExitCode_t RegisterResource(std::string const & path,
-			std::string const & units, uint64_t amount);
+			std::string const & units, uint64_t amount,
+			bool shared = false);
 
 	/**
 	 * @brief Book e a set of resources
@@ -21,6 +21,7 @@
 #include "bbque/config.h"
 #include "bbque/application_manager.h"
 #include "bbque/application_proxy.h"
+#include "bbque/metrics_exporter.h"
 #include "bbque/platform_proxy.h"
 #include "bbque/platform_services.h"
 #include "bbque/plugin_manager.h"
@@ -183,6 +184,11 @@ private:
 	 */
 	PlatformProxy & pp;
 
+	/**
+	 * @brief The Metrics Exporter module
+	 */
+	MetricsExporter & me;
+
 	std::bitset<EVENTS_COUNT> pendingEvts;
 
 	std::mutex pendingEvts_mtx;
@@ -47,7 +47,7 @@ extern "C" {
  * The mainor version is increased at each internal library updated which do
  * not preclude backward compatibilities.
  */
-#define RTLIB_VERSION_MINOR 3
+#define RTLIB_VERSION_MINOR 4
 
 /**
  * @brief The maximum length for an "application" name
@@ -670,6 +670,137 @@ typedef RTLIB_ExitCode_t (*RTLIB_CPS_CTimeUs)(
 
 /**@}*/
 
+/*******************************************************************************
+ *    Asynchronous Control Support
+ ******************************************************************************/
+
+/**
+ * @name Asynchronous Control Functions
+ *
+ * These functions queue a request, which is sent to the Barbeque RTRM by
+ * an RTLib thread, thus they never wait for a Barbeque response. The
+ * completion of a request could be notified by a callback or waited for by
+ * using the returned token. Still queued updates of the same constraint, or
+ * of the Goal-Gap, of an EXC are coalesced: only the latest value is sent
+ * and all the coalesced requests complete with the same result.
+ *
+ * @{
+ */
+
+/**
+ * @brief The token identifying an asynchronous request
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * A null token is returned when the request could not be queued.
+ */
+typedef uint32_t RTLIB_AsyncToken_t;
+
+/**
+ * @brief The completion callback of an asynchronous request
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * @param ech the handler of the EXC the request refers to
+ * @param token the token returned when the request has been queued
+ * @param result the exit code of the request
+ * @param data the data provided when the request has been queued
+ *
+ * @note the callback is run by the RTLib thread in charge of asynchronous
+ * requests, thus it should return as soon as possible
+ */
+typedef void (*RTLIB_Async_Callback)(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_AsyncToken_t token,
+		RTLIB_ExitCode_t result,
+		void *data);
+
+/**
+ * @brief Asynchronously enable an EXC
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * @param ech the handler of the EXC to enable
+ * @param cb the completion callback, if NULL the completion could be waited
+ * by using the returned token
+ * @param data the data passed to the callback
+ *
+ * @see RTLIB_Enable_t
+ */
+typedef RTLIB_AsyncToken_t (*RTLIB_Async_Enable)(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data);
+
+/**
+ * @brief Asynchronously disable an EXC
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * @see RTLIB_Async_Enable
+ * @see RTLIB_Disable_t
+ */
+typedef RTLIB_AsyncToken_t (*RTLIB_Async_Disable)(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data);
+
+/**
+ * @brief Asynchronously assert a set of constraints
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * The constraints are copied, thus the vector could be released as soon as
+ * this call returns.
+ *
+ * @see RTLIB_Async_Enable
+ * @see RTLIB_SetConstraints_t
+ */
+typedef RTLIB_AsyncToken_t (*RTLIB_Async_SetConstraints)(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Constraint_t *constraints,
+		uint8_t count,
+		RTLIB_Async_Callback cb, void *data);
+
+/**
+ * @brief Asynchronously release all the asserted constraints
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * Constraints still queued for the same EXC are dropped.
+ *
+ * @see RTLIB_Async_Enable
+ * @see RTLIB_ClearConstraints_t
+ */
+typedef RTLIB_AsyncToken_t (*RTLIB_Async_ClearConstraints)(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data);
+
+/**
+ * @brief Asynchronously assert a Goal-Gap
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * @see RTLIB_Async_Enable
+ * @see RTLIB_SetGoalGap_t
+ */
+typedef RTLIB_AsyncToken_t (*RTLIB_Async_SetGoalGap)(
+		RTLIB_ExecutionContextHandler_t ech,
+		uint8_t gap,
+		RTLIB_Async_Callback cb, void *data);
+
+/**
+ * @brief Wait for the completion of an asynchronous request
+ * @ingroup rtlib_sec03_plain_async
+ *
+ * Only requests queued without a callback could be waited for, and just
+ * once. The results are kept only for the 256 most recently completed
+ * requests, thus a request should be waited for while still pending.
+ *
+ * @param token the token of the request
+ * @param timeout_ms the maximum waiting time [ms], 0 to wait forever
+ *
+ * @return the exit code of the request, RTLIB_BBQUE_CHANNEL_TIMEOUT if the
+ * request has not been completed within the timeout, RTLIB_ERROR if the
+ * token does not refer to a request which could be waited for.
+ */
+typedef RTLIB_ExitCode_t (*RTLIB_Async_Wait)(
+		RTLIB_AsyncToken_t token,
+		uint32_t timeout_ms);
+
+/**@}*/
+
 /*******************************************************************************
  *    Performance Monitoring Support
  ******************************************************************************/
@@ -985,6 +1116,16 @@ struct RTLIB_Services {
 		/** Release notifier */
 		RTLIB_Notify_Release Release;
 	} Notify;
+
+	/* Asynchronous control interface */
+	struct {
+		RTLIB_Async_Enable Enable;
+		RTLIB_Async_Disable Disable;
+		RTLIB_Async_SetConstraints SetConstraints;
+		RTLIB_Async_ClearConstraints ClearConstraints;
+		RTLIB_Async_SetGoalGap SetGoalGap;
+		RTLIB_Async_Wait Wait;
+	} Async;
 };
 
 /**
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_AWM_MAILBOX_H_
+#define BBQUE_AWM_MAILBOX_H_
+
+#include <cstdint>
+#include <unistd.h>
+
+/** The name of each application AWM mailbox segment, given its PID */
+#define BBQUE_AWM_MAILBOX_FMT "/bbque_awm_%05d"
+
+#define BBQUE_AWM_MAILBOX_NAME_LENGTH 32
+
+#define BBQUE_AWM_MAILBOX_VERSION 2
+
+/** The magic number marking an initialized mailbox */
+#define BBQUE_AWM_MAILBOX_MAGIC 0xBB0EA3B0
+
+/** The number of slots, one for each possible EXC ID */
+#define BBQUE_AWM_MAILBOX_SLOTS 256
+
+/** The size of a cache line, used to avoid false sharing */
+#define BBQUE_AWM_MAILBOX_CACHELINE 64
+
+/** The assigned AWM is valid, i.e. no synchronization is pending */
+#define AWM_MBOX_VALID    0x01
+/** A synchronization has been started by Barbeque */
+#define AWM_MBOX_SYNC     0x02
+/** The EXC is going to be (or it has been) blocked */
+#define AWM_MBOX_BLOCKED  0x04
+
+namespace bbque { namespace rtlib {
+
+/**
+ * @brief The scheduling status of an EXC, as published by Barbeque
+ *
+ * Each slot is written only by Barbeque, which updates it within a sequence
+ * lock: the sequence number is odd while an update is in progress and it is
+ * incremented again once the update is completed. Thus, an application can
+ * detect any change of the slot just by comparing the sequence number with
+ * the one previously read.
+ */
+typedef struct awm_mailbox_slot {
+	/** The update sequence number */
+	uint32_t seq;
+	/** The ID of the assigned AWM (if valid) */
+	uint8_t awm_id;
+	/** The status flags, i.e. AWM_MBOX_* */
+	uint8_t flags;
+	/** The last required synchronization action */
+	uint8_t event;
+} __attribute__((aligned(BBQUE_AWM_MAILBOX_CACHELINE))) awm_mailbox_slot_t;
+
+/**
+ * @brief The AWM mailbox segment of an application
+ *
+ * This is created, and written, only by Barbeque when the application pairs,
+ * and it is removed once the application exits. The application maps it
+ * read-only, right after the pairing. Slots are indexed by the EXC ID.
+ */
+typedef struct awm_mailbox {
+	/** Set to BBQUE_AWM_MAILBOX_MAGIC once the mailbox is initialized */
+	uint32_t magic;
+	/** The mailbox layout version */
+	uint16_t version;
+	/** The application owning the mailbox */
+	pid_t app_pid;
+	/** The status of each EXC */
+	awm_mailbox_slot_t slots[BBQUE_AWM_MAILBOX_SLOTS]
+		__attribute__((aligned(BBQUE_AWM_MAILBOX_CACHELINE)));
+} awm_mailbox_t;
+
+/**
+ * @brief Publish a new status into a mailbox slot (Barbeque side)
+ */
+inline void awm_mailbox_publish(awm_mailbox_slot_t *slot,
+		uint8_t awm_id, uint8_t flags, uint8_t event) {
+	uint32_t seq = slot->seq;
+
+	// Mark the update in progress before touching the payload
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->awm_id = awm_id;
+	slot->flags  = flags;
+	slot->event  = event;
+	__atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Get the sequence number of a mailbox slot (application side)
+ */
+inline uint32_t awm_mailbox_seq(const awm_mailbox_slot_t *slot) {
+	return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Read a consistent snapshot of a mailbox slot (application side)
+ *
+ * @return the sequence number of the snapshot, which is always even
+ */
+inline uint32_t awm_mailbox_read(const awm_mailbox_slot_t *slot,
+		uint8_t & awm_id, uint8_t & flags) {
+	uint32_t seq;
+
+	do {
+		seq = awm_mailbox_seq(slot);
+		awm_id = slot->awm_id;
+		flags  = slot->flags;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((seq & 0x1) ||
+		(seq != __atomic_load_n(&slot->seq, __ATOMIC_RELAXED)));
+
+	return seq;
+}
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_AWM_MAILBOX_H_
@@ -306,6 +306,59 @@ public:
  */
 	RTLIB_ExitCode_t SetGoalGap(uint8_t percent);
 
+/**
+ * @brief Asynchronously set constraints on the AWM selection
+ *
+ * Same as SetConstraints(), but without waiting for the BarbequeRTRM
+ * response, thus this could be safely called on each processing cycle (e.g.
+ * from onMonitor) without delaying it. Updates still queued are coalesced.
+ *
+ * @param cb the completion callback, if NULL the returned token could be
+ * used to wait for the completion
+ * @param data the data passed to the callback
+ *
+ * @return the token of the request, 0 on errors
+ *
+ * @ingroup rtlib_sec02_aem_constr
+ */
+	RTLIB_AsyncToken_t SetConstraintsAsync(
+		RTLIB_Constraint_t *constraints,
+		uint8_t count,
+		RTLIB_Async_Callback cb = NULL, void *data = NULL);
+
+/**
+ * @brief Asynchronously clear all constraints on AWM selection
+ *
+ * @see SetConstraintsAsync
+ *
+ * @ingroup rtlib_sec02_aem_constr
+ */
+	RTLIB_AsyncToken_t ClearConstraintsAsync(
+		RTLIB_Async_Callback cb = NULL, void *data = NULL);
+
+/**
+ * @brief Asynchronously assert a new Goal-Gap
+ *
+ * Only the latest value asserted is sent to the BarbequeRTRM.
+ *
+ * @see SetConstraintsAsync
+ *
+ * @ingroup rtlib_sec02_aem_constr
+ */
+	RTLIB_AsyncToken_t SetGoalGapAsync(uint8_t percent,
+		RTLIB_Async_Callback cb = NULL, void *data = NULL);
+
+/**
+ * @brief Wait for the completion of an asynchronous request
+ *
+ * @param token the token returned by one of the asynchronous calls
+ * @param timeout_ms the maximum waiting time [ms], 0 to wait forever
+ *
+ * @ingroup rtlib_sec02_aem_constr
+ */
+	RTLIB_ExitCode_t WaitAsync(RTLIB_AsyncToken_t token,
+		uint32_t timeout_ms = 0);
+
 
 /*******************************************************************************
  *    AEM Utilities
@@ -20,7 +20,9 @@
 
 #include "bbque/rtlib.h"
 #include "bbque/config.h"
+#include "bbque/rtlib/awm_mailbox.h"
 #include "bbque/rtlib/rpc_messages.h"
+#include "bbque/rtlib/stats_ring.h"
 #include "bbque/utils/utility.h"
 #include "bbque/utils/timer.h"
 #include "bbque/cpp11/condition_variable.h"
@@ -31,9 +33,12 @@
 # include "bbque/utils/perf.h"
 #endif
 
+#include <deque>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
@@ -48,6 +53,9 @@
 #undef  MODULE_NAMESPACE
 #define MODULE_NAMESPACE "rpc"
 
+/** The number of asynchronous request results kept to be waited for */
+#define BBQUE_RTLIB_ASYNC_RESULTS 256
+
 using bbque::utils::Timer;
 using namespace boost::accumulators;
 
@@ -165,6 +173,37 @@ public:
 		return SetCPS(ech, static_cast<float>(1e6)/us);
 	}
 
+/*******************************************************************************
+ *    Asynchronous Control Support
+ ******************************************************************************/
+
+	RTLIB_AsyncToken_t AsyncEnable(
+			const RTLIB_ExecutionContextHandler_t ech,
+			RTLIB_Async_Callback cb, void *data);
+
+	RTLIB_AsyncToken_t AsyncDisable(
+			const RTLIB_ExecutionContextHandler_t ech,
+			RTLIB_Async_Callback cb, void *data);
+
+	RTLIB_AsyncToken_t AsyncSet(
+			const RTLIB_ExecutionContextHandler_t ech,
+			RTLIB_Constraint_t* constraints,
+			uint8_t count,
+			RTLIB_Async_Callback cb, void *data);
+
+	RTLIB_AsyncToken_t AsyncClear(
+			const RTLIB_ExecutionContextHandler_t ech,
+			RTLIB_Async_Callback cb, void *data);
+
+	RTLIB_AsyncToken_t AsyncGGap(
+			const RTLIB_ExecutionContextHandler_t ech,
+			uint8_t percent,
+			RTLIB_Async_Callback cb, void *data);
+
+	RTLIB_ExitCode_t AsyncWait(
+			RTLIB_AsyncToken_t token,
+			uint32_t timeout_ms);
+
 /*******************************************************************************
  *    Performance Monitoring Support
  ******************************************************************************/
@@ -237,6 +276,8 @@ protected:
 		pPerfEventAttr_t pattr;
 		/** Perf counter ID */
 		int id;
+		/** The index into the live statistics records, -1 if not exported */
+		int live_idx;
 		/** The statistics collected for this PRE */
 		accumulator_set<uint32_t,
 			stats<tag::min, tag::max, tag::variance>> samples;
@@ -311,6 +352,12 @@ protected:
 		RTLIB_ExitCode_t event;
 		/** The ID of the assigned AWM (if valid) */
 		uint8_t awm_id;
+		/**
+		 * The AWM mailbox sequence number at which the assigned AWM has
+		 * been last found valid, an odd value if the fast path could not
+		 * be used
+		 */
+		uint32_t mbox_seq;
 		/** The mutex protecting access to this structure */
 		std::mutex mtx;
 		/** The conditional variable to be notified on changes for this EXC */
@@ -330,6 +377,20 @@ protected:
 		utils::Perf perf;
 		/** Map of registered Perf counter IDs */
 		PerfRegisteredEventsMap_t events_map;
+		/** The sampling period [cycles] */
+		uint32_t perf_period;
+		/** The cycles to skip before the next sampled cycle */
+		uint32_t perf_skip;
+		/** The cycles elapsed since the last sampled one (included) */
+		uint32_t perf_cycles;
+		/** True if the current cycle is being sampled */
+		bool perf_sampling;
+		/** The timer used to measure the sampling overhead */
+		Timer perf_tmr;
+		/** The overhead [ms] of sampling the current cycle */
+		double perf_ovh;
+		/** The average overhead [ms] of a sampled cycle */
+		double perf_ovh_avg;
 #endif // CONFIG_BBQUE_RTLIB_PERF_SUPPORT
 
 		/** Statistics on AWM's of this EXC */
@@ -341,11 +402,28 @@ protected:
 		float cps_max;     // [Hz] the requried maximum CPS
 		float cps_expect;  // [ms] the expected cycle time
 
+		/** The cycles of the current live statistics window */
+		uint32_t live_cycles;
+		/** The AWM of the current live statistics window */
+		uint8_t live_awm;
+		/** The cycles time [ms] of the current live statistics window */
+		double live_sum;
+		float live_min;
+		float live_max;
+		/** The perf counters of the current live statistics window */
+		uint64_t live_perf[BBQUE_STATS_RING_PERF_MAX];
+
 		RegisteredExecutionContext(const char *_name, uint8_t id) :
-			name(_name), ctrlTrdPid(0), flags(0x00),
+			name(_name), ctrlTrdPid(0), flags(0x00), mbox_seq(1),
 			time_blocked(0), time_reconf(0), time_processing(0),
-			cps_tstart(0), cps_max(0) {
+#ifdef CONFIG_BBQUE_RTLIB_PERF_SUPPORT
+			perf_period(1), perf_skip(0), perf_cycles(0),
+			perf_sampling(false),
+			perf_ovh(0), perf_ovh_avg(0),
+#endif // CONFIG_BBQUE_RTLIB_PERF_SUPPORT
+			cps_tstart(0), cps_max(0), live_cycles(0) {
 				exc_id = id;
+				memset(live_perf, 0, sizeof(live_perf));
 		}
 
 		~RegisteredExecutionContext() {
@@ -431,6 +509,7 @@ protected:
 		DB(fprintf(stderr, FD("EXC  <= Unregistered [%d:%s]\n"),
 					prec->exc_id, prec->name.c_str()));
 		prec->flags &= ~EXC_FLAGS_EXC_REGISTERED;
+		MailboxUntrack(prec);
 	}
 
 	//--- EXC Enable status
@@ -446,6 +525,7 @@ protected:
 		DB(fprintf(stderr, FD("EXC  <= Disabled [%d:%s]\n"),
 					prec->exc_id, prec->name.c_str()));
 		prec->flags &= ~EXC_FLAGS_EXC_ENABLED;
+		MailboxUntrack(prec);
 	}
 
 	//--- EXC Blocked status
@@ -488,6 +568,19 @@ protected:
 	static char envMetricsTag[BBQUE_RTLIB_OPTS_TAG_MAX+2];
 	static bool envBigNum;
 	static const char *envCsvSep;
+	/** The target overhead [%] of sampled perf counters, 0 to disable */
+	static float envPerfSampling;
+/** The default target overhead [%] of the adaptive sampling */
+#define BBQUE_RTLIB_PERF_SAMPLING_TARGET 1.0
+/** The maximum number of cycles between two sampled cycles */
+#define BBQUE_RTLIB_PERF_SAMPLING_MAX 1024
+
+	//---- RPC channel options
+	static bool envPipelined;
+
+	//---- Live statistics options
+	/** The cycles of each live statistics window, 0 to disable */
+	static int envLiveStats;
 
 	/**
 	 * @brief Look-up configuration from environment variable BBQUE_RTLIB_OPTS
@@ -520,6 +613,17 @@ protected:
 
 	virtual void _Exit() = 0;
 
+	/**
+	 * @brief Send the pipelined requests still queued, if any
+	 *
+	 * Channels supporting pipelined requests (i.e. requests not waiting
+	 * for a response) could queue them to be sent all together. This is
+	 * called once for each processing cycle, to bound the requests delay.
+	 */
+	virtual RTLIB_ExitCode_t _Flush() {
+		return RTLIB_OK;
+	}
+
 
 /******************************************************************************
  * Synchronization Protocol Messages
@@ -652,6 +756,250 @@ private:
 	 */
 	std::string pathCGroup;
 
+/******************************************************************************
+ * AWM Mailbox
+ ******************************************************************************/
+
+	/**
+	 * @brief The AWM mailbox shared with Barbeque, NULL if not available
+	 *
+	 * Barbeque publishes into this segment the status of each EXC, which
+	 * is updated before starting any synchronization. Thus, while the
+	 * sequence number of an EXC slot does not change, the last AWM found
+	 * valid is still assigned and GetWorkingMode could return it without
+	 * locking the EXC.
+	 */
+	const awm_mailbox_t *mbox;
+
+	/**
+	 * @brief The name of the AWM mailbox segment
+	 */
+	char mbox_name[BBQUE_AWM_MAILBOX_NAME_LENGTH];
+
+	/**
+	 * @brief Map (read-only) the AWM mailbox segment
+	 *
+	 * The segment is created by Barbeque while pairing the application.
+	 * A failure is not fatal: GetWorkingMode always falls back to the
+	 * synchronization protocol.
+	 */
+	void MailboxSetup();
+
+	/**
+	 * @brief Unmap the AWM mailbox segment
+	 */
+	void MailboxRelease();
+
+	/**
+	 * @brief Get the assigned AWM if the mailbox says it is still valid
+	 *
+	 * @return true if the AWM has been returned without locking the EXC
+	 */
+	bool MailboxGetWorkingMode(pregExCtx_t prec,
+			RTLIB_WorkingModeParams_t *wm);
+
+	/**
+	 * @brief Enable the fast path once a valid AWM has been found
+	 *
+	 * @param seq the mailbox sequence number read before checking the EXC
+	 * status
+	 */
+	void MailboxTrack(pregExCtx_t prec, uint32_t seq);
+
+	/**
+	 * @brief Disable the fast path, e.g. once the EXC has been disabled
+	 */
+	inline void MailboxUntrack(pregExCtx_t prec) const {
+		__atomic_store_n(&prec->mbox_seq, 1, __ATOMIC_RELEASE);
+	}
+
+/******************************************************************************
+ * Live Statistics
+ ******************************************************************************/
+
+	/**
+	 * @brief The live statistics ring, NULL if not enabled
+	 */
+	rtlib_stats_ring_t *statsRing;
+
+	/**
+	 * @brief The path of the live statistics ring file
+	 */
+	std::string statsRingPath;
+
+	/**
+	 * @brief The mutex protecting the perf counters names of the ring
+	 */
+	std::mutex statsRing_mtx;
+
+	/**
+	 * @brief Create and map the live statistics ring
+	 *
+	 * A stale ring with the same name is replaced by a new file.
+	 */
+	void LiveStatsSetup(const char *name);
+
+	/**
+	 * @brief Unmap and remove the live statistics ring
+	 *
+	 * Readers which have already mapped the ring could still complete
+	 * its conversion.
+	 */
+	void LiveStatsRelease();
+
+	/**
+	 * @brief Get the index of a perf counter into the live records
+	 *
+	 * @return the counter index, -1 if there is no more space for it
+	 */
+	int LiveStatsCounter(const char *name);
+
+	/**
+	 * @brief Account a completed cycle into the current window
+	 */
+	void LiveStatsCycle(pregExCtx_t prec, double cycle_ms);
+
+	/**
+	 * @brief Append the record of the current window, if not empty
+	 */
+	void LiveStatsFlush(pregExCtx_t prec);
+
+/******************************************************************************
+ * Asynchronous Requests
+ ******************************************************************************/
+
+	/**
+	 * @brief The commands which could be asynchronously requested
+	 */
+	typedef enum AsyncCommand {
+		ASYNC_ENABLE = 0,
+		ASYNC_DISABLE,
+		ASYNC_SET,
+		ASYNC_CLEAR,
+		ASYNC_GGAP
+	} AsyncCommand_t;
+
+	/**
+	 * @brief A client waiting for the completion of a request
+	 */
+	typedef struct AsyncWaiter {
+		/** The token returned to the client */
+		RTLIB_AsyncToken_t token;
+		/** The completion callback, NULL if the result is waited */
+		RTLIB_Async_Callback cb;
+		/** The callback data */
+		void *data;
+	} AsyncWaiter_t;
+
+	/**
+	 * @brief A queued asynchronous request
+	 *
+	 * Coalesced requests are represented by a single request, with all
+	 * the corresponding waiters.
+	 */
+	typedef struct AsyncRequest {
+		/** The command to execute */
+		AsyncCommand_t cmd;
+		/** The EXC the command refers to */
+		RTLIB_ExecutionContextHandler_t ech;
+		/** The constraints to assert (ASYNC_SET only) */
+		std::vector<RTLIB_Constraint_t> constraints;
+		/** The Goal-Gap to assert (ASYNC_GGAP only) */
+		uint8_t gap;
+		/** The clients to notify on completion */
+		std::vector<AsyncWaiter_t> waiters;
+	} AsyncRequest_t;
+
+	typedef std::shared_ptr<AsyncRequest_t> pAsyncRequest_t;
+
+	/**
+	 * @brief The state of a request which result is waited
+	 */
+	typedef struct AsyncResult {
+		/** True once the request has been completed */
+		bool done;
+		/** The exit code of the request */
+		RTLIB_ExitCode_t result;
+	} AsyncResult_t;
+
+	/**
+	 * @brief The requests queued, and not yet sent
+	 */
+	std::list<pAsyncRequest_t> asyncQueue;
+
+	/**
+	 * @brief The requests which result is waited, by token
+	 */
+	std::map<RTLIB_AsyncToken_t, AsyncResult_t> asyncResults;
+
+	/**
+	 * @brief The tokens of the completed requests, oldest first
+	 *
+	 * At most BBQUE_RTLIB_ASYNC_RESULTS results are kept, thus the
+	 * results never waited for do not pile up.
+	 */
+	std::deque<RTLIB_AsyncToken_t> asyncCompleted;
+
+	/**
+	 * @brief The last token returned
+	 */
+	RTLIB_AsyncToken_t asyncToken;
+
+	/**
+	 * @brief True if the asynchronous requests thread must exit
+	 */
+	bool asyncDone;
+
+	/**
+	 * @brief The thread sending the asynchronous requests
+	 *
+	 * This is started by the first asynchronous request.
+	 */
+	std::thread asyncTrd;
+
+	/**
+	 * @brief Protect the asynchronous requests queue and results
+	 */
+	std::mutex async_mtx;
+
+	/**
+	 * @brief Notify new requests to the asynchronous requests thread
+	 */
+	std::condition_variable asyncQueue_cv;
+
+	/**
+	 * @brief Notify the completion of waited requests
+	 */
+	std::condition_variable asyncResults_cv;
+
+	/**
+	 * @brief Queue a new request, eventually coalescing it
+	 *
+	 * @return the token of the request, 0 on errors
+	 */
+	RTLIB_AsyncToken_t AsyncPost(pAsyncRequest_t preq,
+			RTLIB_Async_Callback cb, void *data);
+
+	/**
+	 * @brief Coalesce a new request into an already queued one
+	 *
+	 * @return the queued request, if any, which the new one has been
+	 * coalesced into
+	 */
+	pAsyncRequest_t AsyncCoalesce(pAsyncRequest_t preq);
+
+	/**
+	 * @brief The asynchronous requests thread
+	 */
+	void AsyncTrd();
+
+	/**
+	 * @brief Terminate the asynchronous requests thread
+	 *
+	 * The requests already queued are sent before exiting.
+	 */
+	void AsyncStop();
+
 	/**
 	 * @brief Get the next available (and unique) Execution Context ID
 	 */
@@ -836,14 +1184,39 @@ private:
 		prec->perf.Enable();
 	}
 
+	/**
+	 * @brief Start counting the current onRun cycle
+	 *
+	 * With adaptive sampling enabled, counters are enabled just once every
+	 * perf_period cycles, and the overhead of doing that is measured.
+	 */
+	void PerfSampleBegin(pregExCtx_t prec);
+
+	/**
+	 * @brief Stop counting the current onRun cycle and collect statistics
+	 *
+	 * With adaptive sampling enabled, the sampling period is then tuned so
+	 * that the average overhead of a sampled cycle is the target
+	 * percentage of the time of all the cycles it represents.
+	 */
+	void PerfSampleEnd(pregExCtx_t prec);
+
 	void PerfSetupEvents(pregExCtx_t prec);
 
 	void PerfSetupStats(pregExCtx_t prec, pAwmStats_t pstats);
 
-	void PerfCollectStats(pregExCtx_t prec);
+	/**
+	 * @brief Accumulate the perf counters of the last counted cycle
+	 *
+	 * @param cycles the number of cycles the counted one accounts for,
+	 * i.e. all the cycles elapsed since the previous sample
+	 */
+	void PerfCollectStats(pregExCtx_t prec, uint32_t cycles);
 
 	void PerfPrintStats(pregExCtx_t prec, pAwmStats_t pstats);
 
+	void PerfPrintSampling(pregExCtx_t prec);
+
 	bool IsNsecCounter(pregExCtx_t prec, int fd);
 
 	void PerfPrintNsec(pAwmStats_t pstats, pPerfEventStats_t ppes);
@@ -864,8 +1237,11 @@ private:
 # define PerfSetupEvents(prec) {}
 # define PerfEnable(prec) {}
 # define PerfDisable(prec) {}
-# define PerfCollectStats(prec) {}
+# define PerfCollectStats(prec, cycles) {}
+# define PerfSampleBegin(prec) {}
+# define PerfSampleEnd(prec) {}
 # define PerfPrintStats(prec, pstats) {}
+# define PerfPrintSampling(prec) {}
 #endif // CONFIG_BBQUE_RTLIB_PERF_SUPPORT
 
 
@@ -26,6 +26,7 @@
 #include "bbque/cpp11/condition_variable.h"
 #include "bbque/cpp11/thread.h"
 
+#include <climits>
 #include <sys/epoll.h>
 
 
@@ -74,6 +75,8 @@ protected:
 
 	void _Exit();
 
+	RTLIB_ExitCode_t _Flush();
+
 	inline uint32_t RpcMsgToken() {
 		return chTrdPid;
 	}
@@ -148,6 +151,43 @@ private:
 	 */
 	rpc_msg_resp_t chResp;
 
+	/**
+	 * @brief Serialize the writes on the Barbeque FIFO
+	 *
+	 * This protects the queue of pipelined requests, which is flushed by
+	 * any other message sent, from both the application and the channel
+	 * fetch thread.
+	 */
+	std::mutex chSend_mtx;
+
+	/**
+	 * @brief The queue of pipelined requests not yet sent
+	 *
+	 * Pipelined requests are queued, as FIFO messages, and sent all
+	 * together by a single write once the queue is flushed. The queue is
+	 * bounded to PIPE_BUF to keep the write atomic.
+	 */
+	uint8_t txQueue[PIPE_BUF];
+
+	/**
+	 * @brief The bytes queued into txQueue
+	 */
+	size_t txQueued;
+
+	/**
+	 * @brief Send a message, preceded by all the queued ones
+	 */
+	RTLIB_ExitCode_t ChannelSend(const void *buf, size_t count);
+
+	/**
+	 * @brief Queue a pipelined message
+	 *
+	 * @param replace if true, a queued message of the same type for the
+	 * same EXC is updated, rather than queuing a new one
+	 */
+	RTLIB_ExitCode_t ChannelQueue(const void *buf, size_t count,
+			bool replace = false);
+
 	RTLIB_ExitCode_t ChannelRelease();
 
 	RTLIB_ExitCode_t ChannelSetup();
@@ -67,6 +67,16 @@ typedef enum rpc_msg_type {
 
 typedef uint32_t rpc_msg_token_t;
 
+/**
+ * @brief The token flag marking a pipelined request
+ *
+ * The sender of a pipelined request does not wait for its response, thus
+ * only a failure is notified back, by a response carrying the same token.
+ * The requests of each EXC are served by Barbeque in the order they have
+ * been sent.
+ */
+#define RPC_MSG_TOKEN_PIPELINED 0x80000000
+
 /**
  * @brief The RPC message header
  */
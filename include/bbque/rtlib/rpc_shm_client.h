@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SHM_CLIENT_H_
+#define BBQUE_RPC_SHM_CLIENT_H_
+
+#include "bbque/rtlib.h"
+
+#include "bbque/rtlib/bbque_rpc.h"
+#include "bbque/rtlib/rpc_messages.h"
+#include "bbque/rtlib/rpc_shm_server.h"
+#include "bbque/cpp11/condition_variable.h"
+#include "bbque/cpp11/thread.h"
+
+
+namespace bbque { namespace rtlib {
+
+/**
+ * @brief Client side of the RPC shared memory channel
+ *
+ * Definition of the RPC protocol based on POSIX shared memory to implement
+ * the Barbeque communication channel. Messages are exchanged by means of a
+ * pair of ring buffers hosted by a segment created by the application, while
+ * the public segment exported by Barbeque is used just to pair and to notify
+ * new messages.
+ * The communication protocol must be aligend with the RTLib supported
+ * services.
+ *
+ * @see bbque/rtlib.h
+ * @see bbque/rtlib/rpc_messages.h
+ * @see bbque/rtlib/rpc_shm_server.h
+ */
+class BbqueRPC_SHM_Client : public BbqueRPC {
+
+public:
+
+	BbqueRPC_SHM_Client();
+
+	~BbqueRPC_SHM_Client();
+
+protected:
+
+	RTLIB_ExitCode_t _Init(const char *name);
+
+	RTLIB_ExitCode_t _Register(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _Unregister(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _Enable(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _Disable(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _ScheduleRequest(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _Set(pregExCtx_t prec,
+			RTLIB_Constraint* constraints, uint8_t count);
+
+	RTLIB_ExitCode_t _Clear(pregExCtx_t prec);
+
+	RTLIB_ExitCode_t _GGap(pregExCtx_t prec, uint8_t gap);
+
+	void _Exit();
+
+	inline uint32_t RpcMsgToken() {
+		return chTrdPid;
+	}
+
+/******************************************************************************
+ * Synchronization Protocol Messages
+ ******************************************************************************/
+
+	RTLIB_ExitCode_t _SyncpPreChangeResp(
+			rpc_msg_token_t token,
+			pregExCtx_t prec,
+			uint32_t syncLatency);
+
+	RTLIB_ExitCode_t _SyncpSyncChangeResp(
+			rpc_msg_token_t token,
+			pregExCtx_t prec,
+			RTLIB_ExitCode_t sync);
+
+	RTLIB_ExitCode_t _SyncpPostChangeResp(
+			rpc_msg_token_t token,
+			pregExCtx_t prec,
+			RTLIB_ExitCode_t result);
+
+private:
+
+	char app_shm_name[BBQUE_SHM_NAME_LENGTH];
+
+	/**
+	 * @brief The mapped Barbeque public segment
+	 */
+	rpc_shm_server_t *server;
+
+	/**
+	 * @brief The mapped application segment
+	 */
+	rpc_shm_channel_t *channel;
+
+	/**
+	 * @brief The slot of the public segment used by this application
+	 */
+	int slot;
+
+	/**
+	 * @brief The read cursor of the responses ring
+	 */
+	uint32_t cursor;
+
+	bool done;
+
+	bool running;
+
+	std::thread ChTrd;
+
+	std::mutex trdStatus_mtx;
+
+	std::condition_variable trdStatus_cv;
+
+	/**
+	 * @brief Serialize sending of command using the library
+	 *
+	 * The current implementation of the library allows to send a single
+	 * command at each time for single library instance. This is required do
+	 * properly handle responses from Barbque.
+	 * This mutex should be used to protect the chResp responce attribute,
+	 * which is always set to the last received response from Barbques.
+	 *
+	 * @see chResp
+	 */
+	std::mutex chCommand_mtx;
+
+	/**
+	 * @brief Serialize the writes into the requests ring
+	 *
+	 * The requests ring supports a single producer, while synchronization
+	 * protocol responses are sent by the channel thread without holding
+	 * the chCommand_mtx.
+	 */
+	std::mutex chSend_mtx;
+
+	/**
+	 * @brief Signal the reception of a response from Barbeque
+	 *
+	 * Each time a new message has been received from Barbeque by the channel
+	 * fetch thread, this variable is notified. Thus, commands could wait for
+	 * a response by susepnding on it.
+	 */
+	std::condition_variable chResp_cv;
+
+	/**
+	 * @brief The last response reveiced by Barbeque
+	 *
+	 * This attribute should be always protected by the chCommand_mtx
+	 */
+	rpc_msg_resp_t chResp;
+
+	RTLIB_ExitCode_t ChannelRelease();
+
+	RTLIB_ExitCode_t ChannelSetup();
+
+	RTLIB_ExitCode_t ChannelPair(const char *name);
+
+	/**
+	 * @brief Write a message into the requests ring and notify Barbeque
+	 *
+	 * The message could be provided as two separate buffers, which are
+	 * gathered into a single ring record.
+	 */
+	RTLIB_ExitCode_t ChannelSend(const void *buf, size_t count,
+			const void *buf2 = NULL, size_t count2 = 0);
+
+	void ChannelFetch();
+
+	void ChannelTrd(const char *name);
+
+	void RpcBbqResp(rpc_msg_header_t *msg);
+
+};
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_RPC_SHM_CLIENT_H_
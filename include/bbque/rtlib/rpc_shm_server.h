@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SHM_SERVER_H_
+#define BBQUE_RPC_SHM_SERVER_H_
+
+#include "bbque/rtlib/rpc_messages.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/** The name of the Barbeque public shared memory segment */
+#define BBQUE_PUBLIC_SHM "/bbque_rpc_shm"
+
+/** The name of each application channel segment, given its PID */
+#define BBQUE_SHM_CHANNEL_FMT "/bbque_rpc_shm_%05d"
+
+#define BBQUE_SHM_NAME_LENGTH 32
+
+#define BBQUE_RPC_SHM_MAJOR_VERSION 1
+#define BBQUE_RPC_SHM_MINOR_VERSION 0
+
+/** The magic number marking an initialized segment */
+#define BBQUE_RPC_SHM_MAGIC 0xBB0E5A3D
+
+/** The maximum number of applications concurrently paired */
+#define BBQUE_RPC_SHM_CHANNELS 64
+
+/** The bytes of each ring buffer (must be a power of 2) */
+#define BBQUE_RPC_SHM_RING_SIZE 8192
+
+/** The maximum bytes of an RPC message */
+#define BBQUE_RPC_SHM_MSG_MAX (BBQUE_RPC_SHM_RING_SIZE / 2)
+
+/** The size of a cache line, used to avoid false sharing */
+#define BBQUE_RPC_SHM_CACHELINE 64
+
+#define SHM_REC_ALIGN(BYTES) (((BYTES) + 7) & ~7)
+#define SHM_REC_SIZE(BYTES) \
+	SHM_REC_ALIGN(sizeof(bbque::rtlib::rpc_shm_record_t) + (BYTES))
+
+namespace bbque { namespace rtlib {
+
+/**
+ * @brief The header of each message into a ring buffer
+ */
+typedef struct rpc_shm_record {
+	/** The bytes of the record, header included */
+	uint32_t size;
+	/** The record flags, e.g. padding or released records */
+	uint16_t flags;
+	/** Unused, keeps the messages 8 bytes aligned */
+	uint16_t reserved;
+} rpc_shm_record_t;
+
+/** A record used to pad the ring till its end */
+#define RPC_SHM_REC_PAD   0x1
+/** A record released by the reader */
+#define RPC_SHM_REC_FREED 0x2
+
+/**
+ * @brief A Single-Producer/Single-Consumer ring buffer
+ *
+ * Messages are written as variable size records, which are never wrapped
+ * around the end of the ring: the remaining space is filled by a padding
+ * record instead. The producer and consumer offsets are free running
+ * counters, thus the number of used bytes is always (head - tail).
+ * The consumer keeps a private read cursor, thus received messages could be
+ * accessed in place and released even out of order: the tail is moved
+ * forward only across contiguous released records.
+ *
+ * Since the peer could write the ring at any time, the consumer reads each
+ * record header just once, and it never trusts a record which does not fit
+ * into the ring.
+ */
+typedef struct rpc_shm_ring {
+	/** The producer offset */
+	uint32_t head
+		__attribute__((aligned(BBQUE_RPC_SHM_CACHELINE)));
+	/** Set by the consumer while waiting for new records on head */
+	uint32_t sleeping;
+	/** The consumer offset */
+	uint32_t tail
+		__attribute__((aligned(BBQUE_RPC_SHM_CACHELINE)));
+	/** The records buffer */
+	uint8_t data[BBQUE_RPC_SHM_RING_SIZE]
+		__attribute__((aligned(BBQUE_RPC_SHM_CACHELINE)));
+} rpc_shm_ring_t;
+
+/**
+ * @brief The shared memory segment of an application channel
+ *
+ * This is created by the application, and it is mapped by Barbeque once the
+ * application has been registered into a free slot of the public segment.
+ */
+typedef struct rpc_shm_channel {
+	/** Set to BBQUE_RPC_SHM_MAGIC once the channel is initialized */
+	uint32_t magic;
+	/** The channel protocol version */
+	uint16_t major;
+	uint16_t minor;
+	/** The application owning the channel */
+	pid_t app_pid;
+	/** The application to Barbeque messages */
+	rpc_shm_ring_t req;
+	/** The Barbeque to applications messages */
+	rpc_shm_ring_t resp;
+} rpc_shm_channel_t;
+
+/**
+ * @brief The Barbeque public shared memory segment
+ *
+ * Applications pair with Barbeque by writing their PID into a free slot.
+ * Since Barbeque consumes the messages of all the applications, it waits on
+ * a single "doorbell", which is rung by applications for each message sent.
+ */
+typedef struct rpc_shm_server {
+	/** Set to BBQUE_RPC_SHM_MAGIC once the server is ready */
+	uint32_t magic;
+	/** The channel protocol version */
+	uint16_t major;
+	uint16_t minor;
+	/** Incremented by applications for each new message */
+	uint32_t doorbell
+		__attribute__((aligned(BBQUE_RPC_SHM_CACHELINE)));
+	/** Set by Barbeque while waiting for new messages on doorbell */
+	uint32_t sleeping;
+	/** The PID of the application using each slot, 0 if free */
+	pid_t slots[BBQUE_RPC_SHM_CHANNELS]
+		__attribute__((aligned(BBQUE_RPC_SHM_CACHELINE)));
+} rpc_shm_server_t;
+
+
+/******************************************************************************
+ * Futex based wake-ups
+ ******************************************************************************/
+
+/**
+ * @brief Wait for the specified word being changed from the expected value
+ *
+ * @param timeout_ms the maximum waiting time, 0 to wait forever
+ */
+inline int rpc_shm_futex_wait(uint32_t *uaddr, uint32_t val,
+		uint32_t timeout_ms = 0) {
+	struct timespec ts = {
+		(time_t)(timeout_ms / 1000),
+		(long)(timeout_ms % 1000) * 1000000
+	};
+	// NOTE: the futex is shared among processes, thus it must not be a
+	// FUTEX_PRIVATE one
+	return syscall(SYS_futex, uaddr, FUTEX_WAIT, val,
+			timeout_ms ? &ts : NULL, NULL, 0);
+}
+
+/**
+ * @brief Wake-up all the waiters of the specified word
+ */
+inline int rpc_shm_futex_wake(uint32_t *uaddr) {
+	return syscall(SYS_futex, uaddr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
+/******************************************************************************
+ * Ring buffer access
+ ******************************************************************************/
+
+inline rpc_shm_record_t *rpc_shm_ring_record(rpc_shm_ring_t *ring,
+		uint32_t offset) {
+	return (rpc_shm_record_t *)
+		&ring->data[offset & (BBQUE_RPC_SHM_RING_SIZE - 1)];
+}
+
+/**
+ * @brief Check if a record header is consistent
+ *
+ * @param offset the ring offset of the record
+ * @param size the bytes of the record, as read from its header
+ */
+inline bool rpc_shm_record_valid(uint32_t offset, uint32_t size) {
+	if (size < sizeof(rpc_shm_record_t))
+		return false;
+	if (size != SHM_REC_ALIGN(size))
+		return false;
+	// A record is never wrapped around the end of the ring
+	return (size <= BBQUE_RPC_SHM_RING_SIZE -
+			(offset & (BBQUE_RPC_SHM_RING_SIZE - 1)));
+}
+
+/**
+ * @brief Get the message of a record
+ */
+inline rpc_msg_header_t *rpc_shm_record_msg(rpc_shm_record_t *rec) {
+	return (rpc_msg_header_t *)(rec + 1);
+}
+
+/**
+ * @brief Get the record of a message
+ */
+inline rpc_shm_record_t *rpc_shm_msg_record(rpc_msg_header_t *msg) {
+	return ((rpc_shm_record_t *)msg) - 1;
+}
+
+/**
+ * @brief Write a message into the ring (producer side)
+ *
+ * The message could be provided as two separate buffers (e.g. a header and
+ * a payload), which are gathered into the same record.
+ *
+ * @return false if there is not enough free space
+ */
+inline bool rpc_shm_ring_push(rpc_shm_ring_t *ring,
+		const void *buf, size_t count,
+		const void *buf2 = NULL, size_t count2 = 0) {
+	uint32_t head = ring->head;
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	uint32_t size = SHM_REC_SIZE(count + count2);
+	uint32_t room = BBQUE_RPC_SHM_RING_SIZE -
+		(head & (BBQUE_RPC_SHM_RING_SIZE - 1));
+	rpc_shm_record_t *rec;
+
+	if (count + count2 > BBQUE_RPC_SHM_MSG_MAX)
+		return false;
+
+	// A record is never wrapped: pad till the end of the ring
+	if (room < size) {
+		if (BBQUE_RPC_SHM_RING_SIZE - (head - tail) < room + size)
+			return false;
+		rec = rpc_shm_ring_record(ring, head);
+		rec->size = room;
+		rec->flags = RPC_SHM_REC_PAD;
+		head += room;
+	} else if (BBQUE_RPC_SHM_RING_SIZE - (head - tail) < size) {
+		return false;
+	}
+
+	rec = rpc_shm_ring_record(ring, head);
+	rec->size = size;
+	rec->flags = 0;
+	rec->reserved = 0;
+	::memcpy(rpc_shm_record_msg(rec), buf, count);
+	if (count2)
+		::memcpy(((uint8_t *)rpc_shm_record_msg(rec)) + count,
+				buf2, count2);
+
+	// Publish the record, and then check if the consumer is sleeping
+	// NOTE: both must be sequentially consistent, to pair with the
+	// consumer setting "sleeping" before checking the head
+	__atomic_store_n(&ring->head, head + size, __ATOMIC_SEQ_CST);
+	return true;
+}
+
+/**
+ * @brief Check if the consumer should be woken-up (producer side)
+ */
+inline bool rpc_shm_ring_sleeping(rpc_shm_ring_t *ring) {
+	return __atomic_load_n(&ring->sleeping, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Get the next record to read (consumer side)
+ *
+ * @param cursor the consumer private read offset, which is moved to the
+ * next record
+ * @param rec set to the next record to read
+ * @param size set to the bytes of the record, which must be used in place of
+ * the (peer writable) record header
+ *
+ * @return 0 on success, -EAGAIN if the ring is empty, -EBADMSG if the ring
+ * has been corrupted by the producer
+ */
+inline int rpc_shm_ring_peek(rpc_shm_ring_t *ring, uint32_t & cursor,
+		rpc_shm_record_t *& rec, uint32_t & size) {
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint16_t flags;
+
+	while (cursor != head) {
+		rec = rpc_shm_ring_record(ring, cursor);
+		size = __atomic_load_n(&rec->size, __ATOMIC_RELAXED);
+		flags = __atomic_load_n(&rec->flags, __ATOMIC_RELAXED);
+		if (!rpc_shm_record_valid(cursor, size) ||
+				(head - cursor < size))
+			return -EBADMSG;
+		cursor += size;
+		if (!(flags & RPC_SHM_REC_PAD))
+			return 0;
+	}
+
+	return -EAGAIN;
+}
+
+/**
+ * @brief Release a record (consumer side)
+ *
+ * The space of the released record is given back to the producer only once
+ * all the previous records have been released too.
+ */
+inline void rpc_shm_ring_release(rpc_shm_ring_t *ring,
+		rpc_shm_record_t *rec, uint32_t cursor) {
+	uint32_t tail = ring->tail;
+	uint32_t size;
+
+	__atomic_fetch_or(&rec->flags, RPC_SHM_REC_FREED, __ATOMIC_RELAXED);
+	while (tail != cursor) {
+		rec = rpc_shm_ring_record(ring, tail);
+		if (!(__atomic_load_n(&rec->flags, __ATOMIC_RELAXED) &
+					(RPC_SHM_REC_FREED | RPC_SHM_REC_PAD)))
+			break;
+		// Never move the tail beyond the records already read
+		size = __atomic_load_n(&rec->size, __ATOMIC_RELAXED);
+		if (!rpc_shm_record_valid(tail, size) || (cursor - tail < size))
+			break;
+		tail += size;
+	}
+
+	__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Wait for new records (consumer side)
+ *
+ * @param cursor the consumer private read offset
+ * @param timeout_ms the maximum waiting time, 0 to wait forever
+ */
+inline void rpc_shm_ring_wait(rpc_shm_ring_t *ring, uint32_t cursor,
+		uint32_t timeout_ms = 0) {
+	__atomic_store_n(&ring->sleeping, 1, __ATOMIC_SEQ_CST);
+	// The futex returns immediately if the head has been already moved
+	rpc_shm_futex_wait(&ring->head, cursor, timeout_ms);
+	__atomic_store_n(&ring->sleeping, 0, __ATOMIC_RELAXED);
+}
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_RPC_SHM_SERVER_H_
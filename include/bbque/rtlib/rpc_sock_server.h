@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_RPC_SOCK_SERVER_H_
+#define BBQUE_RPC_SOCK_SERVER_H_
+
+#include "bbque/rtlib.h"
+
+#include "bbque/rtlib/rpc_messages.h"
+
+/** The name of the Barbeque public socket, into the RPC dir */
+#define BBQUE_PUBLIC_SOCK "rpc_sock"
+
+#define BBQUE_RPC_SOCK_MAJOR_VERSION 1
+#define BBQUE_RPC_SOCK_MINOR_VERSION 0
+
+/**
+ * @brief The maximum bytes of an RPC message
+ *
+ * This is enough to host an EXC_SET command with the maximum number of
+ * constraints, thus each message could be received into a fixed size
+ * buffer. Being the socket a SOCK_SEQPACKET one, each message is sent and
+ * received with a single system call, without any additional framing.
+ */
+#define BBQUE_RPC_SOCK_MSG_MAX \
+	(sizeof(bbque::rtlib::rpc_msg_EXC_SET_t) + \
+	 (255 * sizeof(RTLIB_Constraint_t)))
+
+#endif // BBQUE_RPC_SOCK_SERVER_H_
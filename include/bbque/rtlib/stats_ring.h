@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_STATS_RING_H_
+#define BBQUE_STATS_RING_H_
+
+#include <cstdint>
+#include <cstring>
+#include <time.h>
+#include <unistd.h>
+
+/** The name of each application statistics ring, given its PID and name */
+#define BBQUE_STATS_RING_FMT "bbque_stats_%05d_%s"
+
+#define BBQUE_STATS_RING_VERSION 1
+
+/** The magic number marking an initialized ring */
+#define BBQUE_STATS_RING_MAGIC 0xBB0E57A7
+
+/** The number of records of a ring (must be a power of 2) */
+#define BBQUE_STATS_RING_RECORDS 4096
+
+/** The maximum number of perf counters of a record */
+#define BBQUE_STATS_RING_PERF_MAX 24
+
+/** The maximum length of EXC and counter names */
+#define BBQUE_STATS_RING_NAME_LENGTH 32
+
+/** The number of EXC names, one for each possible EXC ID */
+#define BBQUE_STATS_RING_EXCS 256
+
+/** The size of a cache line, used to avoid false sharing */
+#define BBQUE_STATS_RING_CACHELINE 64
+
+namespace bbque { namespace rtlib {
+
+/**
+ * @brief The statistics of a window of cycles of an EXC
+ */
+typedef struct rtlib_stats_record {
+	/** The record index + 1, 0 while the record is being written */
+	uint64_t seq;
+	/** The time [us] the window has been closed (CLOCK_MONOTONIC) */
+	uint64_t tstamp_us;
+	/** The number of cycles of this window */
+	uint32_t cycles;
+	/** The EXC ID */
+	uint8_t exc_id;
+	/** The AWM ID */
+	uint8_t awm_id;
+	/** The number of valid perf counters */
+	uint8_t nr_perf;
+	uint8_t reserved;
+	/** The average, minimum and maximum cycle time [ms] */
+	float time_avg_ms;
+	float time_min_ms;
+	float time_max_ms;
+	/** The perf counters deltas, cumulated over the window */
+	uint64_t perf[BBQUE_STATS_RING_PERF_MAX];
+} __attribute__((aligned(BBQUE_STATS_RING_CACHELINE))) rtlib_stats_record_t;
+
+/**
+ * @brief The statistics ring of an application
+ *
+ * The ring is a memory mapped file, created by the RTLib and removed once
+ * the application exits, where each EXC appends a record at the end of each
+ * window of cycles. Records are never
+ * blocked by readers: the oldest ones are simply overwritten, thus readers
+ * detect lost records by the sequence number of each record.
+ */
+typedef struct rtlib_stats_ring {
+	/** Set to BBQUE_STATS_RING_MAGIC once the ring is initialized */
+	uint32_t magic;
+	/** The ring layout version */
+	uint16_t version;
+	/** The number of cycles of each window */
+	uint16_t window;
+	/** The application owning the ring */
+	pid_t app_pid;
+	/** The time [us] the ring has been created (CLOCK_MONOTONIC) */
+	uint64_t tstart_us;
+	/** The number of perf counters */
+	uint32_t nr_perf;
+	/** The name of each perf counter */
+	char perf_names[BBQUE_STATS_RING_PERF_MAX][BBQUE_STATS_RING_NAME_LENGTH];
+	/** The name of each EXC, indexed by EXC ID */
+	char exc_names[BBQUE_STATS_RING_EXCS][BBQUE_STATS_RING_NAME_LENGTH];
+	/** The index of the next record to write */
+	uint64_t head
+		__attribute__((aligned(BBQUE_STATS_RING_CACHELINE)));
+	/** The records */
+	rtlib_stats_record_t records[BBQUE_STATS_RING_RECORDS]
+		__attribute__((aligned(BBQUE_STATS_RING_CACHELINE)));
+} rtlib_stats_ring_t;
+
+/**
+ * @brief Get the current time [us] on the ring clock
+ */
+inline uint64_t rtlib_stats_ring_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Reserve the next record to write (writer side)
+ *
+ * The ring is safe for concurrent writers, i.e. the EXCs of the same
+ * application.
+ *
+ * @param idx the index of the reserved record
+ */
+inline rtlib_stats_record_t *rtlib_stats_ring_reserve(
+		rtlib_stats_ring_t *ring, uint64_t & idx) {
+	rtlib_stats_record_t *rec;
+
+	idx = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+	rec = &ring->records[idx & (BBQUE_STATS_RING_RECORDS - 1)];
+
+	// Mark the record invalid before touching its content
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	return rec;
+}
+
+/**
+ * @brief Publish a reserved record (writer side)
+ */
+inline void rtlib_stats_ring_commit(rtlib_stats_record_t *rec,
+		uint64_t idx) {
+	__atomic_store_n(&rec->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Get the index of the next record to be written (reader side)
+ */
+inline uint64_t rtlib_stats_ring_head(const rtlib_stats_ring_t *ring) {
+	return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Copy out a record (reader side)
+ *
+ * @return false if the record has been overwritten or it is not yet
+ * completely written
+ */
+inline bool rtlib_stats_ring_read(const rtlib_stats_ring_t *ring,
+		uint64_t idx, rtlib_stats_record_t & rec) {
+	const rtlib_stats_record_t *prec =
+		&ring->records[idx & (BBQUE_STATS_RING_RECORDS - 1)];
+
+	if (__atomic_load_n(&prec->seq, __ATOMIC_ACQUIRE) != idx + 1)
+		return false;
+	::memcpy(&rec, prec, sizeof(rec));
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	return (__atomic_load_n(&prec->seq, __ATOMIC_RELAXED) == idx + 1);
+}
+
+} // namespace rtlib
+
+} // namespace bbque
+
+#endif // BBQUE_STATS_RING_H_
@@ -22,6 +22,7 @@
 #include "bbque/plugin_manager.h"
 #include "bbque/application_manager.h"
 
+#include "bbque/utils/arena.h"
 #include "bbque/utils/timer.h"
 #include "bbque/utils/metrics_collector.h"
 
@@ -31,6 +32,7 @@
 using bbque::plugins::LoggerIF;
 using bbque::plugins::SchedulerPolicyIF;
 
+using bbque::utils::Arena;
 using bbque::utils::Timer;
 using bbque::utils::MetricsCollector;
 
@@ -96,6 +98,15 @@ public:
 	 */
 	ExitCode_t Schedule();
 
+	/**
+	 * @brief The arena of the scheduling run temporaries
+	 *
+	 * The arena is reset at the beginning of each scheduling run, thus the
+	 * objects allocated on it (e.g. the resource bindings of the AWMs
+	 * evaluated by the policy) are valid up to the next run.
+	 */
+	static Arena & SchedArena();
+
 private:
 
 	/**
@@ -137,6 +148,9 @@ private:
 		SM_SCHED_AVG_MIGREC,
 		SM_SCHED_AVG_MIGRATE,
 		SM_SCHED_AVG_BLOCKED,
+		//----- Scheduling arena statistics
+		SM_SCHED_ARENA_ALLOCS,
+		SM_SCHED_ARENA_USED,
 
 		SM_METRICS_COUNT
 	} SchedMgrMetrics_t;
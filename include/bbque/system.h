@@ -19,6 +19,7 @@
 #define BBQUE_SYSTEM_H_
 
 #include "bbque/application_manager.h"
+#include "bbque/platform_proxy.h"
 #include "bbque/resource_accounter.h"
 
 using bbque::app::ApplicationStatusIF;
@@ -256,6 +257,15 @@ public:
 		return ra.PutView(tok);
 	}
 
+	/// ............................: PLATFORM :.............................
+
+	/**
+	 * @see PlatformProxy::GetMemoryFootprint()
+	 */
+	inline uint64_t ApplicationMemoryFootprint(AppCPtr_t papp) {
+		return pp.GetMemoryFootprint(am.GetApplication(papp->Uid()));
+	}
+
 private:
 
 	/** ApplicationManager instance */
@@ -264,10 +274,14 @@ private:
 	/** ResourceAccounter instance */
 	ResourceAccounterConfIF & ra;
 
+	/** PlatformProxy instance */
+	PlatformProxy & pp;
+
 	/** Constructor */
 	System() :
 		am(ApplicationManager::GetInstance()),
-		ra(ResourceAccounter::GetInstance()) {
+		ra(ResourceAccounter::GetInstance()),
+		pp(PlatformProxy::GetInstance()) {
 	}
 };
 
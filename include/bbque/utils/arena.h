@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_ARENA_H_
+#define BBQUE_ARENA_H_
+
+#include "bbque/cpp11/mutex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <utility>
+
+/** The default size of the memory chunks of an arena */
+#define BBQUE_ARENA_CHUNK_SIZE (64 * 1024)
+
+/** The alignment of all the arena allocations */
+#define BBQUE_ARENA_ALIGN 16
+
+namespace bbque { namespace utils {
+
+/**
+ * @brief A monotonic memory arena
+ *
+ * The arena serves allocations by bumping a pointer into a list of memory
+ * chunks, and it releases all of them at once, when it is reset. Thus, it
+ * fits the objects having all the same lifetime, e.g. the temporaries of a
+ * scheduling run, which are freed with no per-object cost.
+ *
+ * The chunks are kept by a reset, thus once the arena has grown up to the
+ * needs of a run, the next runs do not allocate memory at all.
+ *
+ * Allocations could be performed concurrently, while the reset must not
+ * overlap with any other operation on the arena.
+ */
+class Arena {
+
+public:
+
+	/**
+	 * @brief Build a new arena
+	 *
+	 * @param chunk_size the size [B] of the chunks the arena grows by
+	 */
+	Arena(size_t chunk_size = BBQUE_ARENA_CHUNK_SIZE);
+
+	/**
+	 * @brief Release all the chunks, running the pending finalizers
+	 */
+	~Arena();
+
+	/**
+	 * @brief Allocate a block of memory
+	 *
+	 * The block is aligned to BBQUE_ARENA_ALIGN, and it is valid up to the
+	 * next reset of the arena.
+	 */
+	void * Allocate(size_t size);
+
+	/**
+	 * @brief Build an object into the arena
+	 *
+	 * The object is destroyed by the next reset of the arena, before its
+	 * memory is reused.
+	 */
+	template<typename T, typename ... Args>
+	T * New(Args && ... args) {
+		T * obj = new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+		AddFinalizer(Destroy<T>, obj);
+		return obj;
+	}
+
+	/**
+	 * @brief Release all the allocations
+	 *
+	 * The objects built into the arena are destroyed, in the reverse order
+	 * of creation, and then the memory chunks are rewound.
+	 */
+	void Reset();
+
+	/**
+	 * @brief The number of resets
+	 *
+	 * This could be used to check whether a pointer to an arena allocation,
+	 * saved in a previous generation, is still valid.
+	 */
+	inline uint32_t Generation() const {
+		return __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+	}
+
+	/**
+	 * @brief The memory [B] allocated since the last reset
+	 */
+	size_t Used() const;
+
+	/**
+	 * @brief The memory [B] held by the arena chunks
+	 */
+	inline size_t Size() const {
+		return size;
+	}
+
+	/**
+	 * @brief The number of allocations since the last reset
+	 */
+	inline uint32_t Allocations() const {
+		return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+	}
+
+private:
+
+	/**
+	 * @brief A memory chunk, followed by its data
+	 */
+	typedef struct Chunk {
+		Chunk * next;
+		size_t size;
+		size_t used;
+	} __attribute__((aligned(BBQUE_ARENA_ALIGN))) Chunk_t;
+
+	/**
+	 * @brief A function destroying an object built into the arena
+	 */
+	typedef struct Finalizer {
+		Finalizer * next;
+		void (*destroy)(void *);
+		void * obj;
+	} Finalizer_t;
+
+	/** The size [B] of the chunks the arena grows by */
+	size_t const chunk_size;
+
+	/** The first chunk */
+	Chunk_t * first;
+
+	/** The chunk serving the allocations */
+	Chunk_t * current;
+
+	/** The memory [B] held by the arena chunks */
+	size_t size;
+
+	/** The number of allocations since the last reset */
+	uint32_t allocations;
+
+	/** The number of resets */
+	uint32_t generation;
+
+	/** The objects to destroy on reset, the most recent first */
+	Finalizer_t * finalizers;
+
+	/** Serialize the switch to a new chunk */
+	std::mutex grow_mtx;
+
+	/**
+	 * @brief Switch to the next chunk, which could serve the specified size
+	 *
+	 * @param full the chunk which could not serve the allocation
+	 */
+	void Grow(Chunk_t * full, size_t size);
+
+	void AddFinalizer(void (*destroy)(void *), void * obj);
+
+	template<typename T>
+	static void Destroy(void * obj) {
+		static_cast<T *>(obj)->~T();
+	}
+
+	static inline char * Data(Chunk_t * chunk) {
+		return reinterpret_cast<char *>(chunk + 1);
+	}
+
+};
+
+
+/**
+ * @brief A standard allocator on an arena
+ *
+ * A default constructed allocator falls back to the heap, thus containers
+ * of the same type could be allocated either on an arena or on the heap.
+ * The deallocation of arena memory is a no-op: the memory is released by
+ * the arena reset.
+ *
+ * @note Copies of a container built on an arena are on the same arena,
+ * while the range constructor could be used to get a copy on the heap.
+ */
+template<typename T>
+class ArenaAllocator {
+
+public:
+
+	typedef T value_type;
+	typedef T * pointer;
+	typedef T const * const_pointer;
+	typedef T & reference;
+	typedef T const & const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<typename U>
+	struct rebind {
+		typedef ArenaAllocator<U> other;
+	};
+
+	ArenaAllocator() :
+		arena(nullptr) {
+	}
+
+	explicit ArenaAllocator(Arena * arena) :
+		arena(arena) {
+	}
+
+	template<typename U>
+	ArenaAllocator(ArenaAllocator<U> const & other) :
+		arena(other.arena) {
+	}
+
+	inline pointer allocate(size_type n, void const * = 0) {
+		if (!arena)
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		return static_cast<pointer>(arena->Allocate(n * sizeof(T)));
+	}
+
+	inline void deallocate(pointer p, size_type) {
+		if (!arena)
+			::operator delete(p);
+	}
+
+	template<typename U, typename ... Args>
+	inline void construct(U * p, Args && ... args) {
+		::new((void *)p) U(std::forward<Args>(args)...);
+	}
+
+	template<typename U>
+	inline void destroy(U * p) {
+		p->~U();
+	}
+
+	inline size_type max_size() const {
+		return std::numeric_limits<size_type>::max() / sizeof(T);
+	}
+
+	inline pointer address(reference x) const {
+		return &x;
+	}
+
+	inline const_pointer address(const_reference x) const {
+		return &x;
+	}
+
+	/** The arena, or null for heap allocations */
+	Arena * arena;
+
+};
+
+template<typename T, typename U>
+inline bool operator==(ArenaAllocator<T> const & a,
+		ArenaAllocator<U> const & b) {
+	return a.arena == b.arena;
+}
+
+template<typename T, typename U>
+inline bool operator!=(ArenaAllocator<T> const & a,
+		ArenaAllocator<U> const & b) {
+	return a.arena != b.arena;
+}
+
+} // namespace utils
+
+} // namespace bbque
+
+#endif // BBQUE_ARENA_H_
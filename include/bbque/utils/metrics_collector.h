@@ -20,9 +20,13 @@
 
 #include "bbque/plugins/logger.h"
 #include "bbque/utils/timer.h"
+#include "bbque/utils/utility.h"
 #include "bbque/cpp11/mutex.h"
 
+#include <cmath>
+#include <cstring>
 #include <map>
+#include <pthread.h>
 #include <vector>
 #include <memory>
 
@@ -39,6 +43,20 @@ using namespace boost::accumulators;
 using bbque::plugins::LoggerIF;
 using bbque::utils::Timer;
 
+/** The maximum number of metrics which could be registered */
+#define BBQUE_METRICS_MAX 256
+
+/** The sub-buckets of each power of two range of an histogram */
+#define BBQUE_METRICS_HIST_SUB_BITS 6
+/** The bits of the largest value recorded by an histogram */
+#define BBQUE_METRICS_HIST_MAX_BITS 40
+/** The number of buckets of an histogram */
+#define BBQUE_METRICS_HIST_BUCKETS \
+	((BBQUE_METRICS_HIST_MAX_BITS - BBQUE_METRICS_HIST_SUB_BITS + 2) << \
+	 (BBQUE_METRICS_HIST_SUB_BITS - 1))
+/** The histograms resolution, i.e. 1/1000 of the samples unit */
+#define BBQUE_METRICS_HIST_SCALE 1000
+
 namespace bbque { namespace utils {
 
 /**
@@ -74,6 +92,8 @@ public:
 		SAMPLE,
 		/** A generic "time" sample for periods computations */
 		PERIOD,
+		/** A generic "double" sample for percentiles computations */
+		HISTOGRAM,
 
 		/** The number of metrics classes */
 		CLASSES_COUNT // This MUST be the last value
@@ -151,11 +171,172 @@ public:
 	/** A pointer to a (base class) registered metrics */
 	typedef std::shared_ptr<Metric> pMetric_t;
 
+	/**
+	 * @brief Mergeable statistics on a set of samples
+	 *
+	 * Minimum, maximum, mean and (population) variance are updated online
+	 * for each new sample. Differently from the boost accumulators, two
+	 * sets of statistics could be merged, which allows to collect samples
+	 * on per-thread shards.
+	 */
+	class SampleStats {
+	public:
+		uint64_t count;
+		double min, max, mean, m2;
+
+		SampleStats() {
+			Reset();
+		}
+
+		void Reset() {
+			count = 0;
+			min = max = mean = m2 = 0;
+		}
+
+		void Add(double sample) {
+			double delta = sample - mean;
+			if (++count == 1) {
+				min = max = sample;
+			} else if (sample < min) {
+				min = sample;
+			} else if (sample > max) {
+				max = sample;
+			}
+			mean += delta / count;
+			m2 += delta * (sample - mean);
+		}
+
+		void Merge(SampleStats const & ss) {
+			double delta = ss.mean - mean;
+			uint64_t total = count + ss.count;
+			if (!ss.count)
+				return;
+			if (!count) {
+				*this = ss;
+				return;
+			}
+			if (ss.min < min)
+				min = ss.min;
+			if (ss.max > max)
+				max = ss.max;
+			mean += delta * ss.count / total;
+			m2 += ss.m2 + delta * delta * count * ss.count / total;
+			count = total;
+		}
+
+		double Variance() const {
+			return count ? m2 / count : 0;
+		}
+	};
+
+	/**
+	 * @brief A log-linear histogram of samples
+	 *
+	 * Samples are scaled by BBQUE_METRICS_HIST_SCALE and then accounted into
+	 * a fixed set of buckets: values lower than 2^SUB_BITS have their own
+	 * bucket, while each following power of two range is split into
+	 * 2^(SUB_BITS-1) buckets. Thus, percentiles are reported with a
+	 * relative error lower than 2^-(SUB_BITS-1), whatever is the value
+	 * magnitude, while values beyond 2^MAX_BITS are accounted into the last
+	 * bucket.
+	 */
+	class Histogram {
+	public:
+		uint64_t count;
+		/** The sum of the (scaled) samples */
+		uint64_t sum;
+		uint64_t buckets[BBQUE_METRICS_HIST_BUCKETS];
+
+		Histogram() {
+			Reset();
+		}
+
+		void Reset() {
+			count = sum = 0;
+			memset(buckets, 0, sizeof(buckets));
+		}
+
+		/** Get the (scaled) value of a sample */
+		static uint64_t Scale(double sample) {
+			if (sample <= 0)
+				return 0;
+			return (uint64_t)(sample * BBQUE_METRICS_HIST_SCALE + 0.5);
+		}
+
+		/** Get the bucket of a (scaled) value */
+		static uint16_t Index(uint64_t value) {
+			uint8_t m;
+			if (value < (1 << BBQUE_METRICS_HIST_SUB_BITS))
+				return value;
+			if (value >> BBQUE_METRICS_HIST_MAX_BITS)
+				return BBQUE_METRICS_HIST_BUCKETS - 1;
+			m = 64 - __builtin_clzll(value) - BBQUE_METRICS_HIST_SUB_BITS;
+			return (m << (BBQUE_METRICS_HIST_SUB_BITS - 1)) + (value >> m);
+		}
+
+		/** Get the highest (scaled) value of a bucket */
+		static uint64_t Value(uint16_t idx) {
+			uint8_t m;
+			if (idx < (1 << BBQUE_METRICS_HIST_SUB_BITS))
+				return idx;
+			m = (idx >> (BBQUE_METRICS_HIST_SUB_BITS - 1)) - 1;
+			return ((uint64_t)(idx -
+				(m << (BBQUE_METRICS_HIST_SUB_BITS - 1)) + 1) << m) - 1;
+		}
+
+		void Record(double sample) {
+			uint64_t value = Scale(sample);
+			++count;
+			sum += value;
+			++buckets[Index(value)];
+		}
+
+		/**
+		 * @brief Add the samples of another histogram
+		 *
+		 * The other histogram could be concurrently updated (with
+		 * atomic operations) by its owner.
+		 */
+		void Merge(Histogram const & h) {
+			count += __atomic_load_n(&h.count, __ATOMIC_RELAXED);
+			sum += __atomic_load_n(&h.sum, __ATOMIC_RELAXED);
+			for (uint16_t i = 0; i < BBQUE_METRICS_HIST_BUCKETS; ++i)
+				buckets[i] += __atomic_load_n(&h.buckets[i],
+						__ATOMIC_RELAXED);
+		}
+
+		double Mean() const {
+			return count ? (double)sum / count / BBQUE_METRICS_HIST_SCALE : 0;
+		}
+
+		/**
+		 * @brief Get the value below which the specified percentage [%]
+		 * of samples fall
+		 */
+		double Percentile(double pct) const {
+			uint64_t rank = (uint64_t)::ceil(pct * count / 100.0);
+			uint64_t cumulated = 0;
+			uint16_t i;
+			if (!count)
+				return 0;
+			if (rank == 0)
+				rank = 1;
+			for (i = 0; i < BBQUE_METRICS_HIST_BUCKETS - 1; ++i) {
+				cumulated += buckets[i];
+				if (cumulated >= rank)
+					break;
+			}
+			return (double)Value(i) / BBQUE_METRICS_HIST_SCALE;
+		}
+	};
+
 	/**
 	 * @brief A counting metric
 	 *
 	 * This is a simple metric which could be used to count events. Indeed
 	 * this metrics supports only the "increment" operation.
+	 * Events are counted on per-thread shards, thus the counters of this
+	 * class are updated only when shards are merged.
 	 */
 	class CounterMetric : public Metric {
 	public:
@@ -206,15 +387,14 @@ public:
 	 * minumum, maximum, mead and variance.<br>
 	 * Mean and variance are computed on the <i>complete population</i>, i.e.
 	 * considering all the samples collected so far.
+	 * Samples are collected on per-thread shards, thus the statistics of
+	 * this class are updated only when shards are merged.
 	 */
 	class SamplesMetric : public Metric {
 	public:
 		/** Statistics on collected Samples */
-		typedef accumulator_set<double,
-			stats<tag::min, tag::max, tag::variance>> statMetric_t;
-		typedef std::shared_ptr<statMetric_t> pStatMetric_t;
-		pStatMetric_t pstat;
-		std::vector<pStatMetric_t> sm_pstat;
+		SampleStats stats;
+		std::vector<SampleStats> sm_stats;
 
 		SamplesMetric(const char *name, const char *desc,
 				uint8_t sm_count = 0, const char **sm_desc = NULL);
@@ -251,6 +431,54 @@ public:
 
 	};
 
+	/**
+	 * @brief A tail statistics collection metrics
+	 *
+	 * This is a metrics which could be used to compute percentiles (e.g.
+	 * tail latencies) on a set of samples, by means of a fixed memory
+	 * histogram. Samples are collected on per-thread shards, thus the
+	 * histograms of this class are updated only when shards are merged.
+	 */
+	class HistogramMetric : public Metric {
+	public:
+		/** Histogram of collected Samples */
+		Histogram hist;
+		std::vector<Histogram> sm_hist;
+
+		HistogramMetric(const char *name, const char *desc,
+				uint8_t sm_count = 0, const char **sm_desc = NULL);
+
+		void Reset();
+
+	};
+
+	/**
+	 * @brief The statistics of a (sub-)metric at a certain time
+	 *
+	 * Only the fields relevant for the metric class are valid.
+	 */
+	typedef struct MetricSnapshot {
+		/** The name of the metric */
+		const char *name;
+		/** A textual description of the (sub-)metric */
+		const char *desc;
+		/** The class of the metric */
+		MetricClass_t mc;
+		/** The index of the sub-metric, -1 for the main metric */
+		int16_t sm_idx;
+		/** The counted events, or the number of samples collected */
+		uint64_t count;
+		/** The current VALUE */
+		double value;
+		/** Statistics on the collected samples */
+		double min, max, mean, stddev;
+		/** The HISTOGRAM percentiles */
+		double p50, p90, p99, p999;
+	} MetricSnapshot_t;
+
+	/** A snapshot of all the registered metrics */
+	typedef std::vector<MetricSnapshot_t> MetricsSnapshot_t;
+
 	/**
 	 * @brief Get a reference to the metrics collector
 	 * The MetricsCollector is a singleton class providing the glue logic for
@@ -327,13 +555,36 @@ public:
 	ExitCode_t Reset(MetricHandler_t mh, uint8_t sm_idx = 0);
 
 	/**
-	 * @brief Add a new sample to a SAMPLE metric
+	 * @brief Add a new sample to a SAMPLE or HISTOGRAM metric
 	 *
-	 * This method is reserved to metrics of SAMPLE class and allows to collect
-	 * one more sample, thus updating the metrics statistics.
+	 * This method is reserved to metrics of SAMPLE and HISTOGRAM classes and
+	 * allows to collect one more sample, thus updating the metrics
+	 * statistics.
 	 */
 	ExitCode_t AddSample(MetricHandler_t mh, double sample, uint8_t sm_idx = 0);
 
+	/**
+	 * @brief Get a snapshot of a HISTOGRAM metric
+	 *
+	 * The samples collected so far by all the threads are merged into the
+	 * specified histogram, which could be used for percentiles queries or
+	 * further merged with other snapshots.
+	 *
+	 * @param sm_idx the sub-metric to get, -1 for the main metric
+	 */
+	ExitCode_t GetHistogram(MetricHandler_t mh, Histogram & hist,
+			int16_t sm_idx = -1);
+
+	/**
+	 * @brief Get a percentile of a HISTOGRAM metric
+	 *
+	 * @param pct the percentage [%] of samples, e.g. 99.9
+	 * @param value the value below which pct samples fall
+	 * @param sm_idx the sub-metric to query, -1 for the main metric
+	 */
+	ExitCode_t GetPercentile(MetricHandler_t mh, double pct, double & value,
+			int16_t sm_idx = -1);
+
 	/**
 	 * @brief Add a new time sample to a PERIDO metric
 	 *
@@ -344,6 +595,18 @@ public:
 			uint8_t sm_idx = 0);
 
 
+	/**
+	 * @brief Get a snapshot of all the registered metrics
+	 *
+	 * The statistics of each metric, and of its sub-metrics, are copied
+	 * into the specified snapshot, which could be then formatted without
+	 * holding any lock. Updates of COUNTER, SAMPLE and HISTOGRAM metrics are
+	 * never blocked while copying, since their shards are just read, while
+	 * the percentiles of HISTOGRAM metrics are computed once the metrics
+	 * lock has been released.
+	 */
+	void GetSnapshot(MetricsSnapshot_t & snap);
+
 	/**
 	 * @brief Reset all metrics.
 	 *
@@ -362,6 +625,53 @@ public:
 
 private:
 
+	/**
+	 * @brief The samples collected by a thread for a SAMPLE metric
+	 *
+	 * This is written only by the owner thread, within a sequence lock, thus
+	 * it could be merged by other threads without locking the owner.
+	 */
+	typedef struct SampleShard {
+		/** The update sequence number, odd while an update is in progress */
+		uint32_t seq;
+		/** The reset generation these statistics refer to */
+		uint32_t gen;
+		/** The statistics of the samples collected so far */
+		SampleStats stats;
+	} SampleShard_t;
+
+	/**
+	 * @brief The metrics updated by a thread
+	 *
+	 * Each thread updating COUNTER or SAMPLE metrics gets its own shard, thus
+	 * concurrent updates do not share any lock or cache-line. The per-metric
+	 * data, indexed by the metric handler, is allocated by the owner thread
+	 * at its first update: the main metric is followed by its sub-metrics.
+	 */
+	class Shard {
+	public:
+		/** The events counted on each COUNTER metric */
+		uint64_t *cnt[BBQUE_METRICS_MAX];
+		/** The samples collected on each SAMPLE metric */
+		SampleShard_t *smp[BBQUE_METRICS_MAX];
+		/** The samples collected on each HISTOGRAM metric */
+		Histogram *hst[BBQUE_METRICS_MAX];
+
+		Shard() {
+			memset(cnt, 0, sizeof(cnt));
+			memset(smp, 0, sizeof(smp));
+			memset(hst, 0, sizeof(hst));
+		}
+
+		~Shard() {
+			for (uint16_t i = 0; i < BBQUE_METRICS_MAX; ++i) {
+				delete [] cnt[i];
+				delete [] smp[i];
+				delete [] hst[i];
+			}
+		}
+	};
+
 	/** A map of metrics handlers on correpsonding registered metrics */
 	typedef std::map<MetricHandler_t, pMetric_t> MetricsMap_t;
 
@@ -393,12 +703,12 @@ private:
 	LoggerIF *logger;
 
 	/**
-	 * @brief Map of all registered metrics
+	 * @brief Map of all registered metrics, indexed by name
 	 */
 	MetricsMap_t metricsMap;
 
 	/**
-	 * @brief The mutex protecting access to metrics maps
+	 * @brief The mutex protecting access to metrics maps and shards
 	 */
 	std::mutex metrics_mtx;
 
@@ -408,25 +718,72 @@ private:
 	MetricsVec_t metricsVec;
 
 	/**
-	 * @brief Build a new MetricsCollector
+	 * @brief All the registered metrics, indexed by handler
+	 *
+	 * Entries are never removed, thus they could be accessed without
+	 * locking once published by the update of metricsCount.
 	 */
-	MetricsCollector();
+	pMetric_t metricsArr[BBQUE_METRICS_MAX];
+
+	/**
+	 * @brief The number of registered metrics
+	 */
+	MetricHandler_t metricsCount;
 
 	/**
-	 * @brief Get the handler of the metric specified by name
+	 * @brief The shards of all the threads which have updated a metric
 	 *
-	 * Return the handler of a metrics with the specified name.
+	 * The first one is the retired shard, which accumulates the metrics
+	 * updated by the threads already terminated.
+	 */
+	std::vector<Shard *> shards;
+
+	/**
+	 * @brief The shard accounting for the terminated threads
+	 */
+	Shard *retired;
+
+	/**
+	 * @brief The shards released by terminated threads, ready to be reused
+	 */
+	std::vector<Shard *> freeShards;
+
+	/**
+	 * @brief The key used to retire a shard on thread termination
 	 */
-	MetricHandler_t GetHandler(const char *name);
+	pthread_key_t shard_key;
+	bool shard_key_valid;
+
+	/**
+	 * @brief The shard of the current thread
+	 */
+	static __thread Shard *tlsShard;
+
+	/**
+	 * @brief The current reset generation of SAMPLE metrics
+	 *
+	 * Samples collected on a previous generation are discarded by shards
+	 * at their next update, and ignored while merging.
+	 */
+	uint32_t resetGen;
+
+	/**
+	 * @brief Build a new MetricsCollector
+	 */
+	MetricsCollector();
 
 	/**
 	 * @brief Get a reference to the registered metrics with specified handler
 	 *
 	 * Given the handler of a metrics, this method return a reference to its
-	 * base class, or an empty pointer if the metric has not yet been
-	 * registered.
+	 * base class, or NULL if the metric has not yet been registered.
+	 * @note this method does not require any lock
 	 */
-	pMetric_t GetMetric(MetricHandler_t hdlr);
+	inline Metric *GetMetric(MetricHandler_t hdlr) {
+		if (hdlr >= __atomic_load_n(&metricsCount, __ATOMIC_ACQUIRE))
+			return NULL;
+		return metricsArr[hdlr].get();
+	}
 
 	/**
 	 * @brief Get a reference to the registered metrics with specified name
@@ -446,6 +803,74 @@ private:
 	ExitCode_t UpdateValue(MetricHandler_t mh, double amount,
 			uint8_t sm_idx = 0);
 
+	/**
+	 * @brief Get the shard of the current thread
+	 *
+	 * A new shard is allocated at the first call from each thread.
+	 */
+	inline Shard *GetShard() {
+		if (likely(tlsShard != NULL))
+			return tlsShard;
+		return NewShard();
+	}
+
+	/**
+	 * @brief Allocate and register the shard of the current thread
+	 *
+	 * The shard of a terminated thread is reused, if any.
+	 */
+	Shard *NewShard();
+
+	/**
+	 * @brief Release the shard of a terminating thread
+	 */
+	static void ReleaseShard(void *ps);
+
+	/**
+	 * @brief Fold a shard into the retired one and make it reusable
+	 *
+	 * @note this method requires a look on the metrics maps
+	 */
+	void RetireShard(Shard *ps);
+
+	/**
+	 * @brief Add a new sample to a HISTOGRAM metric
+	 */
+	ExitCode_t RecordSample(Metric *pm, MetricHandler_t mh,
+			double sample, uint8_t sm_idx);
+
+	/**
+	 * @brief Sum-up the shards of a COUNTER metric
+	 *
+	 * @param cnt the counters of the main metric followed by the sub-metrics
+	 * @note this method requires a look on the metrics maps
+	 */
+	void MergeCounters(MetricHandler_t mh, uint8_t sm_count, uint64_t *cnt);
+
+	/**
+	 * @brief Merge the shards of a SAMPLE metric
+	 *
+	 * @param stats the statistics of the main metric followed by the
+	 * sub-metrics
+	 * @note this method requires a look on the metrics maps
+	 */
+	void MergeSamples(MetricHandler_t mh, uint8_t sm_count, SampleStats *stats);
+
+	/**
+	 * @brief Merge the shards of a HISTOGRAM metric into a snapshot
+	 *
+	 * @note this method requires a look on the metrics maps
+	 */
+	void MergeHistogram(MetricHandler_t mh, Histogram & hist, int16_t sm_idx);
+
+	/**
+	 * @brief Merge all the shards into the COUNTER, SAMPLE and HISTOGRAM
+	 * metrics
+	 *
+	 * @note this method requires a look on the metrics maps
+	 */
+	void MergeShards();
+
 	/**
 	 * @brief Reset all metrics of the specified class
 	 *
@@ -455,6 +880,14 @@ private:
 	 */
 	void _ResetAll(uint8_t mc);
 
+	/**
+	 * @brief Get the description of a sub-metric
+	 *
+	 * The last valid description provided at registration time is used,
+	 * or the description of the main metric if none.
+	 */
+	const char *SubmetricDesc(Metric *m, uint8_t idx);
+
 	/**
 	 * @brief Dump the current value for a metric of class COUNT
 	 */
@@ -498,6 +931,17 @@ private:
 	 */
 	void DumpPeriodSM(PeriodMetric *m, uint8_t idx, MetricStats<double> &ms);
 
+
+	/**
+	 * @brief Dump the current value for a metric of class HISTOGRAM
+	 */
+	void DumpHistogram(HistogramMetric *m);
+
+	/**
+	 * @brief Dump the current value for a sub-metric of class HISTOGRAM
+	 */
+	void DumpHistogramSM(HistogramMetric *m, uint8_t idx);
+
 };
 
 } // namespace utils
@@ -26,6 +26,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "bbque/utils/utility.h"
 
@@ -122,6 +123,11 @@ namespace bbque { namespace utils {
  *  Thomas Gleixner and Ingo Molnar
  * and all the other guys which contributed to the Linux Performance events
  * framework.
+ *
+ * Counters are opened as a single group, which leader is the first added
+ * counter: all of them are thus enabled, disabled and read at once with a
+ * single system call. Counters which could not join the group (e.g. because
+ * the PMU could not co-schedule them) are managed as standalone counters.
  */
 class Perf {
 
@@ -220,11 +226,26 @@ public:
 
 	/**
 	 * @brief Update the specified performance counter
+	 *
+	 * If the counter belongs to the group, all the group counters are
+	 * updated as well.
+	 *
 	 * @return the counter absolute value, or a relative difference since last
 	 * update if delta is true.
 	 */
 	uint64_t Update(int id, bool delta = true);
 
+	/**
+	 * @brief Update all the registered performance counters
+	 *
+	 * The group counters are updated with a single read, while standalone
+	 * counters are read one by one. The updated values are then accessed
+	 * via the Read, Enabled and Running methods.
+	 *
+	 * @return 0 on success, -1 on errors
+	 */
+	int Update();
+
 	/**
 	 * @brief Read the performance counter value
 	 */
@@ -266,6 +287,21 @@ private:
 		uint64_t time_running;
 	} ReadFormat_t;
 
+	/**
+	 * @brief The format of bytes readed from kernel space for a group
+	 *
+	 * This is followed by a (value, id) pair for each group counter.
+	 */
+	typedef struct ReadFormatGroup {
+		uint64_t nr;
+		uint64_t time_enabled;
+		uint64_t time_running;
+		struct {
+			uint64_t value;
+			uint64_t id;
+		} values[];
+	} ReadFormatGroup_t;
+
 	/**
 	 * @brief Informations on a registered counter
 	 */
@@ -276,6 +312,10 @@ private:
 		pid_t pid;
 		/** The attributed of this counter */
 		struct perf_event_attr attr;
+		/** The kernel ID of this counter (group counters only) */
+		uint64_t id;
+		/** The position into the group, -1 for standalone counters */
+		int group_idx;
 
 		/** Counters values as of last last update */
 		ReadFormat_t count;
@@ -284,7 +324,7 @@ private:
 		ReadFormat_t delta;
 
 		RegisteredCounter() :
-			fd(-1), pid(-1) {
+			fd(-1), pid(-1), id(0), group_idx(-1) {
 			memset(&attr,  0, sizeof(attr));
 			memset(&count, 0, sizeof(count));
 			memset(&delta, 0, sizeof(delta));
@@ -327,6 +367,26 @@ private:
 	 */
 	pRegisteredCounter_t pGroupLeader;
 
+	/**
+	 * @brief True if the group leader supports group reads
+	 */
+	bool grouped;
+
+	/**
+	 * @brief The group counters, in the group read order
+	 */
+	std::vector<pRegisteredCounter_t> group;
+
+	/**
+	 * @brief The counters which are not part of the group
+	 */
+	std::vector<pRegisteredCounter_t> standalone;
+
+	/**
+	 * @brief The buffer for group reads
+	 */
+	std::vector<uint64_t> group_buff;
+
 	/**
 	 * @brief Return the number of registered counters
 	 */
@@ -362,6 +422,16 @@ private:
 	 */
 	int ReadCounter(int fd, void *buf, size_t n);
 
+	/**
+	 * @brief Update the deltas of a counter given its new values
+	 */
+	void UpdateCounter(pRegisteredCounter_t prc, ReadFormat_t const & count);
+
+	/**
+	 * @brief Update all the group counters with a single read
+	 */
+	int UpdateGroup();
+
 	/**
 	 * @brief Check if the specified event is a valid CACHE event
 	 */
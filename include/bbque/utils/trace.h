@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_TRACE_H_
+#define BBQUE_TRACE_H_
+
+#include "bbque/config.h"
+
+#include <cstdint>
+
+/** The default trace file, into the run-time folder */
+#define BBQUE_TRACE_FILE BBQUE_PATH_VAR "/bbque.trace"
+
+#define BBQUE_TRACE_VERSION 1
+
+/** The magic number of a trace file */
+#define BBQUE_TRACE_MAGIC 0xBB0E7ACE
+
+/** The number of records of each thread ring (must be a power of 2) */
+#define BBQUE_TRACE_RING_RECORDS 8192
+
+/** The maximum number of distinct tracepoint names */
+#define BBQUE_TRACE_NAMES_MAX 1024
+
+/** The maximum length of a tracepoint name */
+#define BBQUE_TRACE_NAME_LENGTH 48
+
+namespace bbque { namespace utils {
+
+/**
+ * @brief The header of a trace file
+ *
+ * A trace file is made by this header, followed by the table of tracepoint
+ * names (indexed by name ID) and then by the records of all the rings,
+ * each ring in chronological order.
+ */
+typedef struct trace_header {
+	/** Set to BBQUE_TRACE_MAGIC */
+	uint32_t magic;
+	/** The trace file layout version */
+	uint16_t version;
+	/** The number of tracepoint names */
+	uint16_t nr_names;
+	/** The number of records */
+	uint64_t nr_records;
+	/** The number of records lost, i.e. overwritten before the dump */
+	uint64_t nr_lost;
+} trace_header_t;
+
+/**
+ * @brief A tracepoint hit
+ */
+typedef struct trace_record {
+	/** The time [ns] of the hit (CLOCK_MONOTONIC) */
+	uint64_t tstamp_ns;
+	/** The ID of the thread hitting the tracepoint */
+	uint32_t tid;
+	/** The tracepoint name ID */
+	uint16_t name;
+	/** The event type, i.e. a Tracer::EventType_t */
+	uint8_t type;
+	/** The event category, i.e. a Tracer::Category_t */
+	uint8_t cat;
+	/** The event argument, e.g. an application UID or a counter value */
+	union {
+		uint64_t u64;
+		double dbl;
+	} arg;
+	/** An additional event argument, e.g. a resource amount */
+	uint64_t arg2;
+} trace_record_t;
+
+/**
+ * @brief A low-overhead tracer of scheduling and synchronization events
+ *
+ * Each thread hitting a tracepoint appends a record into its own binary
+ * ring, without any lock or shared cache line: the oldest records are
+ * simply overwritten. Rings are recycled once their threads terminate,
+ * thus short living threads (e.g. the ones of a parallel policy) do not
+ * leak memory. Rings are dumped on request into a trace file, to be
+ * converted offline (by the bbque-trace tool) into the Chrome trace-event
+ * JSON format.
+ *
+ * Tracepoints are compiled in only if the CONFIG_BBQUE_TRACE option is set,
+ * and they should be used by means of the BBQUE_TRACE_* macros.
+ */
+class Tracer {
+
+public:
+
+	typedef enum EventType {
+		/** The beginning of a (nested) phase */
+		BEGIN = 0,
+		/** The end of the last begun phase */
+		END,
+		/** A single event */
+		INSTANT,
+		/** A sample of a counter, with a double argument */
+		COUNTER,
+
+		EVENT_TYPES_COUNT
+	} EventType_t;
+
+	typedef enum Category {
+		/** Resource Manager events */
+		RM = 0,
+		/** Scheduling policy phases */
+		SP,
+		/** Scheduling contributions */
+		SC,
+		/** Synchronization phases */
+		SYNC,
+		/** Platform Proxy mapping */
+		PP,
+
+		CATEGORIES_COUNT
+	} Category_t;
+
+	/**
+	 * @brief Get the name of a category
+	 */
+	static const char *CategoryStr(uint8_t cat) {
+		static const char *str[CATEGORIES_COUNT] = {
+			"rm", "sp", "sc", "sync", "pp"
+		};
+		return (cat < CATEGORIES_COUNT) ? str[cat] : "unknown";
+	}
+
+	/**
+	 * @brief Get the ID of a tracepoint name
+	 *
+	 * Each tracepoint gets its name ID at the first hit, thus this is
+	 * expected to be called once for each tracepoint.
+	 */
+	static uint16_t Intern(const char *name);
+
+	/**
+	 * @brief Append a record to the ring of the calling thread
+	 */
+	static void Record(uint8_t type, uint8_t cat, uint16_t name,
+			uint64_t arg, uint64_t arg2 = 0);
+
+	/**
+	 * @brief Append a counter sample to the ring of the calling thread
+	 */
+	static void Counter(uint8_t cat, uint16_t name, double value,
+			uint64_t arg2 = 0);
+
+	/**
+	 * @brief Dump all the rings into a trace file
+	 *
+	 * Rings are not stopped while being dumped: records overwritten
+	 * meanwhile are just accounted as lost.
+	 *
+	 * @return 0 on success, a negative errno otherwise
+	 */
+	static int Dump(const char *path = BBQUE_TRACE_FILE);
+
+};
+
+} // namespace utils
+
+} // namespace bbque
+
+/*******************************************************************************
+ *    Tracepoints
+ ******************************************************************************/
+
+#ifdef CONFIG_BBQUE_TRACE
+
+# define BBQUE_TRACE(TYPE, CAT, NAME, ARG, ARG2) \
+do { \
+	static uint16_t _trc_name = bbque::utils::Tracer::Intern(NAME); \
+	bbque::utils::Tracer::Record(bbque::utils::Tracer::TYPE, \
+			bbque::utils::Tracer::CAT, _trc_name, ARG, ARG2); \
+} while(0)
+
+/** Begin the phase NAME of category CAT, e.g. for the application ARG */
+# define BBQUE_TRACE_BEGIN(CAT, NAME, ARG) \
+	BBQUE_TRACE(BEGIN, CAT, NAME, ARG, 0)
+/** End the last begun phase NAME of category CAT */
+# define BBQUE_TRACE_END(CAT, NAME, ARG) \
+	BBQUE_TRACE(END, CAT, NAME, ARG, 0)
+/** Trace a single event NAME of category CAT, with arguments ARG, ARG2 */
+# define BBQUE_TRACE_INSTANT(CAT, NAME, ARG, ARG2) \
+	BBQUE_TRACE(INSTANT, CAT, NAME, ARG, ARG2)
+/** Trace the VALUE of the counter NAME of category CAT, e.g. for ARG2 */
+# define BBQUE_TRACE_COUNTER(CAT, NAME, VALUE, ARG2) \
+do { \
+	static uint16_t _trc_name = bbque::utils::Tracer::Intern(NAME); \
+	bbque::utils::Tracer::Counter(bbque::utils::Tracer::CAT, \
+			_trc_name, VALUE, ARG2); \
+} while(0)
+/** Get the ID of a tracepoint NAME known only at run-time */
+# define BBQUE_TRACE_NAME(NAME) \
+	bbque::utils::Tracer::Intern(NAME)
+/** Trace the VALUE of the counter with name ID of category CAT */
+# define BBQUE_TRACE_COUNTER_ID(CAT, ID, VALUE, ARG2) \
+	bbque::utils::Tracer::Counter(bbque::utils::Tracer::CAT, \
+			ID, VALUE, ARG2)
+/** Dump all the collected records into the trace file */
+# define BBQUE_TRACE_DUMP() \
+	bbque::utils::Tracer::Dump()
+
+#else // CONFIG_BBQUE_TRACE
+
+# define BBQUE_TRACE_BEGIN(CAT, NAME, ARG) do {} while(0)
+# define BBQUE_TRACE_END(CAT, NAME, ARG) do {} while(0)
+# define BBQUE_TRACE_INSTANT(CAT, NAME, ARG, ARG2) do {} while(0)
+# define BBQUE_TRACE_COUNTER(CAT, NAME, VALUE, ARG2) do {} while(0)
+# define BBQUE_TRACE_NAME(NAME) 0
+# define BBQUE_TRACE_COUNTER_ID(CAT, ID, VALUE, ARG2) do {} while(0)
+# define BBQUE_TRACE_DUMP() do {} while(0)
+
+#endif // CONFIG_BBQUE_TRACE
+
+#endif // BBQUE_TRACE_H_
@@ -0,0 +1,794 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "async_logger.h"
+
+#include "log4cpp_logger.h"
+#include "bbque/cpp11/condition_variable.h"
+#include "bbque/cpp11/mutex.h"
+#include "bbque/cpp11/thread.h"
+#include "bbque/utils/utility.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <vector>
+
+#define LOG_MAX_SENTENCE 256
+
+/** The maximum length of a single conversion specification */
+#define LOG_MAX_SPEC 32
+
+#define QUEUE_MASK (ASYNC_LOGGER_QUEUE_LENGTH - 1)
+
+namespace bbque { namespace plugins {
+
+/**
+ * @brief The class of the argument of a conversion specification
+ */
+typedef enum ArgClass {
+	/** No argument, i.e. "%%" */
+	ARG_NONE = 0,
+	ARG_INT,
+	ARG_LONG,
+	ARG_LLONG,
+	ARG_INTMAX,
+	ARG_SIZE,
+	ARG_PTRDIFF,
+	ARG_DOUBLE,
+	ARG_LDOUBLE,
+	ARG_STRING,
+	ARG_POINTER,
+	/** Not supported, e.g. "%n" or wide strings */
+	ARG_INVALID
+} ArgClass_t;
+
+/**
+ * @brief A parsed conversion specification
+ */
+typedef struct ConvSpec {
+	/** The class of the converted argument */
+	ArgClass_t cls;
+	/** The number of additional int arguments, i.e. '*' width/precision */
+	uint8_t stars;
+} ConvSpec_t;
+
+/**
+ * @brief A queued message
+ */
+typedef struct LogEntry {
+	/** The time [ns] the message has been queued (CLOCK_MONOTONIC) */
+	uint64_t tstamp_ns;
+	/** The logger writing the message */
+	Log4CppLogger *sink;
+	/** The format (copied into strs), or NULL if the message has been
+	 * already formatted */
+	const char *fmt;
+	/** The message priority */
+	uint8_t prio;
+	/** The number of arguments */
+	uint8_t nargs;
+	/** The space used by the strings arguments */
+	uint16_t strs_len;
+	/** The arguments: strings are offsets into strs */
+	union {
+		int64_t i;
+		double d;
+		const void *p;
+	} args[ASYNC_LOGGER_ARGS_MAX];
+	/** The format followed by the content of the strings arguments, or the
+	 * formatted message */
+	char strs[ASYNC_LOGGER_STRINGS_SIZE];
+} LogEntry_t;
+
+/**
+ * @brief The messages queue of a thread
+ *
+ * The queue is written only by its owner thread, which publishes each new
+ * message by advancing the head, and it is read only by the writer thread,
+ * which releases each message by advancing the tail.
+ */
+typedef struct LogQueue {
+	/** The index of the next message to queue */
+	uint64_t head;
+	uint8_t pad0[64 - sizeof(uint64_t)];
+	/** The index of the next message to write */
+	uint64_t tail;
+	uint8_t pad1[64 - sizeof(uint64_t)];
+	/** The number of messages dropped since the queue creation */
+	uint32_t dropped;
+	/** The number of dropped messages already reported */
+	uint32_t dropped_reported;
+	/** The logger of the last dropped message */
+	Log4CppLogger *dropped_sink;
+	/** Set once the owner thread terminated */
+	bool orphan;
+	/** The messages */
+	LogEntry_t entries[ASYNC_LOGGER_QUEUE_LENGTH];
+} LogQueue_t;
+
+
+/** The queue of the current thread */
+static __thread LogQueue_t *tlsQueue = NULL;
+
+/** Serialize the queues setup and the writer thread control */
+static std::mutex queues_mtx;
+
+/** All the queues ever allocated */
+static std::vector<LogQueue_t *> queues;
+
+/** The queues released by terminated threads, ready to be recycled */
+static std::vector<LogQueue_t *> freeQueues;
+
+/** The key used to release a queue on thread termination */
+static pthread_key_t queue_key;
+static bool queue_key_valid = false;
+
+/** The thread formatting and writing the queued messages */
+static std::thread writer_thd;
+
+/** Set true while the writer thread is draining the queues */
+static bool writer_running = false;
+
+/** Set true to terminate the writer thread */
+static bool writer_done = false;
+
+/** Wake-up the writer thread */
+static std::condition_variable writer_cv;
+
+/** Signal the draining of the queues */
+static std::condition_variable drained_cv;
+
+
+static inline uint64_t NowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Parse a conversion specification
+ *
+ * @param p the specification, just after the '%'
+ * @return the first character following the specification
+ */
+static const char *ParseSpec(const char *p, ConvSpec_t & spec) {
+	ArgClass_t len_cls = ARG_INT;
+	bool ldouble = false;
+
+	spec.stars = 0;
+	spec.cls = ARG_INVALID;
+
+	if (*p == '%') {
+		spec.cls = ARG_NONE;
+		return p + 1;
+	}
+
+	// Flags, width and precision
+	while (*p && strchr("-+ #0'", *p))
+		++p;
+	if (*p == '*') {
+		++spec.stars;
+		++p;
+	}
+	while ((*p >= '0') && (*p <= '9'))
+		++p;
+	if (*p == '.') {
+		++p;
+		if (*p == '*') {
+			++spec.stars;
+			++p;
+		}
+		while ((*p >= '0') && (*p <= '9'))
+			++p;
+	}
+
+	// Length modifier
+	switch (*p) {
+	case 'h':
+		if (*(++p) == 'h')
+			++p;
+		break;
+	case 'l':
+		len_cls = ARG_LONG;
+		if (*(++p) == 'l') {
+			len_cls = ARG_LLONG;
+			++p;
+		}
+		break;
+	case 'q':
+		len_cls = ARG_LLONG;
+		++p;
+		break;
+	case 'j':
+		len_cls = ARG_INTMAX;
+		++p;
+		break;
+	case 'z':
+		len_cls = ARG_SIZE;
+		++p;
+		break;
+	case 't':
+		len_cls = ARG_PTRDIFF;
+		++p;
+		break;
+	case 'L':
+		ldouble = true;
+		++p;
+		break;
+	}
+
+	// Conversion
+	switch (*p) {
+	case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+		spec.cls = len_cls;
+		break;
+	case 'e': case 'E': case 'f': case 'F':
+	case 'g': case 'G': case 'a': case 'A':
+		spec.cls = ldouble ? ARG_LDOUBLE : ARG_DOUBLE;
+		break;
+	case 's':
+		if (len_cls == ARG_INT)
+			spec.cls = ARG_STRING;
+		break;
+	case 'p':
+		spec.cls = ARG_POINTER;
+		break;
+	case '\0':
+		return p;
+	}
+
+	return p + 1;
+}
+
+/**
+ * @brief Copy the arguments of a message into a queue entry
+ *
+ * @return false if the format and the arguments do not fit into the entry,
+ * or the format is not supported
+ */
+static bool Capture(LogEntry_t & e, const char *fmt, va_list args) {
+	const char *p = fmt;
+	const char *str;
+	ConvSpec_t spec;
+	size_t len;
+
+	// The format could be a temporary too (e.g. a message built into a
+	// local buffer), thus its content is copied as well
+	len = strlen(fmt) + 1;
+	if (len > ASYNC_LOGGER_STRINGS_SIZE)
+		return false;
+	memcpy(e.strs, fmt, len);
+	e.fmt = e.strs;
+	e.strs_len = len;
+	e.nargs = 0;
+
+	while (*p) {
+		if (*p++ != '%')
+			continue;
+		p = ParseSpec(p, spec);
+		if (spec.cls == ARG_NONE)
+			continue;
+		if ((spec.cls == ARG_INVALID) ||
+				(e.nargs + spec.stars >= ASYNC_LOGGER_ARGS_MAX))
+			return false;
+
+		for (uint8_t s = 0; s < spec.stars; ++s)
+			e.args[e.nargs++].i = va_arg(args, int);
+
+		switch (spec.cls) {
+		case ARG_INT:
+			e.args[e.nargs].i = va_arg(args, int);
+			break;
+		case ARG_LONG:
+			e.args[e.nargs].i = va_arg(args, long);
+			break;
+		case ARG_LLONG:
+			e.args[e.nargs].i = va_arg(args, long long);
+			break;
+		case ARG_INTMAX:
+			e.args[e.nargs].i = va_arg(args, intmax_t);
+			break;
+		case ARG_SIZE:
+			e.args[e.nargs].i = va_arg(args, size_t);
+			break;
+		case ARG_PTRDIFF:
+			e.args[e.nargs].i = va_arg(args, ptrdiff_t);
+			break;
+		case ARG_DOUBLE:
+			e.args[e.nargs].d = va_arg(args, double);
+			break;
+		case ARG_LDOUBLE:
+			e.args[e.nargs].d = va_arg(args, long double);
+			break;
+		case ARG_STRING:
+			// Strings could be temporaries, thus their content is
+			// copied
+			str = va_arg(args, const char *);
+			if (!str)
+				str = "(null)";
+			len = strlen(str) + 1;
+			if (e.strs_len + len > ASYNC_LOGGER_STRINGS_SIZE)
+				return false;
+			memcpy(e.strs + e.strs_len, str, len);
+			e.args[e.nargs].i = e.strs_len;
+			e.strs_len += len;
+			break;
+		case ARG_POINTER:
+			e.args[e.nargs].p = va_arg(args, const void *);
+			break;
+		default:
+			return false;
+		}
+		++e.nargs;
+	}
+
+	return true;
+}
+
+template <typename T>
+static int FormatArg(char *buf, size_t size, const char *spec,
+		uint8_t stars, const int *star_args, T arg) {
+	switch (stars) {
+	case 0:
+		return snprintf(buf, size, spec, arg);
+	case 1:
+		return snprintf(buf, size, spec, star_args[0], arg);
+	default:
+		return snprintf(buf, size, spec, star_args[0], star_args[1], arg);
+	}
+}
+
+/**
+ * @brief Format a queued message
+ */
+static void Format(LogEntry_t const & e, char *str, size_t size) {
+	char spec_str[LOG_MAX_SPEC];
+	const char *p = e.fmt;
+	const char *start;
+	int star_args[2];
+	ConvSpec_t spec;
+	size_t pos = 0;
+	uint8_t a = 0;
+	size_t len;
+	int n;
+
+	if (!e.fmt) {
+		snprintf(str, size, "%s", e.strs);
+		return;
+	}
+
+	while (*p && (pos < size - 1)) {
+		if (*p != '%') {
+			str[pos++] = *p++;
+			continue;
+		}
+
+		start = p;
+		p = ParseSpec(p + 1, spec);
+		if (spec.cls == ARG_NONE) {
+			str[pos++] = '%';
+			continue;
+		}
+
+		len = std::min<size_t>(p - start, LOG_MAX_SPEC - 1);
+		memcpy(spec_str, start, len);
+		spec_str[len] = '\0';
+
+		for (uint8_t s = 0; s < spec.stars; ++s)
+			star_args[s] = e.args[a++].i;
+
+		switch (spec.cls) {
+		case ARG_INT:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (int)e.args[a].i);
+			break;
+		case ARG_LONG:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (long)e.args[a].i);
+			break;
+		case ARG_LLONG:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (long long)e.args[a].i);
+			break;
+		case ARG_INTMAX:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (intmax_t)e.args[a].i);
+			break;
+		case ARG_SIZE:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (size_t)e.args[a].i);
+			break;
+		case ARG_PTRDIFF:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (ptrdiff_t)e.args[a].i);
+			break;
+		case ARG_LDOUBLE:
+			// Captured as a double, thus the 'L' modifier is dropped
+			start = strchr(spec_str, 'L');
+			memmove((char *)start, start + 1, strlen(start));
+			// fall-through
+		case ARG_DOUBLE:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, e.args[a].d);
+			break;
+		case ARG_STRING:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, (const char *)(e.strs + e.args[a].i));
+			break;
+		case ARG_POINTER:
+			n = FormatArg(str + pos, size - pos, spec_str, spec.stars,
+					star_args, e.args[a].p);
+			break;
+		default:
+			n = 0;
+		}
+		++a;
+
+		if (n > 0)
+			pos += std::min<size_t>(n, size - 1 - pos);
+	}
+
+	str[pos] = '\0';
+}
+
+static void ReleaseQueue(void *queue) {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+	// The queue is recycled by the writer, once drained
+	((LogQueue_t *)queue)->orphan = true;
+}
+
+static LogQueue_t *GetQueue() {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+	LogQueue_t *queue;
+
+	if (!queue_key_valid)
+		queue_key_valid = (pthread_key_create(&queue_key, ReleaseQueue) == 0);
+
+	if (!freeQueues.empty()) {
+		queue = freeQueues.back();
+		freeQueues.pop_back();
+	} else {
+		queue = new LogQueue_t;
+		queue->head = 0;
+		queue->tail = 0;
+		queue->dropped = 0;
+		queue->dropped_reported = 0;
+		queue->dropped_sink = NULL;
+		queues.push_back(queue);
+	}
+	queue->orphan = false;
+
+	if (queue_key_valid)
+		pthread_setspecific(queue_key, queue);
+
+	tlsQueue = queue;
+	return queue;
+}
+
+/**
+ * @brief Write all the queued messages, in chronological order
+ */
+static void Drain(std::unique_lock<std::mutex> & queues_ul) {
+	std::vector<LogQueue_t *> qs(queues);
+	char str[LOG_MAX_SENTENCE];
+	LogQueue_t *oldest;
+	LogEntry_t *e;
+	uint64_t tail;
+	uint32_t dropped;
+
+	queues_ul.unlock();
+
+	while (true) {
+
+		// Look for the oldest message among the queue fronts
+		oldest = NULL;
+		for (size_t i = 0; i < qs.size(); ++i) {
+			tail = qs[i]->tail;
+			if (tail == __atomic_load_n(&qs[i]->head, __ATOMIC_ACQUIRE))
+				continue;
+			if (oldest && (oldest->entries[oldest->tail & QUEUE_MASK]
+						.tstamp_ns <=
+					qs[i]->entries[tail & QUEUE_MASK].tstamp_ns))
+				continue;
+			oldest = qs[i];
+		}
+		if (!oldest)
+			break;
+
+		tail = oldest->tail;
+		e = &oldest->entries[tail & QUEUE_MASK];
+		Format(*e, str, sizeof(str));
+		e->sink->Log((LoggerIF::Priority)e->prio, str);
+		__atomic_store_n(&oldest->tail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	// Report the messages dropped meanwhile
+	for (size_t i = 0; i < qs.size(); ++i) {
+		dropped = __atomic_load_n(&qs[i]->dropped, __ATOMIC_RELAXED);
+		if (dropped == qs[i]->dropped_reported)
+			continue;
+		snprintf(str, sizeof(str), "ASYNC LOG: %u messages dropped "
+				"(queue full)", dropped - qs[i]->dropped_reported);
+		__atomic_load_n(&qs[i]->dropped_sink, __ATOMIC_RELAXED)->Log(
+				LoggerIF::WARN, str);
+		qs[i]->dropped_reported = dropped;
+	}
+
+	queues_ul.lock();
+
+	// Recycle the drained queues of terminated threads
+	for (size_t i = 0; i < qs.size(); ++i) {
+		if (!qs[i]->orphan ||
+				(qs[i]->tail != __atomic_load_n(&qs[i]->head,
+						__ATOMIC_ACQUIRE)))
+			continue;
+		qs[i]->orphan = false;
+		freeQueues.push_back(qs[i]);
+	}
+
+	drained_cv.notify_all();
+}
+
+static void Writer() {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+
+	prctl(PR_SET_NAME, (long unsigned int)BBQUE_MODULE_NAME("log"), 0, 0, 0);
+
+	while (!writer_done) {
+		writer_cv.wait_for(queues_ul,
+				std::chrono::milliseconds(ASYNC_LOGGER_PERIOD_MS));
+		Drain(queues_ul);
+	}
+
+	// Write the messages queued before the termination
+	Drain(queues_ul);
+}
+
+static void StopWriter() {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+
+	// Messages are written synchronously from now on
+	__atomic_store_n(&writer_running, false, __ATOMIC_RELEASE);
+	writer_done = true;
+	writer_cv.notify_one();
+	queues_ul.unlock();
+
+	writer_thd.join();
+}
+
+static void StartWriter() {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+
+	if (writer_thd.joinable())
+		return;
+
+	writer_thd = std::thread(Writer);
+	__atomic_store_n(&writer_running, true, __ATOMIC_RELEASE);
+
+	// Pending messages are written at exit, before the loggers are
+	// released
+	atexit(StopWriter);
+}
+
+/**
+ * @brief Wait for the writer to write the message with the given index
+ */
+static void Flush(LogQueue_t *queue, uint64_t idx) {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+
+	writer_cv.notify_one();
+	while (!writer_done &&
+			(__atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) <= idx))
+		drained_cv.wait(queues_ul);
+}
+
+/**
+ * @brief Wait for the writer to write all the queued messages
+ */
+static void FlushAll() {
+	std::unique_lock<std::mutex> queues_ul(queues_mtx);
+	std::vector<uint64_t> heads;
+	size_t i;
+
+	for (i = 0; i < queues.size(); ++i)
+		heads.push_back(__atomic_load_n(&queues[i]->head,
+					__ATOMIC_ACQUIRE));
+
+	writer_cv.notify_one();
+	for (i = 0; (i < heads.size()) && !writer_done; ) {
+		if (__atomic_load_n(&queues[i]->tail, __ATOMIC_ACQUIRE) >=
+				heads[i]) {
+			++i;
+			continue;
+		}
+		drained_cv.wait(queues_ul);
+	}
+}
+
+
+AsyncLogger::AsyncLogger(Log4CppLogger *sink) :
+	LoggerIF(sink->GetLevel()),
+	sink(sink) {
+}
+
+AsyncLogger::~AsyncLogger() {
+	// Queued messages could still refer to the sink
+	if (__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE))
+		FlushAll();
+	Log4CppLogger::Destroy(sink);
+}
+
+//----- static plugin interface
+
+void * AsyncLogger::Create(PF_ObjectParams * params) {
+	Log4CppLogger *sink;
+
+	// Messages are written by a Log4CPP logger, which is thus
+	// configured the same way
+	sink = (Log4CppLogger *)Log4CppLogger::Create(params);
+	if (!sink)
+		return NULL;
+
+	StartWriter();
+	return new AsyncLogger(sink);
+}
+
+int32_t AsyncLogger::Destroy(void * plugin) {
+	if (!plugin)
+		return -1;
+	delete (AsyncLogger *)plugin;
+	return 0;
+}
+
+//----- Logger plugin interface
+
+void AsyncLogger::Queue(Priority prio, const char *fmt, va_list args) {
+	char str[LOG_MAX_SENTENCE];
+	LogQueue_t *queue;
+	LogEntry_t *e;
+	uint64_t head;
+	va_list args_cp;
+
+	if (!Enabled(prio))
+		return;
+
+	// Write the message synchronously while the writer is not running,
+	// e.g. at exit
+	if (!__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE)) {
+		vsnprintf(str, LOG_MAX_SENTENCE, fmt, args);
+		sink->Log(prio, str);
+		return;
+	}
+
+	queue = tlsQueue ? tlsQueue : GetQueue();
+	head = queue->head;
+
+	// Drop the message if the queue is full, unless it is a critical one
+	if ((head - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) >=
+			ASYNC_LOGGER_QUEUE_LENGTH) {
+		if (prio <= ERROR) {
+			__atomic_store_n(&queue->dropped_sink, sink,
+					__ATOMIC_RELAXED);
+			__atomic_store_n(&queue->dropped, queue->dropped + 1,
+					__ATOMIC_RELAXED);
+			return;
+		}
+		Flush(queue, head - ASYNC_LOGGER_QUEUE_LENGTH);
+	}
+
+	e = &queue->entries[head & QUEUE_MASK];
+	e->tstamp_ns = NowNs();
+	e->sink = sink;
+	e->prio = prio;
+
+	// Fall-back to the formatting of the message, if its arguments could
+	// not be captured
+	va_copy(args_cp, args);
+	if (!Capture(*e, fmt, args_cp)) {
+		vsnprintf(e->strs, ASYNC_LOGGER_STRINGS_SIZE, fmt, args);
+		e->fmt = NULL;
+	}
+	va_end(args_cp);
+
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+	if (prio > ERROR) {
+		Flush(queue, head);
+		return;
+	}
+
+	// Wake-up the writer early on bursts, once the queue is half full
+	if ((head + 1 - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) ==
+			ASYNC_LOGGER_QUEUE_LENGTH / 2)
+		writer_cv.notify_one();
+}
+
+#ifdef BBQUE_DEBUG
+void AsyncLogger::Debug(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(DEBUG, fmt, args);
+	va_end(args);
+}
+#endif
+
+void AsyncLogger::Info(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(INFO, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Notice(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(NOTICE, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Warn(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(WARN, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Error(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(ERROR, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Crit(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(CRIT, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Alert(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(ALERT, fmt, args);
+	va_end(args);
+}
+
+void AsyncLogger::Fatal(const char *fmt, ...) {
+	va_list args;
+
+	va_start(args, fmt);
+	Queue(FATAL, fmt, args);
+	va_end(args);
+}
+
+} // namespace plugins
+
+} // namespace bbque
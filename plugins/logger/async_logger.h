@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_ASYNC_LOGGER_H_
+#define BBQUE_ASYNC_LOGGER_H_
+
+#include "bbque/plugins/logger.h"
+#include "bbque/plugins/plugin.h"
+
+#include "bbque/config.h"
+
+#include <cstdarg>
+#include <cstdint>
+
+#define ASYNC_LOGGER_NAMESPACE LOGGER_NAMESPACE".async"
+
+/** The number of messages of each thread queue (must be a power of 2) */
+#define ASYNC_LOGGER_QUEUE_LENGTH 2048
+
+/** The maximum number of arguments of a message */
+#define ASYNC_LOGGER_ARGS_MAX 12
+
+/** The space for the strings arguments of a message */
+#define ASYNC_LOGGER_STRINGS_SIZE 256
+
+/** The period [ms] of the queues draining */
+#define ASYNC_LOGGER_PERIOD_MS 20
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bbque { namespace plugins {
+
+class Log4CppLogger;
+
+/**
+ * @brief An asynchronous Log4CPP based Logger plugin
+ *
+ * The calling thread does not format the messages: it just checks the
+ * priority of the message, and then it copies the format and the raw
+ * arguments (i.e. including the content of strings) into its own lock-free
+ * queue. A background thread formats the queued messages, in chronological
+ * order, and it writes them by means of a Log4CppLogger.
+ * When the queue of a thread is full, new messages are dropped, and the
+ * number of dropped messages is logged as soon as the queue is drained.
+ * Messages with a priority higher than ERROR are instead waited for being
+ * written before returning, since they are likely to be followed by the
+ * daemon termination.
+ *
+ * Messages whose format and strings do not fit into a queue entry are instead
+ * formatted by the calling thread.
+ */
+class AsyncLogger : public LoggerIF {
+
+public:
+
+//----- static plugin interface
+
+	/**
+	 *
+	 */
+	static void * Create(PF_ObjectParams * params);
+
+	/**
+	 *
+	 */
+	static int32_t Destroy(void * logger);
+
+	/**
+	 *
+	 */
+	virtual ~AsyncLogger();
+
+//----- Logger module interface
+
+#ifdef BBQUE_DEBUG
+	/**
+	 * \brief Send a log message with the priority DEBUG
+	 * \param fmt the message to log
+	 */
+	void Debug(const char *fmt, ...);
+#endif
+
+	/**
+	 * \brief Send a log message with the priority INFO
+	 * \param fmt the message to log
+	 */
+	void Info(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority NOTICE
+	 * \param fmt the message to log
+	 */
+	void Notice(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority WARN
+	 * \param fmt the message to log
+	 */
+	void Warn(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority ERROR
+	 * \param fmt the message to log
+	 */
+	void Error(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority CRIT
+	 * \param fmt the message to log
+	 */
+	void Crit(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority ALERT
+	 * \param fmt the message to log
+	 */
+	void Alert(const char *fmt, ...);
+
+	/**
+	 * \brief Send a log message with the priority FATAL
+	 * \param fmt the message to log
+	 */
+	void Fatal(const char *fmt, ...);
+
+private:
+
+	/**
+	 * @brief The logger actually writing the messages
+	 */
+	Log4CppLogger *sink;
+
+	/**
+	 * @brief Build a new asynchronous logger
+	 * @param sink the logger used (by the background thread) to write the
+	 * messages
+	 */
+	AsyncLogger(Log4CppLogger *sink);
+
+	/**
+	 * @brief Queue a message, if its priority is enabled
+	 */
+	void Queue(Priority prio, const char *fmt, va_list args);
+
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_ASYNC_LOGGER_H_
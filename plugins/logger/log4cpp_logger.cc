@@ -53,6 +53,30 @@ namespace po = boost::program_options;
 #define LOG4CPP_COLOR_ALERT	LOG4CPP_COLOR_LRED
 #define LOG4CPP_COLOR_FATAL	LOG4CPP_COLOR_RED
 
+/** The Log4CPP priority of each LoggerIF priority */
+static const l4::Priority::Value l4_prio[] = {
+	l4::Priority::DEBUG,
+	l4::Priority::INFO,
+	l4::Priority::NOTICE,
+	l4::Priority::WARN,
+	l4::Priority::ERROR,
+	l4::Priority::CRIT,
+	l4::Priority::ALERT,
+	l4::Priority::FATAL
+};
+
+/** The color of each LoggerIF priority */
+static const char *l4_color[] = {
+	"%s",
+	LOG4CPP_COLOR_INFO,
+	LOG4CPP_COLOR_NOTICE,
+	LOG4CPP_COLOR_WARN,
+	LOG4CPP_COLOR_ERROR,
+	LOG4CPP_COLOR_CRIT,
+	LOG4CPP_COLOR_ALERT,
+	LOG4CPP_COLOR_FATAL
+};
+
 namespace bbque { namespace plugins {
 
 bool Log4CppLogger::configured = false;
@@ -60,6 +84,15 @@ bool Log4CppLogger::configured = false;
 Log4CppLogger::Log4CppLogger(char const * category) :
 	use_colors(true),
 	logger(l4::Category::getInstance(category)) {
+	uint8_t prio;
+
+	// Cache the lowest priority enabled for the category, which is
+	// defined once for all by the configuration file
+	for (prio = DEBUG; prio < FATAL; ++prio) {
+		if (logger.isPriorityEnabled(l4_prio[prio]))
+			break;
+	}
+	level = (Priority)prio;
 }
 
 Log4CppLogger::~Log4CppLogger() {
@@ -275,6 +308,13 @@ void Log4CppLogger::Fatal(const char *fmt, ...) {
 	}
 }
 
+void Log4CppLogger::Log(Priority prio, const char *str) {
+	if (use_colors)
+		logger.log(l4_prio[prio], l4_color[prio], str);
+	else
+		logger.log(l4_prio[prio], "%s", str);
+}
+
 } // namespace plugins
 
 } // namespace bbque
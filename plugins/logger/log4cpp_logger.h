@@ -112,6 +112,13 @@ public:
 	 */
 	void Fatal(const char *fmt, ...);
 
+	/**
+	 * \brief Send an already formatted log message
+	 * \param prio the priority of the message
+	 * \param str the message to log
+	 */
+	void Log(Priority prio, const char *str);
+
 
 private:
 
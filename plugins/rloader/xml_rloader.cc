@@ -20,7 +20,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cassert>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <boost/filesystem/operations.hpp>
 
 #include "bbque/platform_proxy.h"
@@ -156,9 +161,17 @@ RecipeLoaderIF::ExitCode_t XMLRecipeLoader::LoadRecipe(
 		goto error;
 	}
 
+	// Load the compiled recipe, if available and up-to-date
+	result = LoadCompiled(_recipe_name);
+	if (result != RL_NOT_FOUND) {
+		if (result >= RL_FAILED)
+			goto error;
+		return result;
+	}
+
 	try {
 		// Load the recipe parsing an XML file
-		std::string path(recipe_dir + "/" + _recipe_name + ".recipe");
+		std::string path(recipe_dir + "/" + _recipe_name + RECIPE_FILE_EXT);
 		doc.LoadFile(path.c_str());
 
 		// <BarbequeRTRM> - Recipe root tag
@@ -285,7 +298,7 @@ ticpp::Element * XMLRecipeLoader::LoadPlatform(ticpp::Element * _xml_elem) {
 
 
 std::time_t XMLRecipeLoader::LastModifiedTime(std::string const & _name) {
-	boost::filesystem::path p(recipe_dir + "/" + _name + ".recipe");
+	boost::filesystem::path p(recipe_dir + "/" + _name + RECIPE_FILE_EXT);
 	return boost::filesystem::last_write_time(p);
 }
 
@@ -578,6 +591,200 @@ void XMLRecipeLoader::LoadConstraints(ticpp::Element * _xml_elem) {
 	}
 }
 
+
+// =======================[ Compiled recipes ]================================
+
+RecipeLoaderIF::ExitCode_t XMLRecipeLoader::LoadCompiled(
+		std::string const & _recipe_name) {
+	std::string path(recipe_dir + "/" + _recipe_name +
+			BBQUE_RECIPE_COMPILED_EXT);
+	std::string xml_path(recipe_dir + "/" + _recipe_name + RECIPE_FILE_EXT);
+	RecipeLoaderIF::ExitCode_t result;
+	brc_header_t const * hdr;
+	struct stat st;
+	void * base;
+	int fd;
+
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return RL_NOT_FOUND;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+		close(fd);
+		return RL_NOT_FOUND;
+	}
+
+	// The recipe is accessed in place, there is no need to keep the
+	// mapping once the recipe object has been filled
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		logger->Warn("Compiled recipe [%s] mapping FAILED "
+				"(Error %d: %s)", path.c_str(), errno, strerror(errno));
+		return RL_NOT_FOUND;
+	}
+
+	hdr = (brc_header_t const *) base;
+	if (!brc_valid(base, st.st_size)) {
+		logger->Warn("Compiled recipe [%s] not valid: "
+				"parsing the XML recipe", path.c_str());
+		result = RL_NOT_FOUND;
+	} else if ((access(xml_path.c_str(), F_OK) == 0) &&
+			(LastModifiedTime(_recipe_name) != hdr->src_mtime)) {
+		logger->Warn("Compiled recipe [%s] out-of-date: "
+				"parsing the XML recipe", path.c_str());
+		result = RL_NOT_FOUND;
+	} else {
+		logger->Debug("Loading compiled recipe [%s]...", path.c_str());
+		result = ParseCompiled(hdr);
+	}
+
+	munmap(base, st.st_size);
+	return result;
+}
+
+RecipeLoaderIF::ExitCode_t XMLRecipeLoader::ParseCompiled(
+		brc_header_t const * hdr) {
+	uint8_t result = __RSRC_SUCCESS;
+	brc_platform_t const * pp;
+	brc_awm_t const * pawm;
+	brc_usage_t const * pusage;
+	brc_constraint_t const * pcons;
+	// Promoted, to compare them as the XML parser does
+	int maj = hdr->recipe_major;
+	int min = hdr->recipe_minor;
+	uint32_t i, j;
+
+	// Recipe version control
+	logger->Debug("Recipe version = %d.%d", maj, min);
+	if (maj < RECIPE_MAJOR_VERSION ||
+			(maj >= RECIPE_MAJOR_VERSION && min < RECIPE_MINOR_VERSION)) {
+		logger->Error("Recipe version mismatch (REQUIRED %d.%d). "
+				"Found %d.%d", RECIPE_MAJOR_VERSION, RECIPE_MINOR_VERSION,
+				maj, min);
+		return RL_VERSION_MISMATCH;
+	}
+
+	recipe_ptr->SetPriority(hdr->priority);
+
+	// Load the proper platform section
+	pp = LoadPlatform(hdr);
+	if (!pp)
+		return RL_PLATFORM_MISMATCH;
+
+	// Application Working Modes
+	pawm = brc_awms(hdr) + pp->first_awm;
+	for (i = 0; i < pp->nr_awms; ++i, ++pawm) {
+		char const * wm_name = brc_str(hdr, pawm->name);
+
+		// The awm ID must be unique!
+		if (recipe_ptr->GetWorkingMode(pawm->id)) {
+			logger->Error("AWM ""%s"" error: Double ID found %d",
+					wm_name, pawm->id);
+			return RL_FORMAT_ERROR;
+		}
+
+		AwmPtr_t awm(recipe_ptr->AddWorkingMode(pawm->id, wm_name,
+					pawm->value));
+		if (!awm) {
+			logger->Error("AWM ""%s"" error: Wrong ID specified %d",
+					wm_name, pawm->id);
+			return RL_FORMAT_ERROR;
+		}
+
+		// Resource paths and amounts are already resolved
+		pusage = brc_usages(hdr) + pawm->first_usage;
+		for (j = 0; j < pawm->nr_usages; ++j, ++pusage)
+			result |= AppendToWorkingMode(awm,
+					brc_str(hdr, pusage->path), pusage->amount);
+
+		// AWM plugin specific data
+		LoadPluginsData<ba::AwmPtr_t>(awm, hdr,
+				pawm->first_pdata, pawm->nr_pdata);
+	}
+
+	// "Static" constraints and plugins specific data
+	pcons = brc_constraints(hdr) + pp->first_constraint;
+	for (i = 0; i < pp->nr_constraints; ++i, ++pcons)
+		recipe_ptr->AddConstraint(brc_str(hdr, pcons->resource),
+				pcons->lower, pcons->upper);
+	LoadPluginsData<ba::RecipePtr_t>(recipe_ptr, hdr,
+			pp->first_pdata, pp->nr_pdata);
+
+	if (result == __RSRC_WEAK_LOAD)
+		return RL_WEAK_LOAD;
+
+	return RL_SUCCESS;
+}
+
+brc_platform_t const * XMLRecipeLoader::LoadPlatform(
+		brc_header_t const * hdr) {
+	brc_platform_t const * pp = brc_platforms(hdr);
+
+#ifndef CONFIG_BBQUE_TEST_PLATFORM_DATA
+	brc_platform_t const * pp_gen = nullptr;
+	const char * sys_platform_id;
+	PlatformProxy & pp_proxy(PlatformProxy::GetInstance());
+	const char * platform_id;
+#endif
+
+	if (hdr->nr_platforms == 0) {
+		logger->Error("Compiled recipe without platform sections");
+		return nullptr;
+	}
+
+#ifndef CONFIG_BBQUE_TEST_PLATFORM_DATA
+	// System platform
+	sys_platform_id = pp_proxy.GetPlatformID();
+	if (!sys_platform_id) {
+		logger->Error("Unable to get the system platform ID");
+		assert(sys_platform_id != nullptr);
+		return nullptr;
+	}
+
+	// Look for the platform section matching the system platform id
+	for (uint16_t i = 0; i < hdr->nr_platforms; ++i) {
+		platform_id = brc_str(hdr, pp[i].id);
+		if (strcmp(platform_id, sys_platform_id) == 0) {
+			logger->Info("Platform required: '%s' matching OK",
+					platform_id);
+			return &pp[i];
+		}
+
+		// Keep track of the "generic" platform section (if any)
+		if (!pp_gen && (strcmp(platform_id, PLATFORM_ID_GENERIC) == 0))
+			pp_gen = &pp[i];
+	}
+
+	logger->Error("Platform mismatch: cannot find (system) ID '%s'",
+			sys_platform_id);
+	if (pp_gen) {
+		logger->Warn("Platform mismatch: section '%s' will be parsed",
+				PLATFORM_ID_GENERIC);
+	}
+	return pp_gen;
+#else
+	logger->Warn("TPD enabled: no platform ID check performed");
+	return pp;
+#endif
+}
+
+template<class T>
+void XMLRecipeLoader::LoadPluginsData(T _container,
+		brc_header_t const * hdr,
+		uint32_t first,
+		uint32_t nr) {
+	brc_pdata_t const * pdata = brc_pdata(hdr) + first;
+
+	for (uint32_t i = 0; i < nr; ++i, ++pdata) {
+		PluginAttrPtr_t pattr(new PluginAttr_t(
+					brc_str(hdr, pdata->plugin),
+					brc_str(hdr, pdata->key)));
+		pattr->str = brc_str(hdr, pdata->value);
+		_container->SetAttribute(pattr);
+	}
+}
+
 } // namespace plugins
 
 } // namespace bque
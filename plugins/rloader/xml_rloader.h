@@ -32,6 +32,7 @@
 #include "bbque/plugin_manager.h"
 #include "bbque/plugins/logger.h"
 #include "bbque/plugins/plugin.h"
+#include "bbque/plugins/recipe_compiled.h"
 #include "bbque/utils/attributes_container.h"
 
 #define MODULE_NAMESPACE RECIPE_LOADER_NAMESPACE".xml"
@@ -72,6 +73,9 @@ namespace bbque { namespace plugins {
  *    and libticpp-dev_<version<arch>.deb))
  *
  * The library should be ready to use.
+ *
+ * Recipes compiled by the bbque-rcc tool are loaded instead of the XML ones,
+ * by memory mapping them, if they are not older than the XML ones.
  */
 class XMLRecipeLoader : public RecipeLoaderIF {
 
@@ -117,6 +121,13 @@ public:
 	 */
 	std::time_t LastModifiedTime(std::string const & recipe_name);
 
+	/**
+	 * @see RecipeLoaderIF
+	 */
+	std::string const & RecipesDir() {
+		return recipe_dir;
+	}
+
 private:
 
 	/**
@@ -243,6 +254,39 @@ private:
 	 */
 	void LoadConstraints(ticpp::Element * xml_elem);
 
+	/**
+	 * @brief Load the compiled version of a recipe
+	 * @param recipe_name The recipe name
+	 * @return RL_NOT_FOUND if the compiled recipe is missing, not valid or
+	 * out-of-date, thus the XML recipe must be parsed instead
+	 */
+	ExitCode_t LoadCompiled(std::string const & recipe_name);
+
+	/**
+	 * @brief Fill the recipe with the data of a compiled recipe
+	 * @param hdr The header of the (validated) compiled recipe
+	 */
+	ExitCode_t ParseCompiled(brc_header_t const * hdr);
+
+	/**
+	 * @brief Lookup the platform section of a compiled recipe
+	 * @param hdr The header of the compiled recipe
+	 * @return The platform section to consider
+	 */
+	brc_platform_t const * LoadPlatform(brc_header_t const * hdr);
+
+	/**
+	 * @brief Load the plugins specific data of a compiled recipe
+	 * @param container The object (usually Application or WorkingMode) to
+	 * which add the plugin specific data
+	 * @param hdr The header of the compiled recipe
+	 * @param first The index of the first plugin data
+	 * @param nr The number of plugin data
+	 */
+	template<class T>
+	void LoadPluginsData(T container, brc_header_t const * hdr,
+			uint32_t first, uint32_t nr);
+
 };
 
 } // namespace plugins
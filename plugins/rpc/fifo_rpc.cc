@@ -23,10 +23,17 @@
 #include <boost/filesystem.hpp>
 
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <climits>
 #include <csignal>
 
+/** Get the receive chunk of a message */
+#define FIFO_RX_CHUNK(ptr) \
+	((rx_chunk_t *)((uintptr_t)(ptr) & ~((uintptr_t)BBQUE_FIFO_RX_CHUNK - 1)))
+
 namespace br = bbque::rtlib;
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
@@ -36,7 +43,12 @@ namespace bbque { namespace plugins {
 FifoRPC::FifoRPC(std::string const & fifo_dir) :
 	initialized(false),
 	conf_fifo_dir(fifo_dir),
-	rpc_fifo_fd(0) {
+	rpc_fifo_fd(0),
+	rx_chunk(NULL),
+	rx_head(0),
+	rx_tail(0),
+	rx_drop(0),
+	rx_resync(false) {
 
 	// Get a logger
 	plugins::LoggerIF::Configuration conf(MODULE_NAMESPACE);
@@ -70,6 +82,12 @@ FifoRPC::~FifoRPC() {
 	::close(rpc_fifo_fd);
 	// Remove the server side pipe
 	::unlink(fifo_path.string().c_str());
+
+	// Release the receive chunks
+	if (rx_chunk)
+		PutChunk(rx_chunk);
+	for (size_t i = 0; i < rx_free.size(); ++i)
+		::free(rx_free[i]);
 }
 
 //----- RPCChannelIF module interface
@@ -155,110 +173,185 @@ int FifoRPC::Init() {
 	return 0;
 }
 
+FifoRPC::rx_chunk_t *FifoRPC::GetChunk() {
+	std::unique_lock<std::mutex> rx_ul(rx_mtx);
+	void *chunk = NULL;
+
+	if (!rx_free.empty()) {
+		chunk = rx_free.back();
+		rx_free.pop_back();
+	} else {
+		rx_ul.unlock();
+		logger->Debug("FIFO RPC: new receive chunk");
+		if (::posix_memalign(&chunk, BBQUE_FIFO_RX_CHUNK,
+					sizeof(rx_chunk_t)))
+			return NULL;
+	}
+
+	((rx_chunk_t *)chunk)->refs = 1;
+	return (rx_chunk_t *)chunk;
+}
+
+void FifoRPC::PutChunk(rx_chunk_t *chunk) {
+
+	// Other messages of this chunk are still in use
+	if (__atomic_sub_fetch(&chunk->refs, 1, __ATOMIC_ACQ_REL))
+		return;
+
+	std::unique_lock<std::mutex> rx_ul(rx_mtx);
+	if (rx_free.size() < BBQUE_FIFO_RX_CHUNKS_FREE) {
+		rx_free.push_back(chunk);
+		return;
+	}
+	rx_ul.unlock();
+	::free(chunk);
+}
+
+bool FifoRPC::NextChunk() {
+	size_t pending = rx_tail - rx_head;
+	rx_chunk_t *chunk;
+
+	// All the messages of the current chunk have been already freed,
+	// thus it is reused
+	if (__atomic_load_n(&rx_chunk->refs, __ATOMIC_ACQUIRE) == 1) {
+		::memmove(rx_chunk->data, rx_chunk->data + rx_head, pending);
+		rx_head = 0;
+		rx_tail = pending;
+		return true;
+	}
+
+	chunk = GetChunk();
+	if (!chunk) {
+		logger->Error("FIFO RPC: receive chunk allocation FAILED");
+		return false;
+	}
+	::memcpy(chunk->data, rx_chunk->data + rx_head, pending);
+	PutChunk(rx_chunk);
+	rx_chunk = chunk;
+	rx_head = 0;
+	rx_tail = pending;
+	return true;
+}
+
+bool FifoRPC::ValidHeader(br::rpc_fifo_header_t const & hdr) {
+	return ((hdr.rpc_msg_type < br::RPC_BBQ_MSGS_COUNT) &&
+			(hdr.rpc_msg_offset >= FIFO_PKT_SIZE(header)) &&
+			(hdr.fifo_msg_size >= hdr.rpc_msg_offset +
+			 RPC_PKT_SIZE(header)) &&
+			(hdr.fifo_msg_size <= BBQUE_FIFO_RX_BUFFER));
+}
+
+void FifoRPC::Resync(br::rpc_fifo_header_t const & hdr) {
+
+	// Already looking for a valid header: skip the next byte
+	if (rx_resync) {
+		rx_drop = 1;
+		return;
+	}
+
+	logger->Error("FIFO RPC: malformed message "
+			"[sze: %hd, off: %hd, typ: %hd]",
+			hdr.fifo_msg_size, hdr.rpc_msg_offset, hdr.rpc_msg_type);
+
+	// Messages are written atomically, thus a size within range is
+	// likely to be the actual one: drop just this message
+	if ((hdr.fifo_msg_size >= FIFO_PKT_SIZE(header)) &&
+			(hdr.fifo_msg_size <= BBQUE_FIFO_RX_BUFFER)) {
+		rx_drop = hdr.fifo_msg_size;
+		return;
+	}
+
+	logger->Warn("FIFO RPC: looking for the next valid message...");
+	rx_resync = true;
+	rx_drop = 1;
+}
+
 ssize_t FifoRPC::RecvMessage(rpc_msg_ptr_t & msg) {
 	br::rpc_fifo_header_t hdr;
-	void *fifo_buff_ptr;
-	ssize_t result;
+	uint8_t *fifo_buff_ptr;
+	size_t pending;
 	ssize_t bytes;
 
 	logger->Debug("FIFO RPC: waiting message...");
 
-	// Wait for the next message being available
-	// ... which always starts with the FIFO header
-	bytes = ::read(rpc_fifo_fd, (void*)&hdr, FIFO_PKT_SIZE(header));
-	if (bytes <= 0) {
-		if (bytes == EINTR)
-			logger->Debug("FIFO RPC: exiting FIFO read...");
-		else
-			logger->Error("FIFO RPC: fifo read error");
-		return bytes;
+	if (!rx_chunk) {
+		rx_chunk = GetChunk();
+		if (!rx_chunk) {
+			logger->Error("FIFO RPC: receive chunk allocation FAILED");
+			return -ENOMEM;
+		}
 	}
 
-	// Allocate a new message buffer
-	fifo_buff_ptr = ::malloc(hdr.fifo_msg_size);
-	if (!fifo_buff_ptr) {
-		char c;
-		logger->Error("FIFO RPC: message buffer creation FAILED");
-		// Remove the remaining message from the FIFO
-		for ( ; bytes<hdr.fifo_msg_size; bytes++) {
-			result = ::read(rpc_fifo_fd, (void*)&c, sizeof(char));
-			if (likely(result != -1))
+	// Wait for the next message being completely available into the
+	// receive chunk. All the messages available into the FIFO (e.g. a
+	// batch of pipelined requests) are read at once, thus the following
+	// ones are returned without any further system call.
+	for (;;) {
+
+		// Drop the (received part of a) malformed message
+		if (rx_drop) {
+			pending = std::min(rx_drop, rx_tail - rx_head);
+			rx_head += pending;
+			rx_drop -= pending;
+		}
+		pending = rx_tail - rx_head;
+
+		// Check the message is well formed, otherwise recover the
+		// framing to find the next message
+		if (!rx_drop && (pending >= FIFO_PKT_SIZE(header))) {
+			::memcpy(&hdr, rx_chunk->data + rx_head,
+					FIFO_PKT_SIZE(header));
+			if (!ValidHeader(hdr)) {
+				Resync(hdr);
 				continue;
+			}
+			if (rx_resync) {
+				logger->Warn("FIFO RPC: messages framing "
+						"recovered");
+				rx_resync = false;
+			}
+			if (pending >= hdr.fifo_msg_size)
+				break;
+		}
 
-			// FIXME If a read fails at that point, the FIFO queue
-			// could be dirty with pending bytes of the current
-			// header message... a proper clean-up procedure
-			// should be activated, e.g. lookup for the next
-			// HEADER.
-			logger->Error("FIFO RPC: read FAILED (Error %d: %s)",
-					errno, strerror(errno));
+		// Make room for the remaining part of the message, which could
+		// be as big as the maximum message size
+		if ((rx_head > sizeof(rx_chunk->data) - BBQUE_FIFO_RX_BUFFER) &&
+				!NextChunk())
+			return -ENOMEM;
+
+		bytes = ::read(rpc_fifo_fd, rx_chunk->data + rx_tail,
+				sizeof(rx_chunk->data) - rx_tail);
+		if (bytes <= 0) {
+			if (bytes == EINTR)
+				logger->Debug("FIFO RPC: exiting FIFO read...");
+			else
+				logger->Error("FIFO RPC: fifo read error");
+			return bytes;
 		}
-		return -errno;
+		rx_tail += bytes;
 	}
 
-	// Save header into new buffer
-	::memcpy(fifo_buff_ptr, &hdr, FIFO_PKT_SIZE(header));
+	// Return the message in place: the chunk is referenced until the
+	// message is given back by FreeMessage
+	__atomic_add_fetch(&rx_chunk->refs, 1, __ATOMIC_RELAXED);
+	fifo_buff_ptr = rx_chunk->data + rx_head;
+	rx_head += hdr.fifo_msg_size;
 
 	// Recover the payload start pointer
-	switch (hdr.rpc_msg_type) {
-	case br::RPC_APP_PAIR:
-
-		result = ::read(rpc_fifo_fd,
-			&(((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->rpc_fifo),
-			hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (unlikely(result == -1))
-			goto exit_read_failed;
-
-		msg = (rpc_msg_ptr_t)&(((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl);
-		logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
-				"RPC_HDR [typ: %d, pid: %d, eid: %hd]",
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.fifo_msg_size,
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.rpc_msg_offset,
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->hdr.rpc_msg_type,
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.typ,
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.app_pid,
-			((br::rpc_fifo_APP_PAIR_t*)fifo_buff_ptr)->pyl.hdr.exc_id
-		     );
-		break;
-	default:
-		result = ::read(rpc_fifo_fd,
-			&(((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl),
-			hdr.fifo_msg_size - FIFO_PKT_SIZE(header));
-		if (unlikely(result == -1))
-			goto exit_read_failed;
-
-		msg = &(((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl);
-		logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
-				"RPC_HDR [typ: %d, pid: %d, eid: %hd]",
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.fifo_msg_size,
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.rpc_msg_offset,
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->hdr.rpc_msg_type,
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.typ,
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.app_pid,
-			((br::rpc_fifo_GENERIC_t*)fifo_buff_ptr)->pyl.exc_id
-		     );
-	}
+	msg = (rpc_msg_ptr_t)(fifo_buff_ptr + hdr.rpc_msg_offset);
+	logger->Debug("FIFO RPC: Rx FIFO_HDR [sze: %hd, off: %hd, typ: %hd] "
+			"RPC_HDR [typ: %d, pid: %d, eid: %hd]",
+			hdr.fifo_msg_size, hdr.rpc_msg_offset, hdr.rpc_msg_type,
+			msg->typ, msg->app_pid, msg->exc_id);
+
 	// Recovery the payload size to be returned
 	bytes = hdr.fifo_msg_size - hdr.rpc_msg_offset;
 
-	//logger->Debug("Rx Buffer FIFO_HDR [@%p] RPC_HDR [@%p] => Offset: %hd",
-	//		fifo_buff_ptr, msg,
-	//		(size_t)msg-(size_t)fifo_buff_ptr);
-
 	// HEXDUMP the received buffer
 	//RPC_FIFO_HEX_DUMP_BUFFER(fifo_buff_ptr, hdr.fifo_msg_size);
 
 	return bytes;
-
-exit_read_failed:
-
-	logger->Error("FIFO RPC: read RPC message FAILED (Error %d: %s)",
-			errno, strerror(errno));
-
-	free(fifo_buff_ptr);
-	msg = NULL;
-
-	return -errno;
 }
 
 RPCChannelIF::plugin_data_t FifoRPC::GetPluginData(
@@ -352,60 +445,44 @@ void FifoRPC::ReleasePluginData(plugin_data_t & pd) {
 ssize_t FifoRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
 		size_t count) {
 	fifo_data_t * ppd = (fifo_data_t*)pd.get();
-	br::rpc_fifo_GENERIC_t *fifo_msg;
+	br::rpc_fifo_header_t hdr;
+	struct iovec iov[2];
 	ssize_t error;
 
 	assert(rpc_fifo_fd);
 	assert(ppd && ppd->app_fifo_fd);
 
-	// FIXME copying the RPC message into the FIFO one is not efficient at all,
-	// but this it the less intrusive patch to use a single write on the PIPE.
-	// A better solution, e.g. pre-allocating a channel message, should be
-	// provided by a future patch
-
-	// Build a new message of the required type
-	// NOTE all BBQ generated command have the sam FIFO layout
-	fifo_msg = (br::rpc_fifo_GENERIC_t*)::malloc(
-			offsetof(br::rpc_fifo_GENERIC_t, pyl) + count);
-
-	// Copy the RPC message into the FIFO msg
-	::memcpy(&(fifo_msg->pyl), msg, count);
-
 	logger->Debug("FIFO RPC: TX [typ: %d, sze: %d] "
 			"using app channel [%d:%s]...",
 			msg->typ, count,
 			ppd->app_fifo_fd,
 			ppd->app_fifo_filename);
 
-	// Send the RPC FIFO message
-	fifo_msg->hdr.fifo_msg_size = offsetof(br::rpc_fifo_GENERIC_t, pyl) + count;
-	fifo_msg->hdr.rpc_msg_offset = offsetof(br::rpc_fifo_GENERIC_t, pyl);
-	fifo_msg->hdr.rpc_msg_type = msg->typ;
-	error = ::write(ppd->app_fifo_fd, fifo_msg, fifo_msg->hdr.fifo_msg_size);
+	// Build the FIFO header of the message
+	// NOTE all BBQ generated command have the sam FIFO layout
+	hdr.fifo_msg_size = offsetof(br::rpc_fifo_GENERIC_t, pyl) + count;
+	hdr.rpc_msg_offset = offsetof(br::rpc_fifo_GENERIC_t, pyl);
+	hdr.rpc_msg_type = msg->typ;
+
+	// Send the RPC FIFO message, gathering the header and the RPC message
+	// with a single (atomic) write on the PIPE, without any copy
+	iov[0].iov_base = &hdr;
+	iov[0].iov_len = hdr.rpc_msg_offset;
+	iov[1].iov_base = msg;
+	iov[1].iov_len = count;
+	error = ::writev(ppd->app_fifo_fd, iov, 2);
 	if (error == -1) {
 		logger->Error("FIFO RPC: send massage (header) FAILED (Error %d: %s)",
 				errno, strerror(errno));
 		return -errno;
 	}
 
-	return fifo_msg->hdr.fifo_msg_size;
+	return hdr.fifo_msg_size;
 }
 
 void FifoRPC::FreeMessage(rpc_msg_ptr_t & msg) {
-	void* fifo_msg;
-
-	// Recover the beginning of the FIFO message
-	switch (msg->typ) {
-	case br::RPC_APP_PAIR:
-		fifo_msg = (void*)container_of(msg, br::rpc_fifo_APP_PAIR_t, pyl);
-		break;
-	default:
-		fifo_msg = (void*)container_of(msg, br::rpc_fifo_GENERIC_t, pyl);
-		break;
-	}
-
-	// Releaseing the FIFO message buffer
-	::free(fifo_msg);
+	// Release the receive chunk of the message
+	PutChunk(FIFO_RX_CHUNK(msg));
 }
 
 //----- static plugin interface
@@ -23,11 +23,23 @@
 #include "bbque/plugins/rpc_channel.h"
 #include "bbque/plugins/plugin.h"
 #include "bbque/plugins/logger.h"
+#include "bbque/cpp11/mutex.h"
 
+#include <climits>
 #include <cstdint>
+#include <vector>
 
 #define MODULE_NAMESPACE RPC_CHANNEL_NAMESPACE ".fif"
 
+/** The maximum size of a message */
+#define BBQUE_FIFO_RX_BUFFER (2 * PIPE_BUF)
+
+/** The size of a receive chunk, which is aligned to its (power of 2) size */
+#define BBQUE_FIFO_RX_CHUNK (4 * PIPE_BUF)
+
+/** The receive chunks kept for recycling */
+#define BBQUE_FIFO_RX_CHUNKS_FREE 4
+
 // These are the parameters received by the PluginManager on create calls
 struct PF_ObjectParams;
 
@@ -103,6 +115,59 @@ private:
 	 */
 	int rpc_fifo_fd;
 
+	/**
+	 * @brief A chunk of data read from the server FIFO
+	 *
+	 * The data available into the server FIFO is read at once, thus
+	 * a batch of messages is received by a single system call. Messages
+	 * are then returned in place, one at a time, and the chunk is
+	 * recycled once all its messages have been given back by FreeMessage.
+	 * Since chunks are aligned to their size, the chunk of a message is
+	 * found by its address.
+	 */
+	typedef struct rx_chunk {
+		/** The messages not yet freed, plus one while receiving */
+		uint32_t refs;
+		/** The received data */
+		uint8_t data[BBQUE_FIFO_RX_CHUNK - 8]
+			__attribute__ ((aligned(8)));
+	} rx_chunk_t;
+
+	/**
+	 * @brief The chunk currently used to receive messages
+	 */
+	rx_chunk_t *rx_chunk;
+
+	/**
+	 * @brief The offset of the next message into the receive chunk
+	 */
+	size_t rx_head;
+
+	/**
+	 * @brief The bytes available into the receive chunk
+	 */
+	size_t rx_tail;
+
+	/**
+	 * @brief The chunks released, ready to be recycled
+	 */
+	std::vector<rx_chunk_t *> rx_free;
+
+	/**
+	 * @brief The mutex protecting the released chunks
+	 */
+	std::mutex rx_mtx;
+
+	/**
+	 * @brief The bytes of a malformed message still to be dropped
+	 */
+	size_t rx_drop;
+
+	/**
+	 * @brief Set while looking for a valid header, one byte at a time
+	 */
+	bool rx_resync;
+
 	/**
 	 * @brief   The plugins constructor
 	 * Plugins objects could be build only by using the "create" method.
@@ -114,6 +179,42 @@ private:
 
 	int Init();
 
+	/**
+	 * @brief Get a new receive chunk, recycling a released one if any
+	 */
+	rx_chunk_t *GetChunk();
+
+	/**
+	 * @brief Release a reference to a receive chunk
+	 */
+	void PutChunk(rx_chunk_t *chunk);
+
+	/**
+	 * @brief Make room for a whole message into the receive chunk
+	 *
+	 * The pending part of the next message is moved at the beginning of
+	 * the current chunk, if all its messages have been already freed, or
+	 * into a new one otherwise.
+	 *
+	 * @return false if a new chunk could not be allocated
+	 */
+	bool NextChunk();
+
+	/**
+	 * @brief Check the header of a received message
+	 */
+	static bool ValidHeader(rtlib::rpc_fifo_header_t const & hdr);
+
+	/**
+	 * @brief Recover the messages framing after a malformed header
+	 *
+	 * If the size of the malformed message could be trusted, just that
+	 * message is dropped, otherwise the next valid header is looked for
+	 * one byte at a time. The following messages, possibly sent by other
+	 * applications, are never dropped.
+	 */
+	void Resync(rtlib::rpc_fifo_header_t const & hdr);
+
 };
 
 } // namespace plugins
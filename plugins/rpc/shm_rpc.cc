@@ -0,0 +1,493 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_rpc.h"
+
+#include "bbque/modules_factory.h"
+
+#include "bbque/config.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <thread>
+#include <chrono>
+
+namespace br = bbque::rtlib;
+namespace po = boost::program_options;
+
+namespace bbque { namespace plugins {
+
+ShmRPC::ShmRPC(uint32_t send_timeout) :
+	initialized(false),
+	conf_send_timeout(send_timeout),
+	server(NULL),
+	channels(BBQUE_RPC_SHM_CHANNELS),
+	next_slot(0) {
+
+	// Get a logger
+	plugins::LoggerIF::Configuration conf(MODULE_NAMESPACE);
+	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
+	if (!logger) {
+		if (daemonized)
+			syslog(LOG_INFO, "Build SHM rpc plugin [%p] FAILED "
+					"(Error: missing logger module)", (void*)this);
+		else
+			fprintf(stdout, FI("Build SHM rpc plugin [%p] FAILED "
+					"(Error: missing logger module)\n"), (void*)this);
+	}
+
+	assert(logger);
+	logger->Debug("Built SHM rpc object @%p", (void*)this);
+
+}
+
+ShmRPC::~ShmRPC() {
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+
+	logger->Debug("SHM RPC: cleaning up segment [%s]...",
+			BBQUE_PUBLIC_SHM);
+
+	// Unmap all the application segments still attached
+	for (uint16_t slot = 0; slot < channels.size(); ++slot) {
+		if (!channels[slot])
+			continue;
+		DetachChannel(channels[slot]);
+	}
+	inflight.clear();
+
+	if (server)
+		::munmap(server, sizeof(br::rpc_shm_server_t));
+	// Remove the server side segment
+	::shm_unlink(BBQUE_PUBLIC_SHM);
+}
+
+//----- RPCChannelIF module interface
+
+int ShmRPC::Init() {
+	void *addr;
+	int fd;
+
+	if (initialized)
+		return 0;
+
+	logger->Debug("SHM RPC: channel initialization...");
+
+	// If the segment already exists: destroy it and rebuild a new one
+	if (::shm_unlink(BBQUE_PUBLIC_SHM) == 0)
+		logger->Debug("SHM RPC: destroyed old segment [%s]",
+				BBQUE_PUBLIC_SHM);
+
+	// Create the server side segment
+	logger->Debug("SHM RPC: create segment [%s]...", BBQUE_PUBLIC_SHM);
+	fd = ::shm_open(BBQUE_PUBLIC_SHM, O_CREAT|O_EXCL|O_RDWR, 0660);
+	if (fd < 0) {
+		logger->Error("SHM RPC: RPC segment [%s] creation FAILED "
+				"(Error %d: %s)", BBQUE_PUBLIC_SHM,
+				errno, strerror(errno));
+		return -1;
+	}
+
+	// Ensuring the segment is R/W to the Barbeque group (despite the
+	// umask): only applications of that group are allowed to pair
+	if (fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP) ||
+			ftruncate(fd, sizeof(br::rpc_shm_server_t))) {
+		logger->Error("SHM RPC: setup of RPC segment [%s] FAILED "
+				"(Error %d: %s)", BBQUE_PUBLIC_SHM,
+				errno, strerror(errno));
+		goto err_setup;
+	}
+
+	addr = ::mmap(NULL, sizeof(br::rpc_shm_server_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) {
+		logger->Error("SHM RPC: mapping RPC segment [%s] FAILED "
+				"(Error %d: %s)", BBQUE_PUBLIC_SHM,
+				errno, strerror(errno));
+		goto err_setup;
+	}
+	::close(fd);
+
+	// Marking the segment as ready: applications check the magic number
+	// before registering into a slot
+	server = (br::rpc_shm_server_t *)addr;
+	::memset(server, 0, sizeof(br::rpc_shm_server_t));
+	server->major = BBQUE_RPC_SHM_MAJOR_VERSION;
+	server->minor = BBQUE_RPC_SHM_MINOR_VERSION;
+	__atomic_store_n(&server->magic, BBQUE_RPC_SHM_MAGIC, __ATOMIC_RELEASE);
+
+	// Marking channel as already initialized
+	initialized = true;
+
+	logger->Info("SHM RPC: channel initialization DONE "
+			"(%d slots, %d bytes rings)",
+			BBQUE_RPC_SHM_CHANNELS, BBQUE_RPC_SHM_RING_SIZE);
+	return 0;
+
+err_setup:
+	::close(fd);
+	::shm_unlink(BBQUE_PUBLIC_SHM);
+	return -2;
+}
+
+ShmRPC::pshm_channel_t ShmRPC::AttachChannel(uint16_t slot, pid_t pid) {
+	pshm_channel_t pch(new shm_channel_t);
+	br::rpc_shm_channel_t *shm;
+	void *addr;
+	int fd;
+
+	pch->slot = slot;
+	pch->shm = NULL;
+	pch->app_pid = pid;
+	pch->cursor = 0;
+	pch->pending = 0;
+	pch->released = false;
+	::snprintf(pch->name, BBQUE_SHM_NAME_LENGTH,
+			BBQUE_SHM_CHANNEL_FMT, pid);
+
+	// The application should build the channel before registering into
+	// the slot, the version check is the API versioning verification
+	logger->Debug("SHM RPC: attaching application segment [%s]...",
+			pch->name);
+	fd = ::shm_open(pch->name, O_RDWR, 0);
+	if (fd < 0) {
+		logger->Error("SHM RPC: apps segment NOT FOUND [%s] "
+				"(Error %d: %s)", pch->name,
+				errno, strerror(errno));
+		return pshm_channel_t();
+	}
+
+	addr = ::mmap(NULL, sizeof(br::rpc_shm_channel_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		logger->Error("SHM RPC: mapping apps segment [%s] FAILED "
+				"(Error %d: %s)", pch->name,
+				errno, strerror(errno));
+		return pshm_channel_t();
+	}
+
+	shm = (br::rpc_shm_channel_t *)addr;
+	if ((__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) !=
+				BBQUE_RPC_SHM_MAGIC) ||
+			(shm->major != BBQUE_RPC_SHM_MAJOR_VERSION) ||
+			(shm->app_pid != pid)) {
+		logger->Error("SHM RPC: apps segment not valid [%s]",
+				pch->name);
+		::munmap(addr, sizeof(br::rpc_shm_channel_t));
+		return pshm_channel_t();
+	}
+
+	pch->shm = shm;
+	pch->cursor = shm->req.tail;
+
+	logger->Debug("SHM RPC: [%02d:%s] application segment attached",
+			slot, pch->name);
+
+	return pch;
+}
+
+void ShmRPC::DetachChannel(pshm_channel_t pch) {
+
+	// NOTE: this must be called with the channels table locked
+
+	if (pch->shm)
+		::munmap(pch->shm, sizeof(br::rpc_shm_channel_t));
+	pch->shm = NULL;
+
+	// Give back the slot for other applications
+	channels[pch->slot].reset();
+	__atomic_store_n(&server->slots[pch->slot], 0, __ATOMIC_RELEASE);
+
+	logger->Debug("SHM RPC: [%02d:%s] application segment detached",
+			pch->slot, pch->name);
+}
+
+void ShmRPC::DropChannel(pshm_channel_t pch) {
+
+	// NOTE: this must be called with the channels table locked
+
+	logger->Error("SHM RPC: [%02d:%s] requests ring corrupted, "
+			"channel dropped", pch->slot, pch->name);
+
+	// Messages already received are still freed as usual
+	pch->released = true;
+	if (pch->pending == 0)
+		DetachChannel(pch);
+}
+
+br::rpc_shm_record_t *ShmRPC::FetchMessage(uint32_t & size) {
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	br::rpc_shm_record_t *rec;
+	pshm_channel_t pch;
+	uint16_t slot;
+	pid_t pid;
+	int result;
+
+	for (uint16_t i = 0; i < BBQUE_RPC_SHM_CHANNELS; ++i) {
+		slot = next_slot;
+		next_slot = (next_slot + 1) % BBQUE_RPC_SHM_CHANNELS;
+
+		pid = __atomic_load_n(&server->slots[slot], __ATOMIC_ACQUIRE);
+		if (!pid)
+			continue;
+
+		// Attach the segment of newly registered applications
+		pch = channels[slot];
+		if (!pch) {
+			pch = AttachChannel(slot, pid);
+			if (!pch) {
+				// Drop the registration, the application
+				// will notice the missing response
+				__atomic_store_n(&server->slots[slot], 0,
+						__ATOMIC_RELEASE);
+				continue;
+			}
+			channels[slot] = pch;
+		}
+
+		// Messages sent after the exit are not served
+		if (pch->released)
+			continue;
+
+		result = br::rpc_shm_ring_peek(&pch->shm->req, pch->cursor,
+				rec, size);
+		if (result == -EAGAIN)
+			continue;
+
+		// Each record must carry at least an RPC message header
+		if ((result == -EBADMSG) ||
+				(size < SHM_REC_SIZE(sizeof(rpc_msg_header_t)))) {
+			DropChannel(pch);
+			continue;
+		}
+
+		// Keep track of the channel, to release the record
+		inflight[br::rpc_shm_record_msg(rec)] = pch;
+		++pch->pending;
+		return rec;
+	}
+
+	return NULL;
+}
+
+ssize_t ShmRPC::RecvMessage(rpc_msg_ptr_t & msg) {
+	br::rpc_shm_record_t *rec;
+	uint32_t doorbell;
+	uint32_t size;
+	int result;
+
+	logger->Debug("SHM RPC: waiting message...");
+
+	while (true) {
+
+		// Read the doorbell before looking for messages, thus a message
+		// sent meanwhile will not be lost by the following wait
+		doorbell = __atomic_load_n(&server->doorbell, __ATOMIC_SEQ_CST);
+
+		rec = FetchMessage(size);
+		if (rec)
+			break;
+
+		// Wait for the next message being available
+		__atomic_store_n(&server->sleeping, 1, __ATOMIC_SEQ_CST);
+		result = br::rpc_shm_futex_wait(&server->doorbell, doorbell);
+		__atomic_store_n(&server->sleeping, 0, __ATOMIC_RELAXED);
+		if ((result == -1) && (errno == EINTR)) {
+			logger->Debug("SHM RPC: exiting segment wait...");
+			msg = NULL;
+			return EINTR;
+		}
+	}
+
+	msg = br::rpc_shm_record_msg(rec);
+	logger->Debug("SHM RPC: Rx SHM_REC [sze: %u] "
+			"RPC_HDR [typ: %d, pid: %d, eid: %hd]",
+			size, msg->typ, msg->app_pid, msg->exc_id);
+
+	// Recovery the payload size to be returned
+	// NOTE: this includes the record alignment padding, while the size
+	// has been already checked to cover at least the record header
+	return size - sizeof(br::rpc_shm_record_t);
+}
+
+RPCChannelIF::plugin_data_t ShmRPC::GetPluginData(
+		rpc_msg_ptr_t & msg) {
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	std::map<rpc_msg_ptr_t, pshm_channel_t>::iterator it;
+	pshm_channel_t pch;
+
+	// We should have the public segment already on place
+	assert(initialized);
+
+	// We should also have a valid RPC message
+	assert(msg->typ == br::RPC_APP_PAIR);
+
+	// The channel has been already attached while receiving the message
+	it = inflight.find(msg);
+	if (it != inflight.end())
+		pch = it->second;
+	if (!pch || (pch->app_pid != msg->app_pid)) {
+		logger->Error("SHM RPC: apps channel NOT FOUND [pid: %d]",
+				msg->app_pid);
+		return plugin_data_t();
+	}
+
+	logger->Info("SHM RPC: [%02d:%s] channel initialization DONE",
+			pch->slot, pch->name);
+
+	return plugin_data_t(pch);
+}
+
+void ShmRPC::ReleasePluginData(plugin_data_t & pd) {
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	pshm_channel_t pch(std::static_pointer_cast<shm_channel_t>(pd));
+
+	assert(initialized==true);
+	assert(pch);
+
+	// The segment is unmapped once all its messages have been freed,
+	// i.e. usually once the APP_EXIT message has been processed
+	pch->released = true;
+	if (pch->shm && (pch->pending == 0))
+		DetachChannel(pch);
+
+	logger->Info("SHM RPC: [%02d:%s] channel release DONE",
+			pch->slot, pch->name);
+
+}
+
+ssize_t ShmRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+		size_t count) {
+	pshm_channel_t pch(std::static_pointer_cast<shm_channel_t>(pd));
+	std::unique_lock<std::mutex> send_ul(pch->send_mtx);
+	uint32_t waited_ms = 0;
+	br::rpc_shm_ring_t *ring;
+
+	assert(server);
+	assert(pch);
+
+	if (!pch->shm || pch->released) {
+		logger->Error("SHM RPC: send message FAILED "
+				"(Error: channel [%s] released)", pch->name);
+		return -EPIPE;
+	}
+
+	logger->Debug("SHM RPC: TX [typ: %d, sze: %d] "
+			"using app channel [%02d:%s]...",
+			msg->typ, count, pch->slot, pch->name);
+
+	// Copy the RPC message into the responses ring, waiting for the
+	// application to drain a full ring within the timeout
+	ring = &pch->shm->resp;
+	while (!br::rpc_shm_ring_push(ring, msg, count)) {
+		if ((count > BBQUE_RPC_SHM_MSG_MAX) ||
+				(waited_ms >= conf_send_timeout)) {
+			logger->Error("SHM RPC: send message FAILED "
+					"(Error: ring of channel [%s] full)",
+					pch->name);
+			return -ENOBUFS;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		++waited_ms;
+	}
+
+	// Wake-up the application only if it is waiting
+	if (br::rpc_shm_ring_sleeping(ring))
+		br::rpc_shm_futex_wake(&ring->head);
+
+	return count;
+}
+
+void ShmRPC::FreeMessage(rpc_msg_ptr_t & msg) {
+	std::unique_lock<std::mutex> channels_ul(channels_mtx);
+	std::map<rpc_msg_ptr_t, pshm_channel_t>::iterator it;
+	pshm_channel_t pch;
+
+	// Recover the channel of the message
+	it = inflight.find(msg);
+	if (it == inflight.end()) {
+		logger->Error("SHM RPC: free message FAILED "
+				"(Error: unknown message @%p)", (void*)msg);
+		msg = NULL;
+		return;
+	}
+	pch = it->second;
+	inflight.erase(it);
+	assert(pch->shm && pch->pending);
+
+	// Give back the record space to the application
+	br::rpc_shm_ring_release(&pch->shm->req,
+			br::rpc_shm_msg_record(msg), pch->cursor);
+	msg = NULL;
+
+	// Unmap the segment of exited applications
+	if ((--pch->pending == 0) && pch->released)
+		DetachChannel(pch);
+}
+
+//----- static plugin interface
+
+void * ShmRPC::Create(PF_ObjectParams *params) {
+	static uint32_t conf_send_timeout;
+
+	// Declare the supported options
+	po::options_description shm_rpc_opts_desc("SHM RPC Options");
+	shm_rpc_opts_desc.add_options()
+		(MODULE_NAMESPACE".send_timeout", po::value<uint32_t>
+		 (&conf_send_timeout)->default_value(BBQUE_RPC_TIMEOUT),
+		 "time [ms] to wait for a full application ring")
+		;
+	static po::variables_map shm_rpc_opts_value;
+
+	// Get configuration params
+	PF_Service_ConfDataIn data_in;
+	data_in.opts_desc = &shm_rpc_opts_desc;
+	PF_Service_ConfDataOut data_out;
+	data_out.opts_value = &shm_rpc_opts_value;
+	PF_ServiceData sd;
+	sd.id = MODULE_NAMESPACE;
+	sd.request = &data_in;
+	sd.response = &data_out;
+
+	int32_t response = params->
+		platform_services->InvokeService(PF_SERVICE_CONF_DATA, sd);
+	if (response!=PF_SERVICE_DONE)
+		return NULL;
+
+	if (daemonized)
+		syslog(LOG_INFO, "Using RPC shared memory [%s]",
+				BBQUE_PUBLIC_SHM);
+	else
+		fprintf(stderr, FI("SHM RPC: using segment [%s]\n"),
+				BBQUE_PUBLIC_SHM);
+
+	return new ShmRPC(conf_send_timeout);
+
+}
+
+int32_t ShmRPC::Destroy(void *plugin) {
+  if (!plugin)
+    return -1;
+  delete (ShmRPC *)plugin;
+  return 0;
+}
+
+} // namesapce plugins
+
+} // namespace bque
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_PLUGINS_SHM_RPC_H_
+#define BBQUE_PLUGINS_SHM_RPC_H_
+
+#include "bbque/rtlib/rpc_shm_server.h"
+
+#include "bbque/plugins/rpc_channel.h"
+#include "bbque/plugins/plugin.h"
+#include "bbque/plugins/logger.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define MODULE_NAMESPACE RPC_CHANNEL_NAMESPACE ".shm"
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bbque { namespace plugins {
+
+/**
+ * @brief A shared memory based implementation of the RPCChannelIF interface.
+ *
+ * This class provide a shared memory based communication channel between the
+ * Barbque RTRM and the applications. Each application creates its own
+ * segment, hosting a pair of lock-free ring buffers, and pairs with Barbeque
+ * by registering its PID into a slot of the public segment.
+ *
+ * Received messages are not copied: they are returned in place, and their
+ * ring space is given back to the application once released by FreeMessage.
+ * Wake-ups, in both directions, are based on futexes placed into the shared
+ * segments, thus no system call is required while the peer is running.
+ */
+class ShmRPC : public RPCChannelIF {
+
+/**
+ * @brief The Barbeque side of an application channel
+ *
+ * This is also the plugin data returned for each application.
+ */
+typedef struct shm_channel {
+	/** The slot of the channel into the public segment */
+	uint16_t slot;
+	/** The mapped application segment, NULL once detached */
+	rtlib::rpc_shm_channel_t *shm;
+	/** The application PID */
+	pid_t app_pid;
+	/** The application segment name */
+	char name[BBQUE_SHM_NAME_LENGTH];
+	/** The read cursor of the requests ring */
+	uint32_t cursor;
+	/** The number of received, but not yet freed, messages */
+	uint32_t pending;
+	/** Set once the application has exited */
+	bool released;
+	/** Serialize responses sent by different threads */
+	std::mutex send_mtx;
+} shm_channel_t;
+
+typedef std::shared_ptr<shm_channel_t> pshm_channel_t;
+
+
+public:
+
+//----- static plugin interface
+
+	/**
+	 *
+	 */
+	static void * Create(PF_ObjectParams *);
+
+	/**
+	 *
+	 */
+	static int32_t Destroy(void *);
+
+	virtual ~ShmRPC();
+
+//----- RPCChannelIF module interface
+
+
+	virtual ssize_t RecvMessage(rpc_msg_ptr_t & msg);
+
+	virtual plugin_data_t GetPluginData(rpc_msg_ptr_t & msg);
+
+	virtual void ReleasePluginData(plugin_data_t & pd);
+
+	virtual ssize_t SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+								size_t count);
+
+	virtual void FreeMessage(rpc_msg_ptr_t & msg);
+
+private:
+
+	/**
+	 * @brief System logger instance
+	 */
+	plugins::LoggerIF *logger;
+
+	/**
+	 * @brief Thrue if the channel has been correctly initalized
+	 */
+	bool initialized;
+
+	/**
+	 * @brief The maximum time [ms] to wait for a full ring being drained
+	 */
+	uint32_t conf_send_timeout;
+
+	/**
+	 * @brief The mapped public segment
+	 */
+	rtlib::rpc_shm_server_t *server;
+
+	/**
+	 * @brief The application channels, indexed by slot
+	 */
+	std::vector<pshm_channel_t> channels;
+
+	/**
+	 * @brief The channel of each received, but not yet freed, message
+	 *
+	 * The records live into application writable memory, thus the
+	 * owning channel is tracked on the Barbeque side.
+	 */
+	std::map<rpc_msg_ptr_t, pshm_channel_t> inflight;
+
+	/**
+	 * @brief Protect the channels table and the requests rings reader side
+	 */
+	std::mutex channels_mtx;
+
+	/**
+	 * @brief The next slot to look for messages
+	 *
+	 * Slots are scanned in round-robin, thus a flooding application
+	 * could not starve the others.
+	 */
+	uint16_t next_slot;
+
+	/**
+	 * @brief   The plugins constructor
+	 * Plugins objects could be build only by using the "create" method.
+	 * Usually the PluginManager acts as object
+	 * @param   
+	 * @return  
+	 */
+	ShmRPC(uint32_t send_timeout);
+
+	int Init();
+
+	/**
+	 * @brief Map the segment of an application just registered
+	 */
+	pshm_channel_t AttachChannel(uint16_t slot, pid_t pid);
+
+	/**
+	 * @brief Unmap the segment of an application
+	 */
+	void DetachChannel(pshm_channel_t pch);
+
+	/**
+	 * @brief Stop serving a channel which ring has been corrupted
+	 */
+	void DropChannel(pshm_channel_t pch);
+
+	/**
+	 * @brief Look for the next message, scanning all the channels
+	 *
+	 * @param size set to the bytes of the returned record
+	 *
+	 * @return the record of the next message, NULL if none is available
+	 */
+	rtlib::rpc_shm_record_t *FetchMessage(uint32_t & size);
+
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_PLUGINS_SHM_RPC_H_
@@ -0,0 +1,553 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sock_rpc.h"
+
+#include "bbque/modules_factory.h"
+
+#include "bbque/config.h"
+#include <boost/filesystem.hpp>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+/** The number of message buffers allocated at channel initialization */
+#define BBQUE_RPC_SOCK_BUFFERS 16
+
+namespace br = bbque::rtlib;
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+
+namespace bbque { namespace plugins {
+
+SockRPC::SockRPC(std::string const & sock_dir) :
+	initialized(false),
+	conf_sock_dir(sock_dir),
+	listen_fd(-1),
+	epoll_fd(-1),
+	events_count(0),
+	events_next(0) {
+
+	// Get a logger
+	plugins::LoggerIF::Configuration conf(MODULE_NAMESPACE);
+	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
+	if (!logger) {
+		if (daemonized)
+			syslog(LOG_INFO, "Build SOCK rpc plugin [%p] FAILED "
+					"(Error: missing logger module)", (void*)this);
+		else
+			fprintf(stdout, FI("Build SOCK rpc plugin [%p] FAILED "
+					"(Error: missing logger module)\n"), (void*)this);
+	}
+
+	assert(logger);
+	logger->Debug("Built SOCK rpc object @%p", (void*)this);
+
+}
+
+SockRPC::~SockRPC() {
+	std::map<int, psock_conn_t>::iterator it;
+	fs::path sock_path(conf_sock_dir);
+	sock_path /= "/" BBQUE_PUBLIC_SOCK;
+
+	logger->Debug("SOCK RPC: cleaning up socket [%s]...",
+			sock_path.string().c_str());
+
+	// Close all the application connections
+	for (it = conns.begin(); it != conns.end(); ++it) {
+		std::unique_lock<std::mutex> send_ul((*it).second->send_mtx);
+		::close((*it).second->fd);
+		(*it).second->fd = -1;
+	}
+	conns.clear();
+
+	// Release the buffers pool
+	for (size_t i = 0; i < buffers.size(); ++i)
+		delete buffers[i];
+	buffers.clear();
+
+	if (epoll_fd >= 0)
+		::close(epoll_fd);
+	if (listen_fd >= 0)
+		::close(listen_fd);
+	// Remove the server side socket
+	::unlink(sock_path.string().c_str());
+}
+
+//----- RPCChannelIF module interface
+
+int SockRPC::Init() {
+	fs::path sock_path(conf_sock_dir);
+	boost::system::error_code ec;
+	struct sockaddr_un addr;
+	struct epoll_event ev;
+	struct rlimit rlim;
+
+	if (initialized)
+		return 0;
+
+	logger->Debug("SOCK RPC: channel initialization...");
+
+	sock_path /= "/" BBQUE_PUBLIC_SOCK;
+	if (sock_path.string().length() >= sizeof(addr.sun_path)) {
+		logger->Error("SOCK RPC: socket path [%s] too long",
+				sock_path.string().c_str());
+		return -1;
+	}
+
+	// Each application requires a descriptor: ensure we could serve as
+	// many applications as allowed by the system
+	if ((getrlimit(RLIMIT_NOFILE, &rlim) == 0) &&
+			(rlim.rlim_cur < rlim.rlim_max)) {
+		rlim.rlim_cur = rlim.rlim_max;
+		if (setrlimit(RLIMIT_NOFILE, &rlim) == 0)
+			logger->Info("SOCK RPC: descriptors limit raised to [%lu]",
+					(unsigned long)rlim.rlim_cur);
+	}
+
+	// If the socket already exists: destroy it and rebuild a new one
+	if (fs::exists(sock_path, ec)) {
+		logger->Debug("SOCK RPC: destroying old socket [%s]...",
+			sock_path.string().c_str());
+		::unlink(sock_path.string().c_str());
+	}
+
+	// Make dir (if not already present)
+	fs::create_directories(sock_path.parent_path(), ec);
+
+	// Create the server side socket
+	logger->Debug("SOCK RPC: create socket [%s]...",
+			sock_path.string().c_str());
+	listen_fd = ::socket(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC|SOCK_NONBLOCK,
+			0);
+	if (listen_fd < 0) {
+		logger->Error("SOCK RPC: socket creation FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		return -2;
+	}
+
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::strncpy(addr.sun_path, sock_path.string().c_str(),
+			sizeof(addr.sun_path) - 1);
+	if (::bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+			::listen(listen_fd, SOMAXCONN)) {
+		logger->Error("SOCK RPC: RPC socket [%s] setup FAILED "
+				"(Error %d: %s)", sock_path.string().c_str(),
+				errno, strerror(errno));
+		goto err_listen;
+	}
+
+	// Ensuring the socket is R/W to everyone
+	if (::chmod(sock_path.string().c_str(),
+				S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH)) {
+		logger->Error("FAILED setting permissions on RPC socket [%s] "
+				"(Error %d: %s)",
+				sock_path.string().c_str(),
+				errno, strerror(errno));
+		goto err_listen;
+	}
+
+	// Setup the events loop
+	epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0) {
+		logger->Error("SOCK RPC: epoll creation FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		goto err_listen;
+	}
+	ev.events = EPOLLIN;
+	ev.data.fd = listen_fd;
+	if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev)) {
+		logger->Error("SOCK RPC: epoll setup FAILED "
+				"(Error %d: %s)", errno, strerror(errno));
+		goto err_epoll;
+	}
+
+	// Pre-allocate the message buffers
+	for (int i = 0; i < BBQUE_RPC_SOCK_BUFFERS; ++i)
+		buffers.push_back(new sock_buffer_t);
+
+	// Marking channel as already initialized
+	initialized = true;
+
+	logger->Info("SOCK RPC: channel initialization DONE");
+	return 0;
+
+err_epoll:
+	::close(epoll_fd);
+	epoll_fd = -1;
+err_listen:
+	::close(listen_fd);
+	listen_fd = -1;
+	::unlink(sock_path.string().c_str());
+	return -3;
+}
+
+SockRPC::sock_buffer_t *SockRPC::GetBuffer() {
+	std::unique_lock<std::mutex> buffers_ul(buffers_mtx);
+	sock_buffer_t *buff;
+
+	// The pool grows only if more messages are pending than ever before
+	if (buffers.empty()) {
+		buffers_ul.unlock();
+		logger->Debug("SOCK RPC: growing buffers pool...");
+		return new sock_buffer_t;
+	}
+
+	buff = buffers.back();
+	buffers.pop_back();
+	return buff;
+}
+
+void SockRPC::PutBuffer(sock_buffer_t *buff) {
+	std::unique_lock<std::mutex> buffers_ul(buffers_mtx);
+
+	buff->conn.reset();
+	buffers.push_back(buff);
+}
+
+void SockRPC::AcceptConnections() {
+	struct epoll_event ev;
+	psock_conn_t pconn;
+	struct ucred cred;
+	socklen_t len;
+	struct timeval tv;
+	int fd;
+
+	while (true) {
+		fd = ::accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+				logger->Error("SOCK RPC: accept FAILED "
+						"(Error %d: %s)",
+						errno, strerror(errno));
+			return;
+		}
+
+		// Get the credentials of the connected process
+		len = sizeof(cred);
+		if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len)) {
+			logger->Error("SOCK RPC: [%d] peer credentials FAILED "
+					"(Error %d: %s)",
+					fd, errno, strerror(errno));
+			::close(fd);
+			continue;
+		}
+
+		// Do not get stuck on applications not reading their messages
+		tv.tv_sec = BBQUE_RPC_TIMEOUT / 1000;
+		tv.tv_usec = (BBQUE_RPC_TIMEOUT % 1000) * 1000;
+		::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+		pconn = psock_conn_t(new sock_conn_t);
+		pconn->fd = fd;
+		pconn->peer_pid = cred.pid;
+		pconn->peer_uid = cred.uid;
+		pconn->app_pid = 0;
+		pconn->paired = false;
+		pconn->exited = false;
+
+		ev.events = EPOLLIN|EPOLLRDHUP;
+		ev.data.fd = fd;
+		if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev)) {
+			logger->Error("SOCK RPC: [%d] epoll add FAILED "
+					"(Error %d: %s)",
+					fd, errno, strerror(errno));
+			::close(fd);
+			continue;
+		}
+		conns[fd] = pconn;
+
+		logger->Debug("SOCK RPC: [%5d] connected [pid: %d, uid: %d]",
+				fd, cred.pid, cred.uid);
+	}
+}
+
+SockRPC::sock_buffer_t *SockRPC::CloseConnection(psock_conn_t pconn,
+		ssize_t & bytes) {
+	std::unique_lock<std::mutex> send_ul(pconn->send_mtx);
+	br::rpc_msg_APP_EXIT_t *msg;
+	sock_buffer_t *buff;
+	int fd = pconn->fd;
+
+	logger->Debug("SOCK RPC: [%5d] closing [pid: %d]...",
+			fd, pconn->peer_pid);
+
+	::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	::close(fd);
+	pconn->fd = -1;
+	send_ul.unlock();
+	conns.erase(fd);
+
+	// Applications exited properly are already released
+	if (!pconn->paired || pconn->exited)
+		return NULL;
+
+	// Notify the application exit on its behalf
+	logger->Warn("SOCK RPC: [%5d] application [pid: %d] hangup, "
+			"releasing...", fd, pconn->app_pid);
+	pconn->exited = true;
+	buff = GetBuffer();
+	buff->conn = pconn;
+	msg = (br::rpc_msg_APP_EXIT_t *)buff->data;
+	msg->hdr.typ = br::RPC_APP_EXIT;
+	msg->hdr.token = 0;
+	msg->hdr.app_pid = pconn->app_pid;
+	msg->hdr.exc_id = 0;
+	bytes = RPC_PKT_SIZE(APP_EXIT);
+
+	return buff;
+}
+
+SockRPC::sock_buffer_t *SockRPC::ReadConnection(psock_conn_t pconn,
+		uint32_t events, ssize_t & bytes) {
+	rpc_msg_ptr_t msg;
+	sock_buffer_t *buff;
+	char task_path[] = "/proc/2147483647/task/2147483647";
+
+	// Pending messages are read before handling an hangup
+	if (!(events & EPOLLIN))
+		return CloseConnection(pconn, bytes);
+
+	buff = GetBuffer();
+	bytes = ::recv(pconn->fd, buff->data, BBQUE_RPC_SOCK_MSG_MAX,
+			MSG_DONTWAIT);
+	if (bytes <= 0) {
+		PutBuffer(buff);
+		if ((bytes < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+			return NULL;
+		return CloseConnection(pconn, bytes);
+	}
+
+	msg = (rpc_msg_ptr_t)buff->data;
+	if (bytes < (ssize_t)sizeof(rpc_msg_header_t))
+		goto drop_message;
+
+	// Validate the application PID: the channel thread must belong to the
+	// connected process
+	if (msg->typ == br::RPC_APP_PAIR) {
+		::snprintf(task_path, sizeof(task_path), "/proc/%d/task/%d",
+				pconn->peer_pid, msg->app_pid);
+		if (pconn->paired || ::access(task_path, F_OK)) {
+			logger->Error("SOCK RPC: [%5d] pairing [pid: %d] FAILED "
+					"(Error: not a thread of process [%d])",
+					pconn->fd, msg->app_pid,
+					pconn->peer_pid);
+			goto drop_message;
+		}
+		pconn->app_pid = msg->app_pid;
+		pconn->paired = true;
+	} else if (!pconn->paired || pconn->exited ||
+			(msg->app_pid != pconn->app_pid)) {
+		logger->Error("SOCK RPC: [%5d] message from [pid: %d] "
+				"NOT VALID", pconn->fd, msg->app_pid);
+		goto drop_message;
+	}
+
+	if (msg->typ == br::RPC_APP_EXIT)
+		pconn->exited = true;
+
+	buff->conn = pconn;
+	return buff;
+
+drop_message:
+	PutBuffer(buff);
+	return NULL;
+}
+
+ssize_t SockRPC::RecvMessage(rpc_msg_ptr_t & msg) {
+	std::map<int, psock_conn_t>::iterator it;
+	sock_buffer_t *buff = NULL;
+	ssize_t bytes = 0;
+
+	logger->Debug("SOCK RPC: waiting message...");
+
+	while (!buff) {
+
+		// Wait for the next events, once the previous ones are consumed
+		if (events_next >= events_count) {
+			events_next = events_count = 0;
+			events_count = ::epoll_wait(epoll_fd, events,
+					BBQUE_RPC_SOCK_EVENTS, -1);
+			if (events_count < 0) {
+				events_count = 0;
+				if (errno == EINTR) {
+					logger->Debug("SOCK RPC: exiting socket wait...");
+					msg = NULL;
+					return EINTR;
+				}
+				logger->Error("SOCK RPC: epoll wait FAILED "
+						"(Error %d: %s)",
+						errno, strerror(errno));
+				return -errno;
+			}
+			continue;
+		}
+
+		struct epoll_event & ev(events[events_next++]);
+		if (ev.data.fd == listen_fd) {
+			AcceptConnections();
+			continue;
+		}
+
+		// The connection could have been closed by a previous event
+		it = conns.find(ev.data.fd);
+		if (it == conns.end())
+			continue;
+
+		// NOTE: a single message is read for each event, thus pending
+		// messages are reported by the next wait, after the ones of
+		// the other applications
+		buff = ReadConnection((*it).second, ev.events, bytes);
+	}
+
+	msg = (rpc_msg_ptr_t)buff->data;
+	logger->Debug("SOCK RPC: Rx [fd: %d, sze: %d] "
+			"RPC_HDR [typ: %d, pid: %d, eid: %hd]",
+			buff->conn->fd, bytes,
+			msg->typ, msg->app_pid, msg->exc_id);
+
+	return bytes;
+}
+
+RPCChannelIF::plugin_data_t SockRPC::GetPluginData(
+		rpc_msg_ptr_t & msg) {
+	sock_buffer_t *buff;
+
+	// We should have the socket already on place
+	assert(initialized);
+
+	// We should also have a valid RPC message
+	assert(msg->typ == br::RPC_APP_PAIR);
+
+	// The connection has been already validated while receiving
+	buff = container_of(msg, sock_buffer_t, data);
+	assert(buff->conn);
+
+	logger->Info("SOCK RPC: [%5d] channel initialization DONE "
+			"[pid: %d]", buff->conn->fd, buff->conn->app_pid);
+
+	return plugin_data_t(buff->conn);
+}
+
+void SockRPC::ReleasePluginData(plugin_data_t & pd) {
+	psock_conn_t pconn(std::static_pointer_cast<sock_conn_t>(pd));
+	std::unique_lock<std::mutex> send_ul(pconn->send_mtx);
+
+	assert(initialized==true);
+
+	// The connection is closed by the receiving thread, once notified
+	// of the hangup
+	if (pconn->fd >= 0)
+		::shutdown(pconn->fd, SHUT_RDWR);
+
+	logger->Info("SOCK RPC: [%5d] channel release DONE [pid: %d]",
+			pconn->fd, pconn->app_pid);
+
+}
+
+ssize_t SockRPC::SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+		size_t count) {
+	psock_conn_t pconn(std::static_pointer_cast<sock_conn_t>(pd));
+	std::unique_lock<std::mutex> send_ul(pconn->send_mtx);
+	ssize_t bytes;
+
+	assert(pconn);
+
+	if (pconn->fd < 0) {
+		logger->Error("SOCK RPC: send message FAILED "
+				"(Error: application [%d] disconnected)",
+				pconn->app_pid);
+		return -EPIPE;
+	}
+
+	logger->Debug("SOCK RPC: TX [typ: %d, sze: %d] "
+			"using app channel [%d]...",
+			msg->typ, count, pconn->fd);
+
+	// Each message is sent with a single system call
+	bytes = ::send(pconn->fd, msg, count, MSG_NOSIGNAL);
+	if (bytes < 0) {
+		logger->Error("SOCK RPC: send message FAILED (Error %d: %s)",
+				errno, strerror(errno));
+		return -errno;
+	}
+
+	return bytes;
+}
+
+void SockRPC::FreeMessage(rpc_msg_ptr_t & msg) {
+
+	// Give back the message buffer to the pool
+	PutBuffer(container_of(msg, sock_buffer_t, data));
+	msg = NULL;
+}
+
+//----- static plugin interface
+
+void * SockRPC::Create(PF_ObjectParams *params) {
+	static std::string conf_sock_dir;
+
+	// Declare the supported options
+	po::options_description sock_rpc_opts_desc("SOCK RPC Options");
+	sock_rpc_opts_desc.add_options()
+		(MODULE_NAMESPACE".dir", po::value<std::string>
+		 (&conf_sock_dir)->default_value(BBQUE_PATH_VAR),
+		 "path of the socket dir")
+		;
+	static po::variables_map sock_rpc_opts_value;
+
+	// Get configuration params
+	PF_Service_ConfDataIn data_in;
+	data_in.opts_desc = &sock_rpc_opts_desc;
+	PF_Service_ConfDataOut data_out;
+	data_out.opts_value = &sock_rpc_opts_value;
+	PF_ServiceData sd;
+	sd.id = MODULE_NAMESPACE;
+	sd.request = &data_in;
+	sd.response = &data_out;
+
+	int32_t response = params->
+		platform_services->InvokeService(PF_SERVICE_CONF_DATA, sd);
+	if (response!=PF_SERVICE_DONE)
+		return NULL;
+
+	if (daemonized)
+		syslog(LOG_INFO, "Using RPC socket dir [%s]",
+				conf_sock_dir.c_str());
+	else
+		fprintf(stderr, FI("SOCK RPC: using dir [%s]\n"),
+				conf_sock_dir.c_str());
+
+	return new SockRPC(conf_sock_dir);
+
+}
+
+int32_t SockRPC::Destroy(void *plugin) {
+  if (!plugin)
+    return -1;
+  delete (SockRPC *)plugin;
+  return 0;
+}
+
+} // namesapce plugins
+
+} // namespace bque
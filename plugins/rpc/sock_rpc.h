@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BBQUE_PLUGINS_SOCK_RPC_H_
+#define BBQUE_PLUGINS_SOCK_RPC_H_
+
+#include "bbque/rtlib/rpc_sock_server.h"
+
+#include "bbque/plugins/rpc_channel.h"
+#include "bbque/plugins/plugin.h"
+#include "bbque/plugins/logger.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#define MODULE_NAMESPACE RPC_CHANNEL_NAMESPACE ".sck"
+
+/** The maximum number of events collected by each epoll wait */
+#define BBQUE_RPC_SOCK_EVENTS 64
+
+// These are the parameters received by the PluginManager on create calls
+struct PF_ObjectParams;
+
+namespace bbque { namespace plugins {
+
+/**
+ * @brief A UNIX socket based implementation of the RPCChannelIF interface.
+ *
+ * This class provide a SOCK_SEQPACKET UNIX socket based communication
+ * channel between the Barbque RTRM and the applications. Each application
+ * connects to the public socket, thus getting its own connection, which is
+ * used in both directions. All the connections are served by an epoll loop,
+ * which allows to scale to thousands of applications.
+ *
+ * The application PID is validated against the connection credentials
+ * (SO_PEERCRED), while a connection hangup of an application not properly
+ * exited is notified as an RPC_APP_EXIT message, to release its resources.
+ * Messages are received into buffers recycled by a pool, thus no memory is
+ * allocated per message.
+ */
+class SockRPC : public RPCChannelIF {
+
+/**
+ * @brief An application connection
+ *
+ * This is also the plugin data returned for each application.
+ */
+typedef struct sock_conn {
+	/** The connection socket, -1 once closed */
+	int fd;
+	/** The PID of the process connected (from SO_PEERCRED) */
+	pid_t peer_pid;
+	/** The UID of the process connected (from SO_PEERCRED) */
+	uid_t peer_uid;
+	/** The application PID (i.e. its channel thread ID) */
+	pid_t app_pid;
+	/** Set once the application has paired */
+	bool paired;
+	/** Set once the application has exited */
+	bool exited;
+	/** Serialize messages sent by different threads */
+	std::mutex send_mtx;
+} sock_conn_t;
+
+typedef std::shared_ptr<sock_conn_t> psock_conn_t;
+
+/**
+ * @brief A received message buffer
+ */
+typedef struct sock_buffer {
+	/** The connection the message has been received from */
+	psock_conn_t conn;
+	/** The message */
+	uint64_t data[(BBQUE_RPC_SOCK_MSG_MAX + 7) / 8];
+} sock_buffer_t;
+
+
+public:
+
+//----- static plugin interface
+
+	/**
+	 *
+	 */
+	static void * Create(PF_ObjectParams *);
+
+	/**
+	 *
+	 */
+	static int32_t Destroy(void *);
+
+	virtual ~SockRPC();
+
+//----- RPCChannelIF module interface
+
+
+	virtual ssize_t RecvMessage(rpc_msg_ptr_t & msg);
+
+	virtual plugin_data_t GetPluginData(rpc_msg_ptr_t & msg);
+
+	virtual void ReleasePluginData(plugin_data_t & pd);
+
+	virtual ssize_t SendMessage(plugin_data_t & pd, rpc_msg_ptr_t msg,
+								size_t count);
+
+	virtual void FreeMessage(rpc_msg_ptr_t & msg);
+
+private:
+
+	/**
+	 * @brief System logger instance
+	 */
+	plugins::LoggerIF *logger;
+
+	/**
+	 * @brief Thrue if the channel has been correctly initalized
+	 */
+	bool initialized;
+
+	/**
+	 * @brief The path of the directory for the socket creation
+	 */
+	std::string conf_sock_dir;
+
+	/**
+	 * @brief The public (listening) socket descriptor
+	 */
+	int listen_fd;
+
+	/**
+	 * @brief The epoll descriptor
+	 */
+	int epoll_fd;
+
+	/**
+	 * @brief The events collected by the last epoll wait
+	 */
+	struct epoll_event events[BBQUE_RPC_SOCK_EVENTS];
+
+	/**
+	 * @brief The number of collected events
+	 */
+	int events_count;
+
+	/**
+	 * @brief The next collected event to process
+	 */
+	int events_next;
+
+	/**
+	 * @brief The open connections, indexed by socket descriptor
+	 *
+	 * This is accessed only by the receiving thread.
+	 */
+	std::map<int, psock_conn_t> conns;
+
+	/**
+	 * @brief The buffers available to receive messages
+	 */
+	std::vector<sock_buffer_t *> buffers;
+
+	/**
+	 * @brief Protect the buffers pool
+	 */
+	std::mutex buffers_mtx;
+
+	/**
+	 * @brief   The plugins constructor
+	 * Plugins objects could be build only by using the "create" method.
+	 * Usually the PluginManager acts as object
+	 * @param   
+	 * @return  
+	 */
+	SockRPC(std::string const & sock_dir);
+
+	int Init();
+
+	/**
+	 * @brief Accept all the pending connections
+	 */
+	void AcceptConnections();
+
+	/**
+	 * @brief Close a connection
+	 *
+	 * @return an RPC_APP_EXIT message, if the application has not exited
+	 * properly, NULL otherwise
+	 */
+	sock_buffer_t *CloseConnection(psock_conn_t pconn, ssize_t & bytes);
+
+	/**
+	 * @brief Receive a message from a connection
+	 *
+	 * @return the buffer of the received message, NULL if none
+	 */
+	sock_buffer_t *ReadConnection(psock_conn_t pconn, uint32_t events,
+			ssize_t & bytes);
+
+	/**
+	 * @brief Get a buffer from the pool
+	 */
+	sock_buffer_t *GetBuffer();
+
+	/**
+	 * @brief Give back a buffer to the pool
+	 */
+	void PutBuffer(sock_buffer_t *buff);
+
+};
+
+} // namespace plugins
+
+} // namespace bbque
+
+#endif // BBQUE_PLUGINS_SOCK_RPC_H_
@@ -61,13 +61,13 @@ SCCongestion::SCCongestion(const char * _name, uint16_t const cfg_params[]):
 	// Boundaries enforcement (0 <= penalty <= 100)
 	for (int i = 0; i < SC_RSRC_COUNT; ++i) {
 		if (penalties_int[i] > 100) {
-			logger->Warn("Parameter penalty.%s out of range [0,100]: "
+			BBQUE_LOG_WARN("Parameter penalty.%s out of range [0,100]: "
 					"found %d. Setting to %d", ResourceNames[i],
 					penalties_int[i], penalties_default[i]);
 			penalties_int[i] = penalties_default[i];
 		}
 		penalties[i] = static_cast<float>(penalties_int[i]) / 100.0;
-		logger->Debug("Resource [%s] saturation penalty \t= %.2f",
+		BBQUE_LOG_DEBUG("Resource [%s] saturation penalty \t= %.2f",
 				ResourceNames[i], penalties[i]);
 	}
 }
@@ -97,7 +97,7 @@ SCCongestion::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 	for_each_sched_resource_usage(evl_ent, usage_it) {
 		std::string const & rsrc_path(usage_it->first);
 		UsagePtr_t const & pusage(usage_it->second);
-		logger->Debug("%s: {%s}", evl_ent.StrId(), rsrc_path.c_str());
+		BBQUE_LOG_DEBUG("%s: {%s}", evl_ent.StrId(), rsrc_path.c_str());
 
 		// Get the region of the (next) resource usage
 		GetResourceThresholds(rsrc_path, pusage->GetAmount(), evl_ent, rl);
@@ -118,7 +118,7 @@ SCCongestion::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 
 		// Compute the region index
 		ru_index = CLEIndex(rl.sat_lack, rl.free, pusage->GetAmount(), params);
-		logger->Debug("%s: {%s} index = %.4f", evl_ent.StrId(),
+		BBQUE_LOG_DEBUG("%s: {%s} index = %.4f", evl_ent.StrId(),
 				rsrc_path.c_str(), ru_index);
 
 		// Update the contribute if the index is lower, i.e. the most
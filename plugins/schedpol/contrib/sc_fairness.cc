@@ -63,12 +63,12 @@ SCFairness::SCFairness(const char * _name, uint16_t const cfg_params[]):
 	// Boundaries enforcement (0 <= penalty <= 100)
 	for (int i = 0; i < SC_RSRC_COUNT; ++i) {
 		if (penalties_int[i] > 100) {
-			logger->Warn("Parameter penalty.%s out of range [0,100]: "
+			BBQUE_LOG_WARN("Parameter penalty.%s out of range [0,100]: "
 					"found %d. Setting to %d", ResourceNames[i],
 					penalties_int[i], penalties_default[i]);
 			penalties_int[i] = penalties_default[i];
 		}
-		logger->Debug("Resource [%s] saturation penalty \t= %.2f",
+		BBQUE_LOG_DEBUG("Resource [%s] saturation penalty \t= %.2f",
 				ResourceNames[i], static_cast<float>(penalties_int[i]) / 100.0);
 	}
 }
@@ -79,13 +79,13 @@ SchedContrib::ExitCode_t SCFairness::Init(void * params) {
 
 	// Applications/EXC to schedule, given the priority level
 	num_apps = sv->ApplicationsCount(*prio);
-	logger->Debug("%d Applications/EXC for priority level %d", num_apps, *prio);
+	BBQUE_LOG_DEBUG("%d Applications/EXC for priority level %d", num_apps, *prio);
 
 	// Get the total amount of resource per types
 	for (int i = 0; i < SC_RSRC_COUNT; ++i) {
 		rsrc_avail[i] = sv->ResourceAvailable(ResourceGenPaths[i], vtok);
 		fair_parts[i] = rsrc_avail[i] / num_apps;
-		logger->Debug("R{%s} AVL:%lu Fair partition:%lu",
+		BBQUE_LOG_DEBUG("R{%s} AVL:%lu Fair partition:%lu",
 				ResourceGenPaths[i], rsrc_avail[i], fair_parts[i]);
 	}
 
@@ -116,7 +116,7 @@ SCFairness::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 
 		// Resource availability (in the bound cluster)
 		clust_rsrc_avl = sv->ResourceAvailable(rsrc_bind, vtok);
-		logger->Debug("%s: R{%s} resource availability: %lu", evl_ent.StrId(),
+		BBQUE_LOG_DEBUG("%s: R{%s} resource availability: %lu", evl_ent.StrId(),
 				rsrc_path.c_str(), clust_rsrc_avl);
 
 		// If there are no free resources the index contribute is equal to 0
@@ -138,13 +138,13 @@ SCFairness::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 			penalty = static_cast<float>(penalties_int[SC_RSRC_MEM]) / 100.0;
 		}
 
-		logger->Debug("%s: R{%s} cluster fraction: %lu", evl_ent.StrId(),
+		BBQUE_LOG_DEBUG("%s: R{%s} cluster fraction: %lu", evl_ent.StrId(),
 				rsrc_path.c_str(), clust_fract);
 
 		// Compute the cluster fair partition
 		clust_fair_part = std::min<uint64_t>(clust_rsrc_avl,
 				clust_rsrc_avl / clust_fract);
-		logger->Debug("%s: R{%s} cluster fair partition: %lu",
+		BBQUE_LOG_DEBUG("%s: R{%s} cluster fair partition: %lu",
 				evl_ent.StrId(), rsrc_path.c_str(), clust_fair_part);
 
 		// Set function parameters
@@ -153,7 +153,7 @@ SCFairness::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 		// Compute the region index
 		//ru_index = CLEIndex(clust_fair_part, clust_fair_part,
 		ru_index = CLEIndex(0, clust_fair_part, pusage->GetAmount(), params);
-		logger->Debug("%s: R{%s} index = %.4f", evl_ent.StrId(),
+		BBQUE_LOG_DEBUG("%s: R{%s} index = %.4f", evl_ent.StrId(),
 				rsrc_path.c_str(), ru_index);
 
 		// Update the contribute if the index is lower, i.e. the most
@@ -23,7 +23,8 @@ namespace bbque { namespace plugins {
 
 
 SCReconfig::SCReconfig(const char * _name, uint16_t cfg_params[]):
-	SchedContrib(_name, cfg_params) {
+	SchedContrib(_name, cfg_params),
+	mem_vtok(0) {
 	char conf_str[40];
 
 	// Configuration parameters
@@ -37,9 +38,30 @@ SCReconfig::SCReconfig(const char * _name, uint16_t cfg_params[]):
 		 "Migration factor");
 		;
 
+	snprintf(conf_str, 40, SC_CONF_BASE_STR"%s.memfact", name);
+	opts_desc.add_options()
+		(conf_str,
+		 po::value<uint16_t>
+		 (&memfact)->default_value(DEFAULT_MEMORY_FACTOR),
+		 "Memory migration factor");
+		;
+
+	snprintf(conf_str, 40, SC_CONF_BASE_STR"%s.memref", name);
+	opts_desc.add_options()
+		(conf_str,
+		 po::value<uint32_t>
+		 (&memref)->default_value(DEFAULT_MEMORY_REFERENCE),
+		 "Memory migration reference footprint [MB]");
+		;
+
 	po::variables_map opts_vm;
 	cm.ParseConfigurationFile(opts_desc, opts_vm);
-	logger->Debug("Application migration cost factor \t= %d", migfact);
+	BBQUE_LOG_DEBUG("Application migration cost factor \t= %d", migfact);
+	BBQUE_LOG_DEBUG("Memory migration cost factor \t= %d", memfact);
+	BBQUE_LOG_DEBUG("Memory migration reference [MB] \t= %d", memref);
+
+	if (memref == 0)
+		memref = DEFAULT_MEMORY_REFERENCE;
 }
 
 SchedContrib::ExitCode_t SCReconfig::Init(void * params) {
@@ -48,11 +70,40 @@ SchedContrib::ExitCode_t SCReconfig::Init(void * params) {
 	return SC_SUCCESS;
 }
 
+float SCReconfig::MemoryMigrationCost(AppCPtr_t const & papp) {
+	std::unique_lock<std::mutex> mem_ul(mem_mtx);
+	std::map<AppUid_t, float>::iterator cost_it;
+	uint64_t rss;
+	float cost;
+
+	// Drop the costs computed in a previous scheduling run
+	if (mem_vtok != vtok) {
+		mem_costs.clear();
+		mem_vtok = vtok;
+	}
+
+	cost_it = mem_costs.find(papp->Uid());
+	if (cost_it != mem_costs.end())
+		return cost_it->second;
+
+	// The resident memory to move on the memory nodes of the new cluster
+	rss = sv->ApplicationMemoryFootprint(papp);
+	cost = (float) rss / ((float) memref * 1024 * 1024);
+	if (cost > 1.0)
+		cost = 1.0;
+
+	BBQUE_LOG_DEBUG("%s: memory footprint %" PRIu64 " => MEM migration cost %.4f",
+			papp->StrId(), rss, cost);
+	mem_costs[papp->Uid()] = cost;
+	return cost;
+}
+
 SchedContrib::ExitCode_t
 SCReconfig::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 		float & ctrib) {
 	UsagesMap_t::const_iterator usage_it;
 	float reconf_cost = 0.0;
+	float mem_cost    = 0.0;
 	uint8_t to_mig    = 0;
 	uint64_t rsrc_avl = 0.0;
 	uint64_t rsrc_tot;
@@ -62,8 +113,12 @@ SCReconfig::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 			!evl_ent.papp->CurrentAWM()->ClusterSet().test(evl_ent.clust_id)) {
 		to_mig = 1;
 		uint32_t clset = evl_ent.papp->CurrentAWM()->ClusterSet().to_ulong();
-		logger->Debug("%s: current CLs:{%d} => MIG:%d", evl_ent.StrId(),
+		BBQUE_LOG_DEBUG("%s: current CLs:{%d} => MIG:%d", evl_ent.StrId(),
 				uint32_t(log(clset)/log(2)), to_mig);
+
+		// Memory pages would be moved to the new cluster as well
+		if (memfact)
+			mem_cost = MemoryMigrationCost(evl_ent.papp);
 	}
 
 	// Reconfiguration index = 1 if scheduled in the same AWM, without
@@ -83,7 +138,7 @@ SCReconfig::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 		// Query resource availability
 		rsrc_avl = sv->ResourceAvailable(rsrc_bind, vtok, evl_ent.papp);
 		if (rsrc_avl < pusage->GetAmount()) {
-			logger->Debug("%s: {%s} RQ:%" PRIu64 "| AVL:%" PRIu64,
+			BBQUE_LOG_DEBUG("%s: {%s} RQ:%" PRIu64 "| AVL:%" PRIu64,
 					evl_ent.StrId(), rsrc_path.c_str(),
 					pusage->GetAmount(), rsrc_avl);
 			// Resource allocation is completely discouraged
@@ -97,7 +152,7 @@ SCReconfig::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 
 		// Total amount of resource
 		rsrc_tot = sv->ResourceTotal(pusage->GetBindingList());
-		logger->Debug("%s: {%s} RQ:%" PRIu64 "| AVL:%" PRIu64 "| TOT:%" PRIu64,
+		BBQUE_LOG_DEBUG("%s: {%s} RQ:%" PRIu64 "| AVL:%" PRIu64 "| TOT:%" PRIu64,
 				evl_ent.StrId(), rsrc_path.c_str(),
 				pusage->GetAmount(), rsrc_avl, rsrc_tot);
 
@@ -106,7 +161,17 @@ SCReconfig::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 	}
 
 	// Contribute value
-	ctrib = 1.0 - (1.0 + (float) to_mig * migfact) / (1.0 + (float) migfact) *
+	// NOTE: the migration penalty accounts also for the cost of moving the
+	// application memory, which is proportional to its footprint
+	if (mem_cost == 0.0) {
+		ctrib = 1.0 - (1.0 + (float) to_mig * migfact) /
+			(1.0 + (float) migfact) *
+			((float) reconf_cost / sv->ResourceCountTypes());
+		return SC_SUCCESS;
+	}
+
+	ctrib = 1.0 - (1.0 + (float) to_mig * (migfact + memfact * mem_cost)) /
+		(1.0 + (float) migfact + (float) memfact) *
 		((float) reconf_cost / sv->ResourceCountTypes());
 
 	return SC_SUCCESS;
@@ -18,12 +18,21 @@
 #ifndef BBQUE_SC_RECONFIG_
 #define BBQUE_SC_RECONFIG_
 
+#include <map>
+
+#include "bbque/cpp11/mutex.h"
 #include "sched_contrib.h"
 
 
 // Proportional cost factor between MIGRATION and RECONFIGURATION
 #define DEFAULT_MIGRATION_FACTOR 	4
 
+// Proportional cost factor between MEMORY MIGRATION and RECONFIGURATION
+#define DEFAULT_MEMORY_FACTOR 		0
+
+// Memory footprint [MB] considered as the maximum memory migration cost
+#define DEFAULT_MEMORY_REFERENCE 	1024
+
 
 namespace bbque { namespace plugins {
 
@@ -47,6 +56,41 @@ private:
 	 */
 	uint16_t migfact;
 
+	/**
+	 * Proportional factor meaning how many times the migration of the
+	 * application memory is more penalizing than a reconfiguration
+	 */
+	uint16_t memfact;
+
+	/**
+	 * The memory footprint [MB] corresponding to the maximum memory
+	 * migration cost
+	 */
+	uint32_t memref;
+
+	/**
+	 * Memory migration costs of the applications, computed once per
+	 * scheduling run (i.e., per resource state view)
+	 */
+	std::map<AppUid_t, float> mem_costs;
+
+	/** The resource state view the cached memory costs refer to */
+	RViewToken_t mem_vtok;
+
+	/** Protect the cached memory costs from concurrent evaluations */
+	std::mutex mem_mtx;
+
+	/**
+	 * @brief Estimate the memory migration cost of an application
+	 *
+	 * The footprint is sampled once per scheduling run, no matter how
+	 * many AWMs of the application are evaluated.
+	 *
+	 * @return A value in [0,1], proportional to the memory footprint of
+	 * the application
+	 */
+	float MemoryMigrationCost(AppCPtr_t const & papp);
+
 	/**
 	 * @brief Compute the reconfiguration contribute
 	 */
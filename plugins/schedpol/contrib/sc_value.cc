@@ -45,7 +45,7 @@ SCValue::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 
 	// Initialize the index contribute to the AWM static value
 	ctrib = 0.4 * evl_ent.pawm->Value();
-	logger->Debug("%s: AWM static value: %.4f", evl_ent.StrId(), ctrib);
+	BBQUE_LOG_DEBUG("%s: AWM static value: %.4f", evl_ent.StrId(), ctrib);
 
 	// NAP set?
 	nap = 0.6 * static_cast<float>(evl_ent.papp->GetGoalGap()) / 100.0;
@@ -53,13 +53,13 @@ SCValue::_Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 			(curr_awm->Value() >= evl_ent.pawm->Value()))
 		return SC_SUCCESS;
 
-	logger->Debug("%s: Normalized Actual Penalty (NAP) = %d/100): %.4f",
+	BBQUE_LOG_DEBUG("%s: Normalized Actual Penalty (NAP) = %d/100): %.4f",
 			evl_ent.StrId(), evl_ent.papp->GetGoalGap(), nap);
 
 	// Add the NAP part to the contribute
 	ctrib += nap;
 
-	logger->Debug("%s: AWM Value index: %.4f", evl_ent.StrId(),	ctrib);
+	BBQUE_LOG_DEBUG("%s: AWM Value index: %.4f", evl_ent.StrId(),	ctrib);
 	return SC_SUCCESS;
 }
 
@@ -56,6 +56,7 @@ SchedContrib::SchedContrib(const char * _name,
 	// Identifier name of the contribute
 	strncpy(name, _name, SC_NAME_MAX_LEN);
 	name[SC_NAME_MAX_LEN-1] = '\0';
+	trc_name = BBQUE_TRACE_NAME(name);
 
 	// Array of Maximum Saturation Levels parameters
 	for (int i = 0; i < SC_RSRC_COUNT; ++i)
@@ -74,13 +75,14 @@ SchedContrib::Compute(SchedulerPolicyIF::EvalEntity_t const & evl_ent,
 
 	// A valid token for the resource state view is mandatory
 	if (vtok == 0) {
-		logger->Error("Missing a valid system/state view");
+		BBQUE_LOG_ERROR("Missing a valid system/state view");
 		return SC_ERR_VIEW;
 	}
 
 	_Compute(evl_ent, ctrib);
 
-	logger->Info("%s: %s = %.4f", evl_ent.StrId(), name, ctrib);
+	BBQUE_LOG_INFO("%s: %s = %.4f", evl_ent.StrId(), name, ctrib);
+	BBQUE_TRACE_COUNTER_ID(SC, trc_name, ctrib, evl_ent.papp->Uid());
 	assert((ctrib >= 0) && (ctrib <= 1));
 
 	return SC_SUCCESS;
@@ -110,7 +112,7 @@ void SchedContrib::GetResourceThresholds(std::string const & rsrc_path,
 		rl.sat_lack = rl.saturate - rl.total + rl.free;
 
 	assert(rl.sat_lack <= rl.free);
-	logger->Debug("%s: Regions => usg: %lu| sat: %lu| sat-lack: %lu| "
+	BBQUE_LOG_DEBUG("%s: Regions => usg: %lu| sat: %lu| sat-lack: %lu| "
 			"free: %lu| req: %lu|",
 			evl_ent.StrId(),
 			rl.usage, rl.saturate, rl.sat_lack, rl.free, rsrc_amount);
@@ -122,18 +124,18 @@ float SchedContrib::CLEIndex(uint64_t c_thresh,
 		CLEParams_t const & params) {
 	// SSR: Sub-Saturation Region
 	if (rsrc_amount <= c_thresh) {
-		logger->Debug("Region: ""Constant""");
+		BBQUE_LOG_DEBUG("Region: ""Constant""");
 		return params.k;
 	}
 
 	// ISR: In-Saturation Region
 	if (rsrc_amount <= l_thresh) {
-		logger->Debug("Region: ""Linear""");
+		BBQUE_LOG_DEBUG("Region: ""Linear""");
 		return FuncLinear(rsrc_amount, params.lin);
 	}
 
 	// OSR: Over-Saturation Region
-	logger->Debug("Region: ""Exponential""");
+	BBQUE_LOG_DEBUG("Region: ""Exponential""");
 	return FuncExponential(rsrc_amount, params.exp);
 }
 
@@ -23,6 +23,7 @@
 #include "bbque/configuration_manager.h"
 #include "bbque/plugins/scheduler_policy.h"
 #include "bbque/plugins/logger.h"
+#include "bbque/utils/trace.h"
 
 #define SC_CONF_BASE_STR 	SCHEDULER_POLICY_CONFIG".Contrib."
 #define SC_NAME_MAX_LEN 	11
@@ -252,6 +253,9 @@ protected:
 	 /** Contribute identifier name */
 	 char name[SC_NAME_MAX_LEN];
 
+	 /** The tracepoint name ID of the contribute values */
+	 uint16_t trc_name;
+
 	 /** Maximum Saturation Levels per resource */
 	 float msl_params[SC_RSRC_COUNT];
 
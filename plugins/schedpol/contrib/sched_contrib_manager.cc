@@ -70,7 +70,7 @@ SchedContribManager::SchedContribManager(
 	plugins::LoggerIF::Configuration conf(MODULE_NAMESPACE);
 	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
 	if (logger)
-		logger->Info("Built a new dynamic object[%p]", this);
+		BBQUE_LOG_INFO("Built a new dynamic object[%p]", this);
 	else
 		fprintf(stderr, FI("%s: Built new dynamic object [%p]\n"),
 				SC_MANAGER_NAMESPACE, (void *)this);
@@ -101,7 +101,7 @@ SchedContribManager::SchedContribManager(
 			sc_objs_reqs[sc_str[FAIRNESS]] = SchedContribManager::sc_objs[sc_str[FAIRNESS]];
 			break;
 		default:
-			logger->Error("Scheduling contribution unknown: %d", sc_types[i]);
+			BBQUE_LOG_ERROR("Scheduling contribution unknown: %d", sc_types[i]);
 		}
 	}
 }
@@ -196,11 +196,11 @@ void SchedContribManager::ParseConfiguration() {
 
 	// Boundaries enforcement (0 <= MSL <= 100)
 	for (int i = 0; i < SchedContrib::SC_CPT_COUNT; ++i) {
-		logger->Debug("Resource [%s] min saturation level \t= %d [%]",
+		BBQUE_LOG_DEBUG("Resource [%s] min saturation level \t= %d [%]",
 				(strpbrk(SchedContrib::ConfigParamsStr[i], "."))+1,
 				sc_cfg_params[i]);
 		if (sc_cfg_params[i] > 100) {
-			logger->Warn("Parameter %s out of range [0,100]: found %d. Setting to %d",
+			BBQUE_LOG_WARN("Parameter %s out of range [0,100]: found %d. Setting to %d",
 					SchedContrib::ConfigParamsStr[i],
 					sc_cfg_params[i],
 					SchedContrib::ConfigParamsDefault[i]);
@@ -218,7 +218,7 @@ void SchedContribManager::NormalizeWeights() {
 	// Normalize
 	for (int i = 0; i < SC_COUNT; ++i) {
 		sc_weights_norm[i] = sc_weights[i] / (float) sum;
-		logger->Debug("Contribution [%.*s] weight \t= %.3f", 5,
+		BBQUE_LOG_DEBUG("Contribution [%.*s] weight \t= %.3f", 5,
 				sc_str[i], sc_weights_norm[i]);
 	}
 }
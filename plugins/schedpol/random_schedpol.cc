@@ -47,7 +47,7 @@ RandomSchedPol::RandomSchedPol() :
 	}
 
 	assert(logger);
-	logger->Debug("Built RANDOM SchedPol object @%p", (void*)this);
+	BBQUE_LOG_DEBUG("Built RANDOM SchedPol object @%p", (void*)this);
 
 }
 
@@ -88,7 +88,7 @@ void RandomSchedPol::ScheduleApp(AppCPtr_t papp) {
 	// Select a random AWM for this EXC
 	awms = papp->WorkingModes();
 	selected_awm = dist(rng_engine) % awms->size();
-	logger->Debug("Scheduling EXC [%s] on AWM [%d of %d]",
+	BBQUE_LOG_DEBUG("Scheduling EXC [%s] on AWM [%d of %d]",
 			papp->StrId(), selected_awm, awms->size());
 	it = awms->begin();
 	end = awms->end();
@@ -97,11 +97,11 @@ void RandomSchedPol::ScheduleApp(AppCPtr_t papp) {
 
 	// Bind to a random virtual cluster
 	selected_cluster = dist(rng_engine) % cluster_count;
-	logger->Debug("Scheduling EXC [%s] on Cluster [%d of %d]",
+	BBQUE_LOG_DEBUG("Scheduling EXC [%s] on Cluster [%d of %d]",
 			papp->StrId(), selected_cluster, ra.Total(RSRC_CLUSTER));
 	bindResult = (*it)->BindResource("cluster", RSRC_ID_ANY, selected_cluster);
 	if (bindResult != ba::WorkingMode::WM_SUCCESS) {
-		logger->Error("Resource biding for EXC [%s] FAILED", papp->StrId());
+		BBQUE_LOG_ERROR("Resource biding for EXC [%s] FAILED", papp->StrId());
 		return;
 	}
 
@@ -126,12 +126,12 @@ RandomSchedPol::Schedule(bbque::System & sv, RViewToken_t &rav) {
 	// Get a new view on the ResourceAccounter
 	viewResult = ra.GetView(MODULE_NAMESPACE, ra_view);
 	if (viewResult != ResourceAccounter::RA_SUCCESS) {
-		logger->Crit("Initialization failed "
+		BBQUE_LOG_CRIT("Initialization failed "
 				"(Error: unable to get a view from RA)");
 		return SCHED_ERROR;
 	}
 
-	logger->Info("Random scheduling RUNNING applications...");
+	BBQUE_LOG_INFO("Random scheduling RUNNING applications...");
 
 	papp = sv.GetFirstRunning(app_it);
 	while (papp) {
@@ -139,7 +139,7 @@ RandomSchedPol::Schedule(bbque::System & sv, RViewToken_t &rav) {
 		papp = sv.GetNextRunning(app_it);
 	}
 
-	logger->Info("Random scheduling READY applications...");
+	BBQUE_LOG_INFO("Random scheduling READY applications...");
 
 	papp = sv.GetFirstReady(app_it);
 	while (papp) {
@@ -84,7 +84,7 @@ YamcaSchedPol::YamcaSchedPol():
 	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
 
 	if (logger)
-		logger->Info("YaMCA: Built a new dynamic object[%p]\n", this);
+		BBQUE_LOG_INFO("YaMCA: Built a new dynamic object[%p]\n", this);
 	else
 		std::cout << "YaMCA: Build new dynamic object ["
 			<< this << "]" << std::endl;
@@ -112,11 +112,11 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::Schedule(
 		bbque::System & sv, RViewToken_t & rav) {
 	ExitCode_t result;
 
-	logger->Debug(
+	BBQUE_LOG_DEBUG(
 			"<<<<<<<<<<<<<<<<< Scheduling policy starting >>>>>>>>>>>>>>>>>>");
 	// Get a resources view from Resource Accounter
 	if (InitResourceView() == SCHED_ERROR) {
-		logger->Fatal("Schedule: Aborted due to resource state view missing");
+		BBQUE_LOG_FATAL("Schedule: Aborted due to resource state view missing");
 		return SCHED_ERROR;
 	}
 
@@ -125,8 +125,8 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::Schedule(
 	clusters_full.resize(num_clusters);
 	clusters_full = { false };
 
-	logger->Info("Schedule: Found %d clusters on the platform.", num_clusters);
-	logger->Info("lowest prio = %d", sv.ApplicationLowestPriority());
+	BBQUE_LOG_INFO("Schedule: Found %d clusters on the platform.", num_clusters);
+	BBQUE_LOG_INFO("lowest prio = %d", sv.ApplicationLowestPriority());
 
 	// Iterate from the highest to the lowest priority applications queue
 	for (AppPrio_t prio = 0; prio <= sv.ApplicationLowestPriority();
@@ -143,7 +143,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::Schedule(
 		}
 	}
 
-	logger->Debug(
+	BBQUE_LOG_DEBUG(
 			">>>>>>>>>>>>>>>>> Scheduling policy exiting <<<<<<<<<<<<<<<<<<<");
 
 	rsrc_acct.PrintStatusReport(rsrc_view_token);
@@ -168,12 +168,12 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::InitResourceView() {
 	ResourceAccounter::ExitCode_t view_result;
 	view_result = rsrc_acct.GetView(token_path, rsrc_view_token);
 	if (view_result != ResourceAccounter::RA_SUCCESS) {
-		logger->Fatal("Init: Cannot get a resource state view");
+		BBQUE_LOG_FATAL("Init: Cannot get a resource state view");
 		return SCHED_ERROR;
 	}
 
-	logger->Debug("Init: Requiring view token for %s", token_path);
-	logger->Debug("Init: Resources state view token = %d", rsrc_view_token);
+	BBQUE_LOG_DEBUG("Init: Requiring view token for %s", token_path);
+	BBQUE_LOG_DEBUG("Init: Resources state view token = %d", rsrc_view_token);
 	return SCHED_OK;
 }
 
@@ -181,17 +181,19 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::InitResourceView() {
 SchedulerPolicyIF::ExitCode_t YamcaSchedPol::SchedulePrioQueue(
 		bbque::System & sv,
 		AppPrio_t prio) {
+	SchedEntityMap_t::allocator_type sched_alloc(
+			&SchedulerManager::SchedArena());
 	ExitCode_t result;
 
 
 	//Order scheduling entities
 	for (uint16_t cl_id = 0; cl_id < num_clusters; ++cl_id) {
-		SchedEntityMap_t sched_map;
-		logger->Debug("Schedule: ======================= Cluster%d :", cl_id);
+		SchedEntityMap_t sched_map(std::less<float>(), sched_alloc);
+		BBQUE_LOG_DEBUG("Schedule: ======================= Cluster%d :", cl_id);
 
 		// Skip current cluster if full
 		if (clusters_full[cl_id]) {
-			logger->Warn("Schedule: cluster %d is full, skipping...", cl_id);
+			BBQUE_LOG_WARN("Schedule: cluster %d is full, skipping...", cl_id);
 			continue;
 		}
 
@@ -261,7 +263,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::OrderSchedEntity(
 
 void YamcaSchedPol::SelectWorkingModes(SchedEntityMap_t & sched_map) {
 	Application::ExitCode_t app_result;
-	logger->Debug(
+	BBQUE_LOG_DEBUG(
 			"____________________| Scheduling entities |____________________");
 
 	// The scheduling entities should be picked in a descending order of
@@ -279,7 +281,7 @@ void YamcaSchedPol::SelectWorkingModes(SchedEntityMap_t & sched_map) {
 		if (CheckSkipConditions(papp))
 			continue;
 
-		logger->Debug("Selecting: [%s] schedule request for AWM{%d}...",
+		BBQUE_LOG_DEBUG("Selecting: [%s] schedule request for AWM{%d}...",
 				papp->StrId(),
 				eval_awm->Id());
 
@@ -289,7 +291,7 @@ void YamcaSchedPol::SelectWorkingModes(SchedEntityMap_t & sched_map) {
 
 		// Debugging messages
 		if (app_result != Application::APP_WM_ACCEPTED) {
-			logger->Debug("Selecting: [%s] AWM{%d} rejected ! [ret %d]",
+			BBQUE_LOG_DEBUG("Selecting: [%s] AWM{%d} rejected ! [ret %d]",
 							papp->StrId(),
 							eval_awm->Id(),
 							app_result);
@@ -297,14 +299,14 @@ void YamcaSchedPol::SelectWorkingModes(SchedEntityMap_t & sched_map) {
 		}
 
 		if (!papp->Synching() || papp->Blocking()) {
-			logger->Debug("Selecting: [%s] in %s/%s", papp->StrId(),
+			BBQUE_LOG_DEBUG("Selecting: [%s] in %s/%s", papp->StrId(),
 					Application::StateStr(papp->State()),
 					Application::SyncStateStr(papp->SyncState()));
 			continue;
 		}
 
 		AwmPtr_t const & new_awm = papp->NextAWM();
-		logger->Info("Selecting: [%s] set to AWM{%d} on clusters map [%s]",
+		BBQUE_LOG_INFO("Selecting: [%s] set to AWM{%d} on clusters map [%s]",
 					papp->StrId(),
 					new_awm->Id(),
 					new_awm->ClusterSet().to_string().c_str());
@@ -317,7 +319,7 @@ inline bool YamcaSchedPol::CheckSkipConditions(AppCPtr_t const & papp) {
 	// Skip if the application has been rescheduled yet (with success) or
 	// disabled in the meanwhile
 	if (!papp->Active() && !papp->Blocking()) {
-		logger->Debug("Skipping [%s]. State = {%s/%s}",
+		BBQUE_LOG_DEBUG("Skipping [%s]. State = {%s/%s}",
 					papp->StrId(),
 					Application::StateStr(papp->State()),
 					Application::SyncStateStr(papp->SyncState()));
@@ -327,7 +329,7 @@ inline bool YamcaSchedPol::CheckSkipConditions(AppCPtr_t const & papp) {
 	// Avoid double AWM selection for RUNNING applications with an already
 	// assigned AWM.
 	if ((papp->State() == Application::RUNNING) && papp->NextAWM()) {
-		logger->Debug("Skipping [%s]. No reconfiguration needed. (AWM=%d)",
+		BBQUE_LOG_DEBUG("Skipping [%s]. No reconfiguration needed. (AWM=%d)",
 				papp->StrId(), papp->CurrentAWM()->Id());
 		return true;
 	}
@@ -362,7 +364,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::InsertWorkingModes(
 	for_each(awm_thds.begin(), awm_thds.end(), join_thread);
 	awm_thds.clear();
 
-	logger->Debug("Schedule table size = %d", sched_map.size());
+	BBQUE_LOG_DEBUG("Schedule table size = %d", sched_map.size());
 	return SCHED_OK;
 }
 
@@ -374,12 +376,12 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::EvalWorkingMode(
 				int cl_id) {
 	std::unique_lock<std::mutex> sched_ul(sched_mtx, std::defer_lock);
 
-	logger->Debug("Insert: [%s] AWM{%d} metrics computing...", papp->StrId(),
+	BBQUE_LOG_DEBUG("Insert: [%s] AWM{%d} metrics computing...", papp->StrId(),
 			wm->Id());
 
 	// Skip if the application has been disabled/stopped in the meanwhile
 	if (papp->Disabled()) {
-		logger->Debug("Insert: [%s] disabled/stopped during scheduling [Ord]",
+		BBQUE_LOG_DEBUG("Insert: [%s] disabled/stopped during scheduling [Ord]",
 				papp->StrId());
 		return SCHED_SKIP_APP;
 	}
@@ -390,16 +392,16 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::EvalWorkingMode(
 
 	switch (result) {
 	case SCHED_CLUSTER_FULL:
-		logger->Warn("Insert: No more PEs in cluster %d", cl_id);
+		BBQUE_LOG_WARN("Insert: No more PEs in cluster %d", cl_id);
 		return result;
 
 	case SCHED_RSRC_UNAV:
-		logger->Warn("Insert: [%s] AWM{%d} CL=%d unavailable resources "
+		BBQUE_LOG_WARN("Insert: [%s] AWM{%d} CL=%d unavailable resources "
 				"[RA:%d]", papp->StrId(), wm->Id(), cl_id, result);
 		return result;
 
 	case SCHED_ERROR:
-		logger->Error("Insert: An error occurred [ret %d]", result);
+		BBQUE_LOG_ERROR("Insert: An error occurred [ret %d]", result);
 		return result;
 
 	default:
@@ -411,7 +413,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::EvalWorkingMode(
 	sched_map->insert(std::pair<float, SchedEntity_t>(metrics,
 				SchedEntity_t(papp, wm)));
 
-	logger->Info("{%d} Insert: [%s] AWM{%d} CL=%d metrics %.4f",
+	BBQUE_LOG_INFO("{%d} Insert: [%s] AWM{%d} CL=%d metrics %.4f",
 					sched_map->size(), papp->StrId(),
 					wm->Id(), cl_id, metrics);
 
@@ -454,7 +456,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::MetricsComputation(
 		return result;
 
 	// Metrics
-	logger->Debug("AWM value: %.2f", wm->Value());
+	BBQUE_LOG_DEBUG("AWM value: %.2f", wm->Value());
 	metrics = (wm->Value() - reconf_cost - migr_cost) / cont_level;
 
 	YAMCA_GET_TIMING(coll_metrics, YAMCA_METCOMP_TIME, comp_tmr);
@@ -496,7 +498,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::GetContentionLevel(
 
 	// Safety data check
 	if (!wm) {
-		logger->Crit("Contention level: Missing working mode.\n"
+		BBQUE_LOG_CRIT("Contention level: Missing working mode.\n"
 				"Possibile data corruption in "
 				MODULE_NAMESPACE);
 		assert(!wm);
@@ -505,10 +507,10 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::GetContentionLevel(
 
 	// Binding of the resources requested by the working mode into the current
 	// cluster. Note: No multi-cluster allocation supported yet!
-	logger->Debug("Contention level: Binding into cluster %d", cl_id);
+	BBQUE_LOG_DEBUG("Contention level: Binding into cluster %d", cl_id);
 	wm_result = wm->BindResource("cluster", RSRC_ID_ANY, cl_id);
 	if (wm_result == WorkingMode::WM_RSRC_MISS_BIND)
-		logger->Error("Contention level: {AWM %d} [cluster = %d]"
+		BBQUE_LOG_ERROR("Contention level: {AWM %d} [cluster = %d]"
 				"Incomplete resources binding. %d / %d resources bound.",
 						wm->Id(), cl_id, wm->GetSchedResourceBinding()->size(),
 						wm->RecipeResourceUsages().size());
@@ -538,12 +540,12 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::ComputeContentionLevel(
 		// Query resource availability
 		rsrc_avail = rsrc_acct.Available(pusage->GetBindingList(),
 				rsrc_view_token, papp);
-		logger->Debug("{%s} availability = %" PRIu64,
+		BBQUE_LOG_DEBUG("{%s} availability = %" PRIu64,
 				rsrc_path.c_str(), rsrc_avail);
 
 		// Is the request satisfiable?
 		if (rsrc_avail < pusage->GetAmount()) {
-			logger->Debug("Contention level: [%s] R=%d / A=%d",
+			BBQUE_LOG_DEBUG("Contention level: [%s] R=%d / A=%d",
 					rsrc_path.c_str(), pusage->GetAmount(),	rsrc_avail);
 
 			// Set the availability to a 1/10 of the requested amount of
@@ -568,7 +570,7 @@ SchedulerPolicyIF::ExitCode_t YamcaSchedPol::ComputeContentionLevel(
 	if (cont_level == 0)
 		cont_level = 0.1;
 
-	logger->Debug("Contention level: %.4f", cont_level);
+	BBQUE_LOG_DEBUG("Contention level: %.4f", cont_level);
 	return SCHED_OK;
 }
 
@@ -53,8 +53,10 @@ public:
 	/** The scheduling entity*/
 	typedef std::pair<AppCPtr_t, AwmPtr_t> SchedEntity_t;
 
-	/** Map for ordering the scheduling entities */
-	typedef std::multimap<float, SchedEntity_t> SchedEntityMap_t;
+	/** Map for ordering the scheduling entities, on the scheduling arena */
+	typedef std::multimap<float, SchedEntity_t, std::less<float>,
+			bbque::utils::ArenaAllocator<
+				std::pair<const float, SchedEntity_t>>> SchedEntityMap_t;
 
 //----- static plugin interface
 
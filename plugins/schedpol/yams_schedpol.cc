@@ -27,6 +27,7 @@
 #include "bbque/modules_factory.h"
 #include "bbque/app/working_mode.h"
 #include "bbque/plugins/logger.h"
+#include "bbque/utils/trace.h"
 #include "contrib/sched_contrib_manager.h"
 
 namespace bu = bbque::utils;
@@ -98,7 +99,7 @@ YamsSchedPol::YamsSchedPol():
 	logger = ModulesFactory::GetLoggerModule(std::cref(conf));
 
 	if (logger)
-		logger->Info("yams: Built a new dynamic object[%p]", this);
+		BBQUE_LOG_INFO("yams: Built a new dynamic object[%p]", this);
 	else
 		fprintf(stderr, FI("yams: Built new dynamic object [%p]\n"), (void *)this);
 
@@ -132,19 +133,19 @@ YamsSchedPol::ExitCode_t YamsSchedPol::Init() {
 	ResourceAccounterStatusIF::ExitCode_t ra_result;
 	ra_result = ra.GetView(token_path, vtok);
 	if (ra_result != ResourceAccounterStatusIF::RA_SUCCESS) {
-		logger->Fatal("Init: Cannot get a resource state view");
+		BBQUE_LOG_FATAL("Init: Cannot get a resource state view");
 		return YAMS_ERR_VIEW;
 	}
 
-	logger->Debug("Init: Requiring state view token for %s", token_path);
-	logger->Debug("Init: Resources state view token = %d", vtok);
+	BBQUE_LOG_DEBUG("Init: Requiring state view token for %s", token_path);
+	BBQUE_LOG_DEBUG("Init: Resources state view token = %d", vtok);
 
 	// Get the number of clusters
 	cl_info.rsrcs = sv->GetResources(RSRC_CLUSTER);
 	cl_info.num   = cl_info.rsrcs.size();
 	cl_info.ids.resize(cl_info.num);
 	if (cl_info.num == 0) {
-		logger->Error("Init: No clusters available on the platform");
+		BBQUE_LOG_ERROR("Init: No clusters available on the platform");
 		return YAMS_ERR_CLUSTERS;
 	}
 
@@ -154,11 +155,11 @@ YamsSchedPol::ExitCode_t YamsSchedPol::Init() {
 	for (uint8_t j = 0; cl_it != end_cl; ++cl_it, ++j) {
 		ResourcePtr_t & rsrc(*cl_it);
 		cl_info.ids[j] = ResourcePathUtils::GetID(rsrc->Name(), "cluster");
-		logger->Debug("Init: Cluster ID: %d", cl_info.ids[j]);
+		BBQUE_LOG_DEBUG("Init: Cluster ID: %d", cl_info.ids[j]);
 	}
 
-	logger->Debug("Init: Clusters on the platform: %d", cl_info.num);
-	logger->Debug("Init: Lowest application prio : %d",
+	BBQUE_LOG_DEBUG("Init: Clusters on the platform: %d", cl_info.num);
+	BBQUE_LOG_DEBUG("Init: Lowest application prio : %d",
 			sv->ApplicationLowestPriority());
 
 	// Set the view information into the metrics contribute
@@ -170,7 +171,7 @@ YamsSchedPol::ExitCode_t YamsSchedPol::Init() {
 SchedulerPolicyIF::ExitCode_t
 YamsSchedPol::Schedule(System & sys_if, RViewToken_t & rav) {
 	ExitCode_t result;
-	logger->Debug("@@@@@@@@@@@@@@@@ Scheduling policy starting @@@@@@@@@@@@");
+	BBQUE_LOG_DEBUG("@@@@@@@@@@@@@@@@ Scheduling policy starting @@@@@@@@@@@@");
 
 	// Save a reference to the System interface;
 	sv = &sys_if;
@@ -184,7 +185,9 @@ YamsSchedPol::Schedule(System & sys_if, RViewToken_t & rav) {
 	for (AppPrio_t prio = 0; prio <= sv->ApplicationLowestPriority(); ++prio) {
 		if (!sv->HasApplications(prio))
 			continue;
+		BBQUE_TRACE_BEGIN(SP, "yams.prio", prio);
 		SchedulePrioQueue(prio);
+		BBQUE_TRACE_END(SP, "yams.prio", prio);
 	}
 
 	// Set the new resource state view token
@@ -195,12 +198,12 @@ YamsSchedPol::Schedule(System & sys_if, RViewToken_t & rav) {
 	cl_info.full.reset();
 
 	ra.PrintStatusReport(vtok);
-	logger->Debug("################ Scheduling policy exiting ##############");
+	BBQUE_LOG_DEBUG("################ Scheduling policy exiting ##############");
 
 	return SCHED_DONE;
 
 error:
-	logger->Error("Schedule: an error occurred. Interrupted.");
+	BBQUE_LOG_ERROR("Schedule: an error occurred. Interrupted.");
 	entities.clear();
 	cl_info.full.reset();
 
@@ -228,23 +231,27 @@ do_schedule:
 	ids_it = cl_info.ids.begin();
 	for (; ids_it != cl_info.ids.end(); ++ids_it) {
 		ResID_t & cl_id(*ids_it);
-		logger->Debug("Schedule: :::::::::::::::::::::: Cluster %d:", cl_id);
+		BBQUE_LOG_DEBUG("Schedule: :::::::::::::::::::::: Cluster %d:", cl_id);
 
 		// Skip current cluster if full
 		if (cl_info.full[cl_id]) {
-			logger->Debug("Schedule: cluster %d is full, skipping...", cl_id);
+			BBQUE_LOG_DEBUG("Schedule: cluster %d is full, skipping...", cl_id);
 			continue;
 		}
 
 		// Order schedule entities by aggregate metrics
+		BBQUE_TRACE_BEGIN(SP, "yams.ordering", cl_id);
 		naps_count = OrderSchedEntities(prio, cl_id);
+		BBQUE_TRACE_END(SP, "yams.ordering", cl_id);
 	}
 	// Collect "ordering step" metrics
 	YAMS_GET_TIMING(coll_metrics, YAMS_ORDERING_TIME, yams_tmr);
 
 	// Selection: for each application schedule a working mode
 	YAMS_RESET_TIMING(yams_tmr);
+	BBQUE_TRACE_BEGIN(SP, "yams.selecting", prio);
 	sched_incomplete = SelectSchedEntities(naps_count);
+	BBQUE_TRACE_END(SP, "yams.selecting", prio);
 	entities.clear();
 
 	if (sched_incomplete)
@@ -284,7 +291,7 @@ bool YamsSchedPol::SelectSchedEntities(uint8_t naps_count) {
 	Application::ExitCode_t app_result;
 	SchedEntityList_t::iterator se_it(entities.begin());
 	SchedEntityList_t::iterator end_se(entities.end());
-	logger->Debug("=================| Scheduling entities |=================");
+	BBQUE_LOG_DEBUG("=================| Scheduling entities |=================");
 
 	// Pick the entity and set the new AWM
 	for (; se_it != end_se; ++se_it) {
@@ -299,22 +306,22 @@ bool YamsSchedPol::SelectSchedEntities(uint8_t naps_count) {
 		// Send the schedule request
 		app_result = pschd->papp->ScheduleRequest(pschd->pawm, vtok,
 				pschd->clust_id);
-		logger->Debug("Selecting: [%s] schedule requested", pschd->StrId());
+		BBQUE_LOG_DEBUG("Selecting: [%s] schedule requested", pschd->StrId());
 
 		// Scheduling request rejected
 		if (app_result != ApplicationStatusIF::APP_WM_ACCEPTED) {
-			logger->Debug("Selecting: [%s] rejected !", pschd->StrId());
+			BBQUE_LOG_DEBUG("Selecting: [%s] rejected !", pschd->StrId());
 			continue;
 		}
 
 		// Logging messages
 		if (!pschd->papp->Synching() || pschd->papp->Blocking()) {
-			logger->Debug("Selecting: [%s] state %s|%s", pschd->papp->StrId(),
+			BBQUE_LOG_DEBUG("Selecting: [%s] state %s|%s", pschd->papp->StrId(),
 					Application::StateStr(pschd->papp->State()),
 					Application::SyncStateStr(pschd->papp->SyncState()));
 			continue;
 		}
-		logger->Notice("Selecting: [%s] scheduled << metrics: %.4f >>",
+		BBQUE_LOG_NOTICE("Selecting: [%s] scheduled << metrics: %.4f >>",
 				pschd->StrId(), pschd->metrics);
 
 		// Set the application value (scheduling aggregate metrics)
@@ -330,16 +337,17 @@ bool YamsSchedPol::SelectSchedEntities(uint8_t naps_count) {
 	}
 
 	if (se_it != end_se) {
-		logger->Debug("======================| NAP Break |===================");
+		BBQUE_LOG_DEBUG("======================| NAP Break |===================");
 		return true;
 	}
 
-	logger->Debug("========================| DONE |======================");
+	BBQUE_LOG_DEBUG("========================| DONE |======================");
 	return false;
 }
 
 void YamsSchedPol::InsertWorkingModes(AppCPtr_t const & papp, uint16_t cl_id) {
 	std::list<std::thread> awm_thds;
+	bu::Arena & arena(SchedulerManager::SchedArena());
 	float metrics = 0.0;
 
 	// Application Working Modes
@@ -350,7 +358,9 @@ void YamsSchedPol::InsertWorkingModes(AppCPtr_t const & papp, uint16_t cl_id) {
 	// AWMs (+resources bound to 'cl_id') evaluation
 	for (; awm_it != end_awm; ++awm_it) {
 		AwmPtr_t const & pawm(*awm_it);
-		SchedEntityPtr_t pschd(new SchedEntity_t(papp, pawm, cl_id, metrics));
+		SchedEntityPtr_t pschd(std::allocate_shared<SchedEntity_t>(
+					bu::ArenaAllocator<SchedEntity_t>(&arena),
+					papp, pawm, cl_id, metrics));
 #ifdef BBQUE_SP_YAMS_PARALLEL
 		awm_thds.push_back(
 				std::thread(&YamsSchedPol::EvalWorkingMode, this, pschd)
@@ -364,17 +374,17 @@ void YamsSchedPol::InsertWorkingModes(AppCPtr_t const & papp, uint16_t cl_id) {
 	for_each(awm_thds.begin(), awm_thds.end(), mem_fn(&std::thread::join));
 	awm_thds.clear();
 #endif
-	logger->Debug("Evaluate: table size = %d", entities.size());
+	BBQUE_LOG_DEBUG("Evaluate: table size = %d", entities.size());
 }
 
 void YamsSchedPol::EvalWorkingMode(SchedEntityPtr_t pschd) {
 	std::unique_lock<std::mutex> sched_ul(sched_mtx, std::defer_lock);
 	ExitCode_t result;
-	logger->Debug("Insert: [%s] ...metrics computing...", pschd->StrId());
+	BBQUE_LOG_DEBUG("Insert: [%s] ...metrics computing...", pschd->StrId());
 
 	// Skip if the application has been disabled/stopped in the meanwhile
 	if (pschd->papp->Disabled()) {
-		logger->Debug("Insert: [%s] disabled/stopped during schedule ordering",
+		BBQUE_LOG_DEBUG("Insert: [%s] disabled/stopped during schedule ordering",
 				pschd->papp->StrId());
 		return;
 	}
@@ -387,13 +397,15 @@ void YamsSchedPol::EvalWorkingMode(SchedEntityPtr_t pschd) {
 	// Metrics computation
 	Timer comp_tmr;
 	YAMS_RESET_TIMING(comp_tmr);
+	BBQUE_TRACE_BEGIN(SP, "yams.aggregate", pschd->papp->Uid());
 	AggregateContributes(pschd);
+	BBQUE_TRACE_END(SP, "yams.aggregate", pschd->papp->Uid());
 	YAMS_GET_TIMING(coll_metrics, YAMS_METRICS_COMP_TIME, comp_tmr);
 
 	// Insert the SchedEntity in the scheduling list
 	sched_ul.lock();
 	entities.push_back(pschd);
-	logger->Debug("Insert [%d]: %s: ..:: metrics %1.3f",
+	BBQUE_LOG_DEBUG("Insert [%d]: %s: ..:: metrics %1.3f",
 			entities.size(), pschd->StrId(), pschd->metrics);
 }
 
@@ -416,7 +428,7 @@ void YamsSchedPol::AggregateContributes(SchedEntityPtr_t pschd) {
 		scm_ret = scm->GetIndex(sc_types[i], eval_ent, sc_value, sc_ret);
 		if (scm_ret != SchedContribManager::OK) {
 
-			logger->Error("Aggregate: [SchedContribManager error %d]", scm_ret);
+			BBQUE_LOG_ERROR("Aggregate: [SchedContribManager error %d]", scm_ret);
 			if (scm_ret != SchedContribManager::SC_ERROR) {
 				YAMS_RESET_TIMING(comp_tmr);
 				continue;
@@ -425,12 +437,12 @@ void YamsSchedPol::AggregateContributes(SchedEntityPtr_t pschd) {
 			// SchedContrib specific error handling
 			switch (sc_ret) {
 			case SchedContrib::SC_RSRC_NO_PE:
-				logger->Debug("Aggregate: No available PEs in cluster/node %d",
+				BBQUE_LOG_DEBUG("Aggregate: No available PEs in cluster/node %d",
 						pschd->clust_id);
 				cl_info.full.set(pschd->clust_id);
 				return;
 			default:
-				logger->Warn("Aggregate: Unable to schedule into cluster/node %d"
+				BBQUE_LOG_WARN("Aggregate: Unable to schedule into cluster/node %d"
 						" [SchedContrib error %d]", pschd->clust_id);
 				YAMS_GET_TIMING(coll_mct_metrics, i, comp_tmr);
 				continue;
@@ -440,13 +452,19 @@ void YamsSchedPol::AggregateContributes(SchedEntityPtr_t pschd) {
 
 		// Cumulate the contribution
 		pschd->metrics += sc_value;
-		len += sprintf(metrics_log+len, "%c: %5.4f, ",
-				scm->GetString(sc_types[i])[0],
-				sc_value);
+		if (BBQUE_LOG_ENABLED(NOTICE))
+			len += sprintf(metrics_log+len, "%c: %5.4f, ",
+					scm->GetString(sc_types[i])[0],
+					sc_value);
 	}
 
+	BBQUE_TRACE_COUNTER(SC, "yams.metrics", pschd->metrics,
+			pschd->papp->Uid());
+	if (len == 0)
+		return;
+
 	metrics_log[len-2] = '\0';
-	logger->Notice("Aggregate: %s app-value: (%s) => %5.4f", pschd->StrId(),
+	BBQUE_LOG_NOTICE("Aggregate: %s app-value: (%s) => %5.4f", pschd->StrId(),
 			metrics_log, pschd->metrics);
 }
 
@@ -462,15 +480,15 @@ YamsSchedPol::ExitCode_t YamsSchedPol::BindCluster(SchedEntityPtr_t pschd) {
 
 	// The cluster binding should never fail
 	if (awm_result == WorkingModeStatusIF::WM_RSRC_MISS_BIND) {
-		logger->Error("BindCluster: {AWM %d} [cluster %d]"
+		BBQUE_LOG_ERROR("BindCluster: {AWM %d} [cluster %d]"
 				"Incomplete	resources binding. %d / %d resources bound.",
 				pawm->Id(), cl_id,
-				pawm->GetSchedResourceBinding()->size(),
+				pawm->GetSchedResourceBinding(cl_id)->size(),
 				pawm->RecipeResourceUsages().size());
 		assert(awm_result == WorkingModeStatusIF::WM_SUCCESS);
 		return YAMS_ERROR;
 	}
-	logger->Debug("BindCluster: {AWM %d} resources bound to cluster %d",
+	BBQUE_LOG_DEBUG("BindCluster: {AWM %d} resources bound to cluster %d",
 			pawm->Id(), cl_id);
 
 	return YAMS_SUCCESS;
@@ -142,7 +142,13 @@ private:
 	/** Shared pointer to a scheduling entity */
 	typedef std::shared_ptr<SchedEntity_t> SchedEntityPtr_t;
 
-	/** List of scheduling entities */
+	/**
+	 * List of scheduling entities
+	 *
+	 * The entities are allocated on the scheduling arena, while the list
+	 * itself uses the default allocator, since std::list::sort does not
+	 * support stateful allocators before GCC 11.
+	 */
 	typedef std::list<SchedEntityPtr_t> SchedEntityList_t;
 
 
@@ -295,7 +301,7 @@ private:
 		// Skip if the application has been rescheduled yet (with success) or
 		// disabled in the meanwhile
 		if (!papp->Active() && !papp->Blocking()) {
-			logger->Debug("Skipping [%s]. State = {%s/%s}",
+			BBQUE_LOG_DEBUG("Skipping [%s]. State = {%s/%s}",
 					papp->StrId(),
 					ApplicationStatusIF::StateStr(papp->State()),
 					ApplicationStatusIF::SyncStateStr(papp->SyncState()));
@@ -305,7 +311,7 @@ private:
 		// Avoid double AWM selection for RUNNING applications with an already
 		// assigned AWM.
 		if ((papp->State() == Application::RUNNING) && papp->NextAWM()) {
-			logger->Debug("Skipping [%s]. No reconfiguration needed. (AWM=%d)",
+			BBQUE_LOG_DEBUG("Skipping [%s]. No reconfiguration needed. (AWM=%d)",
 					papp->StrId(), papp->CurrentAWM()->Id());
 			return true;
 		}
@@ -313,7 +319,7 @@ private:
 		// Avoid double AWM selection for SYNCH applications with an already
 		// assigned AWM.
 		if ((papp->State() == Application::SYNC) && papp->NextAWM()) {
-			logger->Debug("Skipping [%s]. AWM already assigned. (AWM=%d)",
+			BBQUE_LOG_DEBUG("Skipping [%s]. AWM already assigned. (AWM=%d)",
 					papp->StrId(), papp->NextAWM()->Id());
 			return true;
 		}
@@ -81,7 +81,7 @@ SasbSyncPol::SasbSyncPol() :
 	mc.Register(metrics, SM_METRICS_COUNT);
 
 	assert(logger);
-	logger->Debug("Built SASB SyncPol object @%p", (void*)this);
+	BBQUE_LOG_DEBUG("Built SASB SyncPol object @%p", (void*)this);
 
 }
 
@@ -98,11 +98,11 @@ char const *SasbSyncPol::Name() {
 ApplicationStatusIF::SyncState_t SasbSyncPol::step1(
 			bbque::System & sv) {
 
-	logger->Debug("STEP 1.0: Running => Blocked");
+	BBQUE_LOG_DEBUG("STEP 1.0: Running => Blocked");
 	if (sv.HasApplications(ApplicationStatusIF::BLOCKED))
 		return ApplicationStatusIF::BLOCKED;
 
-	logger->Debug("STEP 1.0:            "
+	BBQUE_LOG_DEBUG("STEP 1.0:            "
 			"No EXCs to be BLOCKED");
 	return ApplicationStatusIF::SYNC_NONE;
 }
@@ -113,17 +113,17 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::step2(
 
 	switch(status) {
 	case STEP21:
-		logger->Debug("STEP 2.1: Running => Migration (lower prio)");
+		BBQUE_LOG_DEBUG("STEP 2.1: Running => Migration (lower prio)");
 		syncState = ApplicationStatusIF::MIGRATE;
 		break;
 
 	case STEP22:
-		logger->Debug("STEP 2.2: Running => Migration/Reconf (lower prio)");
+		BBQUE_LOG_DEBUG("STEP 2.2: Running => Migration/Reconf (lower prio)");
 		syncState = ApplicationStatusIF::MIGREC;
 		break;
 
 	case STEP23:
-		logger->Debug("STEP 2.3: Running => Reconf (lower prio)");
+		BBQUE_LOG_DEBUG("STEP 2.3: Running => Reconf (lower prio)");
 		syncState = ApplicationStatusIF::RECONF;
 		break;
 
@@ -136,7 +136,7 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::step2(
 	if (sv.HasApplications(syncState))
 		return syncState;
 
-	logger->Debug("STEP 2.0:            "
+	BBQUE_LOG_DEBUG("STEP 2.0:            "
 			"No EXCs to be reschedule (lower prio)");
 	return ApplicationStatusIF::SYNC_NONE;
 }
@@ -148,17 +148,17 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::step3(
 
 	switch(status) {
 	case STEP31:
-		logger->Debug("STEP 3.1: Running => Migration (higher prio)");
+		BBQUE_LOG_DEBUG("STEP 3.1: Running => Migration (higher prio)");
 		syncState = ApplicationStatusIF::MIGRATE;
 		break;
 
 	case STEP32:
-		logger->Debug("STEP 3.2: Running => Migration/Reconf (higher prio)");
+		BBQUE_LOG_DEBUG("STEP 3.2: Running => Migration/Reconf (higher prio)");
 		syncState = ApplicationStatusIF::MIGREC;
 		break;
 
 	case STEP33:
-		logger->Debug("STEP 3.3: Running => Reconf (higher prio)");
+		BBQUE_LOG_DEBUG("STEP 3.3: Running => Reconf (higher prio)");
 		syncState = ApplicationStatusIF::RECONF;
 		break;
 
@@ -171,7 +171,7 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::step3(
 	if (sv.HasApplications(syncState))
 		return syncState;
 
-	logger->Debug("STEP 3.0:            "
+	BBQUE_LOG_DEBUG("STEP 3.0:            "
 			"No EXCs to be reschedule (higher prio)");
 	return ApplicationStatusIF::SYNC_NONE;
 }
@@ -179,11 +179,11 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::step3(
 ApplicationStatusIF::SyncState_t SasbSyncPol::step4(
 			bbque::System & sv) {
 
-	logger->Debug("STEP 4.0: Ready   => Running");
+	BBQUE_LOG_DEBUG("STEP 4.0: Ready   => Running");
 	if (sv.HasApplications(ApplicationStatusIF::STARTING))
 		return ApplicationStatusIF::STARTING;
 
-	logger->Debug("STEP 4.0:            "
+	BBQUE_LOG_DEBUG("STEP 4.0:            "
 			"No EXCs to be started");
 	return ApplicationStatusIF::SYNC_NONE;
 }
@@ -201,7 +201,7 @@ ApplicationStatusIF::SyncState_t SasbSyncPol::GetApplicationsQueue(
 	}
 
 	if (restart) {
-		logger->Debug("Resetting sync status");
+		BBQUE_LOG_DEBUG("Resetting sync status");
 		servedSyncState = ApplicationStatusIF::SYNC_NONE;
 		status = STEP10;
 		// Account for Policy runs
@@ -258,7 +258,7 @@ bool SasbSyncPol::DoSync(AppPtr_t papp) {
 	// Avoid RESHUFFLING notification on application being RECONF just for
 	// resources reshuffling
 	if ((papp->SyncState() == ApplicationStatusIF::RECONF)) {
-		DB(logger->Notice("Force jump reshuffled EXC"));
+		DB(BBQUE_LOG_NOTICE("Force jump reshuffled EXC"));
 		return papp->SwitchingAWM();
 	}
 
@@ -269,7 +269,7 @@ SasbSyncPol::ExitCode_t
 SasbSyncPol::CheckLatency(AppPtr_t papp, SyncLatency_t latency) {
 	// TODO: use a smarter latency validation, e.g. considering the
 	// application and the currently served queue
-	DB(logger->Warn("TODO: Check for [%s] (%d[ms]) syncLatency compliance",
+	DB(BBQUE_LOG_WARN("TODO: Check for [%s] (%d[ms]) syncLatency compliance",
 			papp->StrId(), latency));
 
 	// Right now we use a dummy approach based on WORST CASE.
@@ -399,7 +399,7 @@ void testResourceSetSearch(SystemView & sv,
 		<< std::endl;
 
 	// List of matches
-	std::list<br::ResourcePtr_t> res_match;
+	br::ResourcePtrList_t res_match;
 
 	// Make a path template based search of the given resources set
 	for (std::vector<std::string>::iterator rsrc_it = rsrc_paths.begin();
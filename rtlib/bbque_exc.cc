@@ -371,6 +371,52 @@ RTLIB_ExitCode_t BbqueEXC::SetGoalGap(uint8_t percent) {
 	return result;
 }
 
+RTLIB_AsyncToken_t BbqueEXC::SetConstraintsAsync(
+		RTLIB_Constraint_t *constraints,
+		uint8_t count,
+		RTLIB_Async_Callback cb, void *data) {
+
+	assert(registered == true);
+	assert(rtlib->Async.SetConstraints);
+
+	//--- Queue constraints on this EXC
+	DB(fprintf(stderr, FD("Queue [%d] constraints for EXC [%s] (@%p)...\n"),
+			count, exc_name.c_str(), (void*)exc_hdl));
+	return rtlib->Async.SetConstraints(exc_hdl, constraints, count,
+			cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueEXC::ClearConstraintsAsync(
+		RTLIB_Async_Callback cb, void *data) {
+
+	assert(registered == true);
+	assert(rtlib->Async.ClearConstraints);
+
+	//--- Queue constraints clearing on this EXC
+	DB(fprintf(stderr, FD("Queue clear ALL constraints for EXC [%s] "
+			"(@%p)...\n"), exc_name.c_str(), (void*)exc_hdl));
+	return rtlib->Async.ClearConstraints(exc_hdl, cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueEXC::SetGoalGapAsync(uint8_t percent,
+		RTLIB_Async_Callback cb, void *data) {
+
+	assert(registered == true);
+	assert(rtlib->Async.SetGoalGap);
+
+	//--- Queue a Goal-Gap on this EXC
+	DB(fprintf(stderr, FD("Queue [%d] Goal-Gap for EXC [%s] (@%p)...\n"),
+			percent, exc_name.c_str(), (void*)exc_hdl));
+	return rtlib->Async.SetGoalGap(exc_hdl, percent, cb, data);
+}
+
+RTLIB_ExitCode_t BbqueEXC::WaitAsync(RTLIB_AsyncToken_t token,
+		uint32_t timeout_ms) {
+
+	assert(rtlib->Async.Wait);
+	return rtlib->Async.Wait(token, timeout_ms);
+}
+
 /*******************************************************************************
  *    Control Loop
  ******************************************************************************/
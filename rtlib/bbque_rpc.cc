@@ -18,10 +18,19 @@
 #include "bbque/config.h"
 #include "bbque/rtlib/bbque_rpc.h"
 #include "bbque/rtlib/rpc_fifo_client.h"
+#include "bbque/rtlib/rpc_shm_client.h"
+#include "bbque/rtlib/rpc_sock_client.h"
 #include "bbque/app/application.h"
 
+#include <climits>
 #include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 // Setup logging
 #undef  BBQUE_LOG_MODULE
@@ -44,6 +53,12 @@ BbqueRPC * BbqueRPC::GetInstance() {
 #ifdef CONFIG_BBQUE_RPC_FIFO
 	DB(fprintf(stderr, FD("Using FIFO RPC channel\n")));
 	instance = new BbqueRPC_FIFO_Client();
+#elif defined(CONFIG_BBQUE_RPC_SHM)
+	DB(fprintf(stderr, FD("Using SHM RPC channel\n")));
+	instance = new BbqueRPC_SHM_Client();
+#elif defined(CONFIG_BBQUE_RPC_SOCK)
+	DB(fprintf(stderr, FD("Using SOCK RPC channel\n")));
+	instance = new BbqueRPC_SOCK_Client();
 #else
 #error RPC Channel NOT defined
 #endif // CONFIG_BBQUE_RPC_FIFO
@@ -52,7 +67,11 @@ BbqueRPC * BbqueRPC::GetInstance() {
 }
 
 BbqueRPC::BbqueRPC(void) :
-	initialized(false) {
+	initialized(false),
+	mbox(NULL),
+	statsRing(NULL),
+	asyncToken(0),
+	asyncDone(false) {
 
 	sprintf(chTrdUid, "00000:undef ");
 }
@@ -63,6 +82,9 @@ BbqueRPC::~BbqueRPC(void) {
 
 	DB(fprintf(stderr, FD("BbqueRPC dtor\n")));
 
+	// Send the pending asynchronous requests
+	AsyncStop();
+
 	// Dump out execution statistics
 	it = exc_map.begin();
 	if (it != exc_map.end()) {
@@ -76,8 +98,15 @@ BbqueRPC::~BbqueRPC(void) {
 
 	}
 
+	// Close the current live statistics windows
+	for (it = exc_map.begin(); it != exc_map.end(); ++it)
+		LiveStatsFlush((*it).second);
+
 	// Clean-up all the registered EXCs
 	exc_map.clear();
+
+	MailboxRelease();
+	LiveStatsRelease();
 }
 
 bool BbqueRPC::envPerfCount = false;
@@ -90,6 +119,9 @@ bool BbqueRPC::envMOSTOutput = false;
 char BbqueRPC::envMetricsTag[BBQUE_RTLIB_OPTS_TAG_MAX+2] = "";
 bool BbqueRPC::envBigNum = false;
 const char *BbqueRPC::envCsvSep = " ";
+float BbqueRPC::envPerfSampling = 0;
+bool BbqueRPC::envPipelined = false;
+int  BbqueRPC::envLiveStats = 0;
 
 RTLIB_ExitCode_t BbqueRPC::ParseOptions() {
 	const char *env;
@@ -119,6 +151,10 @@ RTLIB_ExitCode_t BbqueRPC::ParseOptions() {
 			// Enabling "big numbers" notations
 			envBigNum = true;
 			break;
+		case 'B':
+			// Enabling pipelined (batched) RPC requests
+			envPipelined = true;
+			break;
 		case 'c':
 			// Enabling CSV output
 			envCsvOutput = true;
@@ -131,6 +167,16 @@ RTLIB_ExitCode_t BbqueRPC::ParseOptions() {
 			// Disable Kernel and Hipervisor from collected statistics
 			envNoKernel = true;
 			break;
+		case 'L':
+			// Enabling live statistics...
+			envLiveStats = 1;
+			// ... with the specified window [cycles]
+			sscanf(opt+1, "%d", &envLiveStats);
+			if (envLiveStats < 1)
+				envLiveStats = 1;
+			fprintf(stderr, "Enabling live statistics "
+					"[window: %d cycles]\n", envLiveStats);
+			break;
 		case 'M':
 			// Enabling MOST output
 			envMOSTOutput = true;
@@ -158,6 +204,16 @@ RTLIB_ExitCode_t BbqueRPC::ParseOptions() {
 				fprintf(stderr, "WARN: Perf Counters NOT available\n");
 			}
 			break;
+		case 'S':
+			// Enabling adaptive sampling of perf counters...
+			envPerfSampling = BBQUE_RTLIB_PERF_SAMPLING_TARGET;
+			// ... with the specified target overhead [%]
+			sscanf(opt+1, "%f", &envPerfSampling);
+			if (envPerfSampling <= 0)
+				envPerfSampling = BBQUE_RTLIB_PERF_SAMPLING_TARGET;
+			fprintf(stderr, "Enabling Perf Counters sampling "
+					"[overhead: %.2f%%]\n", envPerfSampling);
+			break;
 		case 's':
 			// Setting CSV separator
 			if (opt[1])
@@ -197,6 +253,13 @@ RTLIB_ExitCode_t BbqueRPC::Init(const char *name) {
 		return exitCode;
 	}
 
+	// Setup the AWM mailbox, once the channel thread PID is known
+	MailboxSetup();
+
+	// Setup the live statistics export
+	if (envLiveStats)
+		LiveStatsSetup(name);
+
 	initialized = true;
 
 	DB(fprintf(stderr, FD("Initialation DONE\n")));
@@ -264,6 +327,11 @@ RTLIB_ExecutionContextHandler_t BbqueRPC::Register(
 	// Save the registered execution context
 	exc_map.insert(excMapEntry_t(prec->exc_id, prec));
 
+	// Name the EXC into the live statistics
+	if (statsRing)
+		strncpy(statsRing->exc_names[prec->exc_id], name,
+				BBQUE_STATS_RING_NAME_LENGTH - 1);
+
 	// Mark the EXC as Registered
 	setRegistered(prec);
 
@@ -351,6 +419,7 @@ void BbqueRPC::Unregister(
 
 	// Dump (verbose) execution statistics
 	DumpStats(prec);
+	LiveStatsFlush(prec);
 
 	// Mark the EXC as Unregistered
 	clearRegistered(prec);
@@ -370,6 +439,9 @@ void BbqueRPC::UnregisterAll() {
 		return;
 	}
 
+	// Send the pending asynchronous requests
+	AsyncStop();
+
 	// Unregisterig all the registered EXCs
 	it = exc_map.begin();
 	for ( ; it != exc_map.end(); ++it) {
@@ -565,6 +637,9 @@ void BbqueRPC::DumpStatsConsole(pregExCtx_t prec, bool verbose) {
 		PerfPrintStats(prec, pstats);
 	}
 
+	// Report the perf counters sampling rate
+	PerfPrintSampling(prec);
+
 }
 
 static char _metricPrefix[64] = "";
@@ -620,6 +695,7 @@ void BbqueRPC::DumpStatsMOST(pregExCtx_t prec) {
 
 		// Dump Performance Counters for this AWM
 		PerfPrintStats(prec, pstats);
+		PerfPrintSampling(prec);
 
 	}
 
@@ -783,6 +859,10 @@ void BbqueRPC::_SyncTimeEstimation(pregExCtx_t prec) {
 	// Push sample into accumulator
 	pstats->samples(last_cycle_ms);
 
+	// Export the sample
+	if (statsRing)
+		LiveStatsCycle(prec, last_cycle_ms);
+
 	// Statistic features extraction for cycle time estimation:
 	DB(
 	uint32_t _count = count(pstats->samples);
@@ -837,6 +917,19 @@ RTLIB_ExitCode_t BbqueRPC::GetAssignedWorkingMode(
 		pregExCtx_t prec,
 		RTLIB_WorkingModeParams_t *wm) {
 	std::unique_lock<std::mutex> rec_ul(prec->mtx);
+	uint32_t mbox_seq = 1;
+	uint8_t mbox_awm;
+	uint8_t mbox_flags;
+
+	// Snapshot the mailbox before checking the EXC status: any following
+	// synchronization will be detected by a sequence number change
+	if (mbox) {
+		mbox_seq = awm_mailbox_read(&mbox->slots[prec->exc_id],
+				mbox_awm, mbox_flags);
+		if (!(mbox_flags & AWM_MBOX_VALID) ||
+				(mbox_flags & AWM_MBOX_SYNC))
+			mbox_seq = 1;
+	}
 
 	if (!isEnabled(prec)) {
 		DB(fprintf(stderr, FD("Get AWM FAILED "
@@ -869,6 +962,10 @@ RTLIB_ExitCode_t BbqueRPC::GetAssignedWorkingMode(
 	// Update AWM statistics
 	UpdateStatistics(prec);
 
+	// Allow next calls to take the fast path
+	if (isSyncDone(prec))
+		MailboxTrack(prec, mbox_seq);
+
 	return RTLIB_OK;
 }
 
@@ -951,6 +1048,10 @@ RTLIB_ExitCode_t BbqueRPC::GetWorkingMode(
 					prec->ctrlTrdPid, prec->exc_id));
 	}
 
+	// Checking if the assigned AWM is still valid, without locking
+	if (MailboxGetWorkingMode(prec, wm))
+		return RTLIB_OK;
+
 	// Checking if a valid AWM has been assigned
 	DB(fprintf(stderr, FD("Looking for assigned AWM...\n")));
 	result = GetAssignedWorkingMode(prec, wm);
@@ -1079,6 +1180,239 @@ uint32_t BbqueRPC::GetSyncLatency(pregExCtx_t prec) {
 }
 
 
+/******************************************************************************
+ * AWM Mailbox
+ ******************************************************************************/
+
+void BbqueRPC::MailboxSetup() {
+	const awm_mailbox_t *shm;
+	struct stat mbox_stat;
+	void *addr;
+	int fd;
+
+	snprintf(mbox_name, BBQUE_AWM_MAILBOX_NAME_LENGTH,
+			BBQUE_AWM_MAILBOX_FMT, chTrdPid);
+
+	DB(fprintf(stderr, FD("Mapping AWM mailbox [%s]...\n"), mbox_name));
+
+	// The mailbox is created by Barbeque once the application is paired
+	fd = ::shm_open(mbox_name, O_RDONLY, 0);
+	if (fd < 0) {
+		fprintf(stderr, FW("AWM mailbox [%s] not available "
+					"(Error %d: %s)\n"),
+				mbox_name, errno, strerror(errno));
+		return;
+	}
+
+	if (fstat(fd, &mbox_stat) ||
+			(mbox_stat.st_size < (off_t)sizeof(awm_mailbox_t))) {
+		fprintf(stderr, FW("AWM mailbox [%s] not valid\n"), mbox_name);
+		::close(fd);
+		return;
+	}
+
+	addr = ::mmap(NULL, sizeof(awm_mailbox_t), PROT_READ, MAP_SHARED,
+			fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, FW("AWM mailbox [%s] not available "
+					"(Error %d: %s)\n"),
+				mbox_name, errno, strerror(errno));
+		return;
+	}
+
+	shm = (const awm_mailbox_t *)addr;
+	if ((__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) !=
+				BBQUE_AWM_MAILBOX_MAGIC) ||
+			(shm->version != BBQUE_AWM_MAILBOX_VERSION) ||
+			(shm->app_pid != chTrdPid)) {
+		fprintf(stderr, FW("AWM mailbox [%s] not valid\n"), mbox_name);
+		::munmap(addr, sizeof(awm_mailbox_t));
+		return;
+	}
+
+	mbox = shm;
+}
+
+void BbqueRPC::MailboxRelease() {
+
+	if (!mbox)
+		return;
+
+	// NOTE: the segment is removed by Barbeque
+	::munmap((void *)mbox, sizeof(awm_mailbox_t));
+	mbox = NULL;
+}
+
+bool BbqueRPC::MailboxGetWorkingMode(pregExCtx_t prec,
+		RTLIB_WorkingModeParams_t *wm) {
+	uint32_t seq = __atomic_load_n(&prec->mbox_seq, __ATOMIC_ACQUIRE);
+	uint8_t mbox_awm;
+	uint8_t mbox_flags;
+
+	// NOTE: tracked sequence numbers are always even
+	if (!mbox || (seq & 0x1))
+		return false;
+
+	// The AWM is taken from a consistent snapshot of the slot, i.e. read
+	// before re-checking the sequence number, rather than from the EXC,
+	// which could be updated concurrently by a synchronization
+	if (awm_mailbox_read(&mbox->slots[prec->exc_id],
+				mbox_awm, mbox_flags) != seq)
+		return false;
+
+	DB(fprintf(stderr, FD("Valid AWM still assigned\n")));
+	wm->awm_id = mbox_awm;
+
+	// Update AWM statistics
+	SyncTimeEstimation(prec);
+
+	return true;
+}
+
+void BbqueRPC::MailboxTrack(pregExCtx_t prec, uint32_t seq) {
+	__atomic_store_n(&prec->mbox_seq, seq, __ATOMIC_RELEASE);
+}
+
+
+/******************************************************************************
+ * Live Statistics
+ ******************************************************************************/
+
+void BbqueRPC::LiveStatsSetup(const char *name) {
+	char path[PATH_MAX];
+	void *addr;
+	int fd;
+
+	snprintf(path, PATH_MAX, BBQUE_PATH_VAR "/" BBQUE_STATS_RING_FMT,
+			chTrdPid, name);
+
+	DB(fprintf(stderr, FD("Creating live statistics ring [%s]...\n"),
+				path));
+
+	// A stale ring could be still mapped by a reader, thus it is replaced
+	// by a new file rather than truncated in place
+	::unlink(path);
+	fd = ::open(path, O_CREAT|O_EXCL|O_RDWR, 0644);
+	if (fd < 0) {
+		fprintf(stderr, FW("Live statistics [%s] not available "
+					"(Error %d: %s)\n"),
+				path, errno, strerror(errno));
+		return;
+	}
+
+	if (ftruncate(fd, sizeof(rtlib_stats_ring_t))) {
+		fprintf(stderr, FW("Live statistics [%s] not available "
+					"(Error %d: %s)\n"),
+				path, errno, strerror(errno));
+		::close(fd);
+		::unlink(path);
+		return;
+	}
+
+	addr = ::mmap(NULL, sizeof(rtlib_stats_ring_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, FW("Live statistics [%s] not available "
+					"(Error %d: %s)\n"),
+				path, errno, strerror(errno));
+		::unlink(path);
+		return;
+	}
+	statsRingPath = path;
+
+	// The file is zero filled, i.e. an empty ring
+	statsRing = (rtlib_stats_ring_t *)addr;
+	statsRing->version = BBQUE_STATS_RING_VERSION;
+	statsRing->window = envLiveStats;
+	statsRing->app_pid = chTrdPid;
+	statsRing->tstart_us = rtlib_stats_ring_now();
+	__atomic_store_n(&statsRing->magic, BBQUE_STATS_RING_MAGIC,
+			__ATOMIC_RELEASE);
+
+	fprintf(stderr, FI("Live statistics exported on [%s]\n"), path);
+}
+
+void BbqueRPC::LiveStatsRelease() {
+
+	if (!statsRing)
+		return;
+
+	// NOTE: readers still mapping the ring are not affected
+	::munmap(statsRing, sizeof(rtlib_stats_ring_t));
+	::unlink(statsRingPath.c_str());
+	statsRing = NULL;
+}
+
+int BbqueRPC::LiveStatsCounter(const char *name) {
+	std::unique_lock<std::mutex> statsRing_ul(statsRing_mtx);
+	uint32_t idx;
+
+	// Look-up the counter, which could be already used by another EXC
+	for (idx = 0; idx < statsRing->nr_perf; ++idx) {
+		if (!strcmp(statsRing->perf_names[idx], name))
+			return idx;
+	}
+
+	if (idx == BBQUE_STATS_RING_PERF_MAX)
+		return -1;
+
+	strncpy(statsRing->perf_names[idx], name,
+			BBQUE_STATS_RING_NAME_LENGTH - 1);
+	__atomic_store_n(&statsRing->nr_perf, idx + 1, __ATOMIC_RELEASE);
+	return idx;
+}
+
+void BbqueRPC::LiveStatsCycle(pregExCtx_t prec, double cycle_ms) {
+
+	// A window covers just one AWM
+	if (prec->live_cycles && (prec->live_awm != prec->awm_id))
+		LiveStatsFlush(prec);
+
+	if (!prec->live_cycles) {
+		prec->live_awm = prec->awm_id;
+		prec->live_sum = 0;
+		prec->live_min = cycle_ms;
+		prec->live_max = cycle_ms;
+	}
+
+	++prec->live_cycles;
+	prec->live_sum += cycle_ms;
+	if (cycle_ms < prec->live_min)
+		prec->live_min = cycle_ms;
+	if (cycle_ms > prec->live_max)
+		prec->live_max = cycle_ms;
+
+	if (prec->live_cycles >= (uint32_t)envLiveStats)
+		LiveStatsFlush(prec);
+}
+
+void BbqueRPC::LiveStatsFlush(pregExCtx_t prec) {
+	rtlib_stats_record_t *rec;
+	uint64_t idx;
+
+	if (!statsRing || !prec->live_cycles)
+		return;
+
+	rec = rtlib_stats_ring_reserve(statsRing, idx);
+	rec->tstamp_us = rtlib_stats_ring_now();
+	rec->cycles = prec->live_cycles;
+	rec->exc_id = prec->exc_id;
+	rec->awm_id = prec->live_awm;
+	rec->nr_perf = __atomic_load_n(&statsRing->nr_perf, __ATOMIC_ACQUIRE);
+	rec->time_avg_ms = prec->live_sum / prec->live_cycles;
+	rec->time_min_ms = prec->live_min;
+	rec->time_max_ms = prec->live_max;
+	::memcpy(rec->perf, prec->live_perf, sizeof(rec->perf));
+	rtlib_stats_ring_commit(rec, idx);
+
+	// Start a new window
+	prec->live_cycles = 0;
+	::memset(prec->live_perf, 0, sizeof(prec->live_perf));
+}
+
+
 /******************************************************************************
  * Synchronization Protocol Messages
  ******************************************************************************/
@@ -1355,6 +1689,341 @@ RTLIB_ExitCode_t BbqueRPC::GGap(
 	return RTLIB_OK;
 }
 
+/******************************************************************************
+ * Asynchronous Control Support
+ ******************************************************************************/
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncEnable(
+		const RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	pAsyncRequest_t preq(new AsyncRequest_t);
+
+	preq->cmd = ASYNC_ENABLE;
+	preq->ech = ech;
+	return AsyncPost(preq, cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncDisable(
+		const RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	pAsyncRequest_t preq(new AsyncRequest_t);
+
+	preq->cmd = ASYNC_DISABLE;
+	preq->ech = ech;
+	return AsyncPost(preq, cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncSet(
+		const RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Constraint_t* constraints,
+		uint8_t count,
+		RTLIB_Async_Callback cb, void *data) {
+	pAsyncRequest_t preq;
+
+	// At least 1 constraint it is expected
+	if (!count || !constraints)
+		return 0;
+
+	preq = pAsyncRequest_t(new AsyncRequest_t);
+	preq->cmd = ASYNC_SET;
+	preq->ech = ech;
+	preq->constraints.assign(constraints, constraints + count);
+	return AsyncPost(preq, cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncClear(
+		const RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	pAsyncRequest_t preq(new AsyncRequest_t);
+
+	preq->cmd = ASYNC_CLEAR;
+	preq->ech = ech;
+	return AsyncPost(preq, cb, data);
+}
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncGGap(
+		const RTLIB_ExecutionContextHandler_t ech,
+		uint8_t percent,
+		RTLIB_Async_Callback cb, void *data) {
+	pAsyncRequest_t preq;
+
+	// Enforce the Goal-Gap domain
+	if (unlikely(percent > 100)) {
+		fprintf(stderr, FE("Set Gaol-Gap for EXC [%p] "
+				"(Error: out-of-bound)\n"), (void*)ech);
+		return 0;
+	}
+
+	preq = pAsyncRequest_t(new AsyncRequest_t);
+	preq->cmd = ASYNC_GGAP;
+	preq->ech = ech;
+	preq->gap = percent;
+	return AsyncPost(preq, cb, data);
+}
+
+RTLIB_ExitCode_t BbqueRPC::AsyncWait(
+		RTLIB_AsyncToken_t token,
+		uint32_t timeout_ms) {
+	std::unique_lock<std::mutex> async_ul(async_mtx);
+	std::map<RTLIB_AsyncToken_t, AsyncResult_t>::iterator it;
+	RTLIB_ExitCode_t result;
+
+	it = asyncResults.find(token);
+	if (it == asyncResults.end()) {
+		fprintf(stderr, FE("Waiting request [%u] FAILED "
+				"(Error: unknown token)\n"), token);
+		return RTLIB_ERROR;
+	}
+
+	while (!(*it).second.done) {
+		if (!timeout_ms) {
+			asyncResults_cv.wait(async_ul);
+			continue;
+		}
+		if (asyncResults_cv.wait_for(async_ul,
+				std::chrono::milliseconds(timeout_ms)) ==
+				std::cv_status::timeout)
+			break;
+	}
+
+	if (!(*it).second.done)
+		return RTLIB_BBQUE_CHANNEL_TIMEOUT;
+
+	result = (*it).second.result;
+	asyncResults.erase(it);
+	return result;
+}
+
+/**
+ * @brief Look for a constraint on the same AWM bound
+ */
+static std::vector<RTLIB_Constraint_t>::iterator AsyncFindConstraint(
+		std::vector<RTLIB_Constraint_t> & constraints,
+		RTLIB_Constraint_t const & c) {
+	std::vector<RTLIB_Constraint_t>::iterator cit;
+
+	for (cit = constraints.begin(); cit != constraints.end(); ++cit)
+		if (((*cit).awm == c.awm) && ((*cit).type == c.type))
+			break;
+	return cit;
+}
+
+BbqueRPC::pAsyncRequest_t BbqueRPC::AsyncCoalesce(pAsyncRequest_t preq) {
+	std::list<pAsyncRequest_t>::iterator it;
+	std::vector<RTLIB_Constraint_t>::iterator cit;
+	pAsyncRequest_t pqueued;
+	size_t added;
+
+	// Look-up, starting from the last one, the requests queued for the
+	// same EXC. Goal-Gap and constraints are independent, thus they
+	// could be coalesced across each others, but not across an
+	// Enable/Disable command, which must be executed in order.
+	for (it = asyncQueue.end(); it != asyncQueue.begin(); ) {
+		pqueued = *(--it);
+		if (pqueued->ech != preq->ech)
+			continue;
+		if ((pqueued->cmd == ASYNC_ENABLE) ||
+				(pqueued->cmd == ASYNC_DISABLE))
+			break;
+
+		switch (preq->cmd) {
+		case ASYNC_GGAP:
+			// Only the latest Goal-Gap is relevant
+			if (pqueued->cmd != ASYNC_GGAP)
+				continue;
+			pqueued->gap = preq->gap;
+			return pqueued;
+
+		case ASYNC_SET:
+			// Constraints could not be moved before a Clear
+			if (pqueued->cmd == ASYNC_CLEAR)
+				return pAsyncRequest_t();
+			if (pqueued->cmd != ASYNC_SET)
+				continue;
+			// The merged constraints are sent by a single Set, thus
+			// they must not exceed its count range: otherwise the
+			// new request is queued after the current one
+			added = 0;
+			for (size_t i = 0; i < preq->constraints.size(); ++i)
+				if (AsyncFindConstraint(pqueued->constraints,
+						preq->constraints[i]) ==
+						pqueued->constraints.end())
+					++added;
+			if (pqueued->constraints.size() + added > UINT8_MAX)
+				return pAsyncRequest_t();
+			// Only the latest operation on the same AWM bound is
+			// relevant, thus that one is updated in place
+			for (size_t i = 0; i < preq->constraints.size(); ++i) {
+				RTLIB_Constraint_t & c(preq->constraints[i]);
+				cit = AsyncFindConstraint(pqueued->constraints, c);
+				if (cit != pqueued->constraints.end())
+					(*cit) = c;
+				else
+					pqueued->constraints.push_back(c);
+			}
+			return pqueued;
+
+		case ASYNC_CLEAR:
+			// Constraints still queued are going to be cleared,
+			// thus the previous Set/Clear requests are dropped, and
+			// their waiters notified on the new Clear completion
+			if (pqueued->cmd == ASYNC_GGAP)
+				continue;
+			preq->waiters.insert(preq->waiters.begin(),
+					pqueued->waiters.begin(),
+					pqueued->waiters.end());
+			it = asyncQueue.erase(it);
+			continue;
+
+		default:
+			break;
+		}
+		break;
+	}
+
+	return pAsyncRequest_t();
+}
+
+RTLIB_AsyncToken_t BbqueRPC::AsyncPost(pAsyncRequest_t preq,
+		RTLIB_Async_Callback cb, void *data) {
+	std::unique_lock<std::mutex> async_ul(async_mtx);
+	AsyncWaiter_t waiter;
+	pAsyncRequest_t pqueued;
+
+	if (!getRegistered(preq->ech)) {
+		fprintf(stderr, FE("Asynchronous request [%d] for EXC [%p] "
+				"FAILED (Error: EXC not registered)\n"),
+				preq->cmd, (void*)preq->ech);
+		return 0;
+	}
+
+	if (asyncDone) {
+		fprintf(stderr, FE("Asynchronous request [%d] for EXC [%p] "
+				"FAILED (Error: RTLib exiting)\n"),
+				preq->cmd, (void*)preq->ech);
+		return 0;
+	}
+
+	// Start the requests thread on first use
+	if (!asyncTrd.joinable())
+		asyncTrd = std::thread(&BbqueRPC::AsyncTrd, this);
+
+	// Get a new (not null) token
+	if (unlikely(++asyncToken == 0))
+		++asyncToken;
+	waiter.token = asyncToken;
+	waiter.cb = cb;
+	waiter.data = data;
+	if (!cb) {
+		asyncResults[waiter.token].done = false;
+		asyncResults[waiter.token].result = RTLIB_ERROR;
+	}
+
+	// Coalesce the request with a queued one, or queue it
+	pqueued = AsyncCoalesce(preq);
+	if (pqueued) {
+		DB(fprintf(stderr, FD("Asynchronous request [%u:%d] "
+				"coalesced\n"), waiter.token, preq->cmd));
+		pqueued->waiters.push_back(waiter);
+		return waiter.token;
+	}
+
+	preq->waiters.push_back(waiter);
+	asyncQueue.push_back(preq);
+	asyncQueue_cv.notify_one();
+
+	return waiter.token;
+}
+
+void BbqueRPC::AsyncTrd() {
+	std::unique_lock<std::mutex> async_ul(async_mtx);
+	std::map<RTLIB_AsyncToken_t, AsyncResult_t>::iterator rit;
+	RTLIB_ExitCode_t result = RTLIB_OK;
+	pAsyncRequest_t preq;
+
+	// Set the thread name
+	if (unlikely(prctl(PR_SET_NAME, (long unsigned int)"bq.async", 0, 0, 0)))
+		fprintf(stderr, FW("Set name FAILED! (Error: %s)\n"),
+				strerror(errno));
+
+	DB(fprintf(stderr, FD("Asynchronous requests thread START\n")));
+
+	while (!asyncQueue.empty() || !asyncDone) {
+
+		if (asyncQueue.empty()) {
+			asyncQueue_cv.wait(async_ul);
+			continue;
+		}
+
+		// Get the next request, which could not be coalesced anymore
+		preq = asyncQueue.front();
+		asyncQueue.pop_front();
+		async_ul.unlock();
+
+		switch (preq->cmd) {
+		case ASYNC_ENABLE:
+			result = Enable(preq->ech);
+			break;
+		case ASYNC_DISABLE:
+			result = Disable(preq->ech);
+			break;
+		case ASYNC_SET:
+			result = Set(preq->ech, &preq->constraints[0],
+					preq->constraints.size());
+			break;
+		case ASYNC_CLEAR:
+			result = Clear(preq->ech);
+			break;
+		case ASYNC_GGAP:
+			result = GGap(preq->ech, preq->gap);
+			break;
+		}
+
+		// Notify the completion to all the waiters
+		for (size_t i = 0; i < preq->waiters.size(); ++i) {
+			AsyncWaiter_t & waiter(preq->waiters[i]);
+			if (waiter.cb)
+				waiter.cb(preq->ech, waiter.token, result,
+						waiter.data);
+		}
+
+		async_ul.lock();
+		for (size_t i = 0; i < preq->waiters.size(); ++i) {
+			if (preq->waiters[i].cb)
+				continue;
+			rit = asyncResults.find(preq->waiters[i].token);
+			if (rit == asyncResults.end())
+				continue;
+			(*rit).second.done = true;
+			(*rit).second.result = result;
+			asyncCompleted.push_back(preq->waiters[i].token);
+		}
+		asyncResults_cv.notify_all();
+
+		// Drop the oldest results never waited for
+		while (asyncCompleted.size() > BBQUE_RTLIB_ASYNC_RESULTS) {
+			asyncResults.erase(asyncCompleted.front());
+			asyncCompleted.pop_front();
+		}
+	}
+
+	DB(fprintf(stderr, FD("Asynchronous requests thread END\n")));
+}
+
+void BbqueRPC::AsyncStop() {
+	std::unique_lock<std::mutex> async_ul(async_mtx);
+
+	if (!asyncTrd.joinable())
+		return;
+
+	// Send all the queued requests before exiting
+	asyncDone = true;
+	asyncQueue_cv.notify_one();
+	async_ul.unlock();
+
+	asyncTrd.join();
+}
+
 RTLIB_ExitCode_t BbqueRPC::StopExecution(
 		RTLIB_ExecutionContextHandler_t ech,
 		struct timespec timeout) {
@@ -1516,6 +2185,9 @@ void BbqueRPC::PerfSetupStats(pregExCtx_t prec, pAwmStats_t pstats) {
 		assert(ppes);
 		ppes->id = fd;
 		ppes->pattr = ppea;
+		ppes->live_idx = statsRing ?
+			LiveStatsCounter(bu::Perf::EventName(ppea->type, ppea->config)) :
+			-1;
 
 		// Keep track of perf statistics for this AWM
 		pstats->events_map[fd] = ppes;
@@ -1528,7 +2200,7 @@ void BbqueRPC::PerfSetupStats(pregExCtx_t prec, pAwmStats_t pstats) {
 
 }
 
-void BbqueRPC::PerfCollectStats(pregExCtx_t prec) {
+void BbqueRPC::PerfCollectStats(pregExCtx_t prec, uint32_t cycles) {
 	std::unique_lock<std::mutex> stats_ul(prec->pAwmStats->stats_mtx);
 	pAwmStats_t pstats = prec->pAwmStats;
 	PerfEventStatsMap_t::iterator it;
@@ -1536,6 +2208,9 @@ void BbqueRPC::PerfCollectStats(pregExCtx_t prec) {
 	uint64_t delta;
 	int fd;
 
+	// Update all the perf counters at once
+	prec->perf.Update();
+
 	// Collect counters for registered events
 	it = pstats->events_map.begin();
 	for ( ; it != pstats->events_map.end(); ++it) {
@@ -1543,15 +2218,116 @@ void BbqueRPC::PerfCollectStats(pregExCtx_t prec) {
 		fd = (*it).first;
 
 		// Reading delta for this perf counter
-		delta = prec->perf.Update(fd);
+		delta = prec->perf.Read(fd);
 
-		// Computing stats for this counter
-		ppes->value += delta;
+		// Computing stats for this counter, each sample accounting
+		// for all the cycles elapsed since the previous one
+		ppes->value += delta * cycles;
 		ppes->samples(delta);
+
+		// Export the counter
+		if (ppes->live_idx >= 0)
+			prec->live_perf[ppes->live_idx] += delta * cycles;
 	}
 
 }
 
+void BbqueRPC::PerfSampleBegin(pregExCtx_t prec) {
+
+	if (!envPerfSampling) {
+		PerfEnable(prec);
+		return;
+	}
+
+	// Skip this cycle, if not the first one of the sampling period
+	++prec->perf_cycles;
+	prec->perf_sampling = (prec->perf_skip == 0);
+	if (!prec->perf_sampling) {
+		--prec->perf_skip;
+		return;
+	}
+	prec->perf_skip = prec->perf_period - 1;
+
+	prec->perf_tmr.start();
+	PerfEnable(prec);
+	prec->perf_ovh = prec->perf_tmr.getElapsedTimeMs();
+}
+
+void BbqueRPC::PerfSampleEnd(pregExCtx_t prec) {
+	pAwmStats_t pstats(prec->pAwmStats);
+	double cycle_ms = 0;
+	uint32_t period;
+
+	if (!envPerfSampling) {
+		PerfDisable(prec);
+		PerfCollectStats(prec, 1);
+		return;
+	}
+
+	if (!prec->perf_sampling)
+		return;
+
+	// The sample accounts for all the cycles actually skipped, which
+	// could differ from the sampling period when that has been tuned
+	prec->perf_tmr.start();
+	PerfDisable(prec);
+	PerfCollectStats(prec, prec->perf_cycles);
+	prec->perf_cycles = 0;
+	prec->perf_ovh += prec->perf_tmr.getElapsedTimeMs();
+
+	// Smooth the measured overhead
+	if (prec->perf_ovh_avg == 0)
+		prec->perf_ovh_avg = prec->perf_ovh;
+	prec->perf_ovh_avg = 0.9 * prec->perf_ovh_avg + 0.1 * prec->perf_ovh;
+
+	// The average cycle time of the current AWM
+	if (pstats) {
+		std::unique_lock<std::mutex> stats_ul(pstats->stats_mtx);
+		if (count(pstats->samples))
+			cycle_ms = mean(pstats->samples);
+	}
+	if (cycle_ms <= 0)
+		return;
+
+	// Tune the sampling period to keep the overhead within the target
+	period = ceil((100.0 * prec->perf_ovh_avg) /
+			(envPerfSampling * cycle_ms));
+	if (period < 1)
+		period = 1;
+	if (period > BBQUE_RTLIB_PERF_SAMPLING_MAX)
+		period = BBQUE_RTLIB_PERF_SAMPLING_MAX;
+
+	if (period != prec->perf_period) {
+		DB(fprintf(stderr, FD("Perf sampling period [%u => %u] cycles "
+						"(overhead %.3f[ms], cycle %.3f[ms])\n"),
+					prec->perf_period, period,
+					prec->perf_ovh_avg, cycle_ms));
+		// Keep the sampled cycles evenly spaced
+		if (prec->perf_skip > period - 1)
+			prec->perf_skip = period - 1;
+		prec->perf_period = period;
+	}
+}
+
+void BbqueRPC::PerfPrintSampling(pregExCtx_t prec) {
+
+	if (!envPerfSampling)
+		return;
+
+	if (envMOSTOutput) {
+		DUMP_MOST_METRIC("perf", "sampling_period",
+				prec->perf_period, "%u");
+		DUMP_MOST_METRIC("perf", "sampling_ovh_ms",
+				prec->perf_ovh_avg, "%.6f");
+		return;
+	}
+
+	fprintf(stderr, "\n Sampled 1 every %u cycles "
+			"(overhead %.3f[ms], target %.2f%%)\n",
+			prec->perf_period, prec->perf_ovh_avg,
+			envPerfSampling);
+}
+
 void BbqueRPC::PerfPrintNsec(pAwmStats_t pstats, pPerfEventStats_t ppes) {
 	pPerfEventAttr_t ppea = ppes->pattr;
 	double avg = mean(ppes->samples);
@@ -2069,7 +2845,7 @@ void BbqueRPC::NotifyExit(
 
 	if (envGlobal && PerfRegisteredEvents(prec)) {
 		PerfDisable(prec);
-		PerfCollectStats(prec);
+		PerfCollectStats(prec, 1);
 	}
 
 }
@@ -2105,9 +2881,9 @@ void BbqueRPC::NotifyPreRun(
 	if (!envGlobal && PerfRegisteredEvents(prec)) {
 		if (unlikely(envOverheads)) {
 			PerfDisable(prec);
-			PerfCollectStats(prec);
+			PerfCollectStats(prec, 1);
 		} else {
-			PerfEnable(prec);
+			PerfSampleBegin(prec);
 		}
 	}
 
@@ -2134,8 +2910,7 @@ void BbqueRPC::NotifyPostRun(
 		if (unlikely(envOverheads)) {
 			PerfEnable(prec);
 		} else {
-			PerfDisable(prec);
-			PerfCollectStats(prec);
+			PerfSampleEnd(prec);
 		}
 	}
 
@@ -2162,6 +2937,9 @@ void BbqueRPC::NotifyPostMonitor(
 
 	DB(fprintf(stderr, FD("<=== NotifyMonitor\n")));
 
+	// Send the requests queued during this cycle
+	_Flush();
+
 	// CPS Enforcing
 	if (prec->cps_expect != 0)
 		ForceCPS(prec);
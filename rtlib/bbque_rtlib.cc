@@ -96,6 +96,48 @@ static RTLIB_ExitCode_t rtlib_ggap(
 	return rpc->GGap(ech, gap);
 }
 
+/*******************************************************************************
+ *    Asynchronous Control Support
+ ******************************************************************************/
+
+static RTLIB_AsyncToken_t rtlib_async_enable(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	return rpc->AsyncEnable(ech, cb, data);
+}
+
+static RTLIB_AsyncToken_t rtlib_async_disable(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	return rpc->AsyncDisable(ech, cb, data);
+}
+
+static RTLIB_AsyncToken_t rtlib_async_set(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Constraint_t *constraints, uint8_t count,
+		RTLIB_Async_Callback cb, void *data) {
+	return rpc->AsyncSet(ech, constraints, count, cb, data);
+}
+
+static RTLIB_AsyncToken_t rtlib_async_clear(
+		RTLIB_ExecutionContextHandler_t ech,
+		RTLIB_Async_Callback cb, void *data) {
+	return rpc->AsyncClear(ech, cb, data);
+}
+
+static RTLIB_AsyncToken_t rtlib_async_ggap(
+		RTLIB_ExecutionContextHandler_t ech,
+		uint8_t gap,
+		RTLIB_Async_Callback cb, void *data) {
+	return rpc->AsyncGGap(ech, gap, cb, data);
+}
+
+static RTLIB_ExitCode_t rtlib_async_wait(
+		RTLIB_AsyncToken_t token,
+		uint32_t timeout_ms) {
+	return rpc->AsyncWait(token, timeout_ms);
+}
+
 /*******************************************************************************
  *    Utility Functions
  ******************************************************************************/
@@ -255,6 +297,14 @@ RTLIB_ExitCode_t RTLIB_Init(const char *name, RTLIB_Services_t **rtlib) {
 	rtlib_services.Notify.PostResume = rtlib_notify_post_resume;
 	rtlib_services.Notify.Release = rtlib_notify_release;
 
+	// Asynchronous Control interface
+	rtlib_services.Async.Enable = rtlib_async_enable;
+	rtlib_services.Async.Disable = rtlib_async_disable;
+	rtlib_services.Async.SetConstraints = rtlib_async_set;
+	rtlib_services.Async.ClearConstraints = rtlib_async_clear;
+	rtlib_services.Async.SetGoalGap = rtlib_async_ggap;
+	rtlib_services.Async.Wait = rtlib_async_wait;
+
 	// Building a communication channel
 	rpc = br::BbqueRPC::GetInstance();
 	if (!rpc) {
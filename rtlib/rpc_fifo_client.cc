@@ -23,6 +23,7 @@
 
 #include <sys/prctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -45,22 +46,35 @@ DB(fprintf(stderr, FD("Tx [" #RPC_MSG "] Request "\
 	rf_ ## RPC_MSG.pyl.hdr.exc_id,\
 	SIZE\
 ));\
-if(::write(server_fifo_fd, (void*)&rf_ ## RPC_MSG, SIZE) <= 0) {\
-	fprintf(stderr, FE("write to BBQUE fifo FAILED [%s]\n"),\
-		bbque_fifo_path.c_str());\
-	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;\
-}
+if (ChannelSend((void*)&rf_ ## RPC_MSG, SIZE) != RTLIB_OK)\
+	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
 
 #define RPC_FIFO_SEND(RPC_MSG)\
 	RPC_FIFO_SEND_SIZE(RPC_MSG, FIFO_PKT_SIZE(RPC_MSG))
 
+#define RPC_FIFO_QUEUE_SIZE(RPC_MSG, SIZE, REPLACE)\
+DB(fprintf(stderr, FD("Queue [" #RPC_MSG "] Request "\
+				"RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "], Bytes: %" PRIu32 "...\n"),\
+	rf_ ## RPC_MSG.pyl.hdr.typ,\
+	rf_ ## RPC_MSG.pyl.hdr.app_pid,\
+	rf_ ## RPC_MSG.pyl.hdr.exc_id,\
+	SIZE\
+));\
+rf_ ## RPC_MSG.pyl.hdr.token |= RPC_MSG_TOKEN_PIPELINED;\
+if (ChannelQueue((void*)&rf_ ## RPC_MSG, SIZE, REPLACE) != RTLIB_OK)\
+	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+
+#define RPC_FIFO_QUEUE(RPC_MSG, REPLACE)\
+	RPC_FIFO_QUEUE_SIZE(RPC_MSG, FIFO_PKT_SIZE(RPC_MSG), REPLACE)
+
 
 namespace bbque { namespace rtlib {
 
 BbqueRPC_FIFO_Client::BbqueRPC_FIFO_Client() :
 	BbqueRPC(),
 	app_fifo_path(BBQUE_PATH_VAR "/"),
-	bbque_fifo_path(BBQUE_PATH_VAR "/" BBQUE_PUBLIC_FIFO) {
+	bbque_fifo_path(BBQUE_PATH_VAR "/" BBQUE_PUBLIC_FIFO),
+	txQueued(0) {
 
 	DB(fprintf(stderr, FD("Building FIFO RPC channel\n")));
 }
@@ -113,21 +127,129 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::ChannelRelease() {
 
 }
 
+RTLIB_ExitCode_t BbqueRPC_FIFO_Client::ChannelSend(const void *buf,
+		size_t count) {
+	std::unique_lock<std::mutex> chSend_ul(chSend_mtx);
+	struct iovec iov[2];
+	int iovcnt = 0;
+
+	// Send the queued messages, all together with this one if the write
+	// could still be atomic
+	if (txQueued && (txQueued + count > PIPE_BUF)) {
+		if (::write(server_fifo_fd, txQueue, txQueued) <= 0)
+			goto exit_write_failed;
+		txQueued = 0;
+	}
+	if (txQueued) {
+		iov[iovcnt].iov_base = txQueue;
+		iov[iovcnt++].iov_len = txQueued;
+		txQueued = 0;
+	}
+	iov[iovcnt].iov_base = (void*)buf;
+	iov[iovcnt++].iov_len = count;
+
+	if (::writev(server_fifo_fd, iov, iovcnt) <= 0)
+		goto exit_write_failed;
+
+	return RTLIB_OK;
+
+exit_write_failed:
+	fprintf(stderr, FE("write to BBQUE fifo FAILED [%s]\n"),
+		bbque_fifo_path.c_str());
+	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+}
+
+RTLIB_ExitCode_t BbqueRPC_FIFO_Client::ChannelQueue(const void *buf,
+		size_t count, bool replace) {
+	std::unique_lock<std::mutex> chSend_ul(chSend_mtx);
+	const rpc_fifo_GENERIC_t *msg = (const rpc_fifo_GENERIC_t*)buf;
+	rpc_fifo_GENERIC_t *queued;
+	size_t offset;
+
+	// Look-up for an already queued message to update
+	for (offset = 0; replace && (offset < txQueued);
+			offset += queued->hdr.fifo_msg_size) {
+		queued = (rpc_fifo_GENERIC_t*)(txQueue + offset);
+		if ((queued->hdr.rpc_msg_type != msg->hdr.rpc_msg_type) ||
+				(queued->pyl.exc_id != msg->pyl.exc_id) ||
+				(queued->hdr.fifo_msg_size != count))
+			continue;
+		DB(fprintf(stderr, FD("Replacing queued request [typ: %d, "
+						"eid: %" PRIu8 "]\n"),
+					msg->pyl.typ, msg->pyl.exc_id));
+		::memcpy(queued, buf, count);
+		return RTLIB_OK;
+	}
+
+	// Make room for the new message, by flushing the queue
+	if (txQueued + count > PIPE_BUF) {
+		if (txQueued && (::write(server_fifo_fd, txQueue, txQueued) <= 0)) {
+			fprintf(stderr, FE("write to BBQUE fifo FAILED [%s]\n"),
+				bbque_fifo_path.c_str());
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		}
+		txQueued = 0;
+	}
+
+	// Messages bigger than the queue are sent right away
+	if (count > PIPE_BUF) {
+		chSend_ul.unlock();
+		return ChannelSend(buf, count);
+	}
+
+	::memcpy(txQueue + txQueued, buf, count);
+	txQueued += count;
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_Flush() {
+	std::unique_lock<std::mutex> chSend_ul(chSend_mtx);
+
+	if (!txQueued)
+		return RTLIB_OK;
+
+	DB(fprintf(stderr, FD("Flushing [%" PRIu64 "] queued Bytes...\n"),
+				(uint64_t)txQueued));
+
+	if (::write(server_fifo_fd, txQueue, txQueued) <= 0) {
+		fprintf(stderr, FE("write to BBQUE fifo FAILED [%s]\n"),
+			bbque_fifo_path.c_str());
+		txQueued = 0;
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+	}
+
+	txQueued = 0;
+	return RTLIB_OK;
+}
+
 void BbqueRPC_FIFO_Client::RpcBbqResp() {
-	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_resp_t resp;
 	size_t bytes;
 
 	// Read response RPC header
-	bytes = ::read(client_fifo_fd, (void*)&chResp, RPC_PKT_SIZE(resp));
+	bytes = ::read(client_fifo_fd, (void*)&resp, RPC_PKT_SIZE(resp));
 	if (bytes<=0) {
 		fprintf(stderr, FE("FAILED read from app fifo [%s] "
 					"(Error %d: %s)\n"),
 				app_fifo_path.c_str(),
 				errno, strerror(errno));
-		chResp.result = RTLIB_BBQUE_CHANNEL_READ_FAILED;
+		resp.hdr.token = RpcMsgToken();
+		resp.result = RTLIB_BBQUE_CHANNEL_READ_FAILED;
+	}
+
+	// Pipelined requests are not waiting for a response, which is
+	// received just in case of failures
+	if (resp.hdr.token & RPC_MSG_TOKEN_PIPELINED) {
+		fprintf(stderr, FW("Pipelined request for EXC [%d] FAILED "
+					"(Error %d: %s)\n"),
+				resp.hdr.exc_id, resp.result,
+				RTLIB_ErrorStr((RTLIB_ExitCode_t)resp.result));
+		return;
 	}
 
 	// Notify about reception of a new response
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	chResp = resp;
 	DB(fprintf(stderr, FI("Notify response [%d]\n"), chResp.result));
 	chResp_cv.notify_one();
 }
@@ -525,6 +647,7 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_Set(pregExCtx_t prec,
 	// Here the message is dynamically allocate to make room for a variable
 	// number of constraints...
 	rpc_fifo_EXC_SET_t *prf_EXC_SET;
+	RTLIB_ExitCode_t result;
 	size_t msg_size;
 
 	// At least 1 constraint it is expected
@@ -558,14 +681,25 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_Set(pregExCtx_t prec,
 			(count)*sizeof(RTLIB_Constraint_t));
 
 	// Sending RPC Request
-	volatile rpc_fifo_EXC_SET_t & rf_EXC_SET = (*prf_EXC_SET);
 	DB(fprintf(stderr, FD("Set [%d] constraints on EXC [%d:%d]...\n"),
-				count, rf_EXC_SET.pyl.hdr.app_pid,
-				rf_EXC_SET.pyl.hdr.exc_id));
-	RPC_FIFO_SEND_SIZE(EXC_SET, msg_size);
-
-	// Clean-up the FIFO message
+				count, prf_EXC_SET->pyl.hdr.app_pid,
+				prf_EXC_SET->pyl.hdr.exc_id));
+
+	// The FIFO message is released before checking the result, since it
+	// is copied by both the queueing and the sending
+	if (envPipelined) {
+		// Constraints are accumulated, thus they are all queued
+		prf_EXC_SET->pyl.hdr.token |= RPC_MSG_TOKEN_PIPELINED;
+		result = ChannelQueue((void*)prf_EXC_SET, msg_size, false);
+		::free(prf_EXC_SET);
+		if (result != RTLIB_OK)
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		return RTLIB_OK;
+	}
+	result = ChannelSend((void*)prf_EXC_SET, msg_size);
 	::free(prf_EXC_SET);
+	if (result != RTLIB_OK)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
 
 	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
 
@@ -627,6 +761,12 @@ RTLIB_ExitCode_t BbqueRPC_FIFO_Client::_GGap(pregExCtx_t prec, uint8_t gap) {
 				rf_EXC_GGAP.pyl.hdr.app_pid,
 				rf_EXC_GGAP.pyl.hdr.exc_id));
 
+	// Only the last Goal-Gap is relevant, thus a queued one is updated
+	if (envPipelined) {
+		RPC_FIFO_QUEUE(EXC_GGAP, true);
+		return RTLIB_OK;
+	}
+
 	// Sending RPC Request
 	RPC_FIFO_SEND(EXC_GGAP);
 
@@ -0,0 +1,752 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/rtlib/rpc_shm_client.h"
+
+#include "bbque/rtlib/rpc_messages.h"
+#include "bbque/utils/utility.h"
+#include "bbque/config.h"
+
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+// Setup logging
+#undef  BBQUE_LOG_MODULE
+#define BBQUE_LOG_MODULE "rpc.shm"
+#undef  BBQUE_LOG_UID
+#define BBQUE_LOG_UID GetChUid()
+
+/** The maximum time [ms] the channel thread waits before checking for exit */
+#define RPC_SHM_FETCH_TIMEOUT 100
+
+#define RPC_SHM_SEND_SIZE(RPC_MSG, SIZE)\
+DB(fprintf(stderr, FD("Tx [" #RPC_MSG "] Request "\
+				"RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "], Bytes: %" PRIu32 "...\n"),\
+	rm_ ## RPC_MSG.hdr.typ,\
+	rm_ ## RPC_MSG.hdr.app_pid,\
+	rm_ ## RPC_MSG.hdr.exc_id,\
+	SIZE\
+));\
+if (ChannelSend((void*)&rm_ ## RPC_MSG, SIZE) != RTLIB_OK) {\
+	fprintf(stderr, FE("write to BBQUE segment FAILED [%s]\n"),\
+		BBQUE_PUBLIC_SHM);\
+	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;\
+}
+
+#define RPC_SHM_SEND(RPC_MSG)\
+	RPC_SHM_SEND_SIZE(RPC_MSG, RPC_PKT_SIZE(RPC_MSG))
+
+
+namespace bbque { namespace rtlib {
+
+BbqueRPC_SHM_Client::BbqueRPC_SHM_Client() :
+	BbqueRPC(),
+	server(NULL),
+	channel(NULL),
+	slot(-1),
+	cursor(0) {
+
+	DB(fprintf(stderr, FD("Building SHM RPC channel\n")));
+}
+
+BbqueRPC_SHM_Client::~BbqueRPC_SHM_Client() {
+	DB(fprintf(stderr, FD("BbqueRPC_SHM_Client dtor\n")));
+	ChannelRelease();
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelRelease() {
+	rpc_msg_APP_EXIT_t rm_APP_EXIT = {
+		{
+			RPC_APP_EXIT,
+			RpcMsgToken(),
+			chTrdPid,
+			0
+		}
+	};
+	int error;
+
+	// Already released (or never set up)
+	if (!channel)
+		return RTLIB_OK;
+
+	DB(fprintf(stderr, FD("Releasing SHM RPC channel\n")));
+
+	// Sending RPC Request
+	// NOTE: once received, Barbeque detaches the segment and frees the slot
+	if (ChannelSend(&rm_APP_EXIT, RPC_PKT_SIZE(APP_EXIT)) != RTLIB_OK)
+		fprintf(stderr, FE("Notify BBQUE exit FAILED\n"));
+
+	// Stopping the Fetch Thread
+	done = true;
+	rpc_shm_futex_wake(&channel->resp.head);
+	if (ChTrd.joinable())
+		ChTrd.join();
+
+	// Releasing the private segment
+	::munmap(channel, sizeof(rpc_shm_channel_t));
+	::munmap(server, sizeof(rpc_shm_server_t));
+	channel = NULL;
+	server = NULL;
+	error = ::shm_unlink(app_shm_name);
+	if (error) {
+		fprintf(stderr, FE("FAILED unlinking the application segment [%s] "
+					"(Error %d: %s)\n"),
+				app_shm_name, errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_TEARDOWN_FAILED;
+	}
+	return RTLIB_OK;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelSend(const void *buf,
+		size_t count, const void *buf2, size_t count2) {
+	std::unique_lock<std::mutex> chSend_ul(chSend_mtx);
+	uint32_t waited_ms = 0;
+
+	// Wait for Barbeque draining a full ring, within the RPC timeout
+	while (!rpc_shm_ring_push(&channel->req, buf, count, buf2, count2)) {
+		if ((count + count2 > BBQUE_RPC_SHM_MSG_MAX) ||
+				(waited_ms >= BBQUE_RPC_TIMEOUT))
+			return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		++waited_ms;
+	}
+
+	// Ring the doorbell, and wake-up Barbeque only if it is waiting
+	__atomic_fetch_add(&server->doorbell, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&server->sleeping, __ATOMIC_SEQ_CST))
+		rpc_shm_futex_wake(&server->doorbell);
+
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SHM_Client::RpcBbqResp(rpc_msg_header_t *msg) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+
+	// Copy the response out of the ring
+	::memcpy(&chResp, msg, RPC_PKT_SIZE(resp));
+
+	// Notify about reception of a new response
+	DB(fprintf(stderr, FI("Notify response [%d]\n"), chResp.result));
+	chResp_cv.notify_one();
+}
+
+void BbqueRPC_SHM_Client::ChannelFetch() {
+	rpc_shm_record_t *rec;
+	rpc_msg_header_t *msg;
+	uint32_t size;
+	int result;
+
+	// Wait for the next message, checking for exit at least every
+	// RPC_SHM_FETCH_TIMEOUT [ms]
+	result = rpc_shm_ring_peek(&channel->resp, cursor, rec, size);
+	if (result == -EAGAIN) {
+		DB(fprintf(stderr, FD("Waiting for SHM record...\n")));
+		rpc_shm_ring_wait(&channel->resp, cursor, RPC_SHM_FETCH_TIMEOUT);
+		return;
+	}
+	if ((result == -EBADMSG) ||
+			(size < SHM_REC_SIZE(sizeof(rpc_msg_header_t)))) {
+		fprintf(stderr, FE("Responses ring corrupted, "
+					"channel stopped\n"));
+		done = true;
+		return;
+	}
+
+	// Messages are accessed in place, without any copy
+	msg = rpc_shm_record_msg(rec);
+	DB(fprintf(stderr, FD("Rx SHM_REC [sze: %u] "
+					"RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "]\n"),
+				size, msg->typ, msg->app_pid, msg->exc_id));
+
+	// Dispatching the received message
+	switch (msg->typ) {
+
+	//--- Application Originated Messages
+	case RPC_APP_RESP:
+		DB(fprintf(stderr, FI("APP_RESP\n")));
+		RpcBbqResp(msg);
+		break;
+
+	//--- Execution Context Originated Messages
+	case RPC_EXC_RESP:
+		DB(fprintf(stderr, FI("EXC_RESP\n")));
+		RpcBbqResp(msg);
+		break;
+
+	//--- Barbeque Originated Messages
+	case RPC_BBQ_STOP_EXECUTION:
+		DB(fprintf(stderr, FI("BBQ_STOP_EXECUTION\n")));
+		break;
+	case RPC_BBQ_SYNCP_PRECHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_PRECHANGE\n")));
+		SyncP_PreChangeNotify(*(rpc_msg_BBQ_SYNCP_PRECHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_SYNCCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_SYNCCHANGE\n")));
+		SyncP_SyncChangeNotify(*(rpc_msg_BBQ_SYNCP_SYNCCHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_DOCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_DOCHANGE\n")));
+		SyncP_DoChangeNotify(*(rpc_msg_BBQ_SYNCP_DOCHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_POSTCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_POSTCHANGE\n")));
+		SyncP_PostChangeNotify(*(rpc_msg_BBQ_SYNCP_POSTCHANGE_t *)msg);
+		break;
+
+	default:
+		fprintf(stderr, FE("Unknown BBQ response/command [%d]\n"),
+				msg->typ);
+		assert(false);
+		break;
+	}
+
+	// Give back the record space to Barbeque
+	rpc_shm_ring_release(&channel->resp, rec, cursor);
+}
+
+void BbqueRPC_SHM_Client::ChannelTrd(const char *name) {
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+
+	// Set the thread name
+	if (unlikely(prctl(PR_SET_NAME, (long unsigned int)"bq.shm", 0, 0, 0)))
+		fprintf(stderr, "Set name FAILED! (Error: %s)\n",
+				strerror(errno));
+
+	// Setup the RTLib UID
+	setChId(gettid(), name);
+	DB(fprintf(stderr, FI("channel thread [PID: %d] CREATED\n"),
+				chTrdPid));
+	// Notifying the thread has beed started
+	trdStatus_cv.notify_one();
+
+	// Waiting for channel setup to be completed
+	if (!running)
+		trdStatus_cv.wait(trdStatus_ul);
+
+	DB(fprintf(stderr, FI("channel thread [PID: %d] START\n"),
+				chTrdPid));
+	while (!done)
+		ChannelFetch();
+
+	DB(fprintf(stderr, FI("channel thread [PID: %d] END\n"),
+				chTrdPid));
+}
+
+#define WAIT_RPC_RESP \
+	chResp.result = RTLIB_BBQUE_CHANNEL_TIMEOUT; \
+	chResp_cv.wait_for(chCommand_ul, \
+			std::chrono::milliseconds(BBQUE_RPC_TIMEOUT)); \
+	if (chResp.result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {\
+		fprintf(stderr, FW("RTLIB response TIMEOUT\n")); \
+	}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelPair(const char *name) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_APP_PAIR_t rm_APP_PAIR = {
+		{
+			RPC_APP_PAIR,
+			RpcMsgToken(),
+			chTrdPid,
+			0
+		},
+		BBQUE_RPC_SHM_MAJOR_VERSION,
+		BBQUE_RPC_SHM_MINOR_VERSION,
+		"\0"
+	};
+	::strncpy(rm_APP_PAIR.app_name, name, RTLIB_APP_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Pairing SHM channel [app: %s, pid: %d, slot: %d]\n"),
+					name, chTrdPid, slot));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(APP_PAIR);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::ChannelSetup() {
+	RTLIB_ExitCode_t result = RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	void *addr;
+	pid_t free_slot;
+	int fd;
+
+	DB(fprintf(stderr, FI("Initializing channel\n")));
+
+	// Mapping server segment
+	DB(fprintf(stderr, FD("Opening bbque segment [%s]...\n"),
+				BBQUE_PUBLIC_SHM));
+	fd = ::shm_open(BBQUE_PUBLIC_SHM, O_RDWR, 0);
+	if (fd < 0) {
+		fprintf(stderr, FE("FAILED opening bbque segment [%s] "
+					"(Error %d: %s)\n"),
+				BBQUE_PUBLIC_SHM, errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+	addr = ::mmap(NULL, sizeof(rpc_shm_server_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, FE("FAILED mapping bbque segment [%s] "
+					"(Error %d: %s)\n"),
+				BBQUE_PUBLIC_SHM, errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+	server = (rpc_shm_server_t *)addr;
+
+	// Check the server is ready and speaking the same protocol
+	if ((__atomic_load_n(&server->magic, __ATOMIC_ACQUIRE) !=
+				BBQUE_RPC_SHM_MAGIC) ||
+			(server->major != BBQUE_RPC_SHM_MAJOR_VERSION)) {
+		fprintf(stderr, FE("Barbeque segment [%s] not valid\n"),
+				BBQUE_PUBLIC_SHM);
+		result = RTLIB_BBQUE_CHANNEL_PROTOCOL_MISMATCH;
+		goto err_server;
+	}
+
+	DB(fprintf(stderr, FD("Creating [%s]...\n"), app_shm_name));
+
+	// Creating the client side segment
+	::shm_unlink(app_shm_name);
+	fd = ::shm_open(app_shm_name, O_CREAT|O_EXCL|O_RDWR, 0660);
+	if (fd < 0) {
+		fprintf(stderr, FE("FAILED creating application segment [%s] "
+					"(Error %d: %s)\n"),
+				app_shm_name, errno, strerror(errno));
+		goto err_server;
+	}
+
+	// Ensuring the segment is R/W to the Barbeque group only
+	if (fchmod(fd, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP) ||
+			ftruncate(fd, sizeof(rpc_shm_channel_t))) {
+		fprintf(stderr,
+			FE("FAILED setting up application segment [%s] "
+				"(Error %d: %s)\n"),
+				app_shm_name, errno, strerror(errno));
+		::close(fd);
+		goto err_create;
+	}
+
+	addr = ::mmap(NULL, sizeof(rpc_shm_channel_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, FE("FAILED mapping application segment [%s] "
+					"(Error %d: %s)\n"),
+				app_shm_name, errno, strerror(errno));
+		goto err_create;
+	}
+	channel = (rpc_shm_channel_t *)addr;
+
+	// The segment is zero filled, i.e. empty rings
+	channel->major = BBQUE_RPC_SHM_MAJOR_VERSION;
+	channel->minor = BBQUE_RPC_SHM_MINOR_VERSION;
+	channel->app_pid = chTrdPid;
+	__atomic_store_n(&channel->magic, BBQUE_RPC_SHM_MAGIC,
+			__ATOMIC_RELEASE);
+	cursor = 0;
+
+	// Registering into a free slot
+	for (slot = 0; slot < BBQUE_RPC_SHM_CHANNELS; ++slot) {
+		free_slot = 0;
+		if (__atomic_compare_exchange_n(&server->slots[slot],
+					&free_slot, chTrdPid, false,
+					__ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+			break;
+	}
+	if (slot == BBQUE_RPC_SHM_CHANNELS) {
+		fprintf(stderr, FE("FAILED registering application segment "
+					"[%s] (Error: no free slots)\n"),
+				app_shm_name);
+		result = RTLIB_BBQUE_CHANNEL_UNAVAILABLE;
+		goto err_slot;
+	}
+
+	return RTLIB_OK;
+
+err_slot:
+	::munmap(channel, sizeof(rpc_shm_channel_t));
+	channel = NULL;
+	slot = -1;
+err_create:
+	::shm_unlink(app_shm_name);
+err_server:
+	::munmap(server, sizeof(rpc_shm_server_t));
+	server = NULL;
+	return result;
+
+}
+
+
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Init(
+			const char *name) {
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+	RTLIB_ExitCode_t result;
+	pid_t pid;
+
+	// Starting the communication thread
+	done = false;
+	running = false;
+	ChTrd = std::thread(&BbqueRPC_SHM_Client::ChannelTrd, this, name);
+	trdStatus_cv.wait(trdStatus_ul);
+
+	// Setting up application segment name
+	snprintf(app_shm_name, BBQUE_SHM_NAME_LENGTH,
+			BBQUE_SHM_CHANNEL_FMT, chTrdPid);
+
+	// Setting up the communication channel
+	result = ChannelSetup();
+	if (result != RTLIB_OK)
+		return result;
+
+	// Start the reception thread
+	running = true;
+	trdStatus_cv.notify_one();
+	trdStatus_ul.unlock();
+
+	// Pairing channel with server
+	result = ChannelPair(name);
+	if (result != RTLIB_OK) {
+		// Give back the slot, if not yet attached by Barbeque
+		pid = chTrdPid;
+		__atomic_compare_exchange_n(&server->slots[slot], &pid, 0,
+				false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+		::shm_unlink(app_shm_name);
+		return result;
+	}
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Register(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_REGISTER_t rm_EXC_REGISTER = {
+		{
+			RPC_EXC_REGISTER,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		"\0",
+		"\0"
+	};
+	::strncpy(rm_EXC_REGISTER.exc_name, prec->name.c_str(),
+			RTLIB_EXC_NAME_LENGTH);
+	::strncpy(rm_EXC_REGISTER.recipe, prec->exc_params.recipe,
+			RTLIB_EXC_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Registering EXC [%d:%d:%s]...\n"),
+				rm_EXC_REGISTER.hdr.app_pid,
+				rm_EXC_REGISTER.hdr.exc_id,
+				rm_EXC_REGISTER.exc_name));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_REGISTER);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Unregister(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_UNREGISTER_t rm_EXC_UNREGISTER = {
+		{
+			RPC_EXC_UNREGISTER,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		"\0"
+	};
+	::strncpy(rm_EXC_UNREGISTER.exc_name, prec->name.c_str(),
+			RTLIB_EXC_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Unregistering EXC [%d:%d:%s]...\n"),
+				rm_EXC_UNREGISTER.hdr.app_pid,
+				rm_EXC_UNREGISTER.hdr.exc_id,
+				rm_EXC_UNREGISTER.exc_name));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_UNREGISTER);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Enable(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_START_t rm_EXC_START = {
+		{
+			RPC_EXC_START,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Enabling EXC [%d:%d]...\n"),
+				rm_EXC_START.hdr.app_pid,
+				rm_EXC_START.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_START);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Disable(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_STOP_t rm_EXC_STOP = {
+		{
+			RPC_EXC_STOP,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Disabling EXC [%d:%d]...\n"),
+				rm_EXC_STOP.hdr.app_pid,
+				rm_EXC_STOP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_STOP);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Set(pregExCtx_t prec,
+			RTLIB_Constraint_t* constraints, uint8_t count) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_SET_t rm_EXC_SET;
+
+	// At least 1 constraint it is expected
+	assert(count);
+
+	// Init RPC header
+	rm_EXC_SET.hdr.typ = RPC_EXC_SET;
+	rm_EXC_SET.hdr.token = RpcMsgToken();
+	rm_EXC_SET.hdr.app_pid = chTrdPid;
+	rm_EXC_SET.hdr.exc_id = prec->exc_id;
+	rm_EXC_SET.count = count;
+
+	DB(fprintf(stderr, FD("Set [%d] constraints on EXC [%d:%d]...\n"),
+				count, rm_EXC_SET.hdr.app_pid,
+				rm_EXC_SET.hdr.exc_id));
+
+	// Sending RPC Request
+	// NOTE: the constraints are gathered right after the message header
+	// directly into the ring, thus without any temporary buffer
+	if (ChannelSend(&rm_EXC_SET, offsetof(rpc_msg_EXC_SET_t, constraints),
+				constraints,
+				count * sizeof(RTLIB_Constraint_t)) != RTLIB_OK) {
+		fprintf(stderr, FE("write to BBQUE segment FAILED [%s]\n"),
+			BBQUE_PUBLIC_SHM);
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+	}
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_Clear(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_CLEAR_t rm_EXC_CLEAR = {
+		{
+			RPC_EXC_CLEAR,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Clear constraints for EXC [%d:%d]...\n"),
+				rm_EXC_CLEAR.hdr.app_pid,
+				rm_EXC_CLEAR.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_CLEAR);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_GGap(pregExCtx_t prec, uint8_t gap) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_GGAP_t rm_EXC_GGAP = {
+		{
+			RPC_EXC_GGAP,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		gap,
+	};
+
+	DB(fprintf(stderr, FD("Set Goal-Gap for EXC [%d:%d]...\n"),
+				rm_EXC_GGAP.hdr.app_pid,
+				rm_EXC_GGAP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_GGAP);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_ScheduleRequest(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_SCHEDULE_t rm_EXC_SCHEDULE = {
+		{
+			RPC_EXC_SCHEDULE,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Schedule request for EXC [%d:%d]...\n"),
+				rm_EXC_SCHEDULE.hdr.app_pid,
+				rm_EXC_SCHEDULE.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(EXC_SCHEDULE);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+void BbqueRPC_SHM_Client::_Exit() {
+	ChannelRelease();
+}
+
+
+/******************************************************************************
+ * Synchronization Protocol Messages
+ ******************************************************************************/
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpPreChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, uint32_t syncLatency) {
+
+	rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t rm_BBQ_SYNCP_PRECHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		syncLatency,
+		RTLIB_OK
+	};
+
+	DB(fprintf(stderr, FD("PreChange response EXC [%d:%d] "
+					"latency [%d]...\n"),
+				rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.exc_id,
+				rm_BBQ_SYNCP_PRECHANGE_RESP.syncLatency));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_PRECHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpSyncChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, RTLIB_ExitCode_t sync) {
+
+	rpc_msg_BBQ_SYNCP_SYNCCHANGE_RESP_t rm_BBQ_SYNCP_SYNCCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		(uint8_t)sync
+	};
+
+	// Check that the ExitCode can be represented by the response message
+	assert(sync < 256);
+
+	DB(fprintf(stderr, FD("SyncChange response EXC [%d:%d]...\n"),
+				rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_SYNCCHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SHM_Client::_SyncpPostChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, RTLIB_ExitCode_t result) {
+
+	rpc_msg_BBQ_SYNCP_POSTCHANGE_RESP_t rm_BBQ_SYNCP_POSTCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		(uint8_t)result
+	};
+
+	// Check that the ExitCode can be represented by the response message
+	assert(result < 256);
+
+	DB(fprintf(stderr, FD("PostChange response EXC [%d:%d]...\n"),
+				rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SHM_SEND(BBQ_SYNCP_POSTCHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+} // namespace rtlib
+
+} // namespace bbque
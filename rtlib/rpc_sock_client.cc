@@ -0,0 +1,653 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bbque/rtlib/rpc_sock_client.h"
+
+#include "bbque/rtlib/rpc_messages.h"
+#include "bbque/utils/utility.h"
+#include "bbque/config.h"
+
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+// Setup logging
+#undef  BBQUE_LOG_MODULE
+#define BBQUE_LOG_MODULE "rpc.sck"
+#undef  BBQUE_LOG_UID
+#define BBQUE_LOG_UID GetChUid()
+
+#define RPC_SOCK_SEND_SIZE(RPC_MSG, SIZE)\
+DB(fprintf(stderr, FD("Tx [" #RPC_MSG "] Request "\
+				"RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "], Bytes: %" PRIu32 "...\n"),\
+	rm_ ## RPC_MSG.hdr.typ,\
+	rm_ ## RPC_MSG.hdr.app_pid,\
+	rm_ ## RPC_MSG.hdr.exc_id,\
+	SIZE\
+));\
+if (ChannelSend((void*)&rm_ ## RPC_MSG, SIZE) != RTLIB_OK) {\
+	fprintf(stderr, FE("write to BBQUE socket FAILED [%s]\n"),\
+		bbque_sock_path.c_str());\
+	return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;\
+}
+
+#define RPC_SOCK_SEND(RPC_MSG)\
+	RPC_SOCK_SEND_SIZE(RPC_MSG, RPC_PKT_SIZE(RPC_MSG))
+
+
+namespace bbque { namespace rtlib {
+
+BbqueRPC_SOCK_Client::BbqueRPC_SOCK_Client() :
+	BbqueRPC(),
+	bbque_sock_path(BBQUE_PATH_VAR "/" BBQUE_PUBLIC_SOCK),
+	sock_fd(-1) {
+
+	DB(fprintf(stderr, FD("Building SOCK RPC channel\n")));
+}
+
+BbqueRPC_SOCK_Client::~BbqueRPC_SOCK_Client() {
+	DB(fprintf(stderr, FD("BbqueRPC_SOCK_Client dtor\n")));
+	ChannelRelease();
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::ChannelRelease() {
+	rpc_msg_APP_EXIT_t rm_APP_EXIT = {
+		{
+			RPC_APP_EXIT,
+			RpcMsgToken(),
+			chTrdPid,
+			0
+		}
+	};
+
+	// Already released (or never set up)
+	if (sock_fd < 0)
+		return RTLIB_OK;
+
+	DB(fprintf(stderr, FD("Releasing SOCK RPC channel\n")));
+
+	// Sending RPC Request
+	if (ChannelSend(&rm_APP_EXIT, RPC_PKT_SIZE(APP_EXIT)) != RTLIB_OK)
+		fprintf(stderr, FE("Notify BBQUE exit FAILED\n"));
+
+	// Stopping the Fetch Thread, which gets an end-of-file
+	done = true;
+	::shutdown(sock_fd, SHUT_RDWR);
+	if (ChTrd.joinable())
+		ChTrd.join();
+
+	// Closing the connection
+	if (::close(sock_fd)) {
+		fprintf(stderr, FE("FAILED closing the connection [%s] "
+					"(Error %d: %s)\n"),
+				bbque_sock_path.c_str(), errno, strerror(errno));
+		sock_fd = -1;
+		return RTLIB_BBQUE_CHANNEL_TEARDOWN_FAILED;
+	}
+	sock_fd = -1;
+	return RTLIB_OK;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::ChannelSend(const void *buf,
+		size_t count, const void *buf2, size_t count2) {
+	struct iovec iov[2] = {
+		{ const_cast<void *>(buf), count },
+		{ const_cast<void *>(buf2), count2 }
+	};
+	struct msghdr msg;
+
+	// Each message is sent as a single packet, with a single system call,
+	// thus messages sent by different threads are never interleaved
+	::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count2 ? 2 : 1;
+	if (::sendmsg(sock_fd, &msg, MSG_NOSIGNAL) < 0)
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+
+	return RTLIB_OK;
+}
+
+void BbqueRPC_SOCK_Client::RpcBbqResp(rpc_msg_header_t *msg) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+
+	// Copy the response out of the ring
+	::memcpy(&chResp, msg, RPC_PKT_SIZE(resp));
+
+	// Notify about reception of a new response
+	DB(fprintf(stderr, FI("Notify response [%d]\n"), chResp.result));
+	chResp_cv.notify_one();
+}
+
+void BbqueRPC_SOCK_Client::ChannelFetch() {
+	uint64_t buff[(BBQUE_RPC_SOCK_MSG_MAX + 7) / 8];
+	rpc_msg_header_t *msg = (rpc_msg_header_t *)buff;
+	ssize_t bytes;
+
+	DB(fprintf(stderr, FD("Waiting for message...\n")));
+
+	// Read the next message
+	bytes = ::recv(sock_fd, buff, sizeof(buff), 0);
+	if (bytes <= 0) {
+		if ((bytes < 0) && (errno == EINTR))
+			return;
+		if (!done)
+			fprintf(stderr, FE("FAILED read from bbque socket [%s] "
+						"(Error %d: %s)\n"),
+					bbque_sock_path.c_str(),
+					errno, strerror(errno));
+		// Exit the read thread if we are unable to read from the Barbeque
+		// FIXME an error should be notified to the application
+		done = true;
+		return;
+	}
+
+	DB(fprintf(stderr, FD("Rx [sze: %d] "
+					"RPC_HDR [typ: %d, pid: %d, eid: %" PRIu8 "]\n"),
+				(int)bytes, msg->typ, msg->app_pid, msg->exc_id));
+
+	// Dispatching the received message
+	switch (msg->typ) {
+
+	//--- Application Originated Messages
+	case RPC_APP_RESP:
+		DB(fprintf(stderr, FI("APP_RESP\n")));
+		RpcBbqResp(msg);
+		break;
+
+	//--- Execution Context Originated Messages
+	case RPC_EXC_RESP:
+		DB(fprintf(stderr, FI("EXC_RESP\n")));
+		RpcBbqResp(msg);
+		break;
+
+	//--- Barbeque Originated Messages
+	case RPC_BBQ_STOP_EXECUTION:
+		DB(fprintf(stderr, FI("BBQ_STOP_EXECUTION\n")));
+		break;
+	case RPC_BBQ_SYNCP_PRECHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_PRECHANGE\n")));
+		SyncP_PreChangeNotify(*(rpc_msg_BBQ_SYNCP_PRECHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_SYNCCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_SYNCCHANGE\n")));
+		SyncP_SyncChangeNotify(*(rpc_msg_BBQ_SYNCP_SYNCCHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_DOCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_DOCHANGE\n")));
+		SyncP_DoChangeNotify(*(rpc_msg_BBQ_SYNCP_DOCHANGE_t *)msg);
+		break;
+	case RPC_BBQ_SYNCP_POSTCHANGE:
+		DB(fprintf(stderr, FI("BBQ_SYNCP_POSTCHANGE\n")));
+		SyncP_PostChangeNotify(*(rpc_msg_BBQ_SYNCP_POSTCHANGE_t *)msg);
+		break;
+
+	default:
+		fprintf(stderr, FE("Unknown BBQ response/command [%d]\n"),
+				msg->typ);
+		assert(false);
+		break;
+	}
+}
+
+void BbqueRPC_SOCK_Client::ChannelTrd(const char *name) {
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+
+	// Set the thread name
+	if (unlikely(prctl(PR_SET_NAME, (long unsigned int)"bq.sock", 0, 0, 0)))
+		fprintf(stderr, "Set name FAILED! (Error: %s)\n",
+				strerror(errno));
+
+	// Setup the RTLib UID
+	setChId(gettid(), name);
+	DB(fprintf(stderr, FI("channel thread [PID: %d] CREATED\n"),
+				chTrdPid));
+	// Notifying the thread has beed started
+	trdStatus_cv.notify_one();
+
+	// Waiting for channel setup to be completed
+	if (!running)
+		trdStatus_cv.wait(trdStatus_ul);
+
+	DB(fprintf(stderr, FI("channel thread [PID: %d] START\n"),
+				chTrdPid));
+	while (!done)
+		ChannelFetch();
+
+	DB(fprintf(stderr, FI("channel thread [PID: %d] END\n"),
+				chTrdPid));
+}
+
+#define WAIT_RPC_RESP \
+	chResp.result = RTLIB_BBQUE_CHANNEL_TIMEOUT; \
+	chResp_cv.wait_for(chCommand_ul, \
+			std::chrono::milliseconds(BBQUE_RPC_TIMEOUT)); \
+	if (chResp.result == RTLIB_BBQUE_CHANNEL_TIMEOUT) {\
+		fprintf(stderr, FW("RTLIB response TIMEOUT\n")); \
+	}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::ChannelPair(const char *name) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_APP_PAIR_t rm_APP_PAIR = {
+		{
+			RPC_APP_PAIR,
+			RpcMsgToken(),
+			chTrdPid,
+			0
+		},
+		BBQUE_RPC_SOCK_MAJOR_VERSION,
+		BBQUE_RPC_SOCK_MINOR_VERSION,
+		"\0"
+	};
+	::strncpy(rm_APP_PAIR.app_name, name, RTLIB_APP_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Pairing SOCK channel [app: %s, pid: %d]\n"),
+					name, chTrdPid));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(APP_PAIR);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::ChannelSetup() {
+	struct sockaddr_un addr;
+
+	DB(fprintf(stderr, FI("Initializing channel\n")));
+
+	if (bbque_sock_path.length() >= sizeof(addr.sun_path)) {
+		fprintf(stderr, FE("Bbque socket path [%s] too long\n"),
+				bbque_sock_path.c_str());
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	// Connecting to the server socket
+	DB(fprintf(stderr, FD("Connecting bbque socket [%s]...\n"),
+				bbque_sock_path.c_str()));
+	sock_fd = ::socket(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0);
+	if (sock_fd < 0) {
+		fprintf(stderr, FE("FAILED creating socket "
+					"(Error %d: %s)\n"),
+				errno, strerror(errno));
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::strncpy(addr.sun_path, bbque_sock_path.c_str(),
+			sizeof(addr.sun_path) - 1);
+	if (::connect(sock_fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		fprintf(stderr, FE("FAILED connecting bbque socket [%s] "
+					"(Error %d: %s)\n"),
+				bbque_sock_path.c_str(), errno, strerror(errno));
+		::close(sock_fd);
+		sock_fd = -1;
+		return RTLIB_BBQUE_CHANNEL_SETUP_FAILED;
+	}
+
+	return RTLIB_OK;
+
+}
+
+
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Init(
+			const char *name) {
+	std::unique_lock<std::mutex> trdStatus_ul(trdStatus_mtx);
+	RTLIB_ExitCode_t result;
+
+	// Starting the communication thread
+	done = false;
+	running = false;
+	ChTrd = std::thread(&BbqueRPC_SOCK_Client::ChannelTrd, this, name);
+	trdStatus_cv.wait(trdStatus_ul);
+
+	// Setting up the communication channel
+	result = ChannelSetup();
+	if (result != RTLIB_OK)
+		return result;
+
+	// Start the reception thread
+	running = true;
+	trdStatus_cv.notify_one();
+	trdStatus_ul.unlock();
+
+	// Pairing channel with server
+	// NOTE: on failures, the connection is closed by the ChannelRelease
+	result = ChannelPair(name);
+	if (result != RTLIB_OK)
+		return result;
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Register(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_REGISTER_t rm_EXC_REGISTER = {
+		{
+			RPC_EXC_REGISTER,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		"\0",
+		"\0"
+	};
+	::strncpy(rm_EXC_REGISTER.exc_name, prec->name.c_str(),
+			RTLIB_EXC_NAME_LENGTH);
+	::strncpy(rm_EXC_REGISTER.recipe, prec->exc_params.recipe,
+			RTLIB_EXC_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Registering EXC [%d:%d:%s]...\n"),
+				rm_EXC_REGISTER.hdr.app_pid,
+				rm_EXC_REGISTER.hdr.exc_id,
+				rm_EXC_REGISTER.exc_name));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_REGISTER);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Unregister(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_UNREGISTER_t rm_EXC_UNREGISTER = {
+		{
+			RPC_EXC_UNREGISTER,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		"\0"
+	};
+	::strncpy(rm_EXC_UNREGISTER.exc_name, prec->name.c_str(),
+			RTLIB_EXC_NAME_LENGTH);
+
+	DB(fprintf(stderr, FD("Unregistering EXC [%d:%d:%s]...\n"),
+				rm_EXC_UNREGISTER.hdr.app_pid,
+				rm_EXC_UNREGISTER.hdr.exc_id,
+				rm_EXC_UNREGISTER.exc_name));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_UNREGISTER);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Enable(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_START_t rm_EXC_START = {
+		{
+			RPC_EXC_START,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Enabling EXC [%d:%d]...\n"),
+				rm_EXC_START.hdr.app_pid,
+				rm_EXC_START.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_START);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Disable(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_STOP_t rm_EXC_STOP = {
+		{
+			RPC_EXC_STOP,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Disabling EXC [%d:%d]...\n"),
+				rm_EXC_STOP.hdr.app_pid,
+				rm_EXC_STOP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_STOP);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Set(pregExCtx_t prec,
+			RTLIB_Constraint_t* constraints, uint8_t count) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_SET_t rm_EXC_SET;
+
+	// At least 1 constraint it is expected
+	assert(count);
+
+	// Init RPC header
+	rm_EXC_SET.hdr.typ = RPC_EXC_SET;
+	rm_EXC_SET.hdr.token = RpcMsgToken();
+	rm_EXC_SET.hdr.app_pid = chTrdPid;
+	rm_EXC_SET.hdr.exc_id = prec->exc_id;
+	rm_EXC_SET.count = count;
+
+	DB(fprintf(stderr, FD("Set [%d] constraints on EXC [%d:%d]...\n"),
+				count, rm_EXC_SET.hdr.app_pid,
+				rm_EXC_SET.hdr.exc_id));
+
+	// Sending RPC Request
+	// NOTE: the constraints are gathered right after the message header
+	// directly into the ring, thus without any temporary buffer
+	if (ChannelSend(&rm_EXC_SET, offsetof(rpc_msg_EXC_SET_t, constraints),
+				constraints,
+				count * sizeof(RTLIB_Constraint_t)) != RTLIB_OK) {
+		fprintf(stderr, FE("write to BBQUE socket FAILED [%s]\n"),
+			bbque_sock_path.c_str());
+		return RTLIB_BBQUE_CHANNEL_WRITE_FAILED;
+	}
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_Clear(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_CLEAR_t rm_EXC_CLEAR = {
+		{
+			RPC_EXC_CLEAR,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Clear constraints for EXC [%d:%d]...\n"),
+				rm_EXC_CLEAR.hdr.app_pid,
+				rm_EXC_CLEAR.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_CLEAR);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_GGap(pregExCtx_t prec, uint8_t gap) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_GGAP_t rm_EXC_GGAP = {
+		{
+			RPC_EXC_GGAP,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+		gap,
+	};
+
+	DB(fprintf(stderr, FD("Set Goal-Gap for EXC [%d:%d]...\n"),
+				rm_EXC_GGAP.hdr.app_pid,
+				rm_EXC_GGAP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_GGAP);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_ScheduleRequest(pregExCtx_t prec) {
+	std::unique_lock<std::mutex> chCommand_ul(chCommand_mtx);
+	rpc_msg_EXC_SCHEDULE_t rm_EXC_SCHEDULE = {
+		{
+			RPC_EXC_SCHEDULE,
+			RpcMsgToken(),
+			chTrdPid,
+			prec->exc_id
+		},
+	};
+
+	DB(fprintf(stderr, FD("Schedule request for EXC [%d:%d]...\n"),
+				rm_EXC_SCHEDULE.hdr.app_pid,
+				rm_EXC_SCHEDULE.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(EXC_SCHEDULE);
+
+	DB(fprintf(stderr, FD("Waiting BBQUE response...\n")));
+
+	WAIT_RPC_RESP;
+	return (RTLIB_ExitCode_t)chResp.result;
+}
+
+void BbqueRPC_SOCK_Client::_Exit() {
+	ChannelRelease();
+}
+
+
+/******************************************************************************
+ * Synchronization Protocol Messages
+ ******************************************************************************/
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_SyncpPreChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, uint32_t syncLatency) {
+
+	rpc_msg_BBQ_SYNCP_PRECHANGE_RESP_t rm_BBQ_SYNCP_PRECHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		syncLatency,
+		RTLIB_OK
+	};
+
+	DB(fprintf(stderr, FD("PreChange response EXC [%d:%d] "
+					"latency [%d]...\n"),
+				rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_PRECHANGE_RESP.hdr.exc_id,
+				rm_BBQ_SYNCP_PRECHANGE_RESP.syncLatency));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(BBQ_SYNCP_PRECHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_SyncpSyncChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, RTLIB_ExitCode_t sync) {
+
+	rpc_msg_BBQ_SYNCP_SYNCCHANGE_RESP_t rm_BBQ_SYNCP_SYNCCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		(uint8_t)sync
+	};
+
+	// Check that the ExitCode can be represented by the response message
+	assert(sync < 256);
+
+	DB(fprintf(stderr, FD("SyncChange response EXC [%d:%d]...\n"),
+				rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_SYNCCHANGE_RESP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(BBQ_SYNCP_SYNCCHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+RTLIB_ExitCode_t BbqueRPC_SOCK_Client::_SyncpPostChangeResp(
+		rpc_msg_token_t token, pregExCtx_t prec, RTLIB_ExitCode_t result) {
+
+	rpc_msg_BBQ_SYNCP_POSTCHANGE_RESP_t rm_BBQ_SYNCP_POSTCHANGE_RESP = {
+		{
+			RPC_BBQ_RESP,
+			token,
+			chTrdPid,
+			prec->exc_id
+		},
+		(uint8_t)result
+	};
+
+	// Check that the ExitCode can be represented by the response message
+	assert(result < 256);
+
+	DB(fprintf(stderr, FD("PostChange response EXC [%d:%d]...\n"),
+				rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.app_pid,
+				rm_BBQ_SYNCP_POSTCHANGE_RESP.hdr.exc_id));
+
+	// Sending RPC Request
+	RPC_SOCK_SEND(BBQ_SYNCP_POSTCHANGE_RESP);
+
+	return RTLIB_OK;
+}
+
+} // namespace rtlib
+
+} // namespace bbque
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Build an emulated control groups hierarchy, suitable to test the Linux
+# CGroupFS Platform Proxy (CONFIG_BBQUE_LINUXPP_CGFS) without root privileges
+# or kernel support. The daemon should be configured to use the generated
+# hierarchy by setting:
+#   [LinuxPP]
+#   cgfs_root = <MOUNT_DIR>
+
+if [ $# -lt 2 ]; then
+	echo -e "\nUsage: $0 <MOUNT_DIR> <v1|v2> [PLATFORM_LAYOUT.bpl]\n"
+	echo -e "If running as root, a tmpfs is mounted on MOUNT_DIR,"
+	echo -e "otherwise a plain folder is used.\n\n"
+	exit 1
+fi
+
+ROOT=$1
+VERSION=$2
+BPL=${3:-`dirname $0`/../config/pil/default.bpl}
+CPUP=100000
+
+mkdir -p $ROOT || exit 1
+if [ `id -u` -eq 0 ]; then
+	mount -t tmpfs cgfs_fake $ROOT || exit 1
+fi
+
+# Write an attribute of a group, for the specified (v1) controller
+# $1: controller, $2: group path, $3: attribute, $4: value
+cg_set() {
+	if [ $VERSION == "v2" ]; then
+		DIR=$ROOT/$2
+	else
+		DIR=$ROOT/$1/$2
+	fi
+	mkdir -p $DIR
+	echo "$4" > $DIR/$3
+}
+
+if [ $VERSION == "v2" ]; then
+	echo "cpuset cpu memory" > $ROOT/cgroup.controllers
+fi
+
+# The BarbequeRTRM root and resources containers
+for CTRL in cpuset memory cpu; do
+	cg_set $CTRL bbque cgroup.procs ""
+	cg_set $CTRL bbque/res cgroup.procs ""
+done
+
+# Managed resources clusterization, one group for each NODE of the layout
+NODE=0
+grep "^NODE" $BPL | tr -d ' \t' | while IFS='|' read T CPUS CPUQ MEMS MEMB; do
+	echo "Setup NODE$NODE: CPUs [$CPUS], Quota [$CPUQ%], MEMs [$MEMS], Memory [$MEMB MB]"
+	cg_set cpuset bbque/res/node$NODE cpuset.cpus $CPUS
+	cg_set cpuset bbque/res/node$NODE cpuset.mems $MEMS
+	if [ $VERSION == "v2" ]; then
+		cg_set memory bbque/res/node$NODE memory.max $((MEMB*1048576))
+		cg_set cpu bbque/res/node$NODE cpu.max "$((CPUQ*1000)) $CPUP"
+	else
+		cg_set memory bbque/res/node$NODE memory.limit_in_bytes $((MEMB*1048576))
+		cg_set cpu bbque/res/node$NODE cpu.cfs_period_us $CPUP
+		cg_set cpu bbque/res/node$NODE cpu.cfs_quota_us $((CPUQ*1000))
+	fi
+	NODE=$((NODE+1))
+done
+
+echo "Emulated CGroup $VERSION hierarchy ready at [$ROOT]"
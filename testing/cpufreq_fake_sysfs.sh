@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# Build an emulated cpufreq sysfs tree, suitable to test the CPU frequency
+# management of the Linux Platform Proxy without root privileges or cpufreq
+# drivers. The daemon should be configured to use the generated tree by
+# setting:
+#   [LinuxPP]
+#   cpufreq = userspace
+#   cpufreq_root = <ROOT_DIR>
+
+if [ $# -lt 1 ]; then
+	echo -e "\nUsage: $0 <ROOT_DIR> [CPUS_COUNT] [FREQUENCIES_kHz]\n"
+	echo -e "Example: $0 /tmp/cpu 4 \"800000 1600000 2400000\"\n\n"
+	exit 1
+fi
+
+ROOT=$1
+CPUS=${2:-`nproc`}
+FREQS=${3:-"800000 1200000 1600000 2000000 2400000"}
+FMIN=`echo $FREQS | tr ' ' '\n' | sort -n | head -n1`
+FMAX=`echo $FREQS | tr ' ' '\n' | sort -n | tail -n1`
+
+for CPU in `seq 0 $((CPUS-1))`; do
+	DIR=$ROOT/cpu$CPU/cpufreq
+	mkdir -p $DIR || exit 1
+	echo "$FMIN" > $DIR/cpuinfo_min_freq
+	echo "$FMAX" > $DIR/cpuinfo_max_freq
+	echo "$FREQS" > $DIR/scaling_available_frequencies
+	echo "ondemand userspace performance" > $DIR/scaling_available_governors
+	echo "ondemand" > $DIR/scaling_governor
+	echo "$FMAX" > $DIR/scaling_max_freq
+	echo "<unsupported>" > $DIR/scaling_setspeed
+done
+
+echo "Emulated cpufreq tree for [$CPUS] CPUs ready at [$ROOT]"
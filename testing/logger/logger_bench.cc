@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file logger_bench.cc
+ * @brief Loggers micro-benchmark
+ *
+ * Compare the Log4CPP logger with the asynchronous one, by measuring the
+ * time of a YaMS-like schedule: for each application, AWM and cluster, the
+ * scheduling contributions are computed and aggregated, and then the
+ * entities are selected, with the same logging statements (and priorities)
+ * of the YaMS policy.
+ * Both the loggers are configured by the given Log4CPP configuration file,
+ * which should set the "bq.sp.yams" category at DEBUG level to reproduce the
+ * worst case (Debug messages are logged only by BBQUE_DEBUG builds).
+ */
+
+#include "async_logger.h"
+#include "log4cpp_logger.h"
+
+#include "bbque/platform_services.h"
+
+#include <boost/program_options/parsers.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <time.h>
+#include <unistd.h>
+
+namespace bp = bbque::plugins;
+namespace po = boost::program_options;
+
+/** Required by the Log4CPP logger */
+unsigned char daemonized = 0;
+
+/** The Log4CPP configuration file */
+static const char *conf_file;
+
+static const char *sc_names[] = {
+	"value", "reconfig", "congestion", "fairness"
+};
+
+static inline uint64_t NowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Provide the loggers with the configuration file
+ */
+static int32_t InvokeService(PF_PlatformServiceID id, PF_ServiceData & data) {
+	PF_Service_ConfDataIn *data_in = (PF_Service_ConfDataIn *)data.request;
+	PF_Service_ConfDataOut *data_out = (PF_Service_ConfDataOut *)data.response;
+	std::stringstream conf;
+
+	if (id != PF_SERVICE_CONF_DATA)
+		return PF_SERVICE_UNDEF;
+
+	conf << "[" LOGGER_CONFIG "]\nlog4cpp.conf_file = " << conf_file << "\n";
+	po::store(po::parse_config_file(conf, *(data_in->opts_desc), true),
+			*(data_out->opts_value));
+	po::notify(*(data_out->opts_value));
+
+	return PF_SERVICE_DONE;
+}
+
+static bp::LoggerIF *GetLogger(void * (*Create)(PF_ObjectParams *)) {
+	bp::LoggerIF::Configuration conf("bq.sp.yams", bp::LoggerIF::DEBUG);
+	PF_PlatformServices ps;
+	PF_ObjectParams op;
+
+	memset(&ps, 0, sizeof(ps));
+	ps.InvokeService = InvokeService;
+	op.id = LOGGER_NAMESPACE;
+	op.platform_services = &ps;
+	op.data = &conf;
+
+	return (bp::LoggerIF *)Create(&op);
+}
+
+/**
+ * @brief A schedule, logging as the YaMS policy does
+ */
+static void Schedule(bp::LoggerIF *logger, uint16_t apps, uint16_t awms,
+		uint16_t clusters) {
+	char metrics_log[255];
+	char str_id[40];
+	float metrics;
+	float value;
+	uint8_t len;
+
+	for (uint16_t cl = 0; cl < clusters; ++cl) {
+		for (uint16_t app = 0; app < apps; ++app) {
+			for (uint16_t awm = 0; awm < awms; ++awm) {
+				snprintf(str_id, 40, "[%05d:%6s:%02d] {AWM:%02d,CL:%02d}",
+						1000 + app, "bench", 0, awm, cl);
+#ifdef BBQUE_DEBUG
+				logger->Debug("Insert: [%s] ...metrics computing...",
+						str_id);
+#endif
+
+				metrics = 0;
+				len = 0;
+				for (uint8_t i = 0; i < 4; ++i) {
+					value = fabs(sin(app * awm + i + cl));
+					logger->Info("%s: %s = %.4f", str_id,
+							sc_names[i], value);
+					metrics += value;
+					len += sprintf(metrics_log + len, "%c: %5.4f, ",
+							sc_names[i][0], value);
+				}
+				metrics_log[len - 2] = '\0';
+				logger->Notice("Aggregate: %s app-value: (%s) => %5.4f",
+						str_id, metrics_log, metrics);
+#ifdef BBQUE_DEBUG
+				logger->Debug("Insert [%d]: %s: ..:: metrics %1.3f",
+						awm + 1, str_id, metrics);
+#endif
+			}
+		}
+	}
+
+	for (uint16_t app = 0; app < apps; ++app)
+		logger->Notice("Selecting: [%05d:%6s:%02d] scheduled "
+				"<< metrics: %.4f >>", 1000 + app, "bench", 0, 0.5);
+}
+
+static void Bench(const char *name, bp::LoggerIF *logger, uint32_t runs,
+		uint16_t apps, uint16_t awms, uint16_t clusters,
+		uint32_t period_ms) {
+	std::vector<uint64_t> samples;
+	uint64_t start;
+	uint64_t sum = 0;
+
+	for (uint32_t r = 0; r < runs; ++r) {
+		start = NowNs();
+		Schedule(logger, apps, awms, clusters);
+		samples.push_back(NowNs() - start);
+		sum += samples.back();
+		usleep(period_ms * 1000);
+	}
+
+	std::sort(samples.begin(), samples.end());
+	printf("%-7s schedule time [us] avg: %9.1f, p50: %9.1f, p99: %9.1f, "
+			"max: %9.1f\n",
+			name, sum / (1e3 * samples.size()),
+			samples[samples.size() / 2] / 1e3,
+			samples[(samples.size() * 99) / 100] / 1e3,
+			samples.back() / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+	uint16_t apps = 16, awms = 8, clusters = 2;
+	uint32_t period_ms = 10;
+	uint32_t runs = 100;
+	bp::LoggerIF *logger;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "r:a:w:c:p:h")) != -1) {
+		switch (opt) {
+		case 'r':
+			runs = strtoul(optarg, NULL, 10);
+			break;
+		case 'a':
+			apps = strtoul(optarg, NULL, 10);
+			break;
+		case 'w':
+			awms = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			clusters = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			period_ms = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-r RUNS] [-a APPS] [-w AWMS] "
+					"[-c CLUSTERS] [-p PERIOD_MS] LOG4CPP_CONF\n",
+					argv[0]);
+			return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "Missing the Log4CPP configuration file\n");
+		return EXIT_FAILURE;
+	}
+	conf_file = argv[optind];
+	if (runs == 0)
+		runs = 1;
+
+	printf("Loggers benchmark, %u schedules of %u apps, %u AWMs, "
+			"%u clusters\n", runs, apps, awms, clusters);
+
+	logger = GetLogger(bp::Log4CppLogger::Create);
+	if (!logger)
+		return EXIT_FAILURE;
+	Bench("log4cpp", logger, runs, apps, awms, clusters, period_ms);
+	bp::Log4CppLogger::Destroy(logger);
+
+	logger = GetLogger(bp::AsyncLogger::Create);
+	if (!logger)
+		return EXIT_FAILURE;
+	Bench("async", logger, runs, apps, awms, clusters, period_ms);
+	bp::AsyncLogger::Destroy(logger);
+
+	return EXIT_SUCCESS;
+}
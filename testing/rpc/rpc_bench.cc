@@ -0,0 +1,590 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file rpc_bench.cc
+ * @brief RPC channels micro-benchmark
+ *
+ * Compare the FIFO, the shared memory and the UNIX socket RPC channels, by
+ * measuring:
+ * <ul>
+ * <li><i>latency:</i> the round-trip time of a command, i.e. a request
+ * sent by the "application" and the response sent back by the "server"</li>
+ * <li><i>throughput:</i> the rate of requests the server is able to consume
+ * when the application streams them without waiting for responses</li>
+ * </ul>
+ * Both sides mimic the actual channel implementations, i.e. the FIFO server
+ * reads the header, allocates the buffer and then reads the payload, while
+ * the SHM server accesses messages in place and waits on the doorbell, while
+ * the SOCK server receives each packet with a single call into a buffer.
+ * The server is a forked process, thus wake-ups cross process boundaries as
+ * with the real BarbequeRTRM daemon.
+ *
+ * The "async" test measures instead the overhead of asserting a Goal-Gap at
+ * each processing cycle (i.e. from onMonitor), through the RTLib services,
+ * either synchronously or by the asynchronous API. The RTLib is paired with
+ * a forked server, which answers all the requests on the FIFO channel as
+ * the daemon would do, and counts the Goal-Gaps actually received.
+ */
+
+#include "bbque/rtlib/rpc_fifo_server.h"
+#include "bbque/rtlib/rpc_shm_server.h"
+#include "bbque/rtlib/rpc_sock_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace bbque::rtlib;
+
+/** A request is a schedule command */
+typedef rpc_msg_EXC_SCHEDULE_t bench_req_t;
+/** A response is a command result */
+typedef rpc_msg_resp_t bench_resp_t;
+
+namespace bbque { namespace rtlib {
+/** A response, as sent by FifoRPC::SendMessage */
+RPC_FIFO_DEFINE_MESSAGE(resp);
+} }
+
+/** The type of a request which does not require a response */
+#define BENCH_STREAM RPC_EXC_STOP
+
+static inline uint64_t NowNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void Report(const char *channel, std::vector<uint64_t> & samples,
+		uint64_t stream_ns, uint32_t count) {
+	uint64_t sum = 0;
+
+	std::sort(samples.begin(), samples.end());
+	for (size_t i = 0; i < samples.size(); ++i)
+		sum += samples[i];
+
+	printf("%-5s latency [ns] avg: %8.0f, p50: %8lu, p99: %8lu, "
+			"max: %8lu | throughput: %10.0f msg/s\n",
+			channel, (double)sum / samples.size(),
+			(unsigned long)samples[samples.size() / 2],
+			(unsigned long)samples[(samples.size() * 99) / 100],
+			(unsigned long)samples.back(),
+			(count * 1e9) / stream_ns);
+}
+
+
+/******************************************************************************
+ * FIFO channel
+ ******************************************************************************/
+
+static void FifoServer(int req_fd, int resp_fd) {
+	rpc_fifo_header_t hdr;
+	rpc_fifo_resp_t *resp;
+	void *buff;
+
+	while (::read(req_fd, &hdr, FIFO_PKT_SIZE(header)) > 0) {
+
+		// Read the payload into a new buffer, as FifoRPC::RecvMessage
+		buff = ::malloc(hdr.fifo_msg_size);
+		::memcpy(buff, &hdr, FIFO_PKT_SIZE(header));
+		if (::read(req_fd, ((rpc_fifo_header_t *)buff) + 1,
+				hdr.fifo_msg_size - FIFO_PKT_SIZE(header)) <= 0)
+			break;
+
+		// Send back a response, as FifoRPC::SendMessage
+		if (hdr.rpc_msg_type != BENCH_STREAM ||
+				((rpc_fifo_GENERIC_t *)buff)->pyl.exc_id) {
+			resp = (rpc_fifo_resp_t *)::malloc(FIFO_PKT_SIZE(resp));
+			resp->hdr.fifo_msg_size = FIFO_PKT_SIZE(resp);
+			resp->hdr.rpc_msg_offset = FIFO_PYL_OFFSET(resp);
+			resp->hdr.rpc_msg_type = RPC_EXC_RESP;
+			resp->pyl.hdr = ((rpc_fifo_GENERIC_t *)buff)->pyl;
+			resp->pyl.hdr.typ = RPC_EXC_RESP;
+			resp->pyl.result = 0;
+			if (::write(resp_fd, resp, FIFO_PKT_SIZE(resp)) <= 0)
+				break;
+			::free(resp);
+		}
+
+		::free(buff);
+	}
+}
+
+static void FifoSend(int fd, uint8_t typ, uint8_t exc_id) {
+	rpc_fifo_EXC_SCHEDULE_t req;
+
+	req.hdr.fifo_msg_size = FIFO_PKT_SIZE(EXC_SCHEDULE);
+	req.hdr.rpc_msg_offset = FIFO_PYL_OFFSET(EXC_SCHEDULE);
+	req.hdr.rpc_msg_type = typ;
+	req.pyl.hdr.typ = typ;
+	req.pyl.hdr.token = 0;
+	req.pyl.hdr.app_pid = getpid();
+	req.pyl.hdr.exc_id = exc_id;
+	if (::write(fd, &req, FIFO_PKT_SIZE(EXC_SCHEDULE)) <= 0)
+		exit(EXIT_FAILURE);
+}
+
+static void FifoRecv(int fd) {
+	rpc_fifo_resp_t resp;
+
+	// Read the header and then the payload, as the RTLib client
+	if ((::read(fd, &resp.hdr, FIFO_PKT_SIZE(header)) <= 0) ||
+			(::read(fd, &resp.pyl, RPC_PKT_SIZE(resp)) <= 0))
+		exit(EXIT_FAILURE);
+}
+
+static void FifoBench(uint32_t count) {
+	std::vector<uint64_t> samples(count);
+	int req_fds[2], resp_fds[2];
+	uint64_t start;
+	pid_t pid;
+
+	if (pipe(req_fds) || pipe(resp_fds)) {
+		perror("pipe");
+		exit(EXIT_FAILURE);
+	}
+
+	pid = fork();
+	if (pid == 0) {
+		::close(req_fds[1]);
+		FifoServer(req_fds[0], resp_fds[1]);
+		_exit(EXIT_SUCCESS);
+	}
+	::close(req_fds[0]);
+
+	// Latency: wait for the response of each request
+	for (uint32_t i = 0; i < count; ++i) {
+		start = NowNs();
+		FifoSend(req_fds[1], RPC_EXC_SCHEDULE, 0);
+		FifoRecv(resp_fds[0]);
+		samples[i] = NowNs() - start;
+	}
+
+	// Throughput: the last request only is acknowledged
+	start = NowNs();
+	for (uint32_t i = 1; i < count; ++i)
+		FifoSend(req_fds[1], BENCH_STREAM, 0);
+	FifoSend(req_fds[1], BENCH_STREAM, 1);
+	FifoRecv(resp_fds[0]);
+
+	Report("FIFO", samples, NowNs() - start, count);
+
+	::close(req_fds[1]);
+	waitpid(pid, NULL, 0);
+}
+
+
+/******************************************************************************
+ * Shared memory channel
+ ******************************************************************************/
+
+static void ShmServer(rpc_shm_server_t *server, rpc_shm_channel_t *chn) {
+	uint32_t doorbell, cursor = 0;
+	rpc_shm_record_t *rec;
+	rpc_msg_header_t *msg;
+	bench_resp_t resp;
+	uint32_t size;
+
+	while (true) {
+		doorbell = __atomic_load_n(&server->doorbell, __ATOMIC_SEQ_CST);
+		if (rpc_shm_ring_peek(&chn->req, cursor, rec, size)) {
+			__atomic_store_n(&server->sleeping, 1, __ATOMIC_SEQ_CST);
+			rpc_shm_futex_wait(&server->doorbell, doorbell);
+			__atomic_store_n(&server->sleeping, 0, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		// Messages are accessed in place, as ShmRPC::RecvMessage
+		msg = rpc_shm_record_msg(rec);
+		if (msg->typ == RPC_APP_EXIT)
+			return;
+
+		if (msg->typ != BENCH_STREAM || msg->exc_id) {
+			resp.hdr = *msg;
+			resp.hdr.typ = RPC_EXC_RESP;
+			resp.result = 0;
+			while (!rpc_shm_ring_push(&chn->resp, &resp, sizeof(resp)))
+				sched_yield();
+			if (rpc_shm_ring_sleeping(&chn->resp))
+				rpc_shm_futex_wake(&chn->resp.head);
+		}
+
+		rpc_shm_ring_release(&chn->req, rec, cursor);
+	}
+}
+
+static void ShmSend(rpc_shm_server_t *server, rpc_shm_channel_t *chn,
+		uint8_t typ, uint8_t exc_id) {
+	bench_req_t req;
+
+	req.hdr.typ = typ;
+	req.hdr.token = 0;
+	req.hdr.app_pid = getpid();
+	req.hdr.exc_id = exc_id;
+	while (!rpc_shm_ring_push(&chn->req, &req, sizeof(req)))
+		sched_yield();
+
+	// Ring the doorbell, as the RTLib client
+	__atomic_fetch_add(&server->doorbell, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&server->sleeping, __ATOMIC_SEQ_CST))
+		rpc_shm_futex_wake(&server->doorbell);
+}
+
+static void ShmRecv(rpc_shm_channel_t *chn, uint32_t & cursor) {
+	rpc_shm_record_t *rec;
+	uint32_t size;
+
+	while (rpc_shm_ring_peek(&chn->resp, cursor, rec, size))
+		rpc_shm_ring_wait(&chn->resp, cursor);
+	rpc_shm_ring_release(&chn->resp, rec, cursor);
+}
+
+static void ShmBench(uint32_t count) {
+	std::vector<uint64_t> samples(count);
+	rpc_shm_server_t *server;
+	rpc_shm_channel_t *chn;
+	uint32_t cursor = 0;
+	uint64_t start;
+	pid_t pid;
+
+	server = (rpc_shm_server_t *)mmap(NULL, sizeof(rpc_shm_server_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	chn = (rpc_shm_channel_t *)mmap(NULL, sizeof(rpc_shm_channel_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if ((server == MAP_FAILED) || (chn == MAP_FAILED)) {
+		perror("mmap");
+		exit(EXIT_FAILURE);
+	}
+
+	pid = fork();
+	if (pid == 0) {
+		ShmServer(server, chn);
+		_exit(EXIT_SUCCESS);
+	}
+
+	// Latency: wait for the response of each request
+	for (uint32_t i = 0; i < count; ++i) {
+		start = NowNs();
+		ShmSend(server, chn, RPC_EXC_SCHEDULE, 0);
+		ShmRecv(chn, cursor);
+		samples[i] = NowNs() - start;
+	}
+
+	// Throughput: the last request only is acknowledged
+	start = NowNs();
+	for (uint32_t i = 1; i < count; ++i)
+		ShmSend(server, chn, BENCH_STREAM, 0);
+	ShmSend(server, chn, BENCH_STREAM, 1);
+	ShmRecv(chn, cursor);
+
+	Report("SHM", samples, NowNs() - start, count);
+
+	ShmSend(server, chn, RPC_APP_EXIT, 0);
+	waitpid(pid, NULL, 0);
+	munmap(chn, sizeof(rpc_shm_channel_t));
+	munmap(server, sizeof(rpc_shm_server_t));
+}
+
+
+/******************************************************************************
+ * UNIX socket channel
+ ******************************************************************************/
+
+static void SockServer(int fd) {
+	uint64_t buff[(BBQUE_RPC_SOCK_MSG_MAX + 7) / 8];
+	rpc_msg_header_t *msg = (rpc_msg_header_t *)buff;
+	bench_resp_t resp;
+
+	while (::recv(fd, buff, sizeof(buff), 0) > 0) {
+		if (msg->typ == BENCH_STREAM && !msg->exc_id)
+			continue;
+		resp.hdr = *msg;
+		resp.hdr.typ = RPC_EXC_RESP;
+		resp.result = 0;
+		if (::send(fd, &resp, sizeof(resp), MSG_NOSIGNAL) <= 0)
+			break;
+	}
+}
+
+static void SockSend(int fd, uint8_t typ, uint8_t exc_id) {
+	bench_req_t req;
+
+	req.hdr.typ = typ;
+	req.hdr.token = 0;
+	req.hdr.app_pid = getpid();
+	req.hdr.exc_id = exc_id;
+	if (::send(fd, &req, sizeof(req), MSG_NOSIGNAL) <= 0)
+		exit(EXIT_FAILURE);
+}
+
+static void SockRecv(int fd) {
+	bench_resp_t resp;
+
+	if (::recv(fd, &resp, sizeof(resp), 0) <= 0)
+		exit(EXIT_FAILURE);
+}
+
+static void SockBench(uint32_t count) {
+	std::vector<uint64_t> samples(count);
+	uint64_t start;
+	int fds[2];
+	pid_t pid;
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds)) {
+		perror("socketpair");
+		exit(EXIT_FAILURE);
+	}
+
+	pid = fork();
+	if (pid == 0) {
+		::close(fds[0]);
+		SockServer(fds[1]);
+		_exit(EXIT_SUCCESS);
+	}
+	::close(fds[1]);
+
+	// Latency: wait for the response of each request
+	for (uint32_t i = 0; i < count; ++i) {
+		start = NowNs();
+		SockSend(fds[0], RPC_EXC_SCHEDULE, 0);
+		SockRecv(fds[0]);
+		samples[i] = NowNs() - start;
+	}
+
+	// Throughput: the last request only is acknowledged
+	start = NowNs();
+	for (uint32_t i = 1; i < count; ++i)
+		SockSend(fds[0], BENCH_STREAM, 0);
+	SockSend(fds[0], BENCH_STREAM, 1);
+	SockRecv(fds[0]);
+
+	Report("SOCK", samples, NowNs() - start, count);
+
+	::close(fds[0]);
+	waitpid(pid, NULL, 0);
+}
+
+
+/******************************************************************************
+ * Asynchronous requests
+ ******************************************************************************/
+
+#ifdef CONFIG_BBQUE_RPC_FIFO
+
+/** The time between two processing cycles [us] */
+#ifndef BENCH_CYCLE_US
+# define BENCH_CYCLE_US 50
+#endif
+
+/** The public FIFO of the server, i.e. the one of the BarbequeRTRM daemon */
+#define BENCH_SERVER_FIFO BBQUE_PATH_VAR "/" BBQUE_PUBLIC_FIFO
+
+static void AsyncServer(int req_fd, uint32_t *ggaps) {
+	uint64_t buff[(2 * PIPE_BUF) / 8];
+	rpc_fifo_header_t *hdr = (rpc_fifo_header_t *)buff;
+	rpc_msg_header_t *msg;
+	rpc_fifo_resp_t resp;
+	char app_fifo[PATH_MAX];
+	int resp_fd = -1;
+
+	while (::read(req_fd, hdr, FIFO_PKT_SIZE(header)) > 0) {
+		if ((hdr->fifo_msg_size > sizeof(buff)) ||
+				(::read(req_fd, hdr + 1, hdr->fifo_msg_size -
+					FIFO_PKT_SIZE(header)) <= 0))
+			break;
+		msg = (rpc_msg_header_t *)((uint8_t *)buff + hdr->rpc_msg_offset);
+
+		// Open the application FIFO, as ApplicationProxy on pairing
+		if (msg->typ == RPC_APP_PAIR) {
+			snprintf(app_fifo, PATH_MAX, BBQUE_PATH_VAR "/%.*s",
+					BBQUE_FIFO_NAME_LENGTH,
+					((rpc_fifo_APP_PAIR_t *)buff)->rpc_fifo);
+			resp_fd = ::open(app_fifo, O_WRONLY);
+		}
+		if ((msg->typ == RPC_APP_EXIT) || (resp_fd < 0))
+			break;
+		if (msg->typ == RPC_EXC_GGAP)
+			__atomic_add_fetch(ggaps, 1, __ATOMIC_RELEASE);
+
+		// Pipelined requests are not acknowledged
+		if (msg->token & RPC_MSG_TOKEN_PIPELINED)
+			continue;
+
+		resp.hdr.fifo_msg_size = FIFO_PKT_SIZE(resp);
+		resp.hdr.rpc_msg_offset = FIFO_PYL_OFFSET(resp);
+		resp.hdr.rpc_msg_type = (msg->typ == RPC_APP_PAIR) ?
+			RPC_APP_RESP : RPC_EXC_RESP;
+		resp.pyl.hdr = *msg;
+		resp.pyl.hdr.typ = resp.hdr.rpc_msg_type;
+		resp.pyl.result = RTLIB_OK;
+		if (::write(resp_fd, &resp, FIFO_PKT_SIZE(resp)) <= 0)
+			break;
+	}
+
+	if (resp_fd >= 0)
+		::close(resp_fd);
+	::unlink(BENCH_SERVER_FIFO);
+}
+
+static void AsyncReport(const char *mode, std::vector<uint64_t> & samples,
+		uint32_t sent) {
+	uint64_t sum = 0;
+
+	std::sort(samples.begin(), samples.end());
+	for (size_t i = 0; i < samples.size(); ++i)
+		sum += samples[i];
+
+	printf("%-5s onMonitor overhead [ns] avg: %8.0f, p50: %8lu, "
+			"p99: %8lu | sent: %u/%lu\n",
+			mode, (double)sum / samples.size(),
+			(unsigned long)samples[samples.size() / 2],
+			(unsigned long)samples[(samples.size() * 99) / 100],
+			sent, (unsigned long)samples.size());
+}
+
+static void AsyncBench(uint32_t count) {
+	RTLIB_ExecutionContextParams_t params = {
+		{RTLIB_VERSION_MAJOR, RTLIB_VERSION_MINOR},
+		RTLIB_LANG_CPP,
+		"bench"
+	};
+	std::vector<uint64_t> samples(count);
+	RTLIB_ExecutionContextHandler_t ech;
+	RTLIB_Services_t *rtlib;
+	RTLIB_AsyncToken_t token = 0;
+	uint32_t *ggaps;
+	uint64_t start;
+	int req_fd;
+	pid_t pid;
+
+	// Stand-in for the daemon: refuse to replace a running one
+	if (::mkfifo(BENCH_SERVER_FIFO, 0666)) {
+		fprintf(stderr, "async: cannot create [%s] (Error: %s), "
+				"is BarbequeRTRM running?\n",
+				BENCH_SERVER_FIFO, strerror(errno));
+		return;
+	}
+	req_fd = ::open(BENCH_SERVER_FIFO, O_RDWR);
+	ggaps = (uint32_t *)mmap(NULL, sizeof(uint32_t),
+			PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+	if ((req_fd < 0) || (ggaps == MAP_FAILED)) {
+		perror("async");
+		::unlink(BENCH_SERVER_FIFO);
+		exit(EXIT_FAILURE);
+	}
+
+	// The server exits once the RTLib releases the channel, at exit
+	pid = fork();
+	if (pid == 0) {
+		AsyncServer(req_fd, ggaps);
+		_exit(EXIT_SUCCESS);
+	}
+	::close(req_fd);
+
+	if ((RTLIB_Init("rpc_bench", &rtlib) != RTLIB_OK) || !rtlib) {
+		fprintf(stderr, "async: RTLib initialization FAILED\n");
+		kill(pid, SIGTERM);
+		::unlink(BENCH_SERVER_FIFO);
+		return;
+	}
+	ech = rtlib->Register("bench", &params);
+	if (!ech) {
+		fprintf(stderr, "async: EXC registration FAILED\n");
+		return;
+	}
+
+	// Synchronous: each cycle waits for the response
+	for (uint32_t i = 0; i < count; ++i) {
+		start = NowNs();
+		rtlib->SetGoalGap(ech, i % 100);
+		samples[i] = NowNs() - start;
+		::usleep(BENCH_CYCLE_US);
+	}
+	AsyncReport("SYNC", samples,
+			__atomic_exchange_n(ggaps, 0, __ATOMIC_ACQUIRE));
+
+	// Asynchronous: each cycle just posts the request to bq.async
+	for (uint32_t i = 0; i < count; ++i) {
+		start = NowNs();
+		token = rtlib->Async.SetGoalGap(ech, i % 100, NULL, NULL);
+		samples[i] = NowNs() - start;
+		::usleep(BENCH_CYCLE_US);
+	}
+	rtlib->Async.Wait(token, 0);
+	AsyncReport("ASYNC", samples,
+			__atomic_load_n(ggaps, __ATOMIC_ACQUIRE));
+
+	rtlib->Unregister(ech);
+	munmap(ggaps, sizeof(uint32_t));
+}
+
+#else
+# define AsyncBench(count) \
+	fprintf(stderr, "async: FIFO RPC channel not configured\n")
+#endif // CONFIG_BBQUE_RPC_FIFO
+
+
+int main(int argc, char *argv[]) {
+	uint32_t count = 100000;
+	const char *channel = "all";
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:c:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = strtoul(optarg, NULL, 10);
+			break;
+		case 'c':
+			channel = optarg;
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-n MESSAGES] "
+					"[-c fifo|shm|sock|async|all]\n", argv[0]);
+			return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if (count == 0)
+		count = 1;
+
+	printf("RPC channels benchmark, %u messages\n", count);
+	if (!strcmp(channel, "fifo") || !strcmp(channel, "all"))
+		FifoBench(count);
+	if (!strcmp(channel, "shm") || !strcmp(channel, "all"))
+		ShmBench(count);
+	if (!strcmp(channel, "sock") || !strcmp(channel, "all"))
+		SockBench(count);
+	// NOTE: this initializes the RTLib, thus it must be the last one
+	if (!strcmp(channel, "async") || !strcmp(channel, "all"))
+		AsyncBench(count);
+
+	return EXIT_SUCCESS;
+}
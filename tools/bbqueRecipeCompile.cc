@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief A compiler of the Barbeque recipes
+ *
+ * Each XML recipe is compiled into a binary recipe, placed beside it, which
+ * is then memory mapped and loaded by the recipe loader without any parsing.
+ * All the platform sections are compiled, since the matching one is selected
+ * at load time. A compiled recipe is ignored by the loader once the source
+ * recipe is modified, thus recipes must be compiled again after each change.
+ */
+
+// This must be defined in order to use TinyXML++ (TiCPP) library
+#define TIXML_USE_TICPP
+
+#include "bbque/plugins/recipe_compiled.h"
+#include "bbque/res/resource_utils.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <ticpp.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace bbque::plugins;
+using bbque::res::ConvertValue;
+
+/** The suffix of the XML recipes */
+#define RECIPE_EXT ".recipe"
+
+/** The tables of the recipe under compilation */
+static std::vector<brc_platform_t> platforms;
+static std::vector<brc_awm_t> awms;
+static std::vector<brc_usage_t> usages;
+static std::vector<brc_pdata_t> pdata;
+static std::vector<brc_constraint_t> constraints;
+static std::string strings;
+static std::map<std::string, uint32_t> strings_idx;
+
+static void Usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-o OUT] RECIPE [RECIPE...]\n"
+			" -o OUT  the compiled recipe (default: RECIPE with the "
+				BBQUE_RECIPE_COMPILED_EXT " suffix)\n"
+			"         only for a single RECIPE\n",
+			name);
+}
+
+/**
+ * @brief Get the offset of a string, adding it to the strings table
+ *
+ * Strings are shared, since resource paths are usually repeated by each AWM.
+ */
+static uint32_t Str(std::string const & str) {
+	std::map<std::string, uint32_t>::iterator it(strings_idx.find(str));
+	uint32_t off;
+
+	if (it != strings_idx.end())
+		return it->second;
+
+	off = strings.size();
+	strings.append(str.c_str(), str.size() + 1);
+	strings_idx[str] = off;
+	return off;
+}
+
+static void Reset() {
+	platforms.clear();
+	awms.clear();
+	usages.clear();
+	pdata.clear();
+	constraints.clear();
+	strings.clear();
+	strings_idx.clear();
+}
+
+/**
+ * @brief Compile the resource usages of an AWM (recursively)
+ */
+static bool CompileResources(ticpp::Element * xml_elem,
+		std::string const & curr_path, brc_awm_t & awm) {
+	ticpp::Element * res_elem;
+	std::string res_path;
+	std::string res_units;
+	std::string res_id;
+	uint64_t res_usage;
+	brc_usage_t usage;
+
+	res_elem = xml_elem->FirstChildElement(false);
+	while (res_elem) {
+		res_usage = 0;
+		res_id.clear();
+		res_units.clear();
+
+		// Build the resource path string
+		res_elem->GetAttribute("id", &res_id, false);
+		res_path = curr_path;
+		if (!res_path.empty())
+			res_path += ".";
+		res_path += res_elem->Value() + res_id;
+
+		// Resource quantity request and units
+		res_elem->GetAttribute("qty", &res_usage, false);
+		res_elem->GetAttribute("units", &res_units, false);
+		if (!res_elem->GetAttribute("qty").empty() && res_usage == 0) {
+			fprintf(stderr, "Resource [%s]: usage value not valid\n",
+					res_path.c_str());
+			return false;
+		}
+
+		// Resources without quantity are just containers
+		if (res_usage) {
+			memset(&usage, 0, sizeof(usage));
+			usage.path = Str(res_path);
+			usage.amount = ConvertValue(res_usage, res_units);
+			usages.push_back(usage);
+			++awm.nr_usages;
+		}
+
+		if (!res_elem->NoChildren() &&
+				!CompileResources(res_elem, res_path, awm))
+			return false;
+
+		res_elem = res_elem->NextSiblingElement(false);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Compile the plugins specific data of an application or an AWM
+ */
+static void CompilePluginsData(ticpp::Element * xml_elem,
+		uint32_t & first, uint32_t & nr) {
+	ticpp::Element * plugins_elem;
+	ticpp::Element * plug_elem;
+	ticpp::Node * data_node;
+	std::string name;
+	std::string key;
+	std::string value;
+	brc_pdata_t data;
+
+	first = pdata.size();
+	nr = 0;
+
+	plugins_elem = xml_elem->FirstChildElement("plugins", false);
+	if (!plugins_elem)
+		return;
+
+	plug_elem = plugins_elem->FirstChildElement("plugin", false);
+	while (plug_elem) {
+		plug_elem->GetAttribute("name", &name);
+
+		data_node = plug_elem->FirstChild(false);
+		for ( ; data_node; data_node = data_node->NextSibling(false)) {
+			if (data_node->Type() != TiXmlNode::ELEMENT)
+				continue;
+			value.clear();
+			data_node->GetValue(&key);
+			data_node->ToElement()->GetText(&value, false);
+
+			data.plugin = Str(name);
+			data.key = Str(key);
+			data.value = Str(value);
+			pdata.push_back(data);
+			++nr;
+		}
+
+		plug_elem = plug_elem->NextSiblingElement("plugin", false);
+	}
+}
+
+/**
+ * @brief Compile the static constraints of a platform section
+ */
+static void CompileConstraints(ticpp::Element * xml_elem,
+		brc_platform_t & platform) {
+	ticpp::Element * constr_elem;
+	ticpp::Element * con_elem;
+	std::string constraint_type;
+	std::string resource;
+	brc_constraint_t cons;
+	uint32_t value;
+
+	platform.first_constraint = constraints.size();
+	platform.nr_constraints = 0;
+
+	constr_elem = xml_elem->FirstChildElement("constraints", false);
+	if (!constr_elem)
+		return;
+
+	con_elem = constr_elem->FirstChildElement("constraint", false);
+	for ( ; con_elem;
+			con_elem = con_elem->NextSiblingElement("constraint", false)) {
+		con_elem->GetAttribute("type", &constraint_type);
+		con_elem->GetAttribute("resource", &resource);
+		con_elem->GetAttribute("bound", &value);
+
+		memset(&cons, 0, sizeof(cons));
+		cons.resource = Str(resource);
+		if (constraint_type.compare("L") == 0) {
+			cons.lower = value;
+		} else if (constraint_type.compare("U") == 0) {
+			cons.upper = value;
+		} else {
+			fprintf(stderr, "Constraint [%s]: unknown bound type, "
+					"skipped\n", resource.c_str());
+			continue;
+		}
+		constraints.push_back(cons);
+		++platform.nr_constraints;
+	}
+}
+
+/**
+ * @brief Compile a platform section
+ */
+static bool CompilePlatform(ticpp::Element * pp_elem) {
+	ticpp::Element * awms_elem;
+	ticpp::Element * awm_elem;
+	ticpp::Element * resources_elem;
+	brc_platform_t platform;
+	std::string platform_id;
+	std::string wm_name;
+	unsigned int wm_id;
+	unsigned int wm_value;
+	brc_awm_t awm;
+
+	memset(&platform, 0, sizeof(platform));
+	pp_elem->GetAttribute("id", &platform_id, true);
+	platform.id = Str(platform_id);
+	platform.first_awm = awms.size();
+
+	awms_elem = pp_elem->FirstChildElement("awms", true);
+	awm_elem = awms_elem->FirstChildElement("awm", true);
+	while (awm_elem) {
+		wm_name.clear();
+		awm_elem->GetAttribute("id", &wm_id, true);
+		awm_elem->GetAttribute("name", &wm_name, false);
+		awm_elem->GetAttribute("value", &wm_value, true);
+		if (wm_id > UINT8_MAX) {
+			fprintf(stderr, "AWM [%s]: wrong ID specified %u\n",
+					wm_name.c_str(), wm_id);
+			return false;
+		}
+
+		memset(&awm, 0, sizeof(awm));
+		awm.name = Str(wm_name);
+		awm.id = wm_id;
+		awm.value = wm_value;
+		awm.first_usage = usages.size();
+
+		resources_elem = awm_elem->FirstChildElement("resources", true);
+		if (!CompileResources(resources_elem, "", awm))
+			return false;
+		CompilePluginsData(awm_elem, awm.first_pdata, awm.nr_pdata);
+
+		awms.push_back(awm);
+		++platform.nr_awms;
+
+		awm_elem = awm_elem->NextSiblingElement("awm", false);
+	}
+
+	CompileConstraints(pp_elem, platform);
+	CompilePluginsData(pp_elem, platform.first_pdata, platform.nr_pdata);
+
+	platforms.push_back(platform);
+	return true;
+}
+
+/**
+ * @brief Append a table to the output image, 8 bytes aligned
+ */
+static uint32_t AppendTable(std::vector<char> & out, const void *table,
+		size_t size) {
+	uint32_t off;
+
+	out.resize((out.size() + 7) & ~7UL);
+	off = out.size();
+	out.insert(out.end(), (const char *)table, (const char *)table + size);
+	return off;
+}
+
+static bool Write(const char *out_path, brc_header_t & hdr) {
+	std::string tmp_path(std::string(out_path) + ".tmp");
+	std::vector<char> out(sizeof(brc_header_t));
+	bool written;
+	FILE *fp;
+
+	hdr.nr_platforms = platforms.size();
+	hdr.nr_awms = awms.size();
+	hdr.nr_usages = usages.size();
+	hdr.nr_pdata = pdata.size();
+	hdr.nr_constraints = constraints.size();
+	hdr.strings_size = strings.size();
+
+	hdr.platforms_off = AppendTable(out, platforms.data(),
+			platforms.size() * sizeof(brc_platform_t));
+	hdr.awms_off = AppendTable(out, awms.data(),
+			awms.size() * sizeof(brc_awm_t));
+	hdr.usages_off = AppendTable(out, usages.data(),
+			usages.size() * sizeof(brc_usage_t));
+	hdr.pdata_off = AppendTable(out, pdata.data(),
+			pdata.size() * sizeof(brc_pdata_t));
+	hdr.constraints_off = AppendTable(out, constraints.data(),
+			constraints.size() * sizeof(brc_constraint_t));
+	hdr.strings_off = AppendTable(out, strings.data(), strings.size());
+	memcpy(out.data(), &hdr, sizeof(hdr));
+
+	// The loader could be mapping the previous version meanwhile, thus
+	// replace it atomically
+	fp = fopen(tmp_path.c_str(), "w");
+	if (!fp) {
+		fprintf(stderr, "Opening [%s] FAILED (Error %d: %s)\n",
+				tmp_path.c_str(), errno, strerror(errno));
+		return false;
+	}
+	written = (fwrite(out.data(), out.size(), 1, fp) == 1);
+	if ((fclose(fp) != 0) || !written ||
+			(rename(tmp_path.c_str(), out_path) != 0)) {
+		fprintf(stderr, "Writing [%s] FAILED (Error %d: %s)\n",
+				out_path, errno, strerror(errno));
+		unlink(tmp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static bool Compile(const char *in_path, const char *out_path) {
+	ticpp::Document doc;
+	ticpp::Node * root_node;
+	ticpp::Element * app_elem;
+	ticpp::Element * pp_elem;
+	std::string version_id;
+	uint16_t prio = 0;
+	brc_header_t hdr;
+	struct stat st;
+	int maj = 0, min = 0;
+
+	if (stat(in_path, &st) != 0) {
+		fprintf(stderr, "Opening [%s] FAILED (Error %d: %s)\n",
+				in_path, errno, strerror(errno));
+		return false;
+	}
+
+	Reset();
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = BBQUE_RECIPE_COMPILED_MAGIC;
+	hdr.version = BBQUE_RECIPE_COMPILED_VERSION;
+	hdr.src_mtime = st.st_mtime;
+
+	try {
+		doc.LoadFile(in_path);
+
+		// <BarbequeRTRM>
+		root_node = doc.FirstChild();
+		root_node = root_node->NextSibling("BarbequeRTRM", true);
+		root_node->ToElement()->GetAttribute("recipe_version", &version_id);
+		sscanf(version_id.c_str(), "%d.%d", &maj, &min);
+		hdr.recipe_major = maj;
+		hdr.recipe_minor = min;
+
+		// <application>
+		app_elem = root_node->FirstChildElement("application", true);
+		app_elem->GetAttribute("priority", &prio, false);
+		hdr.priority = prio;
+
+		// <platform> sections
+		pp_elem = app_elem->FirstChildElement("platform", true);
+		while (pp_elem) {
+			if (!CompilePlatform(pp_elem))
+				return false;
+			pp_elem = pp_elem->NextSiblingElement("platform", false);
+		}
+
+	} catch(ticpp::Exception &ex) {
+		fprintf(stderr, "Parsing [%s] FAILED (Error: %s)\n",
+				in_path, ex.what());
+		return false;
+	}
+
+	if (!Write(out_path, hdr))
+		return false;
+
+	printf("%s: %zu platforms, %zu AWMs, %zu resource usages\n",
+			out_path, platforms.size(), awms.size(), usages.size());
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	const char *out_path = NULL;
+	std::string path;
+	int result = EXIT_SUCCESS;
+	size_t len;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			out_path = optarg;
+			break;
+		default:
+			Usage(argv[0]);
+			return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+	if ((optind >= argc) || (out_path && (argc - optind > 1))) {
+		Usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (out_path)
+		return Compile(argv[optind], out_path) ?
+			EXIT_SUCCESS : EXIT_FAILURE;
+
+	for ( ; optind < argc; ++optind) {
+		// The compiled recipe is placed beside the source one
+		path = argv[optind];
+		len = strlen(RECIPE_EXT);
+		if ((path.size() > len) &&
+				(path.compare(path.size() - len, len, RECIPE_EXT) == 0))
+			path.erase(path.size() - len);
+		path += BBQUE_RECIPE_COMPILED_EXT;
+
+		if (!Compile(argv[optind], path.c_str()))
+			result = EXIT_FAILURE;
+	}
+
+	return result;
+}
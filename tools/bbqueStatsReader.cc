@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief A reader of the RTLib live statistics rings
+ *
+ * The records of a ring, exported by an application running with the
+ * BBQUE_RTLIB_OPTS "L" option, are converted into CSV lines or aggregated,
+ * for each EXC and AWM, into a summary table.
+ */
+
+#include "bbque/rtlib/stats_ring.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace bbque::rtlib;
+
+/** The ring polling period [ms] while following it */
+#define STATS_READER_POLL_MS 100
+
+typedef struct Aggregate {
+	uint64_t records;
+	uint64_t cycles;
+	double time_sum;
+	float time_min;
+	float time_max;
+	uint64_t perf[BBQUE_STATS_RING_PERF_MAX];
+} Aggregate_t;
+
+/** Aggregated statistics, indexed by (EXC ID << 8 | AWM ID) */
+static std::map<uint16_t, Aggregate_t> aggregates;
+
+static volatile sig_atomic_t done = 0;
+
+static const char *sep = ",";
+
+static void Usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-f] [-a] [-s SEP] RING\n"
+			" -f      keep following the ring for new records\n"
+			" -a      aggregate records for each EXC and AWM\n"
+			" -s SEP  the CSV separator (default: \",\")\n"
+			" RING    the statistics ring file, e.g. "
+			"/var/bbque/bbque_stats_<pid>_<name>\n", name);
+}
+
+static void Terminate(int) {
+	done = 1;
+}
+
+static void PrintHeader(const rtlib_stats_ring_t *ring) {
+	printf("tstamp_us%sexc_id%sexc%sawm_id%scycles%s"
+			"time_avg_ms%stime_min_ms%stime_max_ms",
+			sep, sep, sep, sep, sep, sep, sep);
+	for (uint32_t i = 0; i < ring->nr_perf; ++i)
+		printf("%s%s", sep, ring->perf_names[i]);
+	putchar('\n');
+}
+
+static void PrintRecord(const rtlib_stats_ring_t *ring,
+		const rtlib_stats_record_t & rec) {
+	printf("%lu%s%u%s%s%s%u%s%u%s%.3f%s%.3f%s%.3f",
+			(unsigned long)(rec.tstamp_us - ring->tstart_us), sep,
+			rec.exc_id, sep, ring->exc_names[rec.exc_id], sep,
+			rec.awm_id, sep, rec.cycles, sep,
+			rec.time_avg_ms, sep, rec.time_min_ms, sep, rec.time_max_ms);
+	for (uint32_t i = 0; i < ring->nr_perf; ++i)
+		printf("%s%lu", sep,
+				(unsigned long)((i < rec.nr_perf) ? rec.perf[i] : 0));
+	putchar('\n');
+}
+
+static void AggregateRecord(const rtlib_stats_record_t & rec) {
+	uint16_t key = (rec.exc_id << 8) | rec.awm_id;
+	std::map<uint16_t, Aggregate_t>::iterator it;
+	Aggregate_t *pagg;
+
+	it = aggregates.find(key);
+	if (it == aggregates.end()) {
+		pagg = &aggregates[key];
+		memset(pagg, 0, sizeof(Aggregate_t));
+		pagg->time_min = rec.time_min_ms;
+		pagg->time_max = rec.time_max_ms;
+	} else {
+		pagg = &(*it).second;
+	}
+
+	++pagg->records;
+	pagg->cycles += rec.cycles;
+	pagg->time_sum += rec.time_avg_ms * rec.cycles;
+	if (rec.time_min_ms < pagg->time_min)
+		pagg->time_min = rec.time_min_ms;
+	if (rec.time_max_ms > pagg->time_max)
+		pagg->time_max = rec.time_max_ms;
+	for (uint8_t i = 0; i < rec.nr_perf; ++i)
+		pagg->perf[i] += rec.perf[i];
+}
+
+static void PrintAggregates(const rtlib_stats_ring_t *ring) {
+	std::map<uint16_t, Aggregate_t>::iterator it;
+	Aggregate_t *pagg;
+
+	printf("exc_id%sexc%sawm_id%srecords%scycles%s"
+			"time_avg_ms%stime_min_ms%stime_max_ms",
+			sep, sep, sep, sep, sep, sep, sep);
+	for (uint32_t i = 0; i < ring->nr_perf; ++i)
+		printf("%s%s_avg", sep, ring->perf_names[i]);
+	putchar('\n');
+
+	for (it = aggregates.begin(); it != aggregates.end(); ++it) {
+		pagg = &(*it).second;
+		printf("%u%s%s%s%u%s%lu%s%lu%s%.3f%s%.3f%s%.3f",
+				(*it).first >> 8, sep,
+				ring->exc_names[(*it).first >> 8], sep,
+				(*it).first & 0xFF, sep,
+				(unsigned long)pagg->records, sep,
+				(unsigned long)pagg->cycles, sep,
+				pagg->time_sum / pagg->cycles, sep,
+				pagg->time_min, sep, pagg->time_max);
+		for (uint32_t i = 0; i < ring->nr_perf; ++i)
+			printf("%s%.1f", sep, (double)pagg->perf[i] / pagg->cycles);
+		putchar('\n');
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const rtlib_stats_ring_t *ring;
+	struct stat ring_stat;
+	rtlib_stats_record_t rec;
+	bool aggregate = false;
+	bool follow = false;
+	uint64_t lost = 0;
+	uint64_t head;
+	uint64_t idx;
+	void *addr;
+	int opt;
+	int fd;
+
+	while ((opt = getopt(argc, argv, "fas:h")) != -1) {
+		switch (opt) {
+		case 'f':
+			follow = true;
+			break;
+		case 'a':
+			aggregate = true;
+			break;
+		case 's':
+			sep = optarg;
+			break;
+		default:
+			Usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc) {
+		Usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	fd = ::open(argv[optind], O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Opening [%s] FAILED (Error %d: %s)\n",
+				argv[optind], errno, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	// The whole ring must be backed by the file, or accessing it faults
+	if (fstat(fd, &ring_stat) ||
+			(ring_stat.st_size < (off_t)sizeof(rtlib_stats_ring_t))) {
+		fprintf(stderr, "[%s] is not a valid statistics ring\n",
+				argv[optind]);
+		::close(fd);
+		return EXIT_FAILURE;
+	}
+	addr = ::mmap(NULL, sizeof(rtlib_stats_ring_t), PROT_READ,
+			MAP_SHARED, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, "Mapping [%s] FAILED (Error %d: %s)\n",
+				argv[optind], errno, strerror(errno));
+		return EXIT_FAILURE;
+	}
+	ring = (const rtlib_stats_ring_t *)addr;
+
+	if ((__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) !=
+				BBQUE_STATS_RING_MAGIC) ||
+			(ring->version != BBQUE_STATS_RING_VERSION) ||
+			(ring->nr_perf > BBQUE_STATS_RING_PERF_MAX)) {
+		fprintf(stderr, "[%s] is not a valid statistics ring\n",
+				argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	signal(SIGINT, Terminate);
+	signal(SIGTERM, Terminate);
+
+	// Start from the oldest record still available
+	head = rtlib_stats_ring_head(ring);
+	idx = (head > BBQUE_STATS_RING_RECORDS) ?
+		head - BBQUE_STATS_RING_RECORDS : 0;
+
+	if (!aggregate)
+		PrintHeader(ring);
+
+	while (!done) {
+
+		for (head = rtlib_stats_ring_head(ring); idx < head; ++idx) {
+
+			// Skip records already overwritten
+			if (head - idx > BBQUE_STATS_RING_RECORDS) {
+				lost += head - idx - BBQUE_STATS_RING_RECORDS;
+				idx = head - BBQUE_STATS_RING_RECORDS;
+			}
+
+			// Stop at records not yet completed, which are
+			// retried at the next poll
+			if (!rtlib_stats_ring_read(ring, idx, rec)) {
+				if (__atomic_load_n(&ring->records[idx &
+						(BBQUE_STATS_RING_RECORDS - 1)].seq,
+						__ATOMIC_ACQUIRE) <= idx)
+					break;
+				++lost;
+				continue;
+			}
+
+			if (aggregate)
+				AggregateRecord(rec);
+			else
+				PrintRecord(ring, rec);
+		}
+
+		if (!follow)
+			break;
+
+		fflush(stdout);
+		usleep(STATS_READER_POLL_MS * 1000);
+	}
+
+	if (aggregate)
+		PrintAggregates(ring);
+
+	if (lost)
+		fprintf(stderr, "%lu records lost\n", (unsigned long)lost);
+
+	::munmap(addr, sizeof(rtlib_stats_ring_t));
+	return EXIT_SUCCESS;
+}
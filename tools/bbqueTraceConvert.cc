@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2012  Politecnico di Milano
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief A converter of the Barbeque trace files
+ *
+ * The records of a trace file, dumped by a Barbeque built with the
+ * CONFIG_BBQUE_TRACE option, are converted into the Chrome trace-event
+ * JSON format, which could be loaded by chrome://tracing or similar viewers.
+ */
+
+#include "bbque/utils/trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <vector>
+
+using namespace bbque::utils;
+
+/** The PID reported for all the events */
+#define TRACE_CONVERT_PID 1
+
+static void Usage(const char *name) {
+	fprintf(stderr, "Usage: %s [-o OUT] [TRACE]\n"
+			" -o OUT  the JSON output file (default: stdout)\n"
+			" TRACE   the trace file (default: %s)\n",
+			name, BBQUE_TRACE_FILE);
+}
+
+static bool OlderRecord(const trace_record_t & a, const trace_record_t & b) {
+	return a.tstamp_ns < b.tstamp_ns;
+}
+
+static void PrintName(FILE *out, const char *name) {
+	fputc('"', out);
+	for ( ; *name; ++name) {
+		if ((*name == '"') || (*name == '\\'))
+			fputc('\\', out);
+		fputc(*name, out);
+	}
+	fputc('"', out);
+}
+
+static void PrintRecord(FILE *out, const trace_record_t & rec,
+		const char *name, uint64_t tstart_ns) {
+	static const char phase[Tracer::EVENT_TYPES_COUNT] = {
+		'B', 'E', 'i', 'C'
+	};
+
+	fprintf(out, "{\"name\":");
+	PrintName(out, name);
+	fprintf(out, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,"
+			"\"pid\":%d,\"tid\":%u",
+			Tracer::CategoryStr(rec.cat), phase[rec.type],
+			(rec.tstamp_ns - tstart_ns) / 1000.0,
+			TRACE_CONVERT_PID, rec.tid);
+
+	switch (rec.type) {
+	case Tracer::BEGIN:
+	case Tracer::END:
+		fprintf(out, ",\"args\":{\"arg\":%lu}}",
+				(unsigned long)rec.arg.u64);
+		break;
+	case Tracer::INSTANT:
+		fprintf(out, ",\"s\":\"t\",\"args\":{\"arg\":%lu,\"arg2\":%lu}}",
+				(unsigned long)rec.arg.u64,
+				(unsigned long)rec.arg2);
+		break;
+	case Tracer::COUNTER:
+		// A distinct series for each value of the second argument,
+		// e.g. for each application
+		fprintf(out, ",\"args\":{\"%lu\":%g}}",
+				(unsigned long)rec.arg2, rec.arg.dbl);
+		break;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const char *in_path = BBQUE_TRACE_FILE;
+	std::vector<trace_record_t> recs;
+	std::vector<char> names;
+	trace_header_t hdr;
+	FILE *out = stdout;
+	FILE *in;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "o:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			out = fopen(optarg, "w");
+			if (!out) {
+				fprintf(stderr, "Opening [%s] FAILED "
+						"(Error %d: %s)\n",
+						optarg, errno, strerror(errno));
+				return EXIT_FAILURE;
+			}
+			break;
+		default:
+			Usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind < argc)
+		in_path = argv[optind];
+
+	in = fopen(in_path, "r");
+	if (!in) {
+		fprintf(stderr, "Opening [%s] FAILED (Error %d: %s)\n",
+				in_path, errno, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	if ((fread(&hdr, sizeof(hdr), 1, in) != 1) ||
+			(hdr.magic != BBQUE_TRACE_MAGIC) ||
+			(hdr.version != BBQUE_TRACE_VERSION)) {
+		fprintf(stderr, "[%s] is not a valid trace file\n", in_path);
+		return EXIT_FAILURE;
+	}
+
+	names.resize((size_t)hdr.nr_names * BBQUE_TRACE_NAME_LENGTH);
+	recs.resize(hdr.nr_records);
+	if ((fread(names.data(), BBQUE_TRACE_NAME_LENGTH, hdr.nr_names, in)
+				!= hdr.nr_names) ||
+			(fread(recs.data(), sizeof(trace_record_t), hdr.nr_records, in)
+				!= hdr.nr_records)) {
+		fprintf(stderr, "[%s] is truncated\n", in_path);
+		return EXIT_FAILURE;
+	}
+	fclose(in);
+
+	// Records are dumped ring by ring, while viewers expect the events
+	// of each thread in chronological order
+	std::stable_sort(recs.begin(), recs.end(), OlderRecord);
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+			"\"args\":{\"name\":\"barbeque\"}}",
+			TRACE_CONVERT_PID);
+	for (size_t i = 0; i < recs.size(); ++i) {
+		if ((recs[i].type >= Tracer::EVENT_TYPES_COUNT) ||
+				(recs[i].name >= hdr.nr_names))
+			continue;
+		fprintf(out, ",\n");
+		PrintRecord(out, recs[i],
+				&names[recs[i].name * BBQUE_TRACE_NAME_LENGTH],
+				recs[0].tstamp_ns);
+	}
+	fprintf(out, "\n],\n\"displayTimeUnit\":\"ns\"}\n");
+
+	if (out != stdout)
+		fclose(out);
+
+	if (hdr.nr_lost)
+		fprintf(stderr, "%lu records lost\n", (unsigned long)hdr.nr_lost);
+
+	return EXIT_SUCCESS;
+}